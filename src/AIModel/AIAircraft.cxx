@@ -43,6 +43,7 @@ extern double fgIsFinite(double x);
 #include "AIManager.hxx"
 #include "AIAircraft.hxx"
 #include "AIFlightPlan.hxx"
+#include "AITrafficSnapshot.hxx"
 #include "performancedata.hxx"
 #include "performancedb.hxx"
 #include <signal.h>
@@ -160,9 +161,9 @@ void FGAIAircraft::bind() {
 }
 
 void FGAIAircraft::update(double dt) {
-    FGAIBase::update(dt);
-    Run(dt);
-    Transform();
+    prepareUpdate(dt);
+    updateKinematics(dt);
+    commitUpdate(dt);
 }
 
 void FGAIAircraft::unbind()
@@ -184,8 +185,11 @@ void FGAIAircraft::setPerformance(const std::string& acType, const std::string&
     }
 }
 
- void FGAIAircraft::Run(double dt)
+// Flight plan, ATC and everything else that looks beyond this aircraft.
+void FGAIAircraft::prepareUpdate(double dt)
 {
+    FGAIBase::update(dt);
+
     // We currently have one situation in which an AIAircraft object is used that is not attached to the
     // AI manager. In this particular case, the AIAircraft is used to shadow the user's aircraft's behavior in the AI world.
     // Since we perhaps don't want a radar entry of our own aircraft, the following conditional should probably be adequate
@@ -195,11 +199,14 @@ void FGAIAircraft::setPerformance(const std::string& acType, const std::string&
     bool outOfSight = false,
          flightplanActive = true;
 
+    _updateSkipped = false;
+
     // user aircraft speed, heading and position are synchronzied in
     // FGAIManager::fetchUserState()
     if (!isUserAircraft) {
         updatePrimaryTargetValues(dt, flightplanActive, outOfSight); // target hdg, alt, speed
         if (outOfSight) {
+            _updateSkipped = true;
             return;
         }
     }
@@ -210,16 +217,30 @@ void FGAIAircraft::setPerformance(const std::string& acType, const std::string&
 
      handleATCRequests(dt); // ATC also has a word to say
      updateSecondaryTargetValues(dt); // target roll, vertical speed, pitch
-     updateActualState(dt);
+}
 
-     updateModelProperties(dt);
+// Moves the aircraft towards its targets using the performance data. Only
+// touches this aircraft, so the AI manager runs it on a worker thread.
+void FGAIAircraft::updateKinematics(double dt)
+{
+    if (!_updateSkipped) {
+        updateActualState(dt);
+    }
+}
 
+void FGAIAircraft::commitUpdate(double dt)
+{
+    if (!_updateSkipped) {
+        updateModelProperties(dt);
 
-     if (!isUserAircraft) {
-         UpdateRadar(manager);
-         invisible = !manager->isVisible(pos);
-     }
-  }
+        if (manager) {
+            UpdateRadar(manager);
+            invisible = !manager->isVisible(pos);
+        }
+    }
+
+    Transform();
+}
 
 
 void FGAIAircraft::AccelTo(double speed) {
@@ -523,6 +544,11 @@ void FGAIAircraft::checkTcas(void)
 void FGAIAircraft::initializeFlightPlan() {
 }
 
+void FGAIAircraft::fillTrafficEntry(FGTrafficEntry& entry) const {
+    FGAIBase::fillTrafficEntry(entry);
+    entry.transponderId = transponderCode;
+}
+
 const char * FGAIAircraft::_getTransponderCode() const {
   return transponderCode.c_str();
 }
@@ -44,6 +44,12 @@ public:
     void bind() override;
     void update(double dt) override;
     void unbind() override;
+    void fillTrafficEntry(FGTrafficEntry& entry) const override;
+
+    bool hasParallelUpdate() const override { return true; }
+    void prepareUpdate(double dt) override;
+    void updateKinematics(double dt) override;
+    void commitUpdate(double dt) override;
 
     void setPerformance(const std::string& acType, const std::string& perfString);
 
@@ -111,9 +117,6 @@ public:
     void clearATCController();
     void dumpCSVHeader(std::ofstream& o);
     void dumpCSV(std::ofstream& o, int lineIndex);
-protected:
-    void Run(double dt);
-
 private:
     FGAISchedule *trafficRef;
     FGATCController *controller,
@@ -190,6 +193,10 @@ private:
 
     bool needsTaxiClearance;
     bool _needsGroundElevation;
+
+    /// set by prepareUpdate() when the rest of this frame's update is skipped
+    bool _updateSkipped = false;
+
     int  takeOffStatus; // 1 = joined departure queue; 2 = Passed DepartureHold waypoint; handover control to tower; 0 = any other state. 
     time_t timeElapsed;
 
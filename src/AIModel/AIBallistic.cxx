@@ -142,6 +142,7 @@ void FGAIBallistic::reinit() {
     _impact_reported = false;
     _collision_reported = false;
     _expiry_reported = false;
+    _haveCollisionPos = false;
 
     _impact_lat = 0;
     _impact_lon = 0;
@@ -980,8 +981,11 @@ void FGAIBallistic::handle_expiry() {
 
 void FGAIBallistic::handle_collision()
 {
-    const FGAIBase *object = manager->calcCollision(pos.getElevationFt(),
-        pos.getLatitudeDeg(),pos.getLongitudeDeg(), _fuse_range);
+    const SGVec3d cartPos = getCartPos();
+    const SGVec3d start = _haveCollisionPos ? _collisionCartPos : cartPos;
+    const FGAIBase *object = manager->calcCollision(start, cartPos, _fuse_range);
+    _collisionCartPos = cartPos;
+    _haveCollisionPos = true;
 
     if (object) {
         report_impact(pos.getElevationM(), object);
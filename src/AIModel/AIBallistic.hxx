@@ -205,6 +205,11 @@ private:
 
     double _fuse_range;
 
+    // where the last collision check left off, so that the next one
+    // covers the whole path in between
+    SGVec3d _collisionCartPos;
+    bool _haveCollisionPos = false;
+
     std::string _submodel;
     std::string _force_path;
     std::string _contents_path;
@@ -50,6 +50,7 @@
 #include "AIFlightPlan.hxx"
 #include "AIBase.hxx"
 #include "AIManager.hxx"
+#include "AITrafficSnapshot.hxx"
 
 static std::string default_model = "Models/Geometry/glider.ac";
 const double FGAIBase::e = 2.71828183;
@@ -1086,6 +1087,23 @@ double FGAIBase::_getImpactSpeed() const {
     return _impact_speed;
 }
 
+void FGAIBase::fillTrafficEntry(FGTrafficEntry& entry) const {
+    entry.id = _refID;
+    entry.type = _otype;
+    entry.typeName = getTypeString();
+    entry.callsign = _callsign;
+    entry.transponderId.clear();
+    entry.position = pos;
+    entry.cartPos = SGVec3d::fromGeod(pos);
+    entry.headingDeg = hdg;
+    entry.trueAirspeedKt = speed;
+    entry.verticalSpeedFps = vs_fps;
+    entry.squawk = -1;
+    entry.transponderAltitudeFt = FGTrafficEntry::NO_ALTITUDE;
+    entry.invisible = false;
+    entry.props = props;
+}
+
 int FGAIBase::getID() const {
     return  _refID;
 }
@@ -42,6 +42,7 @@ class FGAIManager;
 class FGAIFlightPlan;
 class FGFX;
 class FGAIModelData;    // defined below
+struct FGTrafficEntry;
 
 
 class FGAIBase : public SGReferenced {
@@ -72,9 +73,29 @@ public:
     virtual bool init(ModelSearchOrder searchOrder);
     virtual void initModel();
     virtual void update(double dt);
+
+    /**
+     * Models returning true are updated by FGAIManager in three passes
+     * instead of through update(). prepareUpdate() and commitUpdate() run
+     * on the main thread; updateKinematics() runs on a worker thread,
+     * concurrently with other models. It may only change the model's own
+     * state: no property writes, no scene graph access and no looking at
+     * other AI objects.
+     */
+    virtual bool hasParallelUpdate() const { return false; }
+    virtual void prepareUpdate(double) {}
+    virtual void updateKinematics(double) {}
+    virtual void commitUpdate(double) {}
+
     virtual void bind();
     virtual void unbind();
     virtual void reinit() {}
+
+    /**
+     * Describes the object for the traffic snapshot, see FGAIManager.
+     * Subclasses add what only they know about, such as transponder state.
+     */
+    virtual void fillTrafficEntry(FGTrafficEntry& entry) const;
     // default model radius for LOD. 
     virtual double getDefaultModelRadius() { return 20.0; }
     void updateLOD();
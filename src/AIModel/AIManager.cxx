@@ -20,6 +20,9 @@
 
 #include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
 
 #include <simgear/debug/ErrorReportingCallback.hxx>
 #include <simgear/math/sg_geodesy.hxx>
@@ -28,6 +31,7 @@
 #include <simgear/structure/SGBinding.hxx>
 #include <simgear/structure/commands.hxx>
 #include <simgear/structure/exception.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include <Add-ons/AddonManager.hxx>
 #include <Airports/airport.hxx>
@@ -115,6 +119,17 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+struct FGAIManager::TypeTiming
+{
+    SGPropertyNode_ptr countNode;
+    SGPropertyNode_ptr mainThreadNode;
+    SGPropertyNode_ptr workerNode;
+
+    int count = 0;
+    int64_t mainThreadUSec = 0;
+    std::atomic<int64_t> workerUSec{0}; ///< summed over all worker threads
+};
+
 FGAIManager::FGAIManager() :
     cb_ai_bare(SGPropertyChangeCallback<FGAIManager>(this,&FGAIManager::updateLOD,
                fgGetNode("/sim/rendering/static-lod/aimp-bare", true))),
@@ -170,6 +185,28 @@ FGAIManager::init() {
     _radarRangeNode = fgGetNode("/instrumentation/radar/range", true);
     _radarDebugNode = fgGetNode("/instrumentation/radar/debug-mode", true);
 
+    // parallel update: threads 0 picks a count from the number of cores,
+    // and small populations aren't worth waking the workers for
+    SGPropertyNode* parallel = root->getNode("parallel-update", true);
+    _parallelEnabledNode = parallel->getNode("enabled", true);
+    if (!_parallelEnabledNode->hasValue())
+        _parallelEnabledNode->setBoolValue(true);
+    _parallelThreadsNode = parallel->getNode("threads", true);
+    if (!_parallelThreadsNode->hasValue())
+        _parallelThreadsNode->setIntValue(0);
+    _parallelMinModelsNode = parallel->getNode("min-models", true);
+    if (!_parallelMinModelsNode->hasValue())
+        _parallelMinModelsNode->setIntValue(16);
+
+    _gridCellSizeNode = root->getNode("spatial-grid/cell-size-m", true);
+    if (!_gridCellSizeNode->hasValue())
+        _gridCellSizeNode->setDoubleValue(1000.0);
+
+    _performanceNode = root->getNode("performance", true);
+    _updateTimeNode = _performanceNode->getNode("update-ms", true);
+    _workerThreadsNode = _performanceNode->getNode("worker-threads", true);
+    _parallelModelsNode = _performanceNode->getNode("parallel-models", true);
+
     // register scenarios if we didn't do it already
     registerScenarios();
 }
@@ -315,8 +352,16 @@ FGAIManager::shutdown()
     }
 
     ai_list.clear();
+    _grid.clear();
+    _ballisticObjects.clear();
+    _trafficSnapshot.clear();
     _environmentVisiblity.clear();
 
+    _workers.setNumThreads(0);
+    _parallelModels.clear();
+    _parallelTimings.clear();
+    _typeTimings.clear();
+
     if (_userAircraft) {
         _userAircraft->setDie(true);
         // we can't unbind() but we do need to clear these
@@ -386,14 +431,31 @@ FGAIManager::update(double dt)
     }
 
     ai_list.erase(ai_list.begin(), firstAlive);
+    rebuildSpatialGrid();
+
+    SGTimeStamp updateStart = SGTimeStamp::now();
+    updateParallelConfig();
+    for (auto& t : _typeTimings) {
+        t.second->count = 0;
+        t.second->mainThreadUSec = 0;
+        t.second->workerUSec.store(0, std::memory_order_relaxed);
+    }
 
     // every remaining item is alive. update them in turn, but guard for
     // exceptions, so a single misbehaving AI object doesn't bring down the
-    // entire subsystem.
+    // entire subsystem. Models with a parallel update only prepare here.
+    _parallelModels.clear();
+    _parallelTimings.clear();
     for (FGAIBase* base : ai_list) {
+        TypeTiming* timing = typeTiming(base);
+        SGTimeStamp st = SGTimeStamp::now();
         try {
             if (base->isa(FGAIBase::otThermal)) {
                 processThermal(dt, static_cast<FGAIThermal*>(base));
+            } else if (base->hasParallelUpdate()) {
+                base->prepareUpdate(dt);
+                _parallelModels.push_back(base);
+                _parallelTimings.push_back(timing);
             } else {
                 base->update(dt);
             }
@@ -402,9 +464,150 @@ FGAIManager::update(double dt)
                    "\n\tError:" << e.getFormattedMessage());
             base->setDie(true);
         }
+        ++timing->count;
+        timing->mainThreadUSec += (SGTimeStamp::now() - st).toUSecs();
     } // of live AI objects iteration
 
+    // kinematics of the prepared models, on the worker threads
+    const size_t numParallel = _parallelModels.size();
+    _parallelFailed.assign(numParallel, 0);
+    FGAIWorkerPool::Job kinematics = [this, dt](size_t i) {
+        FGAIBase* base = _parallelModels[i];
+        SGTimeStamp st = SGTimeStamp::now();
+        try {
+            base->updateKinematics(dt);
+        } catch (std::exception& e) {
+            SG_LOG(SG_AI, SG_WARN, "caught exception updating AI model:" << base->_getName()<< ", which will be killed."
+                   "\n\tError:" << e.what());
+            _parallelFailed[i] = 1;
+        }
+        _parallelTimings[i]->workerUSec.fetch_add((SGTimeStamp::now() - st).toUSecs(),
+                                                  std::memory_order_relaxed);
+    };
+
+    if (numParallel >= static_cast<size_t>(_parallelMinModelsNode->getIntValue())) {
+        _workers.run(numParallel, kinematics);
+    } else {
+        for (size_t i = 0; i < numParallel; ++i) {
+            kinematics(i);
+        }
+    }
+
+    // and back on the main thread for property and scene graph updates
+    for (size_t i = 0; i < numParallel; ++i) {
+        FGAIBase* base = _parallelModels[i];
+        if (_parallelFailed[i]) {
+            base->setDie(true);
+            continue;
+        }
+
+        SGTimeStamp st = SGTimeStamp::now();
+        try {
+            base->commitUpdate(dt);
+        } catch (sg_exception& e) {
+            SG_LOG(SG_AI, SG_WARN, "caught exception updating AI model:" << base->_getName()<< ", which will be killed."
+                   "\n\tError:" << e.getFormattedMessage());
+            base->setDie(true);
+        }
+        _parallelTimings[i]->mainThreadUSec += (SGTimeStamp::now() - st).toUSecs();
+    }
+
     thermal_lift_node->setDoubleValue( strength );  // for thermals
+
+    publishTrafficSnapshot();
+
+    updateTimingProperties((SGTimeStamp::now() - updateStart).toUSecs() / 1000.0);
+}
+
+void FGAIManager::rebuildSpatialGrid()
+{
+    _grid.setCellSize(_gridCellSizeNode->getDoubleValue());
+    _grid.clear();
+    _ballisticObjects.clear();
+
+    for (FGAIBase* base : ai_list) {
+        switch (base->getType()) {
+        case FGAIBase::otBallistic:
+            _ballisticObjects.push_back(base);
+            break;
+        case FGAIBase::otStorm:
+        case FGAIBase::otThermal:
+            // nothing to hit, and no wake
+            break;
+        default:
+            _grid.insert(base, base->getCartPos());
+        }
+    }
+
+    _grid.build();
+}
+
+void FGAIManager::publishTrafficSnapshot()
+{
+    // refill the previous one unless someone still holds on to it
+    if (!_trafficSnapshot || _trafficSnapshot.isShared()) {
+        _trafficSnapshot = new FGTrafficSnapshot;
+    }
+    FGTrafficSnapshot* snapshot = _trafficSnapshot.get();
+
+    snapshot->_frame = ++_trafficFrame;
+    snapshot->_simTimeSec = globals->get_sim_time_sec();
+    snapshot->_entries.resize(ai_list.size());
+
+    size_t count = 0;
+    for (FGAIBase* base : ai_list) {
+        // objects not attached to the property tree are not traffic yet
+        if (base->getDie() || !base->_getProps()) {
+            continue;
+        }
+        base->fillTrafficEntry(snapshot->_entries[count++]);
+    }
+    snapshot->_entries.resize(count);
+}
+
+void FGAIManager::updateParallelConfig()
+{
+    unsigned threads = 0;
+    if (_parallelEnabledNode->getBoolValue()) {
+        const int requested = _parallelThreadsNode->getIntValue();
+        if (requested > 0) {
+            threads = static_cast<unsigned>(requested);
+        } else {
+            // leave room for the OSG and other helper threads
+            threads = std::min(4u, std::thread::hardware_concurrency() / 2);
+        }
+    }
+
+    _workers.setNumThreads(threads);
+}
+
+FGAIManager::TypeTiming* FGAIManager::typeTiming(FGAIBase* base)
+{
+    const std::string type = base->getTypeString();
+    auto it = _typeTimings.find(type);
+    if (it == _typeTimings.end()) {
+        std::unique_ptr<TypeTiming> timing(new TypeTiming);
+        SGPropertyNode* node = _performanceNode->getNode(type, true);
+        timing->countNode = node->getNode("count", true);
+        timing->mainThreadNode = node->getNode("main-thread-ms", true);
+        timing->workerNode = node->getNode("worker-ms", true);
+        it = _typeTimings.insert(std::make_pair(type, std::move(timing))).first;
+    }
+    return it->second.get();
+}
+
+void FGAIManager::updateTimingProperties(double updateMSec)
+{
+    _updateTimeNode->setDoubleValue(updateMSec);
+    _workerThreadsNode->setIntValue(_workers.numThreads());
+    _parallelModelsNode->setIntValue(static_cast<int>(_parallelModels.size()));
+
+    for (auto& t : _typeTimings) {
+        TypeTiming* timing = t.second.get();
+        timing->countNode->setIntValue(timing->count);
+        timing->mainThreadNode->setDoubleValue(timing->mainThreadUSec / 1000.0);
+        timing->workerNode->setDoubleValue(timing->workerUSec.load(std::memory_order_relaxed) / 1000.0);
+    }
 }
 
 /** update LOD settings of all AI/MP models */
@@ -692,59 +895,60 @@ FGAIManager::loadScenarioFile(const std::string& scenarioName, SGPath& outPath)
 
 const FGAIBase *
 FGAIManager::calcCollision(double alt, double lat, double lon, double fuse_range)
+{
+    const SGVec3d cartPos(SGVec3d::fromGeod(SGGeod::fromDegFt(lon, lat, alt)));
+    return calcCollision(cartPos, cartPos, fuse_range);
+}
+
+const FGAIBase *
+FGAIManager::calcCollision(const SGVec3d& start, const SGVec3d& end, double fuse_range)
 {
     // we specify tgt extent (ft) according to the AIObject type
-    double tgt_ht[]     = {0,  50, 100, 250, 0, 100, 0, 0,  50,  50, 20, 100,  50};
-    double tgt_length[] = {0, 100, 200, 750, 0,  50, 0, 0, 200, 100, 40, 200, 100};
-    ai_list_iterator ai_list_itr = ai_list.begin();
-    ai_list_iterator end = ai_list.end();
-
-    SGGeod pos(SGGeod::fromDegFt(lon, lat, alt));
-    SGVec3d cartPos(SGVec3d::fromGeod(pos));
-
-    while (ai_list_itr != end) {
-        double tgt_alt = (*ai_list_itr)->_getAltitude();
-        int type       = (*ai_list_itr)->getType();
-        tgt_ht[type] += fuse_range;
-
-        if (fabs(tgt_alt - alt) > tgt_ht[type] || type == FGAIBase::otBallistic
-            || type == FGAIBase::otStorm || type == FGAIBase::otThermal ) {
-                //SG_LOG(SG_AI, SG_DEBUG, "AIManager: skipping "
-                //    << fabs(tgt_alt - alt)
-                //    << " "
-                //    << type
-                //    );
-                ++ai_list_itr;
-                continue;
+    static const double tgt_ht[]     = {0,  50, 100, 250, 0, 100, 0, 0,  50,  50, 20, 100,  50};
+    static const double tgt_length[] = {0, 100, 200, 750, 0,  50, 0, 0, 200, 100, 40, 200, 100};
+    const double max_length = *std::max_element(std::begin(tgt_length), std::end(tgt_length));
+
+    // the grid holds the positions from the start of the frame, allow
+    // for targets having moved since
+    const double searchM = (max_length + fuse_range) * SG_FEET_TO_METER + 100.0;
+    _collisionCandidates.clear();
+    _grid.findNearSegment(start, end, searchM, _collisionCandidates);
+
+    const FGAIBase* hit = nullptr;
+    double hitRange = 0.0;
+    for (const auto& candidate : _collisionCandidates) {
+        FGAIBase* target = candidate.object;
+        const int type = target->getType();
+
+        // the current position of the target and the closest point of the segment
+        const SGVec3d tgtPos = target->getCartPos();
+        const SGVec3d d = end - start;
+        const double len2 = dot(d, d);
+        const double along = (len2 > 0.0) ? SGMiscd::clip(dot(tgtPos - start, d) / len2, 0.0, 1.0) : 0.0;
+        const SGVec3d closest = start + along * d;
+
+        const double alt = SGGeod::fromCart(closest).getElevationFt();
+        const double tgt_alt = target->_getAltitude();
+        if (fabs(tgt_alt - alt) > tgt_ht[type] + fuse_range) {
+            continue;
         }
 
-        int id         = (*ai_list_itr)->getID();
-
-        double range = calcRangeFt(cartPos, (*ai_list_itr));
-
-        //SG_LOG(SG_AI, SG_DEBUG, "AIManager:  AI list size "
-        //    << ai_list.size()
-        //    << " type " << type
-        //    << " ID " << id
-        //    << " range " << range
-        //    //<< " bearing " << bearing
-        //    << " alt " << tgt_alt
-        //    );
-
-        tgt_length[type] += fuse_range;
-
-        if (range < tgt_length[type]){
-            SG_LOG(SG_AI, SG_DEBUG, "AIManager: HIT! "
-                << " type " << type
-                << " ID " << id
-                << " range " << range
-                << " alt " << tgt_alt
-                );
-            return (*ai_list_itr).get();
+        const double range = dist(closest, tgtPos) * SG_METER_TO_FEET;
+        if ((range < tgt_length[type] + fuse_range) && (!hit || (range < hitRange))) {
+            hit = target;
+            hitRange = range;
         }
-        ++ai_list_itr;
     }
-    return nullptr;
+
+    if (hit) {
+        SG_LOG(SG_AI, SG_DEBUG, "AIManager: HIT! "
+            << " type " << hit->getTypeString()
+            << " ID " << hit->getID()
+            << " range " << hitRange
+            << " alt " << hit->_getAltitude()
+            );
+    }
+    return hit;
 }
 
 double
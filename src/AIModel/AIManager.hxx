@@ -25,10 +25,17 @@
 
 #include <list>
 #include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/structure/SGSharedPtr.hxx>
 
+#include "AISpatialGrid.hxx"
+#include "AITrafficSnapshot.hxx"
+#include "AIWorkerPool.hxx"
+
 class FGAIBase;
 class FGAIThermal;
 class FGAIAircraft;
@@ -58,6 +65,12 @@ public:
 
     const FGAIBase *calcCollision(double alt, double lat, double lon, double fuse_range);
 
+    /**
+     * @brief the nearest object hit by something moving from start to end,
+     * e.g. a ballistic submodel during the last frame, or nullptr.
+     */
+    const FGAIBase *calcCollision(const SGVec3d& start, const SGVec3d& end, double fuse_range);
+
     inline double get_user_heading() const { return user_heading; }
     inline double get_user_pitch() const { return user_pitch; }
     inline double get_user_speed() const {return user_speed; }
@@ -93,6 +106,23 @@ public:
 
     double calcRangeFt(const SGVec3d& aCartPos, const FGAIBase* aObject) const;
 
+    /**
+     * @brief the live objects which can be hit or leave a wake, i.e. all but
+     * ballistic objects, storms and thermals, as of the start of the AI
+     * update. Rebuilt every frame; objects added since are missing.
+     */
+    const FGAISpatialGrid& spatialGrid() const { return _grid; }
+
+    /**
+     * @brief the live objects, including multiplayer aircraft, as of the end
+     * of the last AI update. Instruments and displays should use this
+     * rather than walking /ai/models.
+     */
+    FGTrafficSnapshotRef trafficSnapshot() const { return _trafficSnapshot; }
+
+    /// The live ballistic objects as of the start of the AI update.
+    const std::vector<FGAIBase*>& ballisticObjects() const { return _ballisticObjects; }
+
     /**
      * @brief Retrieve the representation of the user's aircraft in the AI manager
      * the position and velocity of this object are slaved to the user's aircraft,
@@ -122,6 +152,14 @@ private:
 
     void removeDeadItem(FGAIBase* base);
 
+    void rebuildSpatialGrid();
+    void publishTrafficSnapshot();
+
+    struct TypeTiming;
+    TypeTiming* typeTiming(FGAIBase* base);
+    void updateParallelConfig();
+    void updateTimingProperties(double updateMSec);
+
     // Returns true on success, e.g. returns false if scenario is already loaded.
     bool loadScenarioCommand(const SGPropertyNode* args, SGPropertyNode* root);
     
@@ -175,6 +213,29 @@ private:
     bool _radarEnabled = true,
         _radarDebugMode = false;
     double _radarRangeM = 0.0;
+
+    // Models with a parallel update have their kinematics run on these
+    // workers, see FGAIBase::hasParallelUpdate()
+    FGAIWorkerPool _workers;
+    std::vector<FGAIBase*> _parallelModels;
+    std::vector<TypeTiming*> _parallelTimings;
+    std::vector<char> _parallelFailed;
+
+    FGAISpatialGrid _grid;
+    std::vector<FGAIBase*> _ballisticObjects;
+    FGAISpatialGrid::ResultList _collisionCandidates;
+    SGPropertyNode_ptr _gridCellSizeNode;
+
+    FGTrafficSnapshotRef _trafficSnapshot;
+    uint64_t _trafficFrame = 0;
+
+    SGPropertyNode_ptr _parallelEnabledNode,
+        _parallelThreadsNode, _parallelMinModelsNode;
+
+    // per model type update cost, published under /sim/ai/performance
+    std::map<std::string, std::unique_ptr<TypeTiming>> _typeTimings;
+    SGPropertyNode_ptr _performanceNode, _updateTimeNode,
+        _workerThreadsNode, _parallelModelsNode;
 };
 
 #endif  // _FG_AIMANAGER_HXX
@@ -29,11 +29,13 @@
 #include <stdio.h>
 
 #include <Aircraft/replay.hxx>
+#include <MultiPlayer/multiplaymgr.hxx>
 #include <Main/globals.hxx>
 #include <Main/fg_props.hxx>
 #include <Time/TimeManager.hxx>
 
 #include "AIMultiplayer.hxx"
+#include "AITrafficSnapshot.hxx"
 
 using std::string;
 
@@ -160,7 +162,14 @@ void FGAIMultiplayer::FGAIMultiplayerInterpolate(
         nextIt->second.orientation);
     ecLinearVel = interpolate((float)tau, prevIt->second.linearVel, nextIt->second.linearVel);
     speed = norm(ecLinearVel) * SG_METER_TO_NM * 3600.0;
+}
 
+void FGAIMultiplayer::FGAIMultiplayerInterpolateProperties(
+        MotionInfo::iterator prevIt,
+        MotionInfo::iterator nextIt,
+        double tau
+        )
+{
     if (prevIt->second.properties.size()
         == nextIt->second.properties.size())
     {
@@ -174,12 +183,12 @@ void FGAIMultiplayer::FGAIMultiplayerInterpolate(
         nextPropItEnd = nextIt->second.properties.end();
         while (prevPropIt != prevPropItEnd)
         {
-            PropertyMap::iterator pIt = mPropertyMap.find((*prevPropIt)->id);
+            SGPropertyNode* pNode = findPropertyNode((*prevPropIt)->id);
             //cout << " Setting property..." << (*prevPropIt)->id;
 
-            if (pIt != mPropertyMap.end())
+            if (pNode)
             {
-                //cout << "Found " << pIt->second->getPath() << ":";
+                //cout << "Found " << pNode->getPath() << ":";
 
                 float val;
                 /*
@@ -204,26 +213,26 @@ void FGAIMultiplayer::FGAIMultiplayerInterpolate(
                             // Jean Pellotier, 2018-01-02 : we don't want interpolation for integer values, they are mostly used
                             // for non linearly changing values (e.g. transponder etc ...)
                             // fixes: https://sourceforge.net/p/flightgear/codetickets/1885/
-                            pIt->second->setIntValue((*nextPropIt)->int_value);
+                            pNode->setIntValue((*nextPropIt)->int_value);
                             break;
                         case simgear::props::FLOAT:
                         case simgear::props::DOUBLE:
                             val = (1 - tau)*(*prevPropIt)->float_value +
                                 tau*(*nextPropIt)->float_value;
                             //cout << "Flo: " << val << "\n";
-                            pIt->second->setFloatValue(val);
+                            pNode->setFloatValue(val);
                             break;
                         case simgear::props::STRING:
                         case simgear::props::UNSPECIFIED:
                             //cout << "Str: " << (*nextPropIt)->string_value << "\n";
-                            pIt->second->setStringValue((*nextPropIt)->string_value);
+                            pNode->setStringValue((*nextPropIt)->string_value);
                             break;
                         default:
                             // FIXME - currently defaults to float values
                             val = (1 - tau)*(*prevPropIt)->float_value +
                                 tau*(*nextPropIt)->float_value;
                             //cout << "Unk: " << val << "\n";
-                            pIt->second->setFloatValue(val);
+                            pNode->setFloatValue(val);
                             break;
                     }
                 }
@@ -260,15 +269,11 @@ void FGAIMultiplayer::FGAIMultiplayerExtrapolate(
     double t = tInterp - nextIt->first;
     if (!motion_logging)
     {
-        props->setDoubleValue("lag/extrapolation-t", t);
+        mMotionUpdate.extrapolationT = t;
+        mMotionUpdate.extrapolationOutOfRange = t > 3;
         if (t > 3)
         {
             t = 3;
-            props->setBoolValue("lag/extrapolation-out-of-range", true);
-        }
-        else
-        {
-            props->setBoolValue("lag/extrapolation-out-of-range", false);
         }
     }
 
@@ -282,8 +287,8 @@ void FGAIMultiplayer::FGAIMultiplayerExtrapolate(
 
     double normVel = norm(ecVel);
     double normAngularVel = norm(angularVel);
-    props->setDoubleValue("lag/norm-vel", normVel);
-    props->setDoubleValue("lag/norm-angular-vel", normAngularVel);
+    mMotionUpdate.normVel = normVel;
+    mMotionUpdate.normAngularVel = normAngularVel;
     
     // not doing rotationnal prediction for small speed or rotation rate,
     // to avoid agitated parked plane
@@ -304,39 +309,43 @@ void FGAIMultiplayer::FGAIMultiplayerExtrapolate(
         ecPos += t*(ecVel);
     }
 
+    speed = norm(ecLinearVel) * SG_METER_TO_NM * 3600.0;
+}
+
+void FGAIMultiplayer::applyProperties(const std::vector<FGPropertyData*>& properties)
+{
     std::vector<FGPropertyData*>::const_iterator firstPropIt;
     std::vector<FGPropertyData*>::const_iterator firstPropItEnd;
-    speed = norm(ecLinearVel) * SG_METER_TO_NM * 3600.0;
-    firstPropIt = motionInfo.properties.begin();
-    firstPropItEnd = motionInfo.properties.end();
+    firstPropIt = properties.begin();
+    firstPropItEnd = properties.end();
     while (firstPropIt != firstPropItEnd)
     {
-        PropertyMap::iterator pIt = mPropertyMap.find((*firstPropIt)->id);
+        SGPropertyNode* pNode = findPropertyNode((*firstPropIt)->id);
         //cout << " Setting property..." << (*firstPropIt)->id;
 
-        if (pIt != mPropertyMap.end())
+        if (pNode)
         {
             switch ((*firstPropIt)->type)
             {
               case simgear::props::INT:
               case simgear::props::BOOL:
               case simgear::props::LONG:
-                  pIt->second->setIntValue((*firstPropIt)->int_value);
+                  pNode->setIntValue((*firstPropIt)->int_value);
                   //cout << "Int: " << (*firstPropIt)->int_value << "\n";
                   break;
               case simgear::props::FLOAT:
               case simgear::props::DOUBLE:
-                  pIt->second->setFloatValue((*firstPropIt)->float_value);
+                  pNode->setFloatValue((*firstPropIt)->float_value);
                   //cout << "Flo: " << (*firstPropIt)->float_value << "\n";
                   break;
               case simgear::props::STRING:
               case simgear::props::UNSPECIFIED:
-                  pIt->second->setStringValue((*firstPropIt)->string_value);
+                  pNode->setStringValue((*firstPropIt)->string_value);
                   //cout << "Str: " << (*firstPropIt)->string_value << "\n";
                   break;
               default:
                   // FIXME - currently defaults to float values
-                  pIt->second->setFloatValue((*firstPropIt)->float_value);
+                  pNode->setFloatValue((*firstPropIt)->float_value);
                   //cout << "Unk: " << (*firstPropIt)->float_value << "\n";
                   break;
             }
@@ -436,32 +445,49 @@ static void s_MotionLogging(const std::string& _callsign, double tInterp, SGVec3
 
 void FGAIMultiplayer::update(double dt)
 {
-    using namespace simgear;
+    prepareUpdate(dt);
+    updateKinematics(dt);
+    commitUpdate(dt);
+}
 
+void FGAIMultiplayer::prepareUpdate(double dt)
+{
+    mMotionUpdate.valid = false;
     if (dt <= 0)
     {
         return;
     }
     FGAIBase::update(dt);
 
-    // Check if we already got data
-    if (mMotionInfo.empty())
+    // updateKinematics() can't look these up from a worker thread, so
+    // read them here on the main thread.
+    //
+    // motionLogging is true if we are being run by
+    // scripts/python/recordreplay.py --test-motion-mp.
+    const char* callsign = mLogRawSpeedMultiplayer->getStringValue();
+    mMotionUpdate.motionLogging = callsign && callsign[0] && this->_callsign == callsign;
+    mMotionUpdate.mpClockSec = globals->get_subsystem<TimeManager>()->getMPProtocolClockSec();
+}
+
+// Works out where the aircraft is from the received motion frames. This runs
+// on the AI manager's worker threads, so it only reads the property tree.
+void FGAIMultiplayer::updateKinematics(double dt)
+{
+    using namespace simgear;
+
+    if (dt <= 0)
     {
         return;
     }
 
-    // motion_logging is true if we are being run by
-    // scripts/python/recordreplay.py --test-motion-mp.
-    //
-    bool motion_logging = false;
+    // Check if we already got data
+    if (mMotionInfo.empty())
     {
-        const char* callsign = mLogRawSpeedMultiplayer->getStringValue();
-        if (callsign && callsign[0] && this->_callsign == callsign)
-        {
-            motion_logging = true;
-        }
+        return;
     }
-    
+
+    const bool motion_logging = mMotionUpdate.motionLogging;
+
     double curtime;
     double tInterp;
     if (m_simple_time_enabled->getBoolValue())
@@ -475,7 +501,7 @@ void FGAIMultiplayer::update(double dt)
         }
         else
         {
-            tInterp = globals->get_subsystem<TimeManager>()->getMPProtocolClockSec();
+            tInterp = mMotionUpdate.mpClockSec;
         }
         curtime = tInterp;
     }
@@ -489,7 +515,7 @@ void FGAIMultiplayer::update(double dt)
         // note that the simulation time is updated before calling all the
         // update methods. Thus motioninfo_back contains the time intervals *end* time
         // 2018: notice this time is specifically used for mp protocol
-        curtime = globals->get_subsystem<TimeManager>()->getMPProtocolClockSec();
+        curtime = mMotionUpdate.mpClockSec;
 
         // Dynamically optimize the time offset between the feeder and the client
         // Well, 'dynamically' means that the dynamic of that update must be very
@@ -511,8 +537,7 @@ void FGAIMultiplayer::update(double dt)
             mTimeOffset = curentPkgTime - curtime - lag;
             lastTime = curentPkgTime;
             lagModAveraged = remainder((curentPkgTime - curtime), 3600.0);
-            props->setDoubleValue("lag/pps-averaged", lagPpsAveraged);
-            props->setDoubleValue("lag/lag-mod-averaged", lagModAveraged);
+            mMotionUpdate.lagStatsChanged = true;
         }
         else
         {
@@ -522,8 +547,7 @@ void FGAIMultiplayer::update(double dt)
                 lastTime = curentPkgTime;
                 rawLagMod = remainder(rawLag, 3600.0);
                 lagModAveraged = lagModAveraged *0.99 + 0.01 * rawLagMod;
-                props->setDoubleValue("lag/pps-averaged", lagPpsAveraged);
-                props->setDoubleValue("lag/lag-mod-averaged", lagModAveraged);
+                mMotionUpdate.lagStatsChanged = true;
             }
 
             double offset = 0.0;
@@ -663,6 +687,8 @@ void FGAIMultiplayer::update(double dt)
         }
         
         FGAIMultiplayerInterpolate(prevIt, nextIt, tau, ecPos, ecOrient, ecLinearVel);
+        mMotionUpdate.interpolated = true;
+        mMotionUpdate.tau = tau;
     }
     else
     {
@@ -671,7 +697,10 @@ void FGAIMultiplayer::update(double dt)
         --nextIt;
         --prevIt;   // so mMotionInfo.erase() does the right thing below.
         FGAIMultiplayerExtrapolate(nextIt, tInterp, motion_logging, ecPos, ecOrient, ecLinearVel);
+        mMotionUpdate.interpolated = false;
     }
+    mMotionUpdate.prevIt = prevIt;
+    mMotionUpdate.nextIt = nextIt;
 
     // Remove any motion information before <prevIt> - we will not need this in
     // the future.
@@ -708,6 +737,51 @@ void FGAIMultiplayer::update(double dt)
     roll = rDeg;
     pitch = pDeg;
 
+    mMotionUpdate.tInterp = tInterp;
+    mMotionUpdate.ecPos = ecPos;
+    mMotionUpdate.ecLinearVel = ecLinearVel;
+    mMotionUpdate.hDeg = hDeg;
+    mMotionUpdate.valid = true;
+}
+
+// Writes the results of updateKinematics() to the property tree and scene
+// graph, on the main thread.
+void FGAIMultiplayer::commitUpdate(double dt)
+{
+    SG_UNUSED(dt);
+    if (!mMotionUpdate.valid)
+    {
+        return;
+    }
+    mMotionUpdate.valid = false;
+
+    const bool motion_logging = mMotionUpdate.motionLogging;
+    const SGVec3f& ecLinearVel = mMotionUpdate.ecLinearVel;
+    const float hDeg = mMotionUpdate.hDeg;
+
+    if (mMotionUpdate.lagStatsChanged)
+    {
+        props->setDoubleValue("lag/pps-averaged", lagPpsAveraged);
+        props->setDoubleValue("lag/lag-mod-averaged", lagModAveraged);
+        mMotionUpdate.lagStatsChanged = false;
+    }
+
+    if (mMotionUpdate.interpolated)
+    {
+        FGAIMultiplayerInterpolateProperties(mMotionUpdate.prevIt, mMotionUpdate.nextIt, mMotionUpdate.tau);
+    }
+    else
+    {
+        if (!motion_logging)
+        {
+            props->setDoubleValue("lag/extrapolation-t", mMotionUpdate.extrapolationT);
+            props->setBoolValue("lag/extrapolation-out-of-range", mMotionUpdate.extrapolationOutOfRange);
+        }
+        props->setDoubleValue("lag/norm-vel", mMotionUpdate.normVel);
+        props->setDoubleValue("lag/norm-angular-vel", mMotionUpdate.normAngularVel);
+        applyProperties(mMotionUpdate.nextIt->second.properties);
+    }
+
     // expose velocities/u,v,wbody-fps in the mp tree
     _uBodyNode->setValue(ecLinearVel[0] * SG_METER_TO_FEET);
     _vBodyNode->setValue(ecLinearVel[1] * SG_METER_TO_FEET);
@@ -772,7 +846,7 @@ void FGAIMultiplayer::update(double dt)
 
     if (motion_logging)
     {
-        s_MotionLogging(_callsign, tInterp, ecPos, pos);
+        s_MotionLogging(_callsign, mMotionUpdate.tInterp, mMotionUpdate.ecPos, pos);
     }
     
     //###########################//
@@ -935,6 +1009,47 @@ FGAIMultiplayer::addMotionInfo(FGExternalMotionData& motionInfo,
     
 }
 
+void
+FGAIMultiplayer::addPropertyId(unsigned id, const char* name)
+{
+  int index = FGMultiplayMgr::getPropertyIndex(id);
+  if (index < 0)
+    return;
+  if (mPropertyNodes.empty())
+    mPropertyNodes.resize(FGMultiplayMgr::getNumPropertyIds());
+  mPropertyNodes[index] = props->getNode(name, true);
+}
+
+SGPropertyNode*
+FGAIMultiplayer::findPropertyNode(unsigned id) const
+{
+  int index = FGMultiplayMgr::getPropertyIndex(id);
+  if (index < 0 || index >= (int)mPropertyNodes.size())
+    return nullptr;
+  return mPropertyNodes[index];
+}
+
+void
+FGAIMultiplayer::fillTrafficEntry(FGTrafficEntry& entry) const
+{
+  FGAIBase::fillTrafficEntry(entry);
+  entry.invisible = invisible;
+
+  // the transponder properties arrive as multiplayer property ids 1500
+  // (transmitted-id) and 1501 (altitude), see FGMultiplayMgr
+  const SGPropertyNode* code = findPropertyNode(1500);
+  if (!code)
+    code = props->getNode("instrumentation/transponder/transmitted-id");
+  if (code)
+    entry.squawk = code->getIntValue();
+
+  const SGPropertyNode* altitude = findPropertyNode(1501);
+  if (!altitude)
+    altitude = props->getNode("instrumentation/transponder/altitude");
+  if (altitude)
+    entry.transponderAltitudeFt = altitude->getIntValue();
+}
+
 void
 FGAIMultiplayer::setDoubleProperty(const std::string& prop, double val)
 {
@@ -23,6 +23,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include <MultiPlayer/mpmessages.hxx>
 #include "AIBase.hxx"
@@ -36,7 +37,18 @@ public:
   void bind() override;
   void update(double dt) override;
 
+  bool hasParallelUpdate() const override { return true; }
+  void prepareUpdate(double dt) override;
+  void updateKinematics(double dt) override;
+  void commitUpdate(double dt) override;
+
+  void fillTrafficEntry(FGTrafficEntry& entry) const override;
+
   void addMotionInfo(FGExternalMotionData& motionInfo, long stamp);
+
+  // Sets the property values of this aircraft directly, without going
+  // through a motion frame.
+  void applyProperties(const std::vector<FGPropertyData*>& properties);
   void setDoubleProperty(const std::string& prop, double val);
 
   long getLastTimestamp(void) const
@@ -66,10 +78,7 @@ public:
     return mLagAdjustSystemSpeed;
   }
 
-  void addPropertyId(unsigned id, const char* name)
-  {
-    mPropertyMap[id] = props->getNode(name, true);
-  }
+  void addPropertyId(unsigned id, const char* name);
 
   double getplayerLag(void) const
   {
@@ -109,10 +118,12 @@ private:
   typedef std::map<double,FGExternalMotionData> MotionInfo;
   MotionInfo mMotionInfo;
 
-  // Map between the property id's from the multiplayers network packets
-  // and the property nodes
-  typedef std::map<unsigned, SGSharedPtr<SGPropertyNode> > PropertyMap;
-  PropertyMap mPropertyMap;
+  // The property nodes for the property id's from the multiplayers network
+  // packets, indexed by FGMultiplayMgr::getPropertyIndex() so that applying
+  // a received property is an array lookup.
+  std::vector<SGPropertyNode_ptr> mPropertyNodes;
+
+  SGPropertyNode* findPropertyNode(unsigned id) const;
   
   // Calculates position, orientation and velocity using interpolation between
   // *prevIt and *nextIt, specifically (1-tau)*(*prevIt) + tau*(*nextIt).
@@ -129,6 +140,14 @@ private:
         SGVec3f& ecLinearVel
         );
 
+  // Sets the properties interpolated between *prevIt and *nextIt.
+  //
+  void FGAIMultiplayerInterpolateProperties(
+        MotionInfo::iterator prevIt,
+        MotionInfo::iterator nextIt,
+        double tau
+        );
+
   // Calculates position, orientation and velocity using extrapolation from
   // *nextIt.
   //
@@ -151,6 +170,31 @@ private:
   double lagPpsAveraged;
   double rawLag, rawLagMod, lagModAveraged;
 
+  // What updateKinematics() computed and commitUpdate() has to write to the
+  // property tree. prevIt and nextIt stay valid in between, as only
+  // updateKinematics() erases from mMotionInfo. motionLogging and mpClockSec
+  // are filled in by prepareUpdate() on the main thread.
+  struct MotionUpdate
+  {
+    bool valid = false;
+    bool motionLogging = false;
+    double mpClockSec = 0.0;
+    bool interpolated = false;
+    bool lagStatsChanged = false;
+    MotionInfo::iterator prevIt;
+    MotionInfo::iterator nextIt;
+    double tau = 0.0;
+    double tInterp = 0.0;
+    SGVec3d ecPos;
+    SGVec3f ecLinearVel;
+    float hDeg = 0.0f;
+    double extrapolationT = 0.0;
+    bool extrapolationOutOfRange = false;
+    double normVel = 0.0;
+    double normAngularVel = 0.0;
+  };
+  MotionUpdate mMotionUpdate;
+
   /// Properties which are for now exposed for testing
   bool mAllowExtrapolation;
   double mLagAdjustSystemSpeed;
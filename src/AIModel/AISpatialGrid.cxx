@@ -0,0 +1,201 @@
+// AISpatialGrid.cxx - uniform grid of AI objects for proximity queries
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "AISpatialGrid.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 21 bits per axis: enough for 10m cells out to twice the earth radius
+const int KEY_BITS = 21;
+const int KEY_OFFSET = 1 << (KEY_BITS - 1);
+const double MIN_CELL_SIZE_M = 10.0;
+
+double segmentDistance(const SGVec3d& start, const SGVec3d& end,
+                       const SGVec3d& p, double& along)
+{
+    const SGVec3d d = end - start;
+    const double len2 = dot(d, d);
+    along = (len2 > 0.0) ? SGMiscd::clip(dot(p - start, d) / len2, 0.0, 1.0) : 0.0;
+    return dist(start + along * d, p);
+}
+
+} // of anonymous namespace
+
+FGAISpatialGrid::FGAISpatialGrid(double cellSizeM) :
+    _cellSizeM(std::max(MIN_CELL_SIZE_M, cellSizeM)),
+    _pendingCellSizeM(_cellSizeM)
+{
+}
+
+void FGAISpatialGrid::setCellSize(double cellSizeM)
+{
+    _pendingCellSizeM = std::max(MIN_CELL_SIZE_M, cellSizeM);
+}
+
+void FGAISpatialGrid::clear()
+{
+    _entries.clear();
+    _cells.clear();
+}
+
+void FGAISpatialGrid::insert(FGAIBase* object, const SGVec3d& cartPos)
+{
+    _entries.push_back({0, object, cartPos});
+}
+
+int FGAISpatialGrid::cellIndex(double coord) const
+{
+    const int i = static_cast<int>(std::floor(coord / _cellSizeM));
+    return std::min(std::max(i, -KEY_OFFSET), KEY_OFFSET - 1);
+}
+
+uint64_t FGAISpatialGrid::cellKey(int x, int y, int z)
+{
+    const uint64_t mask = (uint64_t(1) << KEY_BITS) - 1;
+    return ((uint64_t(x + KEY_OFFSET) & mask) << (2 * KEY_BITS)) |
+           ((uint64_t(y + KEY_OFFSET) & mask) << KEY_BITS) |
+           (uint64_t(z + KEY_OFFSET) & mask);
+}
+
+void FGAISpatialGrid::build()
+{
+    _cellSizeM = _pendingCellSizeM;
+    for (Entry& e : _entries) {
+        e.key = cellKey(cellIndex(e.cartPos.x()), cellIndex(e.cartPos.y()),
+                        cellIndex(e.cartPos.z()));
+    }
+
+    // objects of a cell end up next to each other, so a cell is a range
+    std::sort(_entries.begin(), _entries.end(),
+              [](const Entry& a, const Entry& b) { return a.key < b.key; });
+
+    _cells.clear();
+    _cells.reserve(_entries.size());
+    for (uint32_t i = 0; i < _entries.size();) {
+        uint32_t j = i + 1;
+        while ((j < _entries.size()) && (_entries[j].key == _entries[i].key)) {
+            ++j;
+        }
+        _cells.emplace(_entries[i].key, Range(i, j));
+        i = j;
+    }
+}
+
+template <class Visit>
+void FGAISpatialGrid::visitBox(const SGVec3d& min, const SGVec3d& max, const Visit& visit) const
+{
+    const int x0 = cellIndex(min.x()), x1 = cellIndex(max.x());
+    const int y0 = cellIndex(min.y()), y1 = cellIndex(max.y());
+    const int z0 = cellIndex(min.z()), z1 = cellIndex(max.z());
+
+    // for a box spanning more cells than are occupied, looking at every
+    // object is cheaper than hashing every cell
+    const double boxCells = double(x1 - x0 + 1) * double(y1 - y0 + 1) * double(z1 - z0 + 1);
+    if (boxCells > _cells.size()) {
+        for (const Entry& e : _entries) {
+            visit(e);
+        }
+        return;
+    }
+
+    for (int x = x0; x <= x1; ++x) {
+        for (int y = y0; y <= y1; ++y) {
+            for (int z = z0; z <= z1; ++z) {
+                auto it = _cells.find(cellKey(x, y, z));
+                if (it == _cells.end()) {
+                    continue;
+                }
+                for (uint32_t i = it->second.first; i < it->second.second; ++i) {
+                    visit(_entries[i]);
+                }
+            }
+        }
+    }
+}
+
+void FGAISpatialGrid::findInRange(const SGVec3d& center, double rangeM, ResultList& out) const
+{
+    const SGVec3d r(rangeM, rangeM, rangeM);
+    visitBox(center - r, center + r, [&](const Entry& e) {
+        const double d = dist(center, e.cartPos);
+        if (d <= rangeM) {
+            Result result;
+            result.object = e.object;
+            result.cartPos = e.cartPos;
+            result.distanceM = d;
+            out.push_back(result);
+        }
+    });
+}
+
+void FGAISpatialGrid::findNearest(const SGVec3d& center, size_t n, double maxRangeM,
+                                  ResultList& out) const
+{
+    out.clear();
+    if ((n == 0) || _entries.empty()) {
+        return;
+    }
+
+    // widen the search until it holds n objects: the n nearest are then
+    // all inside it
+    double rangeM = std::min(_cellSizeM, maxRangeM);
+    for (;;) {
+        out.clear();
+        findInRange(center, rangeM, out);
+        if ((out.size() >= n) || (rangeM >= maxRangeM) || (out.size() == _entries.size())) {
+            break;
+        }
+        rangeM = std::min(rangeM * 2.0, maxRangeM);
+    }
+
+    auto closer = [](const Result& a, const Result& b) { return a.distanceM < b.distanceM; };
+    if (out.size() > n) {
+        std::partial_sort(out.begin(), out.begin() + n, out.end(), closer);
+        out.resize(n);
+    } else {
+        std::sort(out.begin(), out.end(), closer);
+    }
+}
+
+void FGAISpatialGrid::findNearSegment(const SGVec3d& start, const SGVec3d& end, double rangeM,
+                                      ResultList& out) const
+{
+    const SGVec3d r(rangeM, rangeM, rangeM);
+    const SGVec3d min(std::min(start.x(), end.x()), std::min(start.y(), end.y()),
+                      std::min(start.z(), end.z()));
+    const SGVec3d max(std::max(start.x(), end.x()), std::max(start.y(), end.y()),
+                      std::max(start.z(), end.z()));
+
+    visitBox(min - r, max + r, [&](const Entry& e) {
+        double along;
+        const double d = segmentDistance(start, end, e.cartPos, along);
+        if (d <= rangeM) {
+            Result result;
+            result.object = e.object;
+            result.cartPos = e.cartPos;
+            result.distanceM = d;
+            result.along = along;
+            out.push_back(result);
+        }
+    });
+}
@@ -0,0 +1,97 @@
+// AISpatialGrid.hxx - uniform grid of AI objects for proximity queries
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef _FG_AISPATIALGRID_HXX
+#define _FG_AISPATIALGRID_HXX
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <simgear/math/SGMath.hxx>
+
+class FGAIBase;
+
+/**
+ * A snapshot of AI object positions, hashed into cubic cells of earth
+ * centered cartesian space, which answers range, nearest-n and segment
+ * queries without visiting every object.
+ *
+ * The grid only stores the pointers and the positions handed to insert();
+ * it is rebuilt from scratch with clear(), insert() and build(), and the
+ * objects must outlive it until the next rebuild. Queries are const and
+ * may run concurrently once build() has returned.
+ */
+class FGAISpatialGrid
+{
+public:
+    struct Result
+    {
+        FGAIBase* object = nullptr;
+        SGVec3d cartPos;          ///< as inserted
+        double distanceM = 0.0;   ///< to the query point or segment
+        double along = 0.0;       ///< closest point on a segment, 0 at its start, 1 at its end
+    };
+    typedef std::vector<Result> ResultList;
+
+    explicit FGAISpatialGrid(double cellSizeM = 1000.0);
+
+    /// Takes effect with the next build().
+    void setCellSize(double cellSizeM);
+    double cellSize() const { return _cellSizeM; }
+
+    void clear();
+    void insert(FGAIBase* object, const SGVec3d& cartPos);
+    void build();
+
+    size_t size() const { return _entries.size(); }
+    bool empty() const { return _entries.empty(); }
+
+    /// Appends the objects within rangeM of center, in no particular order.
+    void findInRange(const SGVec3d& center, double rangeM, ResultList& out) const;
+
+    /// The n objects closest to center and within maxRangeM, nearest first.
+    void findNearest(const SGVec3d& center, size_t n, double maxRangeM, ResultList& out) const;
+
+    /// Appends the objects within rangeM of the segment from start to end,
+    /// for example the path of a projectile during the last frame.
+    void findNearSegment(const SGVec3d& start, const SGVec3d& end, double rangeM,
+                         ResultList& out) const;
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        FGAIBase* object;
+        SGVec3d cartPos;
+    };
+
+    typedef std::pair<uint32_t, uint32_t> Range; ///< into _entries
+
+    int cellIndex(double coord) const;
+    static uint64_t cellKey(int x, int y, int z);
+
+    template <class Visit>
+    void visitBox(const SGVec3d& min, const SGVec3d& max, const Visit& visit) const;
+
+    double _cellSizeM;
+    double _pendingCellSizeM;
+    std::vector<Entry> _entries;
+    std::unordered_map<uint64_t, Range> _cells;
+};
+
+#endif // _FG_AISPATIALGRID_HXX
@@ -44,6 +44,9 @@ public:
 
     const char* getTypeString(void) const override { return "tanker"; }
 
+    // the tanker's own Run() follows the aircraft update, so keep it serial
+    bool hasParallelUpdate() const override { return false; }
+
     void setTACANChannelID(const std::string& id);
     
 private:
@@ -0,0 +1,41 @@
+// AITrafficSnapshot.cxx - per-frame picture of AI and multiplayer traffic
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include <config.h>
+
+#include "AITrafficSnapshot.hxx"
+
+const int FGTrafficEntry::NO_ALTITUDE;
+
+const FGTrafficEntry* FGTrafficSnapshot::findById(int id) const
+{
+    for (const auto& e : _entries) {
+        if (e.id == id) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+const FGTrafficEntry* FGTrafficSnapshot::findByCallsign(const std::string& callsign) const
+{
+    for (const auto& e : _entries) {
+        if (e.callsign == callsign) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,89 @@
+// AITrafficSnapshot.hxx - per-frame picture of AI and multiplayer traffic
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef _FG_AITRAFFICSNAPSHOT_HXX
+#define _FG_AITRAFFICSNAPSHOT_HXX
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <simgear/math/SGMath.hxx>
+#include <simgear/props/props.hxx>
+#include <simgear/structure/SGReferenced.hxx>
+#include <simgear/structure/SGSharedPtr.hxx>
+
+/**
+ * One AI or multiplayer object, as instruments and displays see it.
+ */
+struct FGTrafficEntry
+{
+    /// transponderAltitudeFt when no Mode C altitude is transmitted, as
+    /// used by the transponder instrument
+    static const int NO_ALTITUDE = -9999;
+
+    int id = -1;
+    int type = 0;            ///< FGAIBase::object_type
+    std::string typeName;    ///< as the /ai/models child, e.g. "aircraft", "multiplayer"
+    std::string callsign;
+    std::string transponderId; ///< shown by radar displays, may be empty
+
+    SGGeod position;         ///< elevation above sea level
+    SGVec3d cartPos;
+    double headingDeg = 0.0; ///< true
+    double trueAirspeedKt = 0.0;
+    double verticalSpeedFps = 0.0;
+
+    int squawk = -1;         ///< transmitted code, -1 if unknown
+    int transponderAltitudeFt = NO_ALTITUDE;
+    bool invisible = false;  ///< multiplayer aircraft being ignored
+
+    /// The object's /ai/models node, for instrument outputs such as
+    /// tcas/threat-level and for symbol variables. Never null.
+    SGPropertyNode_ptr props;
+};
+
+/**
+ * The live AI and multiplayer objects at the end of an AI update, in one
+ * contiguous array. FGAIManager publishes a new one every frame; holders
+ * of an older one keep a consistent, if dated, picture.
+ */
+class FGTrafficSnapshot : public SGReferenced
+{
+public:
+    typedef std::vector<FGTrafficEntry> EntryList;
+
+    uint64_t frame() const { return _frame; }
+    double simTimeSec() const { return _simTimeSec; }
+
+    const EntryList& entries() const { return _entries; }
+    size_t size() const { return _entries.size(); }
+
+    /// nullptr if there is no object with that id.
+    const FGTrafficEntry* findById(int id) const;
+    const FGTrafficEntry* findByCallsign(const std::string& callsign) const;
+
+private:
+    friend class FGAIManager;
+
+    uint64_t _frame = 0;
+    double _simTimeSec = 0.0;
+    EntryList _entries;
+};
+
+typedef SGSharedPtr<FGTrafficSnapshot> FGTrafficSnapshotRef;
+
+#endif // _FG_AITRAFFICSNAPSHOT_HXX
@@ -0,0 +1,160 @@
+// AIWorkerPool.cxx - worker threads for the parallel part of the AI update
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include <config.h>
+
+#include "AIWorkerPool.hxx"
+
+#include <algorithm>
+
+#include <simgear/threads/SGThread.hxx>
+
+class FGAIWorkerPool::WorkerThread : public SGThread
+{
+public:
+    WorkerThread(FGAIWorkerPool* pool) :
+        _pool(pool)
+    {
+    }
+
+protected:
+    void run() override
+    {
+        _pool->workerMain();
+    }
+
+private:
+    FGAIWorkerPool* _pool;
+};
+
+FGAIWorkerPool::FGAIWorkerPool()
+{
+}
+
+FGAIWorkerPool::~FGAIWorkerPool()
+{
+    stopThreads();
+}
+
+void FGAIWorkerPool::setNumThreads(unsigned n)
+{
+    if (n == numThreads())
+        return;
+
+    stopThreads();
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _busy = n;
+    }
+    for (unsigned i = 0; i < n; ++i) {
+        _threads.emplace_back(new WorkerThread(this));
+        _threads.back()->start();
+    }
+
+    // don't return before every worker has seen the current generation,
+    // otherwise a late starter could take the next batch for an old one
+    std::unique_lock<std::mutex> lock(_lock);
+    _done.wait(lock, [this] { return _busy == 0; });
+}
+
+void FGAIWorkerPool::stopThreads()
+{
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _stop = true;
+    }
+    _wake.notify_all();
+
+    for (auto& t : _threads)
+        t->join();
+    _threads.clear();
+
+    std::lock_guard<std::mutex> lock(_lock);
+    _stop = false;
+    _busy = 0;
+}
+
+void FGAIWorkerPool::run(size_t count, const Job& job)
+{
+    if (count == 0)
+        return;
+
+    if (_threads.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i)
+            job(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _job = &job;
+        _count = count;
+        // several chunks per thread, so a few slow jobs don't leave the
+        // others idle, but not so many that the counter becomes contended
+        _chunk = std::max<size_t>(1, count / (4 * (_threads.size() + 1)));
+        _next.store(0, std::memory_order_relaxed);
+        _busy = numThreads();
+        ++_generation;
+    }
+    _wake.notify_all();
+
+    runJobs();
+
+    std::unique_lock<std::mutex> lock(_lock);
+    _done.wait(lock, [this] { return _busy == 0; });
+    _job = nullptr;
+}
+
+void FGAIWorkerPool::runJobs()
+{
+    for (;;) {
+        const size_t begin = _next.fetch_add(_chunk, std::memory_order_relaxed);
+        if (begin >= _count)
+            break;
+
+        const size_t end = std::min(begin + _chunk, _count);
+        for (size_t i = begin; i < end; ++i)
+            (*_job)(i);
+    }
+}
+
+void FGAIWorkerPool::workerMain()
+{
+    unsigned seen;
+    {
+        // setNumThreads() waits for this, see there
+        std::lock_guard<std::mutex> lock(_lock);
+        seen = _generation;
+        if (--_busy == 0)
+            _done.notify_all();
+    }
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            _wake.wait(lock, [&] { return _stop || _generation != seen; });
+            if (_stop)
+                return;
+            seen = _generation;
+        }
+
+        runJobs();
+
+        std::lock_guard<std::mutex> lock(_lock);
+        if (--_busy == 0)
+            _done.notify_all();
+    }
+}
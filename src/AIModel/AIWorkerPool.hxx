@@ -0,0 +1,74 @@
+// AIWorkerPool.hxx - worker threads for the parallel part of the AI update
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef _FG_AIWORKERPOOL_HXX
+#define _FG_AIWORKERPOOL_HXX
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * A fixed set of threads which run batches of independent jobs.
+ *
+ * run() hands out job indices to the workers and to the calling thread,
+ * and only returns once every job is done, so the caller can treat it like
+ * a plain loop. Jobs must not throw.
+ */
+class FGAIWorkerPool
+{
+public:
+    typedef std::function<void(size_t)> Job;
+
+    FGAIWorkerPool();
+    ~FGAIWorkerPool();
+
+    /// Starts or stops threads so that there are n workers; zero means
+    /// everything runs on the calling thread.
+    void setNumThreads(unsigned n);
+    unsigned numThreads() const { return static_cast<unsigned>(_threads.size()); }
+
+    /// Calls job(i) for each i in [0, count).
+    void run(size_t count, const Job& job);
+
+private:
+    class WorkerThread;
+
+    void workerMain();
+    void runJobs();
+    void stopThreads();
+
+    std::vector<std::unique_ptr<WorkerThread>> _threads;
+
+    std::mutex _lock;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+
+    // The current batch; only changed while no worker is busy.
+    const Job* _job = nullptr;
+    size_t _count = 0;
+    size_t _chunk = 1;
+    std::atomic<size_t> _next{0};
+
+    unsigned _generation = 0; ///< bumped for every batch
+    unsigned _busy = 0;       ///< workers which have not finished the batch
+    bool _stop = false;
+};
+
+#endif // _FG_AIWORKERPOOL_HXX
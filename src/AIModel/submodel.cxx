@@ -129,19 +129,13 @@ void FGSubmodelMgr::update(double dt)
     _hit = false;
     _expiry = false;
 
-    // Check if the submodel hit an object or terrain
-    FGAIManager::ai_list_type sm_list(aiManager()->get_ai_list());
-    FGAIManager::ai_list_iterator sm_list_itr = sm_list.begin();
-    FGAIManager::ai_list_iterator end         = sm_list.end();
+    // Check if the submodel hit an object or terrain. The list only changes
+    // in the AI update, so releasing submodels below does not invalidate it.
+    const std::vector<FGAIBase*>& sm_list = aiManager()->ballisticObjects();
+    auto sm_list_itr = sm_list.begin();
+    auto end         = sm_list.end();
 
     for (; sm_list_itr != end; ++sm_list_itr) {
-        FGAIBase::object_type object_type =(*sm_list_itr)->getType();
-
-        // Continue if object is not ballistic
-        if (object_type != FGAIBase::otBallistic) {
-            continue;
-        }
-
         int parent_subID = (*sm_list_itr)->_getSubID();
         int id = (*sm_list_itr)->getID();
 
@@ -737,160 +737,179 @@ static void setInt(const std::string& value, int* out)
     }
 }
 
-/** Replay.
- * Restore all properties with data from given buffer. */
+/** Loads element <i> of type T from a signal buffer. The buffer may point
+ * into a memory-mapped tape, so it need not be suitably aligned. */
+template<typename T>
+static T
+loadSignal(const char* pBuffer, int Offset, unsigned int i)
+{
+    T v;
+    memcpy(&v, pBuffer + Offset + i*sizeof(T), sizeof(T));
+    return v;
+}
+
+/** Replay signals.
+ * Restore all recorded signals from raw signal buffer(s), interpolating
+ * between pLastBuffer and pNextBuffer if pLastBuffer is not null. */
 void
-FGFlightRecorder::replay(double SimTime, const FGReplayData* _pNextBuffer,
-        const FGReplayData* _pLastBuffer,
-        int* main_window_xpos,
-        int* main_window_ypos,
-        int* main_window_xsize,
-        int* main_window_ysize
-        )
+FGFlightRecorder::replaySignals(double SimTime,
+        const char* pNextBuffer, double NextSimTime,
+        const char* pLastBuffer, double LastSimTime)
 {
-    const char* pLastBuffer = (_pLastBuffer && !_pLastBuffer->raw_data.empty()) ? &_pLastBuffer->raw_data.front() : nullptr;
-    const char* pBuffer = (_pNextBuffer && !_pNextBuffer->raw_data.empty()) ? &_pNextBuffer->raw_data.front() : nullptr;
-    
-    if (pBuffer) {
-        /* Replay signals. */
-        int Offset = 0;
-        double ratio = 1.0;
-        if (pLastBuffer)
+    if (!pNextBuffer) {
+        return;
+    }
+    const char* pBuffer = pNextBuffer;
+    int Offset = 0;
+    double ratio = 1.0;
+    if (pLastBuffer)
+    {
+        double Numerator = SimTime - LastSimTime;
+        double dt = NextSimTime - LastSimTime;
+        // avoid divide by zero and other quirks
+        if ((Numerator > 0.0)&&(dt != 0.0))
         {
-            double NextSimTime = _pNextBuffer->sim_time;
-            double LastSimTime = _pLastBuffer->sim_time;
-            double Numerator = SimTime - LastSimTime;
-            double dt = NextSimTime - LastSimTime;
-            // avoid divide by zero and other quirks
-            if ((Numerator > 0.0)&&(dt != 0.0))
-            {
-                ratio = Numerator / dt;
-                if (ratio > 1.0)
-                    ratio = 1.0;
-            }
+            ratio = Numerator / dt;
+            if (ratio > 1.0)
+                ratio = 1.0;
         }
+    }
 
-        // 64bit aligned data first!
+    // 64bit aligned data first!
+    {
+        // restore doubles
+        unsigned int SignalCount = m_CaptureDouble.size();
+        
+        for (unsigned int i=0; i<SignalCount; i++)
         {
-            // restore doubles
-            const double* pDoubles = (const double*) &pBuffer[Offset];
-            const double* pLastDoubles = (const double*) &pLastBuffer[Offset];
-            unsigned int SignalCount = m_CaptureDouble.size();
-            
-            for (unsigned int i=0; i<SignalCount; i++)
+            double v = loadSignal<double>(pBuffer, Offset, i);
+            if (pLastBuffer)
             {
-                double v = pDoubles[i];
-                if (pLastBuffer)
-                {
-                    v = weighting(m_CaptureDouble[i].Interpolation, ratio,
-                                  pLastDoubles[i], v);
-                }
-                m_CaptureDouble[i].Signal->setDoubleValue(v);
+                v = weighting(m_CaptureDouble[i].Interpolation, ratio,
+                              loadSignal<double>(pLastBuffer, Offset, i), v);
             }
+            m_CaptureDouble[i].Signal->setDoubleValue(v);
+        }
 
-            if (m_LogRawSpeed->getBoolValue() && _pNextBuffer && pLastBuffer) {
-                // Log raw speed values to
-                // /sim/replay/log-raw-speed-values/value[]. This is used by
-                // scripts/python/recordreplay.py --test-motion.
-                //
-                SGGeod pos_geod = SGGeod::fromDegFt(
-                        fgGetDouble("/position/longitude-deg"),
-                        fgGetDouble("/position/latitude-deg"),
-                        fgGetDouble("/position/altitude-ft")
+        if (m_LogRawSpeed->getBoolValue() && pLastBuffer) {
+            // Log raw speed values to
+            // /sim/replay/log-raw-speed-values/value[]. This is used by
+            // scripts/python/recordreplay.py --test-motion.
+            //
+            SGGeod pos_geod = SGGeod::fromDegFt(
+                    fgGetDouble("/position/longitude-deg"),
+                    fgGetDouble("/position/latitude-deg"),
+                    fgGetDouble("/position/altitude-ft")
+                    );
+            SGVec3d pos = SGVec3d::fromGeod(pos_geod);
+            static SGVec3d pos_prev;
+            static double t_prev = -1;
+            double t = SimTime;
+            double dt = t - t_prev;
+            if (t_prev != -1 && dt > 0) {
+                double distance = length(pos - pos_prev);
+                double speed = dt ? distance / dt : -1;
+                SG_LOG(SG_GENERAL, SG_DEBUG, ""
+                        << " User aircraft:"
+                        << " pLastBuffer=" << ((void*) pLastBuffer)
+                        << " t_prev=" << std::setprecision(10) << t_prev
+                        << " t=" << std::setprecision(10) << t
+                        << " dt=" << dt
+                        << " distance=" << distance
+                        << " speed=" << speed
                         );
-                SGVec3d pos = SGVec3d::fromGeod(pos_geod);
-                static SGVec3d pos_prev;
-                static double t_prev = -1;
-                double t = SimTime;
-                double dt = t - t_prev;
-                if (t_prev != -1 && dt > 0) {
-                    double distance = length(pos - pos_prev);
-                    double speed = dt ? distance / dt : -1;
-                    SG_LOG(SG_GENERAL, SG_DEBUG, ""
-                            << " User aircraft:"
-                            << " pLastBuffer=" << ((void*) pLastBuffer)
-                            << " t_prev=" << std::setprecision(10) << t_prev
-                            << " t=" << std::setprecision(10) << t
-                            << " dt=" << dt
-                            << " distance=" << distance
-                            << " speed=" << speed
-                            );
-                    SGPropertyNode* n = fgGetNode("/sim/replay/log-raw-speed-values", true /*create*/);
-                    n->addChild("value")->setDoubleValue(speed);
-                }
-                pos_prev = pos;
-                t_prev = t;
+                SGPropertyNode* n = fgGetNode("/sim/replay/log-raw-speed-values", true /*create*/);
+                n->addChild("value")->setDoubleValue(speed);
             }
-            
-            Offset += SignalCount * sizeof(double);
+            pos_prev = pos;
+            t_prev = t;
         }
+        
+        Offset += SignalCount * sizeof(double);
+    }
 
-        // 32bit aligned data comes second...
+    // 32bit aligned data comes second...
+    {
+        // restore floats
+        unsigned int SignalCount = m_CaptureFloat.size();
+        for (unsigned int i=0; i<SignalCount; i++)
         {
-            // restore floats
-            const float* pFloats = (const float*) &pBuffer[Offset];
-            const float* pLastFloats = (const float*) &pLastBuffer[Offset];
-            unsigned int SignalCount = m_CaptureFloat.size();
-            for (unsigned int i=0; i<SignalCount; i++)
+            float v = loadSignal<float>(pBuffer, Offset, i);
+            if (pLastBuffer)
             {
-                float v = pFloats[i];
-                if (pLastBuffer)
-                {
-                    v = weighting(m_CaptureFloat[i].Interpolation, ratio,
-                                  pLastFloats[i], v);
-                }
-                m_CaptureFloat[i].Signal->setDoubleValue(v);//setFloatValue
+                v = weighting(m_CaptureFloat[i].Interpolation, ratio,
+                              loadSignal<float>(pLastBuffer, Offset, i), v);
             }
-            Offset += SignalCount * sizeof(float);
+            m_CaptureFloat[i].Signal->setDoubleValue(v);//setFloatValue
         }
+        Offset += SignalCount * sizeof(float);
+    }
 
+    {
+        // restore integers (32bit aligned)
+        unsigned int SignalCount = m_CaptureInteger.size();
+        for (unsigned int i=0; i<SignalCount; i++)
         {
-            // restore integers (32bit aligned)
-            const int* pInt = (const int*) &pBuffer[Offset];
-            unsigned int SignalCount = m_CaptureInteger.size();
-            for (unsigned int i=0; i<SignalCount; i++)
-            {
-                m_CaptureInteger[i].Signal->setIntValue(pInt[i]);
-            }
-            Offset += SignalCount * sizeof(int);
+            m_CaptureInteger[i].Signal->setIntValue(loadSignal<int>(pBuffer, Offset, i));
         }
+        Offset += SignalCount * sizeof(int);
+    }
 
-        // 16bit aligned data is next...
+    // 16bit aligned data is next...
+    {
+        // restore 16bit short integers
+        unsigned int SignalCount = m_CaptureInt16.size();
+        for (unsigned int i=0; i<SignalCount; i++)
         {
-            // restore 16bit short integers
-            const short int* pShortInt = (const short int*) &pBuffer[Offset];
-            unsigned int SignalCount = m_CaptureInt16.size();
-            for (unsigned int i=0; i<SignalCount; i++)
-            {
-                m_CaptureInt16[i].Signal->setIntValue(pShortInt[i]);
-            }
-            Offset += SignalCount * sizeof(short int);
+            m_CaptureInt16[i].Signal->setIntValue(loadSignal<short int>(pBuffer, Offset, i));
         }
+        Offset += SignalCount * sizeof(short int);
+    }
 
-        // finally: byte aligned data is last...
+    // finally: byte aligned data is last...
+    {
+        // restore 8bit chars
+        const signed char* pChar = (const signed char*) &pBuffer[Offset];
+        unsigned int SignalCount = m_CaptureInt8.size();
+        for (unsigned int i=0; i<SignalCount; i++)
         {
-            // restore 8bit chars
-            const signed char* pChar = (const signed char*) &pBuffer[Offset];
-            unsigned int SignalCount = m_CaptureInt8.size();
-            for (unsigned int i=0; i<SignalCount; i++)
-            {
-                m_CaptureInt8[i].Signal->setIntValue(pChar[i]);
-            }
-            Offset += SignalCount * sizeof(signed char);
+            m_CaptureInt8[i].Signal->setIntValue(pChar[i]);
         }
+        Offset += SignalCount * sizeof(signed char);
+    }
 
+    {
+        // restore 1bit booleans (8bit aligned)
+        const unsigned char* pFlags = (const unsigned char*) &pBuffer[Offset];
+        unsigned int SignalCount = m_CaptureBool.size();
+        int Size = (SignalCount+7)/8;
+        Offset += Size;
+        for (unsigned int i=0; i<SignalCount; i++)
         {
-            // restore 1bit booleans (8bit aligned)
-            const unsigned char* pFlags = (const unsigned char*) &pBuffer[Offset];
-            unsigned int SignalCount = m_CaptureBool.size();
-            int Size = (SignalCount+7)/8;
-            Offset += Size;
-            for (unsigned int i=0; i<SignalCount; i++)
-            {
-                m_CaptureBool[i].Signal->setBoolValue(0 != (pFlags[i>>3] & (1 << (i&7))));
-            }
+            m_CaptureBool[i].Signal->setBoolValue(0 != (pFlags[i>>3] & (1 << (i&7))));
         }
     }
+}
+
+/** Replay.
+ * Restore all properties with data from given buffer. */
+void
+FGFlightRecorder::replay(double SimTime, const FGReplayData* _pNextBuffer,
+        const FGReplayData* _pLastBuffer,
+        int* main_window_xpos,
+        int* main_window_ypos,
+        int* main_window_xsize,
+        int* main_window_ysize
+        )
+{
+    const char* pLastBuffer = _pLastBuffer ? _pLastBuffer->signals(m_LastSignals) : nullptr;
+    const char* pBuffer = _pNextBuffer ? _pNextBuffer->signals(m_NextSignals) : nullptr;
+    
+    if (pBuffer) {
+        replaySignals(SimTime,
+                pBuffer, _pNextBuffer->sim_time,
+                pLastBuffer, pLastBuffer ? _pLastBuffer->sim_time : 0);
+    }
 
     // Replay any multiplayer messages.
     for (auto multiplayer_message: _pNextBuffer->multiplayer_messages) {
@@ -67,6 +67,12 @@ public:
                                          int* main_window_xsize,
                                          int* main_window_ysize
                                          );
+    // Replays signals only, from raw signal buffers as stored in
+    // FGReplayData::raw_data. The buffers need not be aligned, so they can
+    // point directly into a memory-mapped tape. pLastBuffer may be null.
+    void            replaySignals       (double SimTime,
+                                         const char* pNextBuffer, double NextSimTime,
+                                         const char* pLastBuffer, double LastSimTime);
     int             getRecordSize       (void) { return m_TotalRecordSize;}
     void            getConfig           (SGPropertyNode* root);
     void            resetExtraProperties();
@@ -108,6 +114,10 @@ private:
     FlightRecorder::TSignalList m_CaptureInt16;
     FlightRecorder::TSignalList m_CaptureInt8;
     FlightRecorder::TSignalList m_CaptureBool;
+    
+    // Scratch buffers for decoding delta-encoded frames when replaying.
+    std::vector<char> m_NextSignals;
+    std::vector<char> m_LastSignals;
 
     unsigned m_TotalRecordSize;
     std::string m_ConfigName;
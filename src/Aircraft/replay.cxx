@@ -29,6 +29,10 @@
 #include <float.h>
 #include <string.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
 #include <iostream>
 #include <streambuf>
@@ -36,6 +40,18 @@
 
 #include <zlib.h>
 
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
 #include <osgViewer/ViewerBase>
 
 #include <simgear/constants.h>
@@ -47,6 +63,7 @@
 #include <simgear/misc/stdint.hxx>
 #include <simgear/misc/strutils.hxx>
 #include <simgear/structure/commands.hxx>
+#include <simgear/threads/SGThread.hxx>
 
 #include <Main/fg_props.hxx>
 #include <MultiPlayer/mpmessages.hxx>
@@ -71,6 +88,132 @@ using simgear::gzContainerWriter;
 /** Magic string to verify valid FG flight recorder tapes. */
 static const char* const FlightRecorderFileMagic = "FlightGear Flight Recorder Tape";
 
+/* Continuous recordings whose header has meta/continuous-index=true may end
+with an index footer, written when recording stops:
+
+    FlightRecorderIndexMagic
+    uint32_t    num_frames
+    uint32_t    num_frames_multiplayer
+    uint32_t    num_frames_extra_properties
+    num_frames * {double sim_time; uint64_t offset; uint8_t flags;}
+    uint64_t    offset of footer
+    FlightRecorderIndexMagic
+
+<flags> uses the same bits as compressed frames: 1=signals, 2=multiplayer,
+4=extra-properties. Entries are in recording order, i.e. sorted by sim_time,
+so they can be binary-searched without reading the whole footer.
+If the footer is missing (e.g. FlightGear crashed while recording), we fall
+back to scanning the frames.
+*/
+static const char FlightRecorderIndexMagic[8] = {'F', 'G', 'T', 'A', 'P', 'I', 'D', 'X'};
+static const size_t FlightRecorderIndexEntrySize = sizeof(double) + sizeof(uint64_t) + sizeof(uint8_t);
+
+/* Read-only memory mapping of a complete local fgtape file. */
+class FGReplayTapeMapping
+{
+public:
+    ~FGReplayTapeMapping()
+    {
+        close();
+    }
+
+    bool open(const SGPath& path)
+    {
+        close();
+#ifdef _WIN32
+        m_file = CreateFileW(path.wstr().c_str(), GENERIC_READ, FILE_SHARE_READ,
+                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+            close();
+            return false;
+        }
+        m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping) {
+            close();
+            return false;
+        }
+        m_data = (const char*) MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!m_data) {
+            close();
+            return false;
+        }
+        m_size = size.QuadPart;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) return false;
+        m_data = (const char*) data;
+        m_size = st.st_size;
+#endif
+        return true;
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = INVALID_HANDLE_VALUE;
+#else
+        if (m_data) munmap((void*) m_data, m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const char* m_data = nullptr;
+    size_t      m_size = 0;
+#ifdef _WIN32
+    HANDLE      m_file = INVALID_HANDLE_VALUE;
+    HANDLE      m_mapping = nullptr;
+#endif
+};
+
+/* Read-only std::streambuf for a region of memory, so that frames in a
+memory-mapped tape can be parsed with the same code as file streams. */
+class FGReplayMemoryStreamBuf : public std::streambuf
+{
+public:
+    FGReplayMemoryStreamBuf(const char* begin, const char* end)
+    {
+        setg(const_cast<char*>(begin), const_cast<char*>(begin), const_cast<char*>(end));
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+    {
+        off_type base = gptr() - eback();
+        if (dir == std::ios_base::beg)      base = 0;
+        else if (dir == std::ios_base::end) base = egptr() - eback();
+        off_type pos = base + off;
+        if (pos < 0 || pos > egptr() - eback()) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), eback() + pos, egptr());
+        return pos_type(pos);
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+    {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
 void FGReplayData::UpdateStats()
 {
     size_t  bytes_raw_data_old = m_bytes_raw_data;
@@ -95,11 +238,166 @@ void FGReplayData::UpdateStats()
     if (!s_prop_bytes_raw_data) s_prop_bytes_raw_data = fgGetNode("/sim/replay/datastats_bytes_raw_data", true);
     if (!s_prop_bytes_multiplayer_messages) s_prop_bytes_multiplayer_messages = fgGetNode("/sim/replay/datastats_bytes_multiplayer_messages", true);
     if (!s_prop_num_multiplayer_messages) s_prop_num_multiplayer_messages = fgGetNode("/sim/replay/datastats_num_multiplayer_messages", true);
+    if (!s_prop_bytes_per_frame) s_prop_bytes_per_frame = fgGetNode("/sim/replay/datastats_bytes_per_frame", true);
 
     s_prop_num->setLongValue(s_num);
-    s_prop_bytes_raw_data->setLongValue(s_bytes_raw_data);
+    size_t  bytes_raw_data = s_bytes_raw_data + s_bytes_keyframes;
+    s_prop_bytes_raw_data->setLongValue(bytes_raw_data);
     s_prop_bytes_multiplayer_messages->setLongValue(s_bytes_multiplayer_messages);
     s_prop_num_multiplayer_messages->setLongValue(s_num_multiplayer_messages);
+    s_prop_bytes_per_frame->setLongValue(s_num
+            ? (bytes_raw_data + s_bytes_multiplayer_messages) / s_num
+            : 0);
+}
+
+std::shared_ptr<const std::vector<char>> FGReplayData::makeKeyframe(std::vector<char>&& data)
+{
+    s_bytes_keyframes += data.size();
+    return std::shared_ptr<const std::vector<char>>(
+            new std::vector<char>(std::move(data)),
+            [](const std::vector<char>* keyframe) {
+                s_bytes_keyframes -= keyframe->size();
+                delete keyframe;
+            });
+}
+
+static void AppendVarint(std::vector<char>& out, size_t value)
+{
+    while (value >= 0x80) {
+        out.push_back((char) ((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back((char) value);
+}
+
+static size_t ReadVarint(const char*& p, const char* end)
+{
+    size_t  value = 0;
+    int     shift = 0;
+    while (p != end) {
+        uint8_t c = *p++;
+        value |= (size_t) (c & 0x7f) << shift;
+        if (!(c & 0x80)) break;
+        shift += 7;
+    }
+    return value;
+}
+
+/* A delta is a sequence of runs of changed bytes, each encoded as:
+
+    varint  number of unchanged bytes since end of previous run
+    varint  number of changed bytes
+    bytes   new values of changed bytes
+*/
+const char* FGReplayData::signals(std::vector<char>& scratch) const
+{
+    if (!keyframe) {
+        return raw_data.empty() ? nullptr : &raw_data.front();
+    }
+    if (keyframe->empty()) {
+        return nullptr;
+    }
+    if (raw_data.empty()) {
+        // We are the keyframe or are identical to it.
+        return &keyframe->front();
+    }
+    scratch = *keyframe;
+    size_t      pos = 0;
+    const char* p = &raw_data.front();
+    const char* end = p + raw_data.size();
+    while (p != end) {
+        pos += ReadVarint(p, end);
+        size_t  length = ReadVarint(p, end);
+        if (pos + length > scratch.size() || length > (size_t) (end - p)) {
+            SG_LOG(SG_SYSTEMS, SG_ALERT, "ReplaySystem: Corrupt delta-encoded frame at sim_time=" << sim_time);
+            break;
+        }
+        memcpy(&scratch[pos], p, length);
+        p += length;
+        pos += length;
+    }
+    return &scratch.front();
+}
+
+size_t FGReplayData::signalsSize() const
+{
+    return keyframe ? keyframe->size() : raw_data.size();
+}
+
+void FGReplayData::deltaDecode()
+{
+    if (!keyframe) return;
+    std::vector<char>   full;
+    const char* p = signals(full);
+    if (p && full.empty()) {
+        full = *keyframe;
+    }
+    raw_data.swap(full);
+    keyframe.reset();
+}
+
+void FGReplayDeltaEncoder::encode(FGReplayData* r)
+{
+    r->deltaDecode();
+    if (m_keyframe_interval <= 0 || r->raw_data.empty()) {
+        return;
+    }
+    
+    const std::vector<char>&    full = r->raw_data;
+    size_t  n = full.size();
+    bool    use_delta = false;
+    if (m_keyframe && m_num_deltas < m_keyframe_interval && m_keyframe->size() == n) {
+        // Find runs of changed bytes. We merge runs separated by only a few
+        // unchanged bytes, as each run costs at least two bytes.
+        //
+        const char* a = &m_keyframe->front();
+        const char* b = &full.front();
+        size_t  pos = 0;
+        size_t  i = 0;
+        m_delta.clear();
+        use_delta = true;
+        while (i < n) {
+            if (a[i] == b[i]) {
+                i += 1;
+                continue;
+            }
+            size_t  begin = i;
+            size_t  end = i + 1;
+            for (size_t j=end; j<n; ++j) {
+                if (a[j] != b[j])       end = j + 1;
+                else if (j - end >= 4)  break;
+            }
+            AppendVarint(m_delta, begin - pos);
+            AppendVarint(m_delta, end - begin);
+            m_delta.insert(m_delta.end(), b + begin, b + end);
+            pos = end;
+            i = end;
+            if (m_delta.size() > n / 2) {
+                // Aircraft state has diverged from keyframe.
+                use_delta = false;
+                break;
+            }
+        }
+    }
+    
+    if (use_delta) {
+        r->keyframe = m_keyframe;
+        // Copy so that we don't keep full-size capacity around.
+        std::vector<char>(m_delta).swap(r->raw_data);
+        m_num_deltas += 1;
+    }
+    else {
+        m_keyframe = FGReplayData::makeKeyframe(std::move(r->raw_data));
+        r->raw_data.clear();
+        r->keyframe = m_keyframe;
+        m_num_deltas = 0;
+    }
+}
+
+void FGReplayDeltaEncoder::reset()
+{
+    m_keyframe.reset();
+    m_num_deltas = 0;
 }
 
 FGReplayData::FGReplayData()
@@ -121,17 +419,20 @@ void FGReplayData::resetStatisticsProperties()
     s_prop_bytes_raw_data.reset();
     s_prop_bytes_multiplayer_messages.reset();
     s_prop_num_multiplayer_messages.reset();
+    s_prop_bytes_per_frame.reset();
 }
 
 size_t   FGReplayData::s_num = 0;
 size_t   FGReplayData::s_bytes_raw_data = 0;
 size_t   FGReplayData::s_bytes_multiplayer_messages = 0;
 size_t   FGReplayData::s_num_multiplayer_messages = 0;
+std::atomic<size_t>  FGReplayData::s_bytes_keyframes(0);
 
 SGPropertyNode_ptr   FGReplayData::s_prop_num;
 SGPropertyNode_ptr   FGReplayData::s_prop_bytes_raw_data;
 SGPropertyNode_ptr   FGReplayData::s_prop_bytes_multiplayer_messages;
 SGPropertyNode_ptr   FGReplayData::s_prop_num_multiplayer_messages;
+SGPropertyNode_ptr   FGReplayData::s_prop_bytes_per_frame;
 
 
 namespace ReplayContainer
@@ -176,6 +477,9 @@ FGReplay::FGReplay() :
     m_MultiplayMgr(globals->get_subsystem<FGMultiplayMgr>()),
     m_simple_time_enabled(fgGetNode("/sim/time/simple-time/enabled", true))
 {
+    m_continuous_write_queue_depth = fgGetNode("/sim/replay/continuous-write-queue-depth", true);
+    m_continuous_write_dropped_frames = fgGetNode("/sim/replay/continuous-write-dropped-frames", true);
+    
     SGPropertyNode* continuous = fgGetNode("/sim/replay/record-continuous", true);
     SGPropertyNode* fdm = fgGetNode("/sim/signals/fdm-initialized", true);
     continuous->addChangeListener(this, true /*initial*/);
@@ -272,15 +576,15 @@ void FGReplay::valueChanged(SGPropertyNode * node)
     bool    prop_fdm = fgGetBool("/sim/signals/fdm-initialized");
     
     bool continuous = prop_continuous && prop_fdm;
-    if (continuous == ((m_continuous_out.is_open()) ? true : false)) {
+    if (continuous == m_continuous_recording) {
         // No change.
         return;
     }
     
-    if (m_continuous_out.is_open()) {
+    if (m_continuous_recording) {
         // Stop existing continuous recording.
         SG_LOG(SG_SYSTEMS, SG_ALERT, "Stopping continuous recording");
-        m_continuous_out.close();
+        continuousStopRecording();
         popupTip("Continuous record to file stopped", 5 /*delay*/);
     }
     
@@ -297,6 +601,21 @@ void FGReplay::valueChanged(SGPropertyNode * node)
         
         SG_LOG(SG_SYSTEMS, SG_ALERT, "Starting continuous recording");
         
+        // Write frames on a background thread unless queue size is zero.
+        int queue_size = fgGetInt("/sim/replay/record-continuous-queue-size", 256);
+        if (queue_size > 0) {
+            m_continuous_writer.reset(new FGReplayContinuousWriter(
+                    m_continuous_out,
+                    m_continuous_out_compression,
+                    &m_continuous_out_index,
+                    queue_size
+                    ));
+            m_continuous_writer->start();
+        }
+        m_continuous_recording = true;
+        m_continuous_write_queue_depth->setIntValue(0);
+        m_continuous_write_dropped_frames->setIntValue(0);
+        
         // Make a convenience link to the recording. E.g.
         // harrier-gr3-continuous.fgtape ->
         // harrier-gr3-20201224-005034-continuous.fgtape.
@@ -325,8 +644,8 @@ void FGReplay::valueChanged(SGPropertyNode * node)
 
 FGReplay::~FGReplay()
 {
-    if (m_continuous_out.is_open()) {
-        m_continuous_out.close();
+    if (m_continuous_recording) {
+        continuousStopRecording();
     }
     clear();
 
@@ -360,6 +679,10 @@ FGReplay::clear()
         delete recycler.front();
         recycler.pop_front();
     }
+    m_short_term_encoder.reset();
+    m_medium_term_encoder.reset();
+    m_long_term_encoder.reset();
+    m_buffer_bytes = 0;
 
     // clear messages belonging to old replay session
     fgGetNode("/sim/replay/messages", 0, true)->removeChildren("msg");
@@ -382,6 +705,8 @@ FGReplay::init()
     speed_up             = fgGetNode("/sim/speed-up",            true);
     replay_multiplayer   = fgGetNode("/sim/replay/record-multiplayer",  true);
     recovery_period      = fgGetNode("/sim/replay/recovery-period", true);
+    m_memory_budget_mb   = fgGetNode("/sim/replay/memory-budget-mb", true);
+    m_datastats_bytes_buffered = fgGetNode("/sim/replay/datastats_bytes_buffered", true);
 
     // alias to keep backward compatibility
     fgGetNode("/sim/freeze/replay-state", true)->alias(replay_master);
@@ -411,6 +736,12 @@ FGReplay::reinit()
     // short term sample rate is as every frame
     m_medium_sample_rate = fgGetDouble("/sim/replay/buffer/medium-res-sample-dt", 0.5); // medium term sample rate (sec)
     m_long_sample_rate   = fgGetDouble("/sim/replay/buffer/low-res-sample-dt",    5.0); // long term sample rate (sec)
+    
+    // in-memory frames are delta-encoded against a keyframe every N frames
+    int keyframe_interval = fgGetInt("/sim/replay/buffer/keyframe-interval", 64);
+    m_short_term_encoder.setKeyframeInterval(keyframe_interval);
+    m_medium_term_encoder.setKeyframeInterval(keyframe_interval);
+    m_long_term_encoder.setKeyframeInterval(keyframe_interval);
 
     fillRecycler();
     loadMessages();
@@ -660,13 +991,14 @@ saveRawReplayData(gzContainerWriter& output, const replay_list_type& ReplayData,
     // read the raw data (all records in the given list)
     replay_list_type::const_iterator it = ReplayData.begin();
     size_t CheckCount = 0;
+    std::vector<char> signals;
     while ((it != ReplayData.end())&&
            !output.fail())
     {
         const FGReplayData* pRecord = *it++;
-        assert(RecordSize == pRecord->raw_data.size());
+        assert(RecordSize == pRecord->signalsSize());
         output.write(reinterpret_cast<const char*>(&pRecord->sim_time), sizeof(pRecord->sim_time));
-        output.write(&pRecord->raw_data.front(), pRecord->raw_data.size());
+        output.write(pRecord->signals(signals), RecordSize);
 
         for (auto data: meta->getNode("meta")->getChildren("data")) {
             SG_LOG(SG_SYSTEMS, SG_DEBUG, "data->getStringValue()=" << data->getStringValue());
@@ -935,6 +1267,13 @@ SGPropertyNode_ptr FGReplay::continuousWriteHeader(
     SGPropertyNode* signals = config->getNode("signals", true /*create*/);
     m_pRecorder->getConfig(signals);
     
+    if (tape_type == FGTapeType_CONTINUOUS) {
+        // Tell readers to look for an index footer.
+        m_continuous_out_index.clear();
+        config->setBoolValue("meta/continuous-index",
+                fgGetBool("/sim/replay/record-continuous-index", true));
+    }
+    
     out.open(path.c_str(), std::ofstream::binary | std::ofstream::trunc);
     out.write(FlightRecorderFileMagic, strlen(FlightRecorderFileMagic)+1);
     PropertiesWrite(config, out);
@@ -957,9 +1296,10 @@ static void writeFrame2(FGReplayData* r, std::ostream& out, SGPropertyNode_ptr c
     for (auto data: config->getChildren("data")) {
         const char* data_type = data->getStringValue();
         if (!strcmp(data_type, "signals")) {
-            uint32_t    signals_size = r->raw_data.size();
+            std::vector<char>   signals;
+            uint32_t    signals_size = r->signalsSize();
             out.write(reinterpret_cast<char*>(&signals_size), sizeof(signals_size));
-            out.write(&r->raw_data.front(), r->raw_data.size());
+            if (signals_size) out.write(r->signals(signals), signals_size);
         }
         else if (!strcmp(data_type, "multiplayer")) {
             uint32_t    length = 0;
@@ -990,33 +1330,25 @@ static void writeFrame2(FGReplayData* r, std::ostream& out, SGPropertyNode_ptr c
     
 }
 
-// Writes one frame of continuous record information.
+// Returns flags describing what data in <r> will be written: 1=signals,
+// 2=multiplayer, 4=extra-properties. Zero means there is nothing to write.
 //
-bool
-FGReplay::continuousWriteFrame(FGReplayData* r, std::ostream& out, SGPropertyNode_ptr config)
+static uint8_t FrameFlags(FGReplayData* r, SGPropertyNode* config)
 {
-    SG_LOG(SG_SYSTEMS, SG_BULK, "writing frame."
-            << " out.tellp()=" << out.tellp()
-            << " r->sim_time=" << r->sim_time
-            );
-    // Don't write frame if no data to write.
-    //bool r_has_data = false;
-    bool has_signals = false;
-    bool has_multiplayer = false;
-    bool has_extra_properties = false;
+    uint8_t flags = 0;
     for (auto data: config->getChildren("data")) {
         const char* data_type = data->getStringValue();
         if (!strcmp(data_type, "signals")) {
-            has_signals = true;
+            flags |= 1;
         }
         else if (!strcmp(data_type, "multiplayer")) {
             if (!r->multiplayer_messages.empty()) {
-                has_multiplayer = true;
+                flags |= 2;
             }
         }
         else if (!strcmp(data_type, "extra-properties")) {
             if (!r->extra_properties.empty()) {
-                has_extra_properties = true;
+                flags |= 4;
             }
         }
         else {
@@ -1024,18 +1356,51 @@ FGReplay::continuousWriteFrame(FGReplayData* r, std::ostream& out, SGPropertyNod
             assert(0);
         }
     }
-    if (!has_signals && !has_multiplayer && !has_extra_properties) {
+    return flags;
+}
+
+static void WriteIndexEntry(char* p, double sim_time, uint64_t offset, uint8_t flags)
+{
+    memcpy(p, &sim_time, sizeof(sim_time));
+    memcpy(p + sizeof(sim_time), &offset, sizeof(offset));
+    memcpy(p + sizeof(sim_time) + sizeof(offset), &flags, sizeof(flags));
+}
+
+static void AppendIndexEntry(std::vector<char>& index, double sim_time, uint64_t offset, uint8_t flags)
+{
+    size_t n = index.size();
+    index.resize(n + FlightRecorderIndexEntrySize);
+    WriteIndexEntry(&index[n], sim_time, offset, flags);
+}
+
+// Writes one frame of continuous record information.
+//
+bool
+FGReplay::continuousWriteFrame(
+        FGReplayData* r,
+        std::ostream& out,
+        SGPropertyNode_ptr config,
+        std::vector<char>* index
+        )
+{
+    SG_LOG(SG_SYSTEMS, SG_BULK, "writing frame."
+            << " out.tellp()=" << out.tellp()
+            << " r->sim_time=" << r->sim_time
+            );
+    // Don't write frame if no data to write.
+    uint8_t flags = FrameFlags(r, config);
+    if (!flags) {
         SG_LOG(SG_SYSTEMS, SG_DEBUG, "Not writing frame because no data to write");
         return true;
     }
     
+    if (index) {
+        AppendIndexEntry(*index, r->sim_time, out.tellp(), flags);
+    }
+    
     out.write(reinterpret_cast<char*>(&r->sim_time), sizeof(r->sim_time));
     
     if (m_continuous_out_compression) {
-        uint8_t flags = 0;
-        if (has_signals)            flags |= 1;
-        if (has_multiplayer)        flags |= 2;
-        if (has_extra_properties)   flags |= 4;
         out.write((char*) &flags, sizeof(flags));
         
         /* We need to first write the size of the compressed data so compress
@@ -1058,14 +1423,207 @@ FGReplay::continuousWriteFrame(FGReplayData* r, std::ostream& out, SGPropertyNod
     return ok;
 }
 
-struct FGFrameInfo
+/* std::streambuf that appends to a std::vector<char>. */
+class FGReplayVectorStreamBuf : public std::streambuf
 {
-    size_t  offset;
-    bool    has_signals = false;
-    bool    has_multiplayer = false;
-    bool    has_extra_properties = false;
+public:
+    FGReplayVectorStreamBuf(std::vector<char>& out) : m_out(out)
+    {
+    }
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            m_out.push_back(traits_type::to_char_type(c));
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override
+    {
+        m_out.insert(m_out.end(), s, s + n);
+        return n;
+    }
+
+private:
+    std::vector<char>&  m_out;
 };
 
+/* A continuous recording frame serialised by the main loop, waiting to be
+written by FGReplayContinuousWriter. */
+FGReplayContinuousWriter::FGReplayContinuousWriter(
+        std::ofstream& out,
+        int compression,
+        std::vector<char>* index,
+        size_t capacity
+        )
+:
+m_out(out),
+m_compression(compression),
+m_index(index),
+m_ring(capacity)
+{
+}
+
+bool FGReplayContinuousWriter::push(std::unique_ptr<FGReplayContinuousFrame> frame)
+{
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head.load(std::memory_order_acquire) >= m_ring.size()) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_ring[tail % m_ring.size()] = std::move(frame);
+    {
+        // Publish under the lock, so the writer cannot miss the notification
+        // between finding the queue empty and waiting.
+        std::lock_guard<std::mutex> lock(m_wake_lock);
+        m_tail.store(tail + 1, std::memory_order_release);
+    }
+    m_wake.notify_one();
+    return true;
+}
+
+void FGReplayContinuousWriter::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wake_lock);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    join();
+}
+
+size_t FGReplayContinuousWriter::depth() const
+{
+    return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+}
+
+size_t FGReplayContinuousWriter::dropped() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+void FGReplayContinuousWriter::run()
+{
+    for (;;) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            std::unique_lock<std::mutex> lock(m_wake_lock);
+            m_wake.wait(lock, [&] {
+                return m_stop || m_tail.load(std::memory_order_acquire) != head;
+            });
+            if (head == m_tail.load(std::memory_order_acquire)) {
+                // Stopped, and all frames pushed before stop() are written.
+                break;
+            }
+            continue;
+        }
+        std::unique_ptr<FGReplayContinuousFrame> frame = std::move(m_ring[head % m_ring.size()]);
+        m_head.store(head + 1, std::memory_order_release);
+        write(*frame);
+    }
+    m_out.flush();
+}
+
+void FGReplayContinuousWriter::write(const FGReplayContinuousFrame& frame)
+{
+    if (m_index) {
+        AppendIndexEntry(*m_index, frame.sim_time, m_out.tellp(), frame.flags);
+    }
+    m_out.write(reinterpret_cast<const char*>(&frame.sim_time), sizeof(frame.sim_time));
+    if (m_compression) {
+        m_out.write(reinterpret_cast<const char*>(&frame.flags), sizeof(frame.flags));
+        std::ostringstream  compressed;
+        compression_ostream out_compressing(compressed, 1024, 1024);
+        out_compressing.write(frame.data.data(), frame.data.size());
+        out_compressing.flush();
+        
+        const std::string&  compressed_str = compressed.str();
+        uint32_t compressed_size = compressed_str.size();
+        m_out.write(reinterpret_cast<const char*>(&compressed_size), sizeof(compressed_size));
+        m_out.write(compressed_str.c_str(), compressed_str.size());
+    }
+    else {
+        m_out.write(frame.data.data(), frame.data.size());
+    }
+    if (!m_out && !m_failed) {
+        SG_LOG(SG_SYSTEMS, SG_ALERT, "Failed to write continuous recording frame at sim_time=" << frame.sim_time);
+        m_failed = true;
+    }
+}
+
+// Serialises one frame of continuous record information and queues it for
+// writing by m_continuous_writer.
+//
+void
+FGReplay::continuousQueueFrame(FGReplayData* r)
+{
+    uint8_t flags = FrameFlags(r, m_continuous_out_config);
+    if (!flags) {
+        SG_LOG(SG_SYSTEMS, SG_DEBUG, "Not writing frame because no data to write");
+        return;
+    }
+    std::unique_ptr<FGReplayContinuousFrame> frame(new FGReplayContinuousFrame);
+    frame->sim_time = r->sim_time;
+    frame->flags = flags;
+    {
+        FGReplayVectorStreamBuf buffer(frame->data);
+        std::ostream            out(&buffer);
+        writeFrame2(r, out, m_continuous_out_config);
+    }
+    if (!m_continuous_writer->push(std::move(frame))) {
+        SG_LOG(SG_SYSTEMS, SG_DEBUG, "Continuous recording queue full, dropped frame at sim_time=" << r->sim_time);
+        // Extra properties are recorded as changes, so make sure that the
+        // next frame contains all of them.
+        m_pRecorder->resetExtraProperties();
+    }
+}
+
+void
+FGReplay::continuousStopRecording()
+{
+    if (m_continuous_writer) {
+        // Flush queued frames.
+        m_continuous_writer->stop();
+        SG_LOG(SG_SYSTEMS, SG_DEBUG, "Continuous recording writer stopped."
+                << " dropped frames=" << m_continuous_writer->dropped()
+                );
+        m_continuous_writer.reset();
+    }
+    if (m_continuous_out_config
+            && m_continuous_out_config->getBoolValue("meta/continuous-index")
+            && m_continuous_out)
+    {
+        uint64_t    footer_offset = m_continuous_out.tellp();
+        uint32_t    num_frames = m_continuous_out_index.size() / FlightRecorderIndexEntrySize;
+        uint32_t    num_frames_multiplayer = 0;
+        uint32_t    num_frames_extra_properties = 0;
+        for (uint32_t i=0; i<num_frames; ++i) {
+            uint8_t flags = m_continuous_out_index[(i+1) * FlightRecorderIndexEntrySize - 1];
+            if (flags & 2) ++num_frames_multiplayer;
+            if (flags & 4) ++num_frames_extra_properties;
+        }
+        m_continuous_out.write(FlightRecorderIndexMagic, sizeof(FlightRecorderIndexMagic));
+        m_continuous_out.write(reinterpret_cast<char*>(&num_frames), sizeof(num_frames));
+        m_continuous_out.write(reinterpret_cast<char*>(&num_frames_multiplayer), sizeof(num_frames_multiplayer));
+        m_continuous_out.write(reinterpret_cast<char*>(&num_frames_extra_properties), sizeof(num_frames_extra_properties));
+        if (num_frames) {
+            m_continuous_out.write(&m_continuous_out_index.front(), m_continuous_out_index.size());
+        }
+        m_continuous_out.write(reinterpret_cast<char*>(&footer_offset), sizeof(footer_offset));
+        m_continuous_out.write(FlightRecorderIndexMagic, sizeof(FlightRecorderIndexMagic));
+        SG_LOG(SG_SYSTEMS, SG_DEBUG, "Wrote continuous recording index footer:"
+                << " num_frames=" << num_frames
+                << " footer_offset=" << footer_offset
+                );
+    }
+    m_continuous_out_index.clear();
+    m_continuous_out_index.shrink_to_fit();
+    m_continuous_out.close();
+    m_continuous_recording = false;
+}
+
 std::ostream& operator << (std::ostream& out, const FGFrameInfo& frame_info)
 {
     return out << "{"
@@ -1075,6 +1633,159 @@ std::ostream& operator << (std::ostream& out, const FGFrameInfo& frame_info)
             << "}";
 }
 
+void FGReplayFrameIndex::clear()
+{
+    m_entries = nullptr;
+    m_num_frames = 0;
+    m_scanned.clear();
+    m_scanned.shrink_to_fit();
+}
+
+void FGReplayFrameIndex::setEntries(const char* entries, size_t num_frames)
+{
+    clear();
+    m_entries = entries;
+    m_num_frames = num_frames;
+}
+
+void FGReplayFrameIndex::add(double sim_time, const FGFrameInfo& frameinfo)
+{
+    assert(m_entries == nullptr || m_entries == m_scanned.data());
+    uint8_t flags = (frameinfo.has_signals ? 1 : 0)
+            | (frameinfo.has_multiplayer ? 2 : 0)
+            | (frameinfo.has_extra_properties ? 4 : 0);
+    
+    // Frames are scanned in recording order, so this normally appends. A
+    // repeated time replaces the earlier frame.
+    size_t i = lowerBound(sim_time);
+    if (i == m_num_frames || time(i) != sim_time) {
+        m_scanned.insert(m_scanned.begin() + i * FlightRecorderIndexEntrySize,
+                FlightRecorderIndexEntrySize, 0);
+        m_entries = m_scanned.data();
+        m_num_frames += 1;
+    }
+    WriteIndexEntry(&m_scanned[i * FlightRecorderIndexEntrySize], sim_time,
+            frameinfo.offset, flags);
+}
+
+double FGReplayFrameIndex::time(size_t i) const
+{
+    assert(i < m_num_frames);
+    double sim_time;
+    memcpy(&sim_time, m_entries + i * FlightRecorderIndexEntrySize, sizeof(sim_time));
+    return sim_time;
+}
+
+FGFrameInfo FGReplayFrameIndex::frameInfo(size_t i) const
+{
+    assert(i < m_num_frames);
+    const char* p = m_entries + i * FlightRecorderIndexEntrySize;
+    uint64_t    offset;
+    uint8_t     flags;
+    memcpy(&offset, p + sizeof(double), sizeof(offset));
+    memcpy(&flags, p + sizeof(double) + sizeof(offset), sizeof(flags));
+    
+    FGFrameInfo frameinfo;
+    frameinfo.offset = offset;
+    frameinfo.has_signals = flags & 1;
+    frameinfo.has_multiplayer = flags & 2;
+    frameinfo.has_extra_properties = flags & 4;
+    return frameinfo;
+}
+
+size_t FGReplayFrameIndex::lowerBound(double sim_time) const
+{
+    size_t begin = 0;
+    size_t end = m_num_frames;
+    while (begin < end) {
+        size_t mid = begin + (end - begin) / 2;
+        if (time(mid) < sim_time) {
+            begin = mid + 1;
+        }
+        else {
+            end = mid;
+        }
+    }
+    return begin;
+}
+
+size_t FGReplayFrameIndex::upperBound(double sim_time) const
+{
+    size_t begin = 0;
+    size_t end = m_num_frames;
+    while (begin < end) {
+        size_t mid = begin + (end - begin) / 2;
+        if (time(mid) <= sim_time) {
+            begin = mid + 1;
+        }
+        else {
+            end = mid;
+        }
+    }
+    return begin;
+}
+
+// Approximate memory used by a frame in one of the in-memory lists.
+static size_t frameBytes(const FGReplayData* r)
+{
+    return sizeof(*r) + r->m_bytes_raw_data + r->m_bytes_multiplayer_messages
+            + r->extra_properties.size();
+}
+
+void
+FGReplay::recycleFront(replay_list_type& list)
+{
+    FGReplayData* front = list.front();
+    m_buffer_bytes -= std::min(m_buffer_bytes, frameBytes(front));
+    // Release our reference so the keyframe can go once its last frame does.
+    front->keyframe.reset();
+    MoveFrontMultiplayerPackets(list);
+    recycler.push_back(front);
+    list.pop_front();
+}
+
+void
+FGReplay::moveFront(replay_list_type& from, replay_list_type& to, FGReplayDeltaEncoder& encoder)
+{
+    FGReplayData* front = from.front();
+    from.pop_front();
+    m_buffer_bytes -= std::min(m_buffer_bytes, frameBytes(front));
+    encoder.encode(front);
+    front->UpdateStats();
+    m_buffer_bytes += frameBytes(front);
+    to.push_back(front);
+}
+
+void
+FGReplay::applyMemoryBudget(size_t memory_budget)
+{
+    // Discard oldest frames until we are within budget.
+    while (bufferBytes() > memory_budget)
+    {
+        if (!long_term.empty())         recycleFront(long_term);
+        else if (!medium_term.empty())  recycleFront(medium_term);
+        else if (short_term.size() > 1) recycleFront(short_term);
+        else break;
+    }
+}
+
+void
+FGReplay::recountBufferBytes()
+{
+    m_buffer_bytes = 0;
+    for (auto list: {&short_term, &medium_term, &long_term}) {
+        for (auto r: *list) {
+            m_buffer_bytes += frameBytes(r);
+        }
+    }
+}
+
+size_t
+FGReplay::bufferBytes() const
+{
+    return m_buffer_bytes + FGReplayData::s_bytes_keyframes;
+}
+
 void
 FGReplay::update( double dt )
 {
@@ -1119,9 +1830,10 @@ FGReplay::update( double dt )
             if (m_continuous_in.is_open()) {
                 SG_LOG(SG_SYSTEMS, SG_DEBUG, "Unloading continuous recording");
                 m_continuous_in.close();
-                m_continuous_in_time_to_frameinfo.clear();
+                m_continuous_in_frame_index.clear();
+                m_continuous_in_map.reset();
             }
-            assert(m_continuous_in_time_to_frameinfo.empty());
+            assert(m_continuous_in_frame_index.empty());
 
             guiMessage("Replay stopped. Your controls!");
         }
@@ -1280,8 +1992,13 @@ FGReplay::update( double dt )
         SG_LOG(SG_SYSTEMS, SG_ALERT, "ReplaySystem: Inconsistent data!");
     }
     
-    if (m_continuous_out.is_open()) {
-        continuousWriteFrame(r, m_continuous_out, m_continuous_out_config);
+    if (m_continuous_writer) {
+        continuousQueueFrame(r);
+        m_continuous_write_queue_depth->setIntValue(m_continuous_writer->depth());
+        m_continuous_write_dropped_frames->setIntValue(m_continuous_writer->dropped());
+    }
+    else if (m_continuous_recording) {
+        continuousWriteFrame(r, m_continuous_out, m_continuous_out_config, &m_continuous_out_index);
     }
     
     if (replay_state == 0)
@@ -1337,14 +2054,24 @@ FGReplay::update( double dt )
         }
     }
 
+    // Delta-encode the new frame now that it has been written to any
+    // continuous and recovery recordings.
+    //
+    m_short_term_encoder.encode(r);
+    r->UpdateStats();
+    m_buffer_bytes += frameBytes(r);
+    
+    // If we have a memory budget, it limits the long term list instead of
+    // m_low_res_time.
+    //
+    double  memory_budget_mb = m_memory_budget_mb->getDoubleValue();
+
     if ( sim_time - st_front->sim_time > m_high_res_time )
     {
         while ( !short_term.empty() && sim_time - st_front->sim_time > m_high_res_time )
         {
             st_front = short_term.front();
-            MoveFrontMultiplayerPackets(short_term);
-            recycler.push_back(st_front);
-            short_term.pop_front();
+            recycleFront(short_term);
         }
 
         // update the medium term list
@@ -1352,9 +2079,7 @@ FGReplay::update( double dt )
         {
             last_mt_time = sim_time;
             if (!short_term.empty()) {
-                st_front = short_term.front();
-                medium_term.push_back( st_front );
-                short_term.pop_front();
+                moveFront(short_term, medium_term, m_medium_term_encoder);
             }
 
             if (!medium_term.empty())
@@ -1365,21 +2090,17 @@ FGReplay::update( double dt )
                     while ( !medium_term.empty() && sim_time - mt_front->sim_time > m_medium_res_time )
                     {
                         mt_front = medium_term.front();
-                        MoveFrontMultiplayerPackets(medium_term);
-                        recycler.push_back(mt_front);
-                        medium_term.pop_front();
+                        recycleFront(medium_term);
                     }
                     // update the long term list
                     if ( sim_time - last_lt_time > m_long_sample_rate )
                     {
                         last_lt_time = sim_time;
                         if (!medium_term.empty()) {
-                            mt_front = medium_term.front();
-                            long_term.push_back( mt_front );
-                            medium_term.pop_front();
+                            moveFront(medium_term, long_term, m_long_term_encoder);
                         }
 
-                        if (!long_term.empty())
+                        if (!long_term.empty() && memory_budget_mb <= 0)
                         {
                             FGReplayData *lt_front = long_term.front();
                             if ( sim_time - lt_front->sim_time > m_low_res_time )
@@ -1387,9 +2108,7 @@ FGReplay::update( double dt )
                                 while ( !long_term.empty() && sim_time - lt_front->sim_time > m_low_res_time )
                                 {
                                     lt_front = long_term.front();
-                                    MoveFrontMultiplayerPackets(long_term);
-                                    recycler.push_back(lt_front);
-                                    long_term.pop_front();
+                                    recycleFront(long_term);
                                 }
                             }
                         }
@@ -1398,6 +2117,12 @@ FGReplay::update( double dt )
             }
         }
     }
+    
+    if (memory_budget_mb > 0)
+    {
+        applyMemoryBudget(memory_budget_mb * 1024 * 1024);
+    }
+    m_datastats_bytes_buffered->setLongValue(bufferBytes());
 
 #if 0
     cout << "short term size = " << short_term.size()
@@ -1422,6 +2147,8 @@ FGReplay::record(double sim_time)
     {
         r = recycler.front();
         recycler.pop_front();
+        // Discard any delta encoding from previous use.
+        r->keyframe.reset();
     }
 
     return m_pRecorder->capture(sim_time, r);
@@ -1488,7 +2215,8 @@ FGReplay::replay( double time ) {
     
     std::lock_guard<std::mutex> lock(m_continuous_in_time_to_frameinfo_lock);
     
-    if (!m_continuous_in_time_to_frameinfo.empty()) {
+    const FGReplayFrameIndex& frames = m_continuous_in_frame_index;
+    if (!frames.empty()) {
         // We are replaying a continuous recording.
         //
         
@@ -1543,55 +2271,56 @@ FGReplay::replay( double time ) {
         // to find a pair of frames that straddle the requested <time> so that
         // we can interpolate.
         //
-        auto p = m_continuous_in_time_to_frameinfo.lower_bound(time);
+        size_t p = frames.lowerBound(time);
         bool ret = false;
         
         size_t  offset;
         size_t  offset_prev = 0;
         
-        if (p == m_continuous_in_time_to_frameinfo.end()) {
+        if (p == frames.size()) {
             // We are at end of recording; replay last frame.
             --p;
-            offset = p->second.offset;
+            offset = frames.frameInfo(p).offset;
             ret = true;
         }
-        else if (p->first > time) {
+        else if (frames.time(p) > time) {
             // Look for preceding item.
-            if (p == m_continuous_in_time_to_frameinfo.begin()) {
+            if (p == 0) {
                 // <time> is before beginning of recording.
-                offset = p->second.offset;
+                offset = frames.frameInfo(p).offset;
             }
             else {
                 // Interpolate between pair of items that straddle <time>.
-                auto prev = p;
-                --prev;
-                offset_prev = prev->second.offset;
-                offset = p->second.offset;
+                offset_prev = frames.frameInfo(p - 1).offset;
+                offset = frames.frameInfo(p).offset;
             }
         }
         else {
             // Exact match.
-            offset = p->second.offset;
+            offset = frames.frameInfo(p).offset;
         }
+        const double p_time = frames.time(p);
         
         // Before interpolating signals, we replay all property changes from
         // all frame times t satisfying t_prop_begin < t < time. We also replay
         // all recent multiplayer packets in this range, i.e. for which t >
         // time - multiplayer_recent.
         //
-        for (auto p_before = m_continuous_in_time_to_frameinfo.upper_bound(t_begin);
-                p_before != m_continuous_in_time_to_frameinfo.end();
+        for (size_t p_before = frames.upperBound(t_begin);
+                p_before < frames.size();
                 ++p_before) {
-            if (p_before->first >= p->first) {
+            const double        t_before = frames.time(p_before);
+            if (t_before >= p_time) {
                 break;
             }
+            const FGFrameInfo   info_before = frames.frameInfo(p_before);
             // Replaying a frame is expensive because we read frame data
             // from disc each time. So we only replay this frame if it has
             // extra_properties, or if it has multiplayer packets and we are
             // within <multiplayer_recent> seconds of current time.
             //
-            bool    replay_this_frame = p_before->second.has_extra_properties;
-            if (p_before->second.has_multiplayer && p_before->first > time - multiplayer_recent) {
+            bool    replay_this_frame = info_before.has_extra_properties;
+            if (info_before.has_multiplayer && t_before > time - multiplayer_recent) {
                 replay_this_frame = true;
             }
             
@@ -1601,17 +2330,17 @@ FGReplay::replay( double time ) {
                     << " m_continuous_in_frame_time_last=" << m_continuous_in_frame_time_last
                     << " time=" << time
                     << " t_begin=" << t_begin
-                    << " p_before->first=" << p_before->first
-                    << " p_before->second=" << p_before->second
+                    << " t_before=" << t_before
+                    << " info_before=" << info_before
                     );
 
             if (replay_this_frame) {
                 replay(
-                        p_before->first,
-                        p_before->second.offset,
+                        t_before,
+                        info_before.offset,
                         0 /*offset_old*/,
                         false /*replay_signals*/,
-                        p_before->first > time - multiplayer_recent /*replay_multiplayer*/,
+                        t_before > time - multiplayer_recent /*replay_multiplayer*/,
                         true /*replay_extra_properties*/,
                         &xpos,
                         &ypos,
@@ -1664,7 +2393,7 @@ FGReplay::replay( double time ) {
         }
         
         m_continuous_in_time_last = time;
-        m_continuous_in_frame_time_last = p->first;
+        m_continuous_in_frame_time_last = p_time;
         
         return ret;
     }
@@ -1888,6 +2617,75 @@ static std::unique_ptr<FGReplayData> ReadFGReplayData(
     return ret;
 }
 
+/* Reads all or part of a FGReplayData from a memory-mapped tape.
+
+If <signals> is not null and frames are uncompressed, signals are not copied
+into the returned FGReplayData; instead we set *signals to point directly into
+the mapping (or to null if the frame has no signals). */
+static std::unique_ptr<FGReplayData> ReadFGReplayData(
+        const FGReplayTapeMapping& map,
+        size_t pos,
+        SGPropertyNode* config,
+        bool load_signals,
+        bool load_multiplayer,
+        bool load_extra_properties,
+        int m_continuous_in_compression,
+        const char** signals
+        )
+{
+    SG_LOG(SG_SYSTEMS, SG_BULK, "reading mapped frame. pos=" << pos);
+    if (signals) *signals = nullptr;
+    if (pos + sizeof(double) > map.size()) {
+        SG_LOG(SG_SYSTEMS, SG_DEBUG, "Failed to read fgtape frame at offset " << pos);
+        return nullptr;
+    }
+    std::unique_ptr<FGReplayData>   ret(new FGReplayData);
+    memcpy(&ret->sim_time, map.data() + pos, sizeof(ret->sim_time));
+    
+    size_t data_pos = pos + sizeof(ret->sim_time);
+    FGReplayMemoryStreamBuf buffer(map.data() + data_pos, map.data() + map.size());
+    std::istream in(&buffer);
+    
+    bool ok;
+    if (m_continuous_in_compression)
+    {
+        uint8_t     flags;
+        uint32_t    compressed_size;
+        in.read((char*) &flags, sizeof(flags));
+        in.read((char*) &compressed_size, sizeof(compressed_size));
+        simgear::ZlibDecompressorIStream    in_decompress(in, SGPath(), simgear::ZLibCompressionFormat::ZLIB_RAW);
+        ok = ReadFGReplayData2(in_decompress, config, load_signals, load_multiplayer, load_extra_properties, ret.get());
+    }
+    else
+    {
+        if (load_signals && signals) {
+            // Find signals within the mapping; ReadFGReplayData2() will then
+            // skip them.
+            size_t p = data_pos;
+            for (auto data: config->getChildren("data")) {
+                uint32_t    length;
+                if (p + sizeof(length) > map.size()) break;
+                memcpy(&length, map.data() + p, sizeof(length));
+                p += sizeof(length);
+                if (p + length > map.size()) break;
+                if (!strcmp(data->getStringValue(), "signals")) {
+                    if (length) *signals = map.data() + p;
+                    break;
+                }
+                p += length;
+            }
+            load_signals = false;
+        }
+        ok = ReadFGReplayData2(in, config, load_signals, load_multiplayer, load_extra_properties, ret.get());
+    }
+    if (!ok) {
+        SG_LOG(SG_SYSTEMS, SG_DEBUG, "Failed to read fgtape frame at offset " << pos);
+        if (signals) *signals = nullptr;
+        return nullptr;
+    }
+    return ret;
+}
+
 // Replays one frame from uncompressed file. <offset> and <offset_old>
 // are offsets in file of frames that are >= and < <time> respectively.
 // <offset_old> may be 0, in which case it is ignored.
@@ -1896,6 +2694,9 @@ static std::unique_ptr<FGReplayData> ReadFGReplayData(
 // replay_signals, replay_multiplayer and replay_extra_properties. Then call
 // m_pRecorder->replay(), which updates the global state.
 //
+// If the recording is memory-mapped and uncompressed, signals are replayed
+// directly from the mapping without being copied.
+//
 void FGReplay::replay(
         double time,
         size_t offset,
@@ -1909,15 +2710,32 @@ void FGReplay::replay(
         int* ysize
         )
 {
-    std::unique_ptr<FGReplayData> replay_data = ReadFGReplayData(
-            m_continuous_in,
-            offset,
-            m_continuous_in_config,
-            replay_signals,
-            replay_multiplayer,
-            replay_extra_properties,
-            m_continuous_in_compression
-            );
+    const char* signals = nullptr;
+    const char* signals_old = nullptr;
+    std::unique_ptr<FGReplayData> replay_data;
+    if (m_continuous_in_map) {
+        replay_data = ReadFGReplayData(
+                *m_continuous_in_map,
+                offset,
+                m_continuous_in_config,
+                replay_signals,
+                replay_multiplayer,
+                replay_extra_properties,
+                m_continuous_in_compression,
+                &signals
+                );
+    }
+    else {
+        replay_data = ReadFGReplayData(
+                m_continuous_in,
+                offset,
+                m_continuous_in_config,
+                replay_signals,
+                replay_multiplayer,
+                replay_extra_properties,
+                m_continuous_in_compression
+                );
+    }
     if (!replay_data) {
         if (!replay_error->getBoolValue()) {
             SG_LOG(SG_SYSTEMS, SG_ALERT, "Failed to read fgtape frame at offset=" << offset << " time=" << time);
@@ -1928,7 +2746,19 @@ void FGReplay::replay(
     }
     assert(replay_data.get());
     std::unique_ptr<FGReplayData> replay_data_old;
-    if (offset_old) {
+    if (offset_old && m_continuous_in_map) {
+        replay_data_old = ReadFGReplayData(
+                *m_continuous_in_map,
+                offset_old,
+                m_continuous_in_config,
+                replay_signals,
+                replay_multiplayer,
+                replay_extra_properties,
+                m_continuous_in_compression,
+                &signals_old
+                );
+    }
+    else if (offset_old) {
         replay_data_old = ReadFGReplayData(
                 m_continuous_in,
                 offset_old,
@@ -1949,6 +2779,13 @@ void FGReplay::replay(
             << " replay_data->extra_properties.size()=" << replay_data->extra_properties.size()
             << " replay_data->replay_extra_property_changes.size()=" << replay_data->replay_extra_property_changes.size()
             );
+    if (signals) {
+        m_pRecorder->replaySignals(time,
+                signals, replay_data->sim_time,
+                replay_data_old ? signals_old : nullptr,
+                replay_data_old ? replay_data_old->sim_time : 0
+                );
+    }
     m_pRecorder->replay(time, replay_data.get(), replay_data_old.get(), xpos, ypos, xsize, ysize);
 }
 
@@ -1957,14 +2794,14 @@ FGReplay::get_start_time()
 {
     double ret;
     std::lock_guard<std::mutex> lock(m_continuous_in_time_to_frameinfo_lock);
-    if (!m_continuous_in_time_to_frameinfo.empty()) {
-        ret = m_continuous_in_time_to_frameinfo.begin()->first;
+    if (!m_continuous_in_frame_index.empty()) {
+        ret = m_continuous_in_frame_index.time(0);
         SG_LOG(SG_SYSTEMS, SG_DEBUG,
                 "ret=" << ret
-                << " m_continuous_in_time_to_frameinfo is "
-                << m_continuous_in_time_to_frameinfo.begin()->first
+                << " m_continuous_in_frame_index is "
+                << m_continuous_in_frame_index.time(0)
                 << ".."
-                << m_continuous_in_time_to_frameinfo.rbegin()->first
+                << m_continuous_in_frame_index.time(m_continuous_in_frame_index.size() - 1)
                 );
         // We don't set /sim/replay/end-time here - it is updated when indexing
         // in the background.
@@ -1993,14 +2830,14 @@ double
 FGReplay::get_end_time()
 {
     std::lock_guard<std::mutex> lock(m_continuous_in_time_to_frameinfo_lock);
-    if (!m_continuous_in_time_to_frameinfo.empty()) {
-        double ret = m_continuous_in_time_to_frameinfo.rbegin()->first;
+    if (!m_continuous_in_frame_index.empty()) {
+        double ret = m_continuous_in_frame_index.time(m_continuous_in_frame_index.size() - 1);
         SG_LOG(SG_SYSTEMS, SG_DEBUG,
                 "ret=" << ret
-                << " m_continuous_in_time_to_frameinfo is "
-                << m_continuous_in_time_to_frameinfo.begin()->first
+                << " m_continuous_in_frame_index is "
+                << m_continuous_in_frame_index.time(0)
                 << ".."
-                << m_continuous_in_time_to_frameinfo.rbegin()->first
+                << m_continuous_in_frame_index.time(m_continuous_in_frame_index.size() - 1)
                 );
         // We don't set /sim/replay/end-time here - it is updated when indexing
         // in the background.
@@ -2068,6 +2905,7 @@ loadRawReplayData(gzContainerReader& input, FGFlightRecorder* pRecorder, replay_
                 pBuffer->multiplayer_messages.push_back( message);
             }
         }
+        pBuffer->UpdateStats();
     }
 
     // did we get all we have hoped for?
@@ -2216,11 +3054,11 @@ void FGReplay::indexContinuousRecording(const void* data, size_t numbytes)
             << " numbytes=" << numbytes
             << " m_continuous_indexing_pos=" << m_continuous_indexing_pos
             << " m_continuous_in_compression=" << m_continuous_in_compression
-            << " m_continuous_in_time_to_frameinfo.size()=" << m_continuous_in_time_to_frameinfo.size()
+            << " m_continuous_in_frame_index.size()=" << m_continuous_in_frame_index.size()
             );
     time_t t0 = time(NULL);
     std::streampos original_pos = m_continuous_indexing_pos;
-    size_t original_num_frames = m_continuous_in_time_to_frameinfo.size();
+    size_t original_num_frames = m_continuous_in_frame_index.size();
     
     // Reset any EOF because there might be new data.
     m_continuous_indexing_in.clear();
@@ -2231,6 +3069,7 @@ void FGReplay::indexContinuousRecording(const void* data, size_t numbytes)
         size_t  bytes = 0;
     };
     std::map<std::string, data_stats_t> stats;
+    bool index_footer = m_continuous_in_config->getBoolValue("meta/continuous-index");
     
     for(;;)
     {
@@ -2238,8 +3077,17 @@ void FGReplay::indexContinuousRecording(const void* data, size_t numbytes)
                 << " m_continuous_in.tellg()=" << m_continuous_in.tellg()
                 );
         m_continuous_indexing_in.seekg(m_continuous_indexing_pos);
+        char sim_time_raw[sizeof(double)];
+        m_continuous_indexing_in.read(sim_time_raw, sizeof(sim_time_raw));
+        if (m_continuous_indexing_in && index_footer
+                && !memcmp(sim_time_raw, FlightRecorderIndexMagic, sizeof(FlightRecorderIndexMagic)))
+        {
+            // Start of index footer, so there are no more frames.
+            SG_LOG(SG_SYSTEMS, SG_DEBUG, "Reached index footer at m_continuous_indexing_pos=" << m_continuous_indexing_pos);
+            break;
+        }
         double sim_time;
-        m_continuous_indexing_in.read(reinterpret_cast<char*>(&sim_time), sizeof(sim_time));
+        memcpy(&sim_time, sim_time_raw, sizeof(sim_time));
 
         SG_LOG(SG_SYSTEMS, SG_BULK, ""
                 << " m_continuous_indexing_pos=" << m_continuous_indexing_pos
@@ -2336,15 +3184,15 @@ void FGReplay::indexContinuousRecording(const void* data, size_t numbytes)
         }
         
         // We have successfully read a frame, so add it to
-        // m_continuous_in_time_to_frameinfo[].
+        // m_continuous_in_frame_index.
         //
         m_continuous_indexing_pos = m_continuous_indexing_in.tellg();
         std::lock_guard<std::mutex> lock(m_continuous_in_time_to_frameinfo_lock);
-        m_continuous_in_time_to_frameinfo[sim_time] = frameinfo;
+        m_continuous_in_frame_index.add(sim_time, frameinfo);
     }
     time_t t = time(NULL) - t0;
     auto new_bytes = m_continuous_indexing_pos - original_pos;
-    auto num_frames = m_continuous_in_time_to_frameinfo.size();
+    auto num_frames = m_continuous_in_frame_index.size();
     auto num_new_frames = num_frames - original_num_frames;
     if (num_new_frames) {
         SG_LOG(SG_SYSTEMS, SG_DEBUG, "Continuous recording: index updated:"
@@ -2357,7 +3205,7 @@ void FGReplay::indexContinuousRecording(const void* data, size_t numbytes)
             << " time taken=" << t << "s."
             << " num_new_frames=" << num_new_frames
             << " m_continuous_indexing_pos=" << m_continuous_indexing_pos
-            << " m_continuous_in_time_to_frameinfo.size()=" << m_continuous_in_time_to_frameinfo.size()
+            << " m_continuous_in_frame_index.size()=" << m_continuous_in_frame_index.size()
             << " m_num_frames_multiplayer=" << m_num_frames_multiplayer
             << " m_num_frames_extra_properties=" << m_num_frames_extra_properties
             );
@@ -2368,25 +3216,142 @@ void FGReplay::indexContinuousRecording(const void* data, size_t numbytes)
                 );
     }
     
+    updateContinuousIndexProperties();
+    if (!numbytes) {
+        SG_LOG(SG_SYSTEMS, SG_ALERT, "Continuous recording: indexing finished"
+                << " m_continuous_in_frame_index.size()=" << m_continuous_in_frame_index.size()
+                );
+        m_continuous_indexing_in.close();
+    }
+}
+
+bool FGReplay::indexContinuousRecordingFromFooter()
+{
+    if (!m_continuous_in_map) {
+        return false;
+    }
+    const char* data = m_continuous_in_map->data();
+    size_t      size = m_continuous_in_map->size();
+    const size_t magic_size = sizeof(FlightRecorderIndexMagic);
+    
+    uint64_t    footer_offset;
+    uint32_t    num_frames;
+    uint32_t    num_frames_multiplayer;
+    uint32_t    num_frames_extra_properties;
+    const size_t header_size = magic_size + sizeof(num_frames)
+            + sizeof(num_frames_multiplayer) + sizeof(num_frames_extra_properties);
+    if (size < magic_size + sizeof(footer_offset)
+            || memcmp(data + size - magic_size, FlightRecorderIndexMagic, magic_size))
+    {
+        SG_LOG(SG_SYSTEMS, SG_DEBUG, "Continuous recording has no index footer");
+        return false;
+    }
+    memcpy(&footer_offset, data + size - magic_size - sizeof(footer_offset), sizeof(footer_offset));
+    if (footer_offset < (uint64_t) m_continuous_indexing_pos
+            || footer_offset > size
+            || size - footer_offset < header_size
+            || memcmp(data + footer_offset, FlightRecorderIndexMagic, magic_size))
+    {
+        SG_LOG(SG_SYSTEMS, SG_ALERT, "Continuous recording has corrupt index footer");
+        return false;
+    }
+    const char* p = data + footer_offset + magic_size;
+    memcpy(&num_frames, p, sizeof(num_frames));
+    p += sizeof(num_frames);
+    memcpy(&num_frames_multiplayer, p, sizeof(num_frames_multiplayer));
+    p += sizeof(num_frames_multiplayer);
+    memcpy(&num_frames_extra_properties, p, sizeof(num_frames_extra_properties));
+    p += sizeof(num_frames_extra_properties);
+    if (footer_offset + header_size
+            + (uint64_t) num_frames * FlightRecorderIndexEntrySize
+            + sizeof(footer_offset) + magic_size != size)
+    {
+        SG_LOG(SG_SYSTEMS, SG_ALERT, "Continuous recording has inconsistent index footer:"
+                << " num_frames=" << num_frames
+                << " footer_offset=" << footer_offset
+                << " size=" << size
+                );
+        return false;
+    }
+    
+    // The entries are searched in place, so opening a long recording does
+    // not depend on its number of frames.
     std::lock_guard<std::mutex> lock(m_continuous_in_time_to_frameinfo_lock);
-    fgSetInt("/sim/replay/continuous-stats-num-frames", m_continuous_in_time_to_frameinfo.size());
+    m_continuous_in_frame_index.setEntries(p, num_frames);
+    m_num_frames_multiplayer = num_frames_multiplayer;
+    m_num_frames_extra_properties = num_frames_extra_properties;
+    if (num_frames_multiplayer) {
+        m_continuous_in_multiplayer = true;
+    }
+    if (num_frames_extra_properties) {
+        m_continuous_in_extra_properties = true;
+    }
+    m_continuous_indexing_pos = footer_offset;
+    SG_LOG(SG_SYSTEMS, SG_ALERT, "Continuous recording: using index footer"
+            << " m_continuous_in_frame_index.size()=" << m_continuous_in_frame_index.size()
+            );
+    return true;
+}
+
+bool FGReplay::indexContinuousRecordingFile(
+        const SGPath& Filename,
+        std::streampos frames_begin,
+        simgear::HTTP::FileRequestRef filerequest
+        )
+{
+    m_continuous_in_frame_index.clear();
+    m_num_frames_extra_properties = 0;
+    m_num_frames_multiplayer = 0;
+    m_continuous_indexing_in.open(Filename.str());
+    m_continuous_indexing_pos = frames_begin;
+
+    // If it is a complete local file we memory-map it and use its index
+    // footer if it has one.
+    m_continuous_in_map.reset();
+    if (!filerequest) {
+        m_continuous_in_map.reset(new FGReplayTapeMapping);
+        if (!m_continuous_in_map->open(Filename)) {
+            SG_LOG(SG_SYSTEMS, SG_ALERT, "Failed to memory-map " << Filename << ", using file reads");
+            m_continuous_in_map.reset();
+        }
+    }
+    if (m_continuous_in_map
+            && m_continuous_in_config->getBoolValue("meta/continuous-index")
+            && indexContinuousRecordingFromFooter())
+    {
+        m_continuous_indexing_in.close();
+        updateContinuousIndexProperties();
+        return true;
+    }
+    if (filerequest) {
+        filerequest->setCallback(
+                [this](const void* data, size_t numbytes)
+                {
+                    indexContinuousRecording(data, numbytes);
+                }
+                );
+    }
+    else {
+        indexContinuousRecording(nullptr, 0);
+    }
+    return false;
+}
+
+void FGReplay::updateContinuousIndexProperties()
+{
+    std::lock_guard<std::mutex> lock(m_continuous_in_time_to_frameinfo_lock);
+    fgSetInt("/sim/replay/continuous-stats-num-frames", m_continuous_in_frame_index.size());
     fgSetInt("/sim/replay/continuous-stats-num-frames-extra-properties", m_num_frames_extra_properties);
     fgSetInt("/sim/replay/continuous-stats-num-frames-multiplayer", m_num_frames_multiplayer);
-    if (!m_continuous_in_time_to_frameinfo.empty()) {
-        double t_begin = m_continuous_in_time_to_frameinfo.begin()->first;
-        double t_end = m_continuous_in_time_to_frameinfo.rbegin()->first;
+    if (!m_continuous_in_frame_index.empty()) {
+        double t_begin = m_continuous_in_frame_index.time(0);
+        double t_end = m_continuous_in_frame_index.time(m_continuous_in_frame_index.size() - 1);
         fgSetDouble("/sim/replay/start-time", t_begin);
         fgSetDouble("/sim/replay/end-time", t_end);
         setTimeStr("/sim/replay/start-time-str", t_begin);
         setTimeStr("/sim/replay/end-time-str", t_end);
         SG_LOG(SG_SYSTEMS, SG_DEBUG, "Have set /sim/replay/end-time to " << fgGetDouble("/sim/replay/end-time"));
     }
-    if (!numbytes) {
-        SG_LOG(SG_SYSTEMS, SG_ALERT, "Continuous recording: indexing finished"
-                << " m_continuous_in_time_to_frameinfo.size()=" << m_continuous_in_time_to_frameinfo.size()
-                );
-        m_continuous_indexing_in.close();
-    }
 }
 
 void FGReplay::call_indexContinuousRecording(void* ref, const void* data, size_t numbytes)
@@ -2432,27 +3397,10 @@ FGReplay::loadTape(const SGPath& Filename, bool Preview, SGPropertyNode& MetaMet
         fillRecycler();
         m_continuous_in_time_last = -1;
         m_continuous_in_frame_time_last = -1;
-        m_continuous_in_time_to_frameinfo.clear();
-        m_num_frames_extra_properties = 0;
-        m_num_frames_multiplayer = 0;
-        m_continuous_indexing_in.open(Filename.str());
-        m_continuous_indexing_pos = in.tellg();
         m_continuous_in_compression = m_continuous_in_config->getNode("meta/continuous-compression", true /*create*/)->getIntValue();
         SG_LOG(SG_SYSTEMS, SG_DEBUG, "m_continuous_in_compression=" << m_continuous_in_compression);
         SG_LOG(SG_SYSTEMS, SG_DEBUG, "filerequest=" << filerequest.get());
-
-        // Make an in-memory index of the recording.
-        if (filerequest) {
-            filerequest->setCallback(
-                    [this](const void* data, size_t numbytes)
-                    {
-                        indexContinuousRecording(data, numbytes);
-                    }
-                    );
-        }
-        else {
-            indexContinuousRecording(nullptr, 0);
-        }
+        indexContinuousRecordingFile(Filename, in.tellg(), filerequest);
         start(true /*NewTape*/);
         return true;
     }
@@ -2594,6 +3542,7 @@ FGReplay::loadTape(const SGPath& Filename, bool Preview, SGPropertyNode& MetaMet
                 ok &= loadRawReplayData(input, m_pRecorder, medium_term, RecordSize, multiplayer);
             if (ok)
                 ok &= loadRawReplayData(input, m_pRecorder, long_term,   RecordSize, multiplayer);
+            recountBufferBytes();
 
             // restore replay messages
             if (ok)
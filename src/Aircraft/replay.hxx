@@ -36,19 +36,28 @@
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/io/iostreams/gzcontainerfile.hxx>
 #include <simgear/io/HTTPFileRequest.hxx>
+#include <simgear/threads/SGThread.hxx>
 
 #include <MultiPlayer/multiplaymgr.hxx>
 
+#include <atomic>
+#include <condition_variable>
 #include <deque>
+#include <fstream>
+#include <memory>
 #include <vector>
 
 class FGFlightRecorder;
+class FGReplayTapeMapping;
 
 struct FGReplayData {
 
     double sim_time;
-    // Our aircraft state.
+    // Our aircraft state. If <keyframe> is set, this is a delta against
+    // *keyframe, see FGReplayDeltaEncoder; use signals() to get complete
+    // data.
     std::vector<char>   raw_data;
+    std::shared_ptr<const std::vector<char>>    keyframe;
     
     // Incoming multiplayer messages.
     std::vector<std::shared_ptr<std::vector<char>>> multiplayer_messages;
@@ -56,9 +65,23 @@ struct FGReplayData {
     std::map<std::string, std::string>              replay_extra_property_changes;
     std::vector<std::string>                        replay_extra_property_removals;
     
+    // Returns pointer to complete signal data, decoding into <scratch> if
+    // necessary. Returns null if we have no signal data.
+    const char* signals(std::vector<char>& scratch) const;
+    
+    // Size of complete signal data.
+    size_t signalsSize() const;
+    
+    // Makes raw_data complete again, if it is a delta.
+    void deltaDecode();
+    
     // Updates static statistics defined below. 
     void UpdateStats();
 
+    // Makes a keyframe holding <data>. Its size counts towards
+    // s_bytes_keyframes for as long as any frame refers to it.
+    static std::shared_ptr<const std::vector<char>> makeKeyframe(std::vector<char>&& data);
+
     // Resets out static property nodes; to be called by fgStartNewReset().
     static void resetStatisticsProperties();
     
@@ -74,10 +97,41 @@ struct FGReplayData {
     static size_t   s_bytes_raw_data;
     static size_t   s_bytes_multiplayer_messages;
     static size_t   s_num_multiplayer_messages;
+    // Keyframes are shared and may be released on the continuous writer's
+    // thread.
+    static std::atomic<size_t>  s_bytes_keyframes;
     static SGPropertyNode_ptr   s_prop_num;
     static SGPropertyNode_ptr   s_prop_bytes_raw_data;
     static SGPropertyNode_ptr   s_prop_bytes_multiplayer_messages;
     static SGPropertyNode_ptr   s_prop_num_multiplayer_messages;
+    static SGPropertyNode_ptr   s_prop_bytes_per_frame;
+};
+
+// Delta-encodes signal data of frames in one of FGReplay's in-memory lists.
+//
+// Every <keyframe-interval> frames (or sooner if the aircraft state has
+// changed a lot) we start a new keyframe holding complete signal data, shared
+// by all following frames in the list. The other frames only store the byte
+// runs that differ from their keyframe, so decoding any frame is O(1) and
+// does not depend on neighbouring frames, which may be discarded.
+//
+class FGReplayDeltaEncoder
+{
+public:
+    // Interval of zero disables delta encoding.
+    void setKeyframeInterval(int interval) { m_keyframe_interval = interval; }
+    
+    // Encodes <r> against our current keyframe or makes it a new keyframe.
+    // <r> may already be encoded against another encoder's keyframe.
+    void encode(FGReplayData* r);
+    
+    void reset();
+
+private:
+    std::shared_ptr<const std::vector<char>>    m_keyframe;
+    std::vector<char>   m_delta;
+    int                 m_num_deltas = 0;
+    int                 m_keyframe_interval = 64;
 };
 
 typedef struct {
@@ -93,8 +147,105 @@ enum FGTapeType
     FGTapeType_RECOVERY,
 };
 
-struct FGFrameInfo;
+// Where a frame of a Continuous recording is, and what data it has.
+struct FGFrameInfo
+{
+    size_t  offset;
+    bool    has_signals = false;
+    bool    has_multiplayer = false;
+    bool    has_extra_properties = false;
+};
+
+/* Index of the frames of a Continuous recording, sorted by sim_time. Entries
+use the layout of the index footer, so the footer of a memory-mapped recording
+is searched in place instead of being read; otherwise the entries are built up
+in memory while scanning the recording. */
+class FGReplayFrameIndex
+{
+public:
+    void clear();
     
+    // Uses <num_frames> footer entries at <entries>, which must stay valid
+    // until the next clear().
+    void setEntries(const char* entries, size_t num_frames);
+    
+    // Adds a frame found by scanning the recording.
+    void add(double sim_time, const FGFrameInfo& frameinfo);
+    
+    size_t size() const { return m_num_frames; }
+    bool empty() const { return m_num_frames == 0; }
+    
+    double time(size_t i) const;
+    FGFrameInfo frameInfo(size_t i) const;
+    
+    // Position of the first frame with time >= <sim_time>, or size().
+    size_t lowerBound(double sim_time) const;
+    
+    // Position of the first frame with time > <sim_time>, or size().
+    size_t upperBound(double sim_time) const;
+
+private:
+    const char*         m_entries = nullptr;
+    size_t              m_num_frames = 0;
+    std::vector<char>   m_scanned;
+};
+
+struct FGReplayContinuousFrame
+{
+    double              sim_time;
+    uint8_t             flags;
+    std::vector<char>   data;   // Uncompressed, as written by writeFrame2().
+};
+
+/* Compresses and writes continuous recording frames on a background thread.
+
+The main loop pushes serialised frames into a bounded single-producer
+single-consumer ring buffer. If the writer falls behind and the ring is full,
+frames are dropped rather than stalling the main loop. */
+class FGReplayContinuousWriter : public SGThread
+{
+public:
+    // If <index> is not null, we append an index footer entry for each frame.
+    FGReplayContinuousWriter(
+            std::ofstream& out,
+            int compression,
+            std::vector<char>* index,
+            size_t capacity
+            );
+
+    // Called by main loop only. Returns false if frame was dropped because
+    // the queue is full.
+    bool push(std::unique_ptr<FGReplayContinuousFrame> frame);
+
+    // Writes all queued frames and waits for thread to finish.
+    void stop();
+
+    // Number of frames queued but not yet written.
+    size_t depth() const;
+
+    size_t dropped() const;
+
+protected:
+    void run() override;
+
+private:
+    void write(const FGReplayContinuousFrame& frame);
+
+    std::ofstream&      m_out;
+    int                 m_compression;
+    std::vector<char>*  m_index;
+    bool                m_failed = false;
+
+    std::vector<std::unique_ptr<FGReplayContinuousFrame>>   m_ring;
+    std::atomic<size_t> m_head{0};  // Only modified by writer thread.
+    std::atomic<size_t> m_tail{0};  // Only modified by main loop.
+    std::atomic<size_t> m_dropped{0};
+
+    std::mutex              m_wake_lock;
+    std::condition_variable m_wake;
+    bool                    m_stop = false;    // Guarded by m_wake_lock.
+};
+
 typedef std::deque < FGReplayData *> replay_list_type;
 typedef std::vector < FGReplayMessages > replay_messages_type;
 
@@ -150,6 +301,9 @@ public:
     static std::string  makeTapePath(const std::string& tape_name);
     
 private:
+    // test class is a friend so it can drive the buffers and tapes directly
+    friend class ReplayTests;
+
     void clear();
     FGReplayData* record(double time);
     void interpolate(double time, const replay_list_type &list);
@@ -200,12 +354,74 @@ private:
     //
     static void call_indexContinuousRecording(void* ref, const void* data, size_t numbytes);
     
+    // Fills in-memory index directly from the index footer of a
+    // memory-mapped Continuous recording, without reading any frames.
+    //
+    // Returns false if recording has no valid index footer, in which case the
+    // caller should fall back to indexContinuousRecording().
+    //
+    bool indexContinuousRecordingFromFooter();
+    
+    // Makes the in-memory index of the Continuous recording <Filename>, whose
+    // frames start at <frames_begin>. Uses the index footer if the recording
+    // is a complete local file that has one, otherwise scans its frames, as
+    // they are downloaded if <filerequest> is set.
+    //
+    // Returns true if the index footer was used.
+    //
+    bool indexContinuousRecordingFile(
+            const SGPath& Filename,
+            std::streampos frames_begin,
+            simgear::HTTP::FileRequestRef filerequest
+            );
+    
+    // Writes statistics about the in-memory index into /sim/replay/.
+    //
+    void updateContinuousIndexProperties();
+    
+    // Moves front of <list> to recycler.
+    //
+    void recycleFront(replay_list_type& list);
+    
+    // Moves front of <from> to back of <to>, re-encoding it with <encoder>.
+    //
+    void moveFront(replay_list_type& from, replay_list_type& to, FGReplayDeltaEncoder& encoder);
+    
+    // Recycles the oldest frames, long term ones first, until bufferBytes()
+    // is within <memory_budget>. The newest short term frame is kept.
+    //
+    void applyMemoryBudget(size_t memory_budget);
+    
+    // Recalculates m_buffer_bytes from scratch.
+    //
+    void recountBufferBytes();
+    
+    // Approximate memory used by the in-memory lists, including keyframes.
+    //
+    size_t bufferBytes() const;
+    
     SGPropertyNode_ptr continuousWriteHeader(
             std::ofstream&      out,
             const SGPath&       path,
             FGTapeType          tape_type
             );
-    bool continuousWriteFrame(FGReplayData* r, std::ostream& out, SGPropertyNode_ptr meta);
+    // If index is not null, we append an index footer entry for the frame.
+    //
+    bool continuousWriteFrame(
+            FGReplayData* r,
+            std::ostream& out,
+            SGPropertyNode_ptr meta,
+            std::vector<char>* index=nullptr
+            );
+    
+    // Queues frame for writing to m_continuous_out by m_continuous_writer.
+    //
+    void continuousQueueFrame(FGReplayData* r);
+    
+    // Flushes and stops m_continuous_writer, appends index footer (if
+    // enabled) and closes m_continuous_out.
+    //
+    void continuousStopRecording();
 
     double sim_time;
     double last_mt_time;
@@ -220,6 +436,16 @@ private:
     replay_list_type long_term;
     replay_list_type recycler;
     replay_messages_type replay_messages;
+    
+    FGReplayDeltaEncoder    m_short_term_encoder;
+    FGReplayDeltaEncoder    m_medium_term_encoder;
+    FGReplayDeltaEncoder    m_long_term_encoder;
+    
+    // Approximate memory used by frames in short_term, medium_term and
+    // long_term, not including their keyframes; see bufferBytes().
+    size_t              m_buffer_bytes = 0;
+    SGPropertyNode_ptr  m_memory_budget_mb;
+    SGPropertyNode_ptr  m_datastats_bytes_buffered;
 
     SGPropertyNode_ptr disable_replay;
     SGPropertyNode_ptr replay_master;
@@ -260,7 +486,7 @@ private:
     bool                            m_continuous_in_multiplayer;
     bool                            m_continuous_in_extra_properties;
     std::mutex                      m_continuous_in_time_to_frameinfo_lock;
-    std::map<double, FGFrameInfo>   m_continuous_in_time_to_frameinfo;
+    FGReplayFrameIndex              m_continuous_in_frame_index;
     SGPropertyNode_ptr              m_continuous_in_config;
     double                          m_continuous_in_time_last;
     double                          m_continuous_in_frame_time_last;
@@ -268,6 +494,10 @@ private:
     std::ifstream                   m_continuous_indexing_in;
     std::streampos                  m_continuous_indexing_pos;
     
+    // Memory mapping of m_continuous_in if it is a complete local file. When
+    // set, frames are read directly from the mapping.
+    std::unique_ptr<FGReplayTapeMapping>    m_continuous_in_map;
+    
     // Only used for gathering statistics that are then written into
     // properties.
     //
@@ -277,7 +507,18 @@ private:
     // For writing uncompressed fgtape file.
     SGPropertyNode_ptr  m_continuous_out_config;
     std::ofstream       m_continuous_out;
+    std::vector<char>   m_continuous_out_index;     // Packed index footer entries.
     int                 m_continuous_out_compression;
+    
+    // Whether we are making a continuous recording. Unlike
+    // m_continuous_out.is_open(), this is safe to read while
+    // m_continuous_writer is writing.
+    bool                m_continuous_recording = false;
+    
+    // If set, owns m_continuous_out and m_continuous_out_index until stopped.
+    std::unique_ptr<FGReplayContinuousWriter>   m_continuous_writer;
+    SGPropertyNode_ptr  m_continuous_write_queue_depth;
+    SGPropertyNode_ptr  m_continuous_write_dropped_frames;
     int                 m_continuous_in_compression;
     
     SGPropertyNode_ptr  m_simple_time_enabled;
@@ -35,6 +35,10 @@
 #include <string.h> // memchr()
 #include <ctype.h> // isspace()
 #include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #include <simgear/constants.h>
 #include <simgear/debug/logstream.hxx>
@@ -42,6 +46,8 @@
 #include <simgear/misc/strutils.hxx>
 #include <simgear/structure/exception.hxx>
 #include <simgear/misc/sg_path.hxx>
+#include <simgear/threads/SGThread.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include <cstddef>              // std::size_t
 #include <string>
@@ -87,6 +93,115 @@ APTLoader::APTLoader()
 
 APTLoader::~APTLoader() { }
 
+namespace {
+
+/**
+ * Decompresses an apt.dat file on a helper thread, so inflating the data
+ * overlaps with splitting it into lines. The text is handed over in large
+ * blocks which always end on a line boundary and are followed by a '\0',
+ * so lines never straddle two blocks and atoi() on a line is safe.
+ */
+class AptDatBlockReader : public SGThread
+{
+public:
+  struct Block
+  {
+    std::unique_ptr<char[]> data;
+    std::size_t size = 0;
+    std::size_t fileOffset = 0;   // approximate, for progress reporting
+  };
+
+  explicit AptDatBlockReader(sg_gzifstream& in) : _in(in) { }
+
+  ~AptDatBlockReader()
+  {
+    {
+      std::lock_guard<std::mutex> g(_lock);
+      _cancelled = true;
+    }
+    _changed.notify_all();
+    join();
+  }
+
+  // Returns false once the whole file has been handed over.
+  bool nextBlock(Block& block)
+  {
+    std::unique_lock<std::mutex> g(_lock);
+    _changed.wait(g, [this] { return !_blocks.empty() || _finished; });
+    if (_blocks.empty()) {
+      return false;
+    }
+
+    block = std::move(_blocks.front());
+    _blocks.pop_front();
+    _changed.notify_all();
+    return true;
+  }
+
+protected:
+  void run() override
+  {
+    const std::size_t blockSize = 4 << 20;
+    std::string carry;
+
+    for (;;) {
+      Block block;
+      block.data.reset(new char[carry.size() + blockSize + 1]);
+      memcpy(block.data.get(), carry.data(), carry.size());
+      _in.read(block.data.get() + carry.size(), blockSize);
+      const std::size_t numRead = static_cast<std::size_t>(_in.gcount());
+      const std::size_t total = carry.size() + numRead;
+      carry.clear();
+
+      if (numRead == 0) {
+        if (total == 0) {
+          break;
+        }
+        block.size = total;     // last line without a terminator
+      } else {
+        // memrchr() is not portable
+        const char* lineEnd = block.data.get() + total;
+        while (lineEnd > block.data.get() && *(lineEnd - 1) != '\n') {
+          --lineEnd;
+        }
+        if (lineEnd == block.data.get()) {
+          // a single line longer than the block: keep collecting
+          carry.assign(block.data.get(), total);
+          continue;
+        }
+        block.size = lineEnd - block.data.get();
+        carry.assign(block.data.get() + block.size, total - block.size);
+      }
+
+      block.data[block.size] = '\0';
+      block.fileOffset = _in.approxOffset();
+
+      std::unique_lock<std::mutex> g(_lock);
+      // a few blocks of read-ahead are plenty
+      _changed.wait(g, [this] { return _blocks.size() < 4 || _cancelled; });
+      if (_cancelled) {
+        return;
+      }
+      _blocks.push_back(std::move(block));
+      _changed.notify_all();
+    }
+
+    std::lock_guard<std::mutex> g(_lock);
+    _finished = true;
+    _changed.notify_all();
+  }
+
+private:
+  sg_gzifstream& _in;
+  std::mutex _lock;
+  std::condition_variable _changed;
+  std::deque<Block> _blocks;
+  bool _finished = false;
+  bool _cancelled = false;
+};
+
+} // of anonymous namespace
+
 void APTLoader::readAptDatFile(const SGPath &aptdb_file,
                                std::size_t bytesReadSoFar,
                                std::size_t totalSizeOfAllAptDatFiles)
@@ -102,13 +217,12 @@ void APTLoader::readAptDatFile(const SGPath &aptdb_file,
                           sg_location(aptdb_file));
   }
 
-  string line;
-
   unsigned int rowCode = 0;     // terminology used in the apt.dat format spec
   unsigned int line_num = 0;
   // "airport identifier": terminology used in the apt.dat format spec. It is
   // often an ICAO code, but not always.
   string currentAirportId;
+  RawAirportInfo* currentAirport = nullptr;
   // Boolean used to make sure we don't try to load the same airport several
   // times. Defaults to true only to ensure we don't add garbage to
   // 'airportInfoMap' under the key "" (empty airport identifier) in case the
@@ -116,103 +230,113 @@ void APTLoader::readAptDatFile(const SGPath &aptdb_file,
   // its header---which would be invalid, anyway.
   bool skipAirport = true;
 
-  // Read the apt.dat header (two lines)
-  while ( line_num < 2 && std::getline(in, line) ) {
-    // 'line' may end with an \r character (tested on Linux, only \n was
-    // stripped: std::getline() only discards the _native_ line terminator)
-    line_num++;
-
-    if ( line_num == 1 ) {
-      std::string stripped_line = simgear::strutils::strip(line);
-      // First line indicates IBM ("I") or Macintosh ("A") line endings.
-      if ( stripped_line != "I" && stripped_line != "A" ) {
-        std::string pb = "invalid first line (neither 'I' nor 'A')";
-        SG_LOG( SG_GENERAL, SG_ALERT, aptdb_file << ": " << pb);
-        throw sg_format_exception("cannot parse '" + apt_dat + "': " + pb,
-                                  stripped_line);
-      }
-    } else {     // second line of the file
-      vector<string> fields(strutils::split(line, 0, 1));
-
-      if (fields.empty()) {
-        string errMsg = "unable to parse format version: empty line";
-        SG_LOG(SG_GENERAL, SG_ALERT, apt_dat << ": " << errMsg);
-        throw sg_format_exception("cannot parse '" + apt_dat + "': " + errMsg,
-                                  string());
-      } else {
-        unsigned int aptDatFormatVersion =
-          strutils::readNonNegativeInt<unsigned int>(fields[0]);
-        SG_LOG(SG_GENERAL, SG_INFO,
-               "apt.dat format version (" << apt_dat << "): " <<
-               aptDatFormatVersion);
-      }
-    }
-  } // end of the apt.dat header
-
-  throwExceptionIfStreamError(in, aptdb_file);
-
-  while ( std::getline(in, line) ) {
-    // 'line' may end with an \r character, see above
-    line_num++;
+  AptDatBlockReader reader(in);
+  reader.start();
 
-    if ( isBlankOrCommentLine(line) )
-      continue;
+  AptDatBlockReader::Block block;
+  while (reader.nextBlock(block)) {
+    const char* p = block.data.get();
+    const char* blockEnd = p + block.size;
 
-    if ((line_num % 100) == 0) {
-      // every 100 lines
-      unsigned int percent = ((bytesReadSoFar + in.approxOffset()) * 100)
-                             / totalSizeOfAllAptDatFiles;
-      cache->setRebuildPhaseProgress(
-        NavDataCache::REBUILD_READING_APT_DAT_FILES, percent);
-    }
+    while (p < blockEnd) {
+      const char* eol = static_cast<const char*>(memchr(p, '\n', blockEnd - p));
+      if (!eol) {
+        eol = blockEnd;
+      }
+      // 'line' may end with an \r character: only \n is a line terminator
+      // here, like it is for std::getline() on non-Windows systems
+      const std::string_view line(p, eol - p);
+      p = eol + 1;
+      line_num++;
+
+      // Read the apt.dat header (two lines)
+      if ( line_num == 1 ) {
+        std::string stripped_line = simgear::strutils::strip(string(line));
+        // First line indicates IBM ("I") or Macintosh ("A") line endings.
+        if ( stripped_line != "I" && stripped_line != "A" ) {
+          std::string pb = "invalid first line (neither 'I' nor 'A')";
+          SG_LOG( SG_GENERAL, SG_ALERT, aptdb_file << ": " << pb);
+          throw sg_format_exception("cannot parse '" + apt_dat + "': " + pb,
+                                    stripped_line);
+        }
+        continue;
+      } else if ( line_num == 2 ) {
+        vector<string> fields(strutils::split(string(line), 0, 1));
+
+        if (fields.empty()) {
+          string errMsg = "unable to parse format version: empty line";
+          SG_LOG(SG_GENERAL, SG_ALERT, apt_dat << ": " << errMsg);
+          throw sg_format_exception("cannot parse '" + apt_dat + "': " + errMsg,
+                                    string());
+        } else {
+          unsigned int aptDatFormatVersion =
+            strutils::readNonNegativeInt<unsigned int>(fields[0]);
+          SG_LOG(SG_GENERAL, SG_INFO,
+                 "apt.dat format version (" << apt_dat << "): " <<
+                 aptDatFormatVersion);
+        }
+        continue;
+      } // end of the apt.dat header
 
-    // Extract the first field into 'rowCode'
-    rowCode = atoi(line.c_str());
-
-    if ( rowCode == 1  /* Airport */ ||
-         rowCode == 16 /* Seaplane base */ ||
-         rowCode == 17 /* Heliport */ ) {
-      vector<string> tokens(simgear::strutils::split(line));
-      if (tokens.size() < 6) {
-        SG_LOG( SG_GENERAL, SG_WARN,
-                apt_dat << ":"  << line_num << ": invalid airport header "
-                "(at least 6 fields are required)" );
-        skipAirport = true; // discard everything until the next airport header
+      if ( isBlankOrCommentLine(line) )
         continue;
-      }
 
-      currentAirportId = tokens[4]; // often an ICAO, but not always
-      // Check if the airport is already in 'airportInfoMap'; get the
-      // existing entry, if any, otherwise insert a new one.
-      std::pair<AirportInfoMapType::iterator, bool>
-        insertRetval = airportInfoMap.insert(
-          AirportInfoMapType::value_type(currentAirportId, RawAirportInfo()));
-      skipAirport = !insertRetval.second;
-
-      if ( skipAirport ) {
-        SG_LOG( SG_GENERAL, SG_INFO,
-                apt_dat << ":"  << line_num << ": skipping airport " <<
-                currentAirportId << " (already defined earlier)" );
-      } else {
-        // We haven't seen this airport yet in any apt.dat file
-        RawAirportInfo& airportInfo = insertRetval.first->second;
-        airportInfo.file = aptdb_file;
-        airportInfo.rowCode = rowCode;
-        airportInfo.firstLineNum = line_num;
-        airportInfo.firstLineTokens = std::move(tokens);
+      // Extract the first field into 'rowCode'. The line is followed by
+      // '\n' or the '\0' after the block, so atoi() stops in time.
+      rowCode = atoi(line.data());
+
+      if ( rowCode == 1  /* Airport */ ||
+           rowCode == 16 /* Seaplane base */ ||
+           rowCode == 17 /* Heliport */ ) {
+        vector<string> tokens(simgear::strutils::split(string(line)));
+        if (tokens.size() < 6) {
+          SG_LOG( SG_GENERAL, SG_WARN,
+                  apt_dat << ":"  << line_num << ": invalid airport header "
+                  "(at least 6 fields are required)" );
+          skipAirport = true; // discard everything until the next airport header
+          continue;
+        }
+
+        currentAirportId = tokens[4]; // often an ICAO, but not always
+        // Check if the airport is already in 'airportInfoMap'; get the
+        // existing entry, if any, otherwise insert a new one.
+        std::pair<AirportInfoMapType::iterator, bool>
+          insertRetval = airportInfoMap.insert(
+            AirportInfoMapType::value_type(currentAirportId, RawAirportInfo()));
+        skipAirport = !insertRetval.second;
+
+        if ( skipAirport ) {
+          SG_LOG( SG_GENERAL, SG_INFO,
+                  apt_dat << ":"  << line_num << ": skipping airport " <<
+                  currentAirportId << " (already defined earlier)" );
+        } else {
+          // We haven't seen this airport yet in any apt.dat file
+          currentAirport = &insertRetval.first->second;
+          currentAirport->file = aptdb_file;
+          currentAirport->rowCode = rowCode;
+          currentAirport->firstLineNum = line_num;
+          currentAirport->firstLineTokens = std::move(tokens);
+        }
+      } else if ( rowCode == 99 ) {
+        SG_LOG( SG_GENERAL, SG_DEBUG,
+                apt_dat << ":"  << line_num << ": code 99 found "
+                "(normally at end of file)" );
+      } else if ( !skipAirport ) {
+        // Line belonging to an already started, and not skipped airport
+        // entry; just append it. The text itself stays in the block.
+        currentAirport->otherLines.emplace_back(line_num, rowCode, line);
       }
-    } else if ( rowCode == 99 ) {
-      SG_LOG( SG_GENERAL, SG_DEBUG,
-              apt_dat << ":"  << line_num << ": code 99 found "
-              "(normally at end of file)" );
-    } else if ( !skipAirport ) {
-      // Line belonging to an already started, and not skipped airport entry;
-      // just append it.
-      airportInfoMap[currentAirportId].otherLines.emplace_back(
-        line_num, rowCode, line);
-    }
+    } // of loop over the lines in the block
+
+    unsigned int percent = ((bytesReadSoFar + block.fileOffset) * 100)
+                           / totalSizeOfAllAptDatFiles;
+    cache->setRebuildPhaseProgress(
+      NavDataCache::REBUILD_READING_APT_DAT_FILES, percent);
+
+    textBlocks.push_back(std::move(block.data));
   } // of file reading loop
 
+  // the reader is done with 'in' once it has reported the end of the file
   throwExceptionIfStreamError(in, aptdb_file);
 }
 
@@ -221,29 +345,89 @@ void APTLoader::loadAirports()
   AirportInfoMapType::size_type nbLoadedAirports = 0;
   AirportInfoMapType::size_type nbAirports = airportInfoMap.size();
 
-  // Loop over all airports found in all apt.dat files
-  for (AirportInfoMapType::const_iterator it = airportInfoMap.begin();
-       it != airportInfoMap.end(); it++) {
-    // Full path to the apt.dat file this airport info comes from
-    const string aptDat = it->second.file.utf8Str();
-
-    // this is just the current airport identifier
-    last_apt_id = it->first;
-    RawAirportInfo rawinfo = it->second;
+  std::vector<const AirportInfoMapType::value_type*> airports;
+  airports.reserve(nbAirports);
+  for (const auto& entry : airportInfoMap) {
+    airports.push_back(&entry);
+  }
 
-    loadAirport(aptDat, last_apt_id, &rawinfo);
-    nbLoadedAirports++;
+  // Splitting lines into fields is independent for each airport, so it is
+  // done by helper threads, one batch ahead of the inserts into the cache,
+  // which have to happen on this thread.
+  const std::size_t batchSize = 256;
+  const unsigned int numThreads =
+    std::max(1u, std::min(4u, std::thread::hardware_concurrency() - 1));
+
+  auto tokenizeBatch = [&airports, batchSize, numThreads]
+    (std::size_t begin, std::vector<TokenizedLines>& result,
+     std::vector<std::thread>& threads)
+  {
+    const std::size_t end = std::min(begin + batchSize, airports.size());
+    result.clear();
+    result.resize(end - begin);
+    for (unsigned int t = 0; t < numThreads; ++t) {
+      threads.emplace_back([&airports, &result, begin, end, t, numThreads] {
+        for (std::size_t i = begin + t; i < end; i += numThreads) {
+          tokenizeLines(airports[i]->second.otherLines, result[i - begin]);
+        }
+      });
+    }
+  };
 
-    if ((nbLoadedAirports % 300) == 0) {
-      // Every 300 airports
-      unsigned int percent = nbLoadedAirports * 100 / nbAirports;
-      cache->setRebuildPhaseProgress(NavDataCache::REBUILD_LOADING_AIRPORTS,
-                                     percent);
+  auto joinAll = [](std::vector<std::thread>& threads) {
+    for (auto& t : threads) {
+      t.join();
     }
-  } // of loop over 'airportInfoMap'
+    threads.clear();
+  };
+
+  SGTimeStamp st;
+  double waitMSec = 0.0;
+  std::vector<TokenizedLines> current, next;
+  std::vector<std::thread> threads;
+  tokenizeBatch(0, next, threads);
+
+  try {
+    for (std::size_t begin = 0; begin < airports.size(); begin += batchSize) {
+      st.stamp();
+      joinAll(threads);
+      waitMSec += st.elapsedMSec();
+      current.swap(next);
+
+      if (begin + batchSize < airports.size()) {
+        tokenizeBatch(begin + batchSize, next, threads);
+      }
+
+      for (std::size_t i = 0; i < current.size(); ++i) {
+        const AirportInfoMapType::value_type* entry = airports[begin + i];
+        // Full path to the apt.dat file this airport info comes from
+        const string aptDat = entry->second.file.utf8Str();
+
+        // this is just the current airport identifier
+        last_apt_id = entry->first;
+        loadAirport(aptDat, last_apt_id, &entry->second, current[i]);
+        nbLoadedAirports++;
+
+        if ((nbLoadedAirports % 300) == 0) {
+          // Every 300 airports
+          unsigned int percent = nbLoadedAirports * 100 / nbAirports;
+          cache->setRebuildPhaseProgress(NavDataCache::REBUILD_LOADING_AIRPORTS,
+                                         percent);
+        }
+      }
+    } // of loop over 'airportInfoMap'
+  } catch (...) {
+    joinAll(threads);
+    throw;
+  }
 
   SG_LOG( SG_GENERAL, SG_INFO,
-          "Loaded data for " << nbLoadedAirports << " airports" );
+          "Loaded data for " << nbLoadedAirports << " airports (waited "
+          << waitMSec << "msec for tokenizing)" );
+
+  // the raw data is not needed any more
+  airportInfoMap.clear();
+  textBlocks.clear();
 }
 
 // Parse and return specific apt.dat file containing a single airport.
@@ -254,8 +438,10 @@ const FGAirport* APTLoader::loadAirportFromFile(std::string id, const SGPath& ap
 
   readAptDatFile(aptdb_file.str(), bytesReadSoFar, totalSizeOfAllAptDatFiles);
 
-  RawAirportInfo rawInfo = airportInfoMap[id];
-  return loadAirport(aptdb_file.c_str(), id, &rawInfo, true);
+  const RawAirportInfo& rawInfo = airportInfoMap[id];
+  TokenizedLines tokens;
+  tokenizeLines(rawInfo.otherLines, tokens);
+  return loadAirport(aptdb_file.c_str(), id, &rawInfo, tokens, true);
 }
 
 static bool isCommLine(const int code)
@@ -263,7 +449,28 @@ static bool isCommLine(const int code)
     return ((code >= 50) && (code <= 56)) || ((code >= 1050) && (code <= 1056));
 }
 
-const FGAirport* APTLoader::loadAirport(const string aptDat, const std::string airportID, RawAirportInfo* airport_info, bool createFGAirport)
+void APTLoader::tokenizeLines(const LinesList& lines, TokenizedLines& tokens)
+{
+  tokens.resize(lines.size());
+
+  for (std::size_t i = 0; i < lines.size(); ++i) {
+    const unsigned int rowCode = lines[i].rowCode;
+    const string str(lines[i].str);
+
+    if ( rowCode == 110 ) { // Pavement: the last field is a free text name
+      tokens[i] = simgear::strutils::split(str, 0, 4);
+    } else if ( rowCode == 10 || rowCode == 100 || rowCode == 101 ||
+                rowCode == 102 || rowCode == 14 || isCommLine(rowCode) ||
+                (rowCode >= 111 && rowCode <= 116) ) {
+      tokens[i] = simgear::strutils::split(str);
+    }
+  }
+}
+
+const FGAirport* APTLoader::loadAirport(const string aptDat, const std::string airportID,
+                                        const RawAirportInfo* airport_info,
+                                        const TokenizedLines& tokens,
+                                        bool createFGAirport)
 {
   // The first line for this airport was already split over whitespace, but
   // remains to be parsed for the most part.
@@ -273,28 +480,25 @@ const FGAirport* APTLoader::loadAirport(const string aptDat, const std::string a
   NodeBlock current_block = None;
 
   // Loop over the second and subsequent lines
-  for (LinesList::const_iterator linesIt = lines.begin();
-       linesIt != lines.end(); linesIt++) {
+  for (LinesList::size_type i = 0; i < lines.size(); i++) {
+    const LinesList::const_iterator linesIt = lines.begin() + i;
+    // Fields of the line, as split by tokenizeLines()
+    const vector<string>& token = tokens[i];
     // Beware that linesIt->str may end with an '\r' character, see above!
     unsigned int rowCode = linesIt->rowCode;
 
     if ( rowCode == 10 ) { // Runway v810
-      parseRunwayLine810(aptDat, linesIt->number,
-                         simgear::strutils::split(linesIt->str));
+      parseRunwayLine810(aptDat, linesIt->number, token);
     } else if ( rowCode == 100 ) { // Runway v850
-      parseRunwayLine850(aptDat, linesIt->number,
-                         simgear::strutils::split(linesIt->str));
+      parseRunwayLine850(aptDat, linesIt->number, token);
     } else if ( rowCode == 101 ) { // Water Runway v850
-      parseWaterRunwayLine850(aptDat, linesIt->number,
-                              simgear::strutils::split(linesIt->str));
+      parseWaterRunwayLine850(aptDat, linesIt->number, token);
     } else if ( rowCode == 102 ) { // Helipad v850
-      parseHelipadLine850(aptDat, linesIt->number,
-                          simgear::strutils::split(linesIt->str));
+      parseHelipadLine850(aptDat, linesIt->number, token);
     } else if ( rowCode == 18 ) {
       // beacon entry (ignore)
     } else if ( rowCode == 14 ) {  // Viewpoint/control tower
-      parseViewpointLine(aptDat, linesIt->number,
-                         simgear::strutils::split(linesIt->str));
+      parseViewpointLine(aptDat, linesIt->number, token);
     } else if ( rowCode == 19 ) {
       // windsock entry (ignore)
     } else if ( rowCode == 20 ) {
@@ -306,24 +510,20 @@ const FGAirport* APTLoader::loadAirport(const string aptDat, const std::string a
     } else if ( rowCode == 0 ) {
       // ??
     } else if (isCommLine(rowCode)) {
-        parseCommLine(aptDat, linesIt->number, rowCode,
-                      simgear::strutils::split(linesIt->str));
+        parseCommLine(aptDat, linesIt->number, rowCode, token);
     } else if (rowCode == 110) {
         current_block = Pavement;
-        parsePavementLine850(simgear::strutils::split(linesIt->str, 0, 4));
+        parsePavementLine850(token);
     } else if (rowCode >= 111 && rowCode <= 116) {
         switch (current_block) {
         case Pavement :
-          parseNodeLine850(&pavements, aptDat, linesIt->number, rowCode,
-                                   simgear::strutils::split(linesIt->str));
+          parseNodeLine850(&pavements, aptDat, linesIt->number, rowCode, token);
           break;
         case AirportBoundary :
-          parseNodeLine850(&airport_boundary, aptDat, linesIt->number, rowCode,
-                                          simgear::strutils::split(linesIt->str));
+          parseNodeLine850(&airport_boundary, aptDat, linesIt->number, rowCode, token);
           break;
         case LinearFeature :
-          parseNodeLine850(&linear_feature, aptDat, linesIt->number, rowCode,
-                                        simgear::strutils::split(linesIt->str));
+          parseNodeLine850(&linear_feature, aptDat, linesIt->number, rowCode, token);
           break;
         default :
         case None :
@@ -385,7 +585,7 @@ const FGAirport* APTLoader::loadAirport(const string aptDat, const std::string a
 
 
 // Tell whether an apt.dat line is blank or a comment line
-bool APTLoader::isBlankOrCommentLine(const std::string& line)
+bool APTLoader::isBlankOrCommentLine(std::string_view line)
 {
   size_t pos = line.find_first_not_of(" \t");
   return ( pos == std::string::npos ||
@@ -393,9 +593,9 @@ bool APTLoader::isBlankOrCommentLine(const std::string& line)
            line.find("##", pos) == pos );
 }
 
-std::string APTLoader::cleanLine(const std::string& line)
+std::string APTLoader::cleanLine(std::string_view line)
 {
-  std::string res = line;
+  std::string res(line);
 
   // Lines obtained from readAptDatFile() may end with \r, which can be quite
   // confusing when printed to the terminal.
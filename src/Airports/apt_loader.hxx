@@ -25,7 +25,9 @@
 #ifndef _FG_APT_LOADER_HXX
 #define _FG_APT_LOADER_HXX
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include "airport.hxx"
@@ -66,15 +68,19 @@ public:
 private:
   struct Line
   {
-    Line(unsigned int number_, unsigned int rowCode_, std::string str_)
+    Line(unsigned int number_, unsigned int rowCode_, std::string_view str_)
       : number(number_), rowCode(rowCode_), str(str_) { }
 
     unsigned int number;
     unsigned int rowCode;         // Terminology of the apt.dat spec
-    std::string str;
+    // Points into 'textBlocks', without the line terminator
+    std::string_view str;
   };
 
   typedef std::vector<Line> LinesList;
+  // The whitespace-separated fields of each line of an airport, as needed by
+  // the parse*() functions (empty for row codes that are ignored)
+  typedef std::vector<std::vector<std::string> > TokenizedLines;
 
   struct RawAirportInfo
   {
@@ -98,12 +104,19 @@ private:
   APTLoader(const APTLoader&);            // disable copy constructor
   APTLoader& operator=(const APTLoader&); // disable copy-assignment operator
 
-  const FGAirport* loadAirport(const string aptDat, const std::string airportID, RawAirportInfo* airport_info, bool createFGAirport=false);
+  const FGAirport* loadAirport(const string aptDat, const std::string airportID,
+                               const RawAirportInfo* airport_info,
+                               const TokenizedLines& tokens,
+                               bool createFGAirport=false);
+
+  // Split the lines of an airport into fields. This only depends on the
+  // lines themselves, so it can run on several threads at once.
+  static void tokenizeLines(const LinesList& lines, TokenizedLines& tokens);
 
   // Tell whether an apt.dat line is blank or a comment line
-  bool isBlankOrCommentLine(const std::string& line);
+  static bool isBlankOrCommentLine(std::string_view line);
   // Return a copy of 'line' with trailing '\r' char(s) removed
-  std::string cleanLine(const std::string& line);
+  static std::string cleanLine(std::string_view line);
   void throwExceptionIfStreamError(const sg_gzifstream& input_stream,
                                    const SGPath& path);
   void parseAirportLine(unsigned int rowCode,
@@ -131,6 +144,8 @@ private:
 
   std::vector<std::string> token;
   AirportInfoMapType airportInfoMap;
+  // Decompressed apt.dat text, kept until the airports have been loaded
+  std::vector<std::unique_ptr<char[]> > textBlocks;
   double rwy_lat_accum;
   double rwy_lon_accum;
   double last_rwy_heading;
@@ -51,6 +51,21 @@ double AnalogComponent::clamp( double value ) const
     return value;
 }
 
+void AnalogComponent::collectDependencies( std::set<const SGPropertyNode*>& inputs,
+                                           std::set<const SGPropertyNode*>& outputs ) const
+{
+  Component::collectDependencies(inputs, outputs);
+
+  _valueInput.collectDependentProperties(inputs);
+  _referenceInput.collectDependentProperties(inputs);
+  _minInput.collectDependentProperties(inputs);
+  _maxInput.collectDependentProperties(inputs);
+  if( _periodical )
+    _periodical->collectDependentProperties(inputs);
+
+  outputs.insert(_output_list.begin(), _output_list.end());
+}
+
 bool AnalogComponent::configure( SGPropertyNode& cfg_node,
                                  const std::string& cfg_name,
                                  SGPropertyNode& prop_root )
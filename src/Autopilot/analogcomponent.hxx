@@ -139,6 +139,9 @@ protected:
 
 public:
     const PeriodicalValue * getPeriodicalValue() const { return _periodical; }
+
+    void collectDependencies( std::set<const SGPropertyNode*>& inputs,
+                              std::set<const SGPropertyNode*>& outputs ) const override;
 };
 
 inline void AnalogComponent::disabled( double dt )
@@ -27,6 +27,9 @@
 
 #include "autopilot.hxx"
 
+#include <map>
+#include <set>
+
 #include <simgear/structure/StateMachine.hxx>
 #include <simgear/sg_inlines.h>
 
@@ -127,6 +130,7 @@ static ComponentForge componentForge;
 Autopilot::Autopilot( SGPropertyNode_ptr rootNode, SGPropertyNode_ptr configNode ) :
   _name("unnamed autopilot"),
   _serviceable(true),
+  _dependencyOrder(true),
   _rootNode(rootNode)
 {
   if (componentForge.empty())
@@ -154,6 +158,14 @@ Autopilot::Autopilot( SGPropertyNode_ptr rootNode, SGPropertyNode_ptr configNode
   SGPropertyNode_ptr prop_root =
     fgGetNode(prop_root_node ? prop_root_node->getStringValue() : "/", true);
 
+  // dependency-order, just like property-root, may be overridden in the
+  // local system node
+  SGPropertyNode_ptr order_node = rootNode->getChild("dependency-order");
+  if( !order_node )
+    order_node = configNode->getChild("dependency-order");
+  if( order_node )
+    _dependencyOrder = order_node->getBoolValue();
+
   // Just like the JSBSim interface properties for systems, create properties
   // given in the autopilot file and set to given (default) values.
   readInterfaceProperties(prop_root, configNode);
@@ -169,7 +181,8 @@ Autopilot::Autopilot( SGPropertyNode_ptr rootNode, SGPropertyNode_ptr configNode
     SGPropertyNode_ptr node = configNode->getChild(i);
     string childName = node->getName();
     if(    childName == "property"
-        || childName == "property-root" )
+        || childName == "property-root"
+        || childName == "dependency-order" )
       continue;
     if( componentForge.count(childName) == 0 )
     {
@@ -188,6 +201,9 @@ Autopilot::Autopilot( SGPropertyNode_ptr rootNode, SGPropertyNode_ptr configNode
     SG_LOG( SG_AUTOPILOT, SG_DEBUG, "adding  autopilot component \"" << childName << "\" as \"" << component->subsystemId() << "\" with interval=" << updateInterval );
     add_component(component,updateInterval);
   }
+
+  if( _dependencyOrder )
+    order_components();
 }
 
 Autopilot::~Autopilot() 
@@ -229,6 +245,99 @@ void Autopilot::add_component( Component * component, double updateInterval )
   }
 
   set_subsystem( name, component, updateInterval );
+
+  _components.push_back( ConfiguredComponent{name, component, updateInterval} );
+}
+
+void Autopilot::order_components()
+{
+  const size_t n = _components.size();
+
+  // the components writing each property
+  std::vector<std::set<const SGPropertyNode*> > reads(n);
+  std::map<const SGPropertyNode*, std::vector<size_t> > writers;
+  for( size_t i = 0; i < n; ++i )
+  {
+    std::set<const SGPropertyNode*> writes;
+    _components[i].component->collectDependencies(reads[i], writes);
+    for( const SGPropertyNode* node : writes )
+      writers[node].push_back(i);
+  }
+
+  std::vector<std::set<size_t> > successors(n);
+  std::vector<size_t> blockers(n, 0);
+  for( size_t i = 0; i < n; ++i )
+  {
+    for( const SGPropertyNode* node : reads[i] )
+    {
+      auto it = writers.find(node);
+      if( it == writers.end() )
+        continue;
+      for( size_t w : it->second )
+      {
+        if( w != i && successors[w].insert(i).second )
+          ++blockers[i];
+      }
+    }
+  }
+
+  // Kahn's algorithm, keeping the configuration order wherever the
+  // dependencies allow it. A feedback loop is broken at its first component,
+  // which then reads the value of the previous frame, as it always did.
+  std::set<size_t> ready;
+  for( size_t i = 0; i < n; ++i )
+    if( blockers[i] == 0 )
+      ready.insert(i);
+
+  std::vector<bool> done(n, false);
+  std::vector<size_t> order;
+  size_t loops = 0;
+  while( order.size() < n )
+  {
+    size_t next = 0;
+    if( !ready.empty() )
+    {
+      next = *ready.begin();
+      ready.erase(ready.begin());
+    }
+    else
+    {
+      while( done[next] )
+        ++next;
+      ++loops;
+    }
+
+    done[next] = true;
+    order.push_back(next);
+    for( size_t s : successors[next] )
+      if( !done[s] && --blockers[s] == 0 )
+        ready.insert(s);
+  }
+
+  SG_LOG( SG_AUTOPILOT, SG_DEBUG, "autopilot " << _name << ": ordered "
+          << n << " components by dependency, " << loops
+          << " feedback loop(s)" );
+
+  bool reordered = false;
+  for( size_t i = 0; i < n; ++i )
+    reordered |= (order[i] != i);
+  if( !reordered )
+    return;
+
+  // the group updates its members in the order they were added, so re-add
+  // them in dependency order. _components keeps them alive meanwhile.
+  for( const ConfiguredComponent& entry : _components )
+    remove_subsystem( entry.name );
+
+  std::vector<ConfiguredComponent> ordered;
+  ordered.reserve(n);
+  for( size_t i : order )
+  {
+    const ConfiguredComponent& entry = _components[i];
+    set_subsystem( entry.name, entry.component.get(), entry.interval );
+    ordered.push_back(entry);
+  }
+  _components.swap(ordered);
 }
 
 void Autopilot::update( double dt ) 
@@ -23,6 +23,8 @@
 #ifndef __AUTOPILOT_HXX
 #define __AUTOPILOT_HXX 1
 
+#include <vector>
+
 #include <simgear/props/props.hxx>
 #include <simgear/structure/subsystem_mgr.hxx>
 
@@ -33,6 +35,12 @@ class Component;
 /**
  * @brief A SGSubsystemGroup implementation to serve as a collection
  * of Components
+ *
+ * Unless dependency-order is set to false, the components are registered
+ * with the group in dependency order once configured: the component writing
+ * a property is updated before the components reading it, so a value
+ * propagates through a chain of components in a single frame. Feedback
+ * loops keep the configuration order.
  */
 class Autopilot : public SGSubsystemGroup
 {
@@ -59,9 +67,21 @@ public:
 protected:
 
 private:
+    struct ConfiguredComponent
+    {
+        std::string name;
+        SGSharedPtr<Component> component;
+        double interval;
+    };
+
+    void order_components();
+
     std::string _name;
     bool _serviceable;
+    bool _dependencyOrder;
     SGPropertyNode_ptr _rootNode;
+
+    std::vector<ConfiguredComponent> _components; ///< in update (dependency) order
 };
 
 }
@@ -131,6 +131,17 @@ bool Component::isPropertyEnabled()
     return true;
 }
 
+//------------------------------------------------------------------------------
+void Component::collectDependencies( std::set<const SGPropertyNode*>& inputs,
+                                     std::set<const SGPropertyNode*>& outputs ) const
+{
+  if( _condition )
+    _condition->collectDependentProperties(inputs);
+
+  if( _enable_prop )
+    inputs.insert(_enable_prop);
+}
+
 void Component::update( double dt )
 {
   bool firstTime = false;
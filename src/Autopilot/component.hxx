@@ -27,6 +27,8 @@
 #  include <config.h>
 #endif
 
+#include <set>
+
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/props/propsfwd.hxx>
 
@@ -120,6 +122,16 @@ public:
      * Returns true, if neither &lt;condition&gt; nor &lt;prop&gt; exists
      */
     bool isPropertyEnabled();
+
+    /**
+     * @brief add the properties read and written by this component, which
+     *        allows the autopilot to update the writer of a property before
+     *        its readers.
+     * @param inputs  receives the properties this component depends on
+     * @param outputs receives the properties this component sets
+     */
+    virtual void collectDependencies( std::set<const SGPropertyNode*>& inputs,
+                                      std::set<const SGPropertyNode*>& outputs ) const;
 };
 
 }
@@ -44,6 +44,20 @@ bool DigitalComponent::InputMap::get_value( const std::string & name ) const
   return (*__i).second->test();
 }
 
+void DigitalComponent::collectDependencies( std::set<const SGPropertyNode*>& inputs,
+                                            std::set<const SGPropertyNode*>& outputs ) const
+{
+  Component::collectDependencies(inputs, outputs);
+
+  for( InputMap::const_iterator it = _input.begin(); it != _input.end(); ++it )
+    if( it->second )
+      it->second->collectDependentProperties(inputs);
+
+  for( OutputMap::const_iterator it = _output.begin(); it != _output.end(); ++it )
+    if( it->second->getProperty() )
+      outputs.insert(it->second->getProperty());
+}
+
 /*
   <input>
     <name>Foo</name>
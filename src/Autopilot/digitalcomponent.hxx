@@ -54,6 +54,8 @@ public:
 
   bool getValue() const;
   void setValue( bool value );
+
+  const SGPropertyNode* getProperty() const { return _node; }
 };
 
 inline DigitalOutput::DigitalOutput() : _inverted(false) 
@@ -104,6 +106,9 @@ public:
 
 //    typedef std::map<const std::string,SGSharedPtr<const SGCondition> > InputMap;
     typedef std::map<const std::string,DigitalOutput_ptr> OutputMap;
+
+    void collectDependencies( std::set<const SGPropertyNode*>& inputs,
+                              std::set<const SGPropertyNode*>& outputs ) const override;
 protected:
 
     /**
@@ -50,6 +50,7 @@ class DigitalFilterImplementation:
     virtual bool configure( SGPropertyNode& cfg_node,
                             const std::string& cfg_name,
                             SGPropertyNode& prop_root ) = 0;
+    virtual void collectDependencies( std::set<const SGPropertyNode*>& inputs ) const {}
 
     void setDigitalFilter( DigitalFilter * digitalFilter ) { _digitalFilter = digitalFilter; }
 
@@ -65,6 +66,7 @@ protected:
   bool configure( SGPropertyNode& cfg_node,
                   const std::string& cfg_name,
                   SGPropertyNode& prop_root );
+  void collectDependencies( std::set<const SGPropertyNode*>& inputs ) const;
 public:
   GainFilterImplementation() : _gainInput(1.0) {}
   double compute(  double dt, double input );
@@ -81,6 +83,7 @@ class DerivativeFilterImplementation : public GainFilterImplementation {
   bool configure( SGPropertyNode& cfg_node,
                   const std::string& cfg_name,
                   SGPropertyNode& prop_root );
+  void collectDependencies( std::set<const SGPropertyNode*>& inputs ) const;
 public:
   DerivativeFilterImplementation();
   double compute(  double dt, double input );
@@ -93,6 +96,7 @@ protected:
   bool configure( SGPropertyNode& cfg_node,
                   const std::string& cfg_name,
                   SGPropertyNode& prop_root );
+  void collectDependencies( std::set<const SGPropertyNode*>& inputs ) const;
   bool _isSecondOrder;
   double _output_1, _output_2;
 public:
@@ -109,6 +113,7 @@ protected:
   bool configure( SGPropertyNode& cfg_node,
                   const std::string& cfg_name,
                   SGPropertyNode& prop_root );
+  void collectDependencies( std::set<const SGPropertyNode*>& inputs ) const;
 public:
   MovingAverageFilterImplementation();
   double compute(  double dt, double input );
@@ -122,6 +127,7 @@ protected:
   bool configure( SGPropertyNode& cfg_node,
                   const std::string& cfg_name,
                   SGPropertyNode& prop_root );
+  void collectDependencies( std::set<const SGPropertyNode*>& inputs ) const;
 public:
   NoiseSpikeFilterImplementation();
   double compute(  double dt, double input );
@@ -136,6 +142,7 @@ protected:
   bool configure( SGPropertyNode& cfg_node,
                   const std::string& cfg_name,
                   SGPropertyNode& prop_root );
+  void collectDependencies( std::set<const SGPropertyNode*>& inputs ) const;
 public:
   RateLimitFilterImplementation();
   double compute(  double dt, double input );
@@ -152,6 +159,7 @@ protected:
   bool configure( SGPropertyNode& cfg_node,
                   const std::string& cfg_name,
                   SGPropertyNode& prop_root );
+  void collectDependencies( std::set<const SGPropertyNode*>& inputs ) const;
 public:
   IntegratorFilterImplementation();
   double compute(  double dt, double input );
@@ -170,6 +178,7 @@ protected:
   bool configure( SGPropertyNode& cfg_node,
                   const std::string& cfg_name,
                   SGPropertyNode& prop_root );
+  void collectDependencies( std::set<const SGPropertyNode*>& inputs ) const;
 public:
   DampedOscillationFilterImplementation();
   double compute(  double dt, double input );
@@ -184,6 +193,7 @@ protected:
   bool configure( SGPropertyNode& cfg_node,
                   const std::string& cfg_name,
                   SGPropertyNode& prop_root );
+  void collectDependencies( std::set<const SGPropertyNode*>& inputs ) const;
 public:
   HighPassFilterImplementation();
   double compute(  double dt, double input );
@@ -198,6 +208,7 @@ protected:
   bool configure( SGPropertyNode& cfg_node,
                   const std::string& cfg_name,
                   SGPropertyNode& prop_root );
+  void collectDependencies( std::set<const SGPropertyNode*>& inputs ) const;
 public:
   LeadLagFilterImplementation();
   double compute(  double dt, double input );
@@ -216,6 +227,7 @@ protected:
     bool configure(SGPropertyNode& cfg_node,
                    const std::string& cfg_name,
                    SGPropertyNode& prop_root) override;
+    void collectDependencies(std::set<const SGPropertyNode*>& inputs) const override;
 
 public:
     CoherentNoiseFilterImplementation();
@@ -255,6 +267,11 @@ bool GainFilterImplementation::configure( SGPropertyNode& cfg_node,
   return false;
 }
 
+void GainFilterImplementation::collectDependencies( std::set<const SGPropertyNode*>& inputs ) const
+{
+  _gainInput.collectDependentProperties(inputs);
+}
+
 /* --------------------------------------------------------------------------------- */
 /* --------------------------------------------------------------------------------- */
 
@@ -296,6 +313,12 @@ bool DerivativeFilterImplementation::configure( SGPropertyNode& cfg_node,
   return false;
 }
 
+void DerivativeFilterImplementation::collectDependencies( std::set<const SGPropertyNode*>& inputs ) const
+{
+  GainFilterImplementation::collectDependencies(inputs);
+  _TfInput.collectDependentProperties(inputs);
+}
+
 double DerivativeFilterImplementation::compute(  double dt, double input )
 {
   double output = (input - _input_1) * _TfInput.get_value() * _gainInput.get_value() / dt;
@@ -354,6 +377,11 @@ bool MovingAverageFilterImplementation::configure( SGPropertyNode& cfg_node,
   return false;
 }
 
+void MovingAverageFilterImplementation::collectDependencies( std::set<const SGPropertyNode*>& inputs ) const
+{
+  _samplesInput.collectDependentProperties(inputs);
+}
+
 /* --------------------------------------------------------------------------------- */
 /* --------------------------------------------------------------------------------- */
 
@@ -395,6 +423,11 @@ bool NoiseSpikeFilterImplementation::configure( SGPropertyNode& cfg_node,
   return false;
 }
 
+void NoiseSpikeFilterImplementation::collectDependencies( std::set<const SGPropertyNode*>& inputs ) const
+{
+  _rateOfChangeInput.collectDependentProperties(inputs);
+}
+
 /* --------------------------------------------------------------------------------- */
 
 RateLimitFilterImplementation::RateLimitFilterImplementation() :
@@ -444,6 +477,12 @@ bool RateLimitFilterImplementation::configure( SGPropertyNode& cfg_node,
   return false;
 }
 
+void RateLimitFilterImplementation::collectDependencies( std::set<const SGPropertyNode*>& inputs ) const
+{
+  _rateOfChangeMax.collectDependentProperties(inputs);
+  _rateOfChangeMin.collectDependentProperties(inputs);
+}
+
 /* --------------------------------------------------------------------------------- */
 /* --------------------------------------------------------------------------------- */
 
@@ -503,6 +542,12 @@ bool ExponentialFilterImplementation::configure( SGPropertyNode& cfg_node,
   return false;
 }
 
+void ExponentialFilterImplementation::collectDependencies( std::set<const SGPropertyNode*>& inputs ) const
+{
+  GainFilterImplementation::collectDependencies(inputs);
+  _TfInput.collectDependentProperties(inputs);
+}
+
 /* --------------------------------------------------------------------------------- */
 
 IntegratorFilterImplementation::IntegratorFilterImplementation() :
@@ -535,6 +580,14 @@ bool IntegratorFilterImplementation::configure( SGPropertyNode& cfg_node,
   return false;
 }
 
+void IntegratorFilterImplementation::collectDependencies( std::set<const SGPropertyNode*>& inputs ) const
+{
+  GainFilterImplementation::collectDependencies(inputs);
+  _TfInput.collectDependentProperties(inputs);
+  _minInput.collectDependentProperties(inputs);
+  _maxInput.collectDependentProperties(inputs);
+}
+
 double IntegratorFilterImplementation::compute(  double dt, double input )
 {
   double output = _output_1 + input *  _gainInput.get_value() * dt;
@@ -581,6 +634,14 @@ bool DampedOscillationFilterImplementation::configure( SGPropertyNode& cfg_node,
   return false;
 }
 
+void DampedOscillationFilterImplementation::collectDependencies( std::set<const SGPropertyNode*>& inputs ) const
+{
+  GainFilterImplementation::collectDependencies(inputs);
+  _aInput.collectDependentProperties(inputs);
+  _bInput.collectDependentProperties(inputs);
+  _cInput.collectDependentProperties(inputs);
+}
+
 double DampedOscillationFilterImplementation::compute( double dt, double input )
 {
   if (fabs(input) > 1e-15) {
@@ -673,6 +734,12 @@ bool HighPassFilterImplementation::configure( SGPropertyNode& cfg_node,
   return false;
 }
 
+void HighPassFilterImplementation::collectDependencies( std::set<const SGPropertyNode*>& inputs ) const
+{
+  GainFilterImplementation::collectDependencies(inputs);
+  _TfInput.collectDependentProperties(inputs);
+}
+
 /* --------------------------------------------------------------------------------- */
 
 LeadLagFilterImplementation::LeadLagFilterImplementation() :
@@ -726,6 +793,13 @@ bool LeadLagFilterImplementation::configure( SGPropertyNode& cfg_node,
   return false;
 }
 
+void LeadLagFilterImplementation::collectDependencies( std::set<const SGPropertyNode*>& inputs ) const
+{
+  GainFilterImplementation::collectDependencies(inputs);
+  _TfaInput.collectDependentProperties(inputs);
+  _TfbInput.collectDependentProperties(inputs);
+}
+
 
 /* --------------------------------------------------------------------------------- */
 
@@ -785,6 +859,11 @@ bool CoherentNoiseFilterImplementation::configure(SGPropertyNode& cfg_node,
     return false;
 }
 
+void CoherentNoiseFilterImplementation::collectDependencies(std::set<const SGPropertyNode*>& inputs) const
+{
+    _amplitude.collectDependentProperties(inputs);
+}
+
 /* -------------------------------------------------------------------------- */
 /* Digital Filter Component Implementation                                    */
 /* -------------------------------------------------------------------------- */
@@ -810,6 +889,15 @@ typedef std::map<std::string, DigitalFilterImplementation*(*)()>
 DigitalFilterMap;
 static DigitalFilterMap componentForge;
 
+//------------------------------------------------------------------------------
+void DigitalFilter::collectDependencies( std::set<const SGPropertyNode*>& inputs,
+                                        std::set<const SGPropertyNode*>& outputs ) const
+{
+  AnalogComponent::collectDependencies(inputs, outputs);
+  if( _implementation )
+    _implementation->collectDependencies(inputs);
+}
+
 //------------------------------------------------------------------------------
 bool DigitalFilter::configure( SGPropertyNode& prop_root,
                                SGPropertyNode& cfg )
@@ -67,6 +67,9 @@ public:
 
     virtual bool configure( SGPropertyNode& prop_root,
                             SGPropertyNode& cfg );
+
+    void collectDependencies( std::set<const SGPropertyNode*>& inputs,
+                              std::set<const SGPropertyNode*>& outputs ) const override;
 };
 
 } // namespace FGXMLAutopilot
@@ -66,7 +66,7 @@ protected:
   bool _rIsDominant;
 public:
   RSFlipFlopImplementation( bool rIsDominant = true ) : _rIsDominant( rIsDominant ) {}
-  virtual bool getState( double dt, DigitalComponent::InputMap input, bool & q );
+  virtual bool getState( double dt, const DigitalComponent::InputMap& input, bool & q );
 };
 
 /**
@@ -130,7 +130,7 @@ protected:
    * @param q a reference to a boolean variable to receive the output state
    * @return true if the state has changed, false otherwise
    */
-  virtual bool onRaisingEdge( DigitalComponent::InputMap input, bool & q ) = 0;
+  virtual bool onRaisingEdge( const DigitalComponent::InputMap& input, bool & q ) = 0;
 public:
 
   /**
@@ -147,7 +147,7 @@ public:
    * @param q a reference to a boolean variable to receive the output state
    * @return true if the state has changed, false otherwise
    */
-  virtual bool getState( double dt, DigitalComponent::InputMap input, bool & q );
+  virtual bool getState( double dt, const DigitalComponent::InputMap& input, bool & q );
 };
 
 /**
@@ -205,7 +205,7 @@ public:
    * @param q a reference to a boolean variable to receive the output state
    * @return true if the state has changed, false otherwise
    */
-  virtual bool onRaisingEdge( DigitalComponent::InputMap input, bool & q );
+  virtual bool onRaisingEdge( const DigitalComponent::InputMap& input, bool & q );
 };
 
 /** 
@@ -226,7 +226,7 @@ public:
    * @param q a reference to a boolean variable to receive the output state
    * @return true if the state has changed, false otherwise
    */
-  virtual bool onRaisingEdge( DigitalComponent::InputMap input, bool & q ) {
+  virtual bool onRaisingEdge( const DigitalComponent::InputMap& input, bool & q ) {
     q = input.get_value("D");
     return true;
   }
@@ -250,7 +250,7 @@ public:
    * @param q a reference to a boolean variable to receive the output state
    * @return true if the state has changed, false otherwise
    */
-  virtual bool onRaisingEdge( DigitalComponent::InputMap input, bool & q ) {
+  virtual bool onRaisingEdge( const DigitalComponent::InputMap& input, bool & q ) {
     q = !q;
     return true;
   }
@@ -283,7 +283,7 @@ public:
    * @param q a reference to a boolean variable to receive the output state
    * @return true if the state has changed, false otherwise
    */
-  virtual bool getState( double dt, DigitalComponent::InputMap input, bool & q );
+  virtual bool getState( double dt, const DigitalComponent::InputMap& input, bool & q );
 };
 
 } // namespace
@@ -306,7 +306,7 @@ bool MonoFlopImplementation::configure( SGPropertyNode& cfg_node,
   return false;
 }
 
-bool MonoFlopImplementation::getState( double dt, DigitalComponent::InputMap input, bool & q )
+bool MonoFlopImplementation::getState( double dt, const DigitalComponent::InputMap& input, bool & q )
 {
   if( JKFlipFlopImplementation::getState( dt, input, q ) ) {
     _t = q ? _time.get_value() : 0;
@@ -323,7 +323,7 @@ bool MonoFlopImplementation::getState( double dt, DigitalComponent::InputMap inp
 }
 
 
-bool RSFlipFlopImplementation::getState( double dt, DigitalComponent::InputMap input, bool & q )
+bool RSFlipFlopImplementation::getState( double dt, const DigitalComponent::InputMap& input, bool & q )
 {
   bool s = input.get_value("S");
   bool r = input.get_value("R");
@@ -342,7 +342,7 @@ bool RSFlipFlopImplementation::getState( double dt, DigitalComponent::InputMap i
   return false; // signal state unchagned
 }
 
-bool ClockedFlipFlopImplementation::getState( double dt, DigitalComponent::InputMap input, bool & q )
+bool ClockedFlipFlopImplementation::getState( double dt, const DigitalComponent::InputMap& input, bool & q )
 {
   bool c = input.get_value("clock");
   bool raisingEdge = c && !_clock;
@@ -357,7 +357,7 @@ bool ClockedFlipFlopImplementation::getState( double dt, DigitalComponent::Input
   return onRaisingEdge( input, q );
 }
 
-bool JKFlipFlopImplementation::onRaisingEdge( DigitalComponent::InputMap input, bool & q )
+bool JKFlipFlopImplementation::onRaisingEdge( const DigitalComponent::InputMap& input, bool & q )
 {
   bool j = input.get_value("J");
   bool k = input.get_value("K");
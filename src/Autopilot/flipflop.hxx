@@ -49,7 +49,7 @@ public:
    * @param q a reference to a boolean variable to receive the output state
    * @return true if the state has changed, false otherwise
    */
-  virtual bool getState( double dt, DigitalComponent::InputMap input, bool & q ) { return false; }
+  virtual bool getState( double dt, const DigitalComponent::InputMap& input, bool & q ) { return false; }
 
  /**
   * @brief configure this component from a property node. Iterates through all nodes found
@@ -19,6 +19,7 @@
 //
 
 #include <cstdlib>
+#include <limits>
 
 #include "inputvalue.hxx"
 
@@ -28,7 +29,9 @@ using namespace FGXMLAutopilot;
 
 //------------------------------------------------------------------------------
 PeriodicalValue::PeriodicalValue( SGPropertyNode& prop_root,
-                                  SGPropertyNode& cfg )
+                                  SGPropertyNode& cfg ) :
+  _minValue(0.0),
+  _maxValue(0.0)
 {
   SGPropertyNode_ptr minNode = cfg.getChild( "min" );
   SGPropertyNode_ptr maxNode = cfg.getChild( "max" );
@@ -45,28 +48,47 @@ PeriodicalValue::PeriodicalValue( SGPropertyNode& prop_root,
   {
     minPeriod = new InputValue(prop_root, *minNode);
     maxPeriod = new InputValue(prop_root, *maxNode);
+
+    // most periods are plain numbers, like 0 and 360
+    if( minPeriod->is_constant() )
+    {
+      _minValue = minPeriod->get_value();
+      minPeriod = NULL;
+    }
+    if( maxPeriod->is_constant() )
+    {
+      _maxValue = maxPeriod->get_value();
+      maxPeriod = NULL;
+    }
   }
 }
 
 //------------------------------------------------------------------------------
 double PeriodicalValue::normalize( double value ) const
 {
-  return SGMiscd::normalizePeriodic( minPeriod->get_value(),
-                                     maxPeriod->get_value(),
-                                     value );
+  return SGMiscd::normalizePeriodic( get_min(), get_max(), value );
 }
 
 //------------------------------------------------------------------------------
 double PeriodicalValue::normalizeSymmetric( double value ) const
 {
-  double minValue = minPeriod->get_value();
-  double maxValue = maxPeriod->get_value();
+  double minValue = get_min();
+  double maxValue = get_max();
   
   value = SGMiscd::normalizePeriodic( minValue, maxValue, value );
   double width_2 = (maxValue - minValue)/2;
   return value > width_2 ? width_2 - value : value;
 }
 
+//------------------------------------------------------------------------------
+void PeriodicalValue::collectDependentProperties( std::set<const SGPropertyNode*>& props ) const
+{
+  if( minPeriod )
+    minPeriod->collectDependentProperties(props);
+  if( maxPeriod )
+    maxPeriod->collectDependentProperties(props);
+}
+
 //------------------------------------------------------------------------------
 InputValue::InputValue( SGPropertyNode& prop_root,
                         SGPropertyNode& cfg,
@@ -93,6 +115,10 @@ void InputValue::parse( SGPropertyNode& prop_root,
   _min = NULL;
   _max = NULL;
   _periodical = NULL;
+  _offsetValue = 0.0;
+  _scaleValue = 1.0;
+  _minValue = -std::numeric_limits<double>::infinity();
+  _maxValue = std::numeric_limits<double>::infinity();
 
   SGPropertyNode * n;
 
@@ -117,6 +143,8 @@ void InputValue::parse( SGPropertyNode& prop_root,
   if( (n = cfg.getChild( "period" )) != NULL )
     _periodical = new PeriodicalValue(prop_root, *n);
 
+  fold_constants();
+
 
   SGPropertyNode *valueNode = cfg.getChild("value");
   if( valueNode != NULL )
@@ -165,6 +193,62 @@ void InputValue::parse( SGPropertyNode& prop_root,
   }
 }
 
+//------------------------------------------------------------------------------
+void InputValue::fold_constants()
+{
+  if( _scale && _scale->is_constant() )
+  {
+    _scaleValue = _scale->get_value();
+    _scale = NULL;
+  }
+
+  if( _offset && _offset->is_constant() )
+  {
+    _offsetValue = _offset->get_value();
+    _offset = NULL;
+  }
+
+  if( _min && _min->is_constant() )
+  {
+    _minValue = _min->get_value();
+    _min = NULL;
+  }
+
+  if( _max && _max->is_constant() )
+  {
+    _maxValue = _max->get_value();
+    _max = NULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+bool InputValue::is_constant() const
+{
+  return !_property && !_expression && !_scale && !_offset && !_min && !_max
+      && (!_periodical || _periodical->is_constant());
+}
+
+//------------------------------------------------------------------------------
+void InputValue::collectDependentProperties( std::set<const SGPropertyNode*>& props ) const
+{
+  if( _property )
+    props.insert(_property);
+  if( _expression )
+    _expression->collectDependentProperties(props);
+  if( _condition )
+    _condition->collectDependentProperties(props);
+
+  const InputValue* inputs[] = { _scale, _offset, _min, _max };
+  for( const InputValue* input : inputs )
+  {
+    if( input )
+      input->collectDependentProperties(props);
+  }
+
+  if( _periodical )
+    _periodical->collectDependentProperties(props);
+}
+
 void InputValue::set_value( double aValue ) 
 {
     if (!_property)
@@ -202,21 +286,22 @@ double InputValue::get_value() const
     
     if( _scale ) 
         value *= _scale->get_value();
+    else if( _scaleValue != 1.0 )
+        value *= _scaleValue;
 
     if( _offset ) 
         value += _offset->get_value();
+    else if( _offsetValue != 0.0 )
+        value += _offsetValue;
 
-    if( _min ) {
-        double m = _min->get_value();
-        if( value < m )
-            value = m;
-    }
+    // without a <min> or <max>, these compare with -inf and +inf
+    const double minValue = _min ? _min->get_value() : _minValue;
+    if( value < minValue )
+        value = minValue;
 
-    if( _max ) {
-        double m = _max->get_value();
-        if( value > m )
-            value = m;
-    }
+    const double maxValue = _max ? _max->get_value() : _maxValue;
+    if( value > maxValue )
+        value = maxValue;
 
     if( _periodical ) {
       value = _periodical->normalize( value );
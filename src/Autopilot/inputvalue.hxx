@@ -26,6 +26,8 @@
 #endif
 
 
+#include <set>
+
 #include <simgear/structure/SGExpression.hxx>
 
 namespace FGXMLAutopilot {
@@ -41,13 +43,20 @@ typedef SGSharedPtr<class PeriodicalValue> PeriodicalValue_ptr;
  */
 class PeriodicalValue : public SGReferenced {
 private:
-     InputValue_ptr minPeriod; // The minimum value of the period
-     InputValue_ptr maxPeriod; // The maximum value of the period
+     InputValue_ptr minPeriod; // The minimum value of the period, unless constant
+     InputValue_ptr maxPeriod; // The maximum value of the period, unless constant
+     double _minValue;
+     double _maxValue;
+
+     double get_min() const { return minPeriod ? minPeriod->get_value() : _minValue; }
+     double get_max() const { return maxPeriod ? maxPeriod->get_value() : _maxValue; }
 public:
      PeriodicalValue( SGPropertyNode& prop_root,
                       SGPropertyNode& cfg );
      double normalize( double value ) const;
      double normalizeSymmetric( double value ) const;
+     bool is_constant() const { return !minPeriod && !maxPeriod; }
+     void collectDependentProperties( std::set<const SGPropertyNode*>& props ) const;
 };
 
 /**
@@ -69,7 +78,16 @@ private:
      PeriodicalValue_ptr  _periodical; //
      SGSharedPtr<const SGCondition> _condition;
      SGSharedPtr<SGExpressiond> _expression;  ///< expression to generate the value
-     
+
+     // Offset, scale and clipping inputs which are plain numbers are folded
+     // into these when parsing, and their InputValue dropped.
+     double _offsetValue;
+     double _scaleValue;
+     double _minValue;
+     double _maxValue;
+
+     void fold_constants();
+
 public:
     InputValue( SGPropertyNode& prop_root,
                 SGPropertyNode& node,
@@ -98,17 +116,23 @@ public:
     void set_value( double value );
 
     inline double get_scale() const {
-      return _scale == NULL ? 1.0 : _scale->get_value();
+      return _scale == NULL ? _scaleValue : _scale->get_value();
     }
 
     inline double get_offset() const {
-      return _offset == NULL ? 0.0 : _offset->get_value();
+      return _offset == NULL ? _offsetValue : _offset->get_value();
     }
 
     inline bool is_enabled() const {
       return _condition == NULL ? true : _condition->test();
     }
 
+    /* true if the value never changes; the condition is not considered */
+    bool is_constant() const;
+
+    /* add the properties this input (and its condition) depends on */
+    void collectDependentProperties( std::set<const SGPropertyNode*>& props ) const;
+
 };
 
 /**
@@ -122,18 +146,23 @@ class InputValueList : public std::vector<InputValue_ptr> {
   public:
     InputValueList( double def = 0.0 ) : _def(def) { }
 
-    InputValue_ptr get_active() const {
+    InputValue* get_active() const {
       for (const_iterator it = begin(); it != end(); ++it) {
         if( (*it)->is_enabled() )
-          return *it;
+          return it->get();
       }
       return NULL;
     }
 
     double get_value() const {
-      InputValue_ptr input = get_active();
+      const InputValue* input = get_active();
       return input == NULL ? _def : input->get_value();
     }
+
+    void collectDependentProperties( std::set<const SGPropertyNode*>& props ) const {
+      for (const_iterator it = begin(); it != end(); ++it)
+        (*it)->collectDependentProperties(props);
+    }
   private:
 
     double _def;
@@ -235,6 +235,16 @@ void PIDController::update( bool firstTime, double dt )
     edf_n_1 = edf_n;
 }
 
+//------------------------------------------------------------------------------
+void PIDController::collectDependencies( std::set<const SGPropertyNode*>& inputs,
+                                        std::set<const SGPropertyNode*>& outputs ) const
+{
+  AnalogComponent::collectDependencies(inputs, outputs);
+  Kp.collectDependentProperties(inputs);
+  Ti.collectDependentProperties(inputs);
+  Td.collectDependentProperties(inputs);
+}
+
 //------------------------------------------------------------------------------
 bool PIDController::configure( SGPropertyNode& cfg_node,
                                const std::string& cfg_name,
@@ -87,6 +87,9 @@ public:
     static const char* staticSubsystemClassId() { return "pid-controller"; }
 
     void update( bool firstTime, double dt );
+
+    void collectDependencies( std::set<const SGPropertyNode*>& inputs,
+                              std::set<const SGPropertyNode*>& outputs ) const override;
 };
 
 }
@@ -32,6 +32,15 @@ PISimpleController::PISimpleController() :
 {
 }
 
+//------------------------------------------------------------------------------
+void PISimpleController::collectDependencies( std::set<const SGPropertyNode*>& inputs,
+                                             std::set<const SGPropertyNode*>& outputs ) const
+{
+  AnalogComponent::collectDependencies(inputs, outputs);
+  _Kp.collectDependentProperties(inputs);
+  _Ki.collectDependentProperties(inputs);
+}
+
 //------------------------------------------------------------------------------
 bool PISimpleController::configure( SGPropertyNode& cfg_node,
                                     const std::string& cfg_name,
@@ -61,6 +61,9 @@ public:
     static const char* staticSubsystemClassId() { return "pi-simple-controller"; }
 
     void update( bool firstTime, double dt );
+
+    void collectDependencies( std::set<const SGPropertyNode*>& inputs,
+                              std::set<const SGPropertyNode*>& outputs ) const override;
 };
 
 }
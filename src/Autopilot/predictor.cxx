@@ -33,6 +33,15 @@ Predictor::Predictor () :
 {
 }
 
+//------------------------------------------------------------------------------
+void Predictor::collectDependencies( std::set<const SGPropertyNode*>& inputs,
+                                    std::set<const SGPropertyNode*>& outputs ) const
+{
+  AnalogComponent::collectDependencies(inputs, outputs);
+  _seconds.collectDependentProperties(inputs);
+  _filter_gain.collectDependentProperties(inputs);
+}
+
 //------------------------------------------------------------------------------
 bool Predictor::configure( SGPropertyNode& cfg_node,
                            const std::string& cfg_name,
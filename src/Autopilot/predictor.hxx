@@ -65,6 +65,9 @@ public:
     static const char* staticSubsystemClassId() { return "predict-simple"; }
 
     void update( bool firstTime, double dt );
+
+    void collectDependencies( std::set<const SGPropertyNode*>& inputs,
+                              std::set<const SGPropertyNode*>& outputs ) const override;
 };
 
 } // namespace FGXMLAutopilot
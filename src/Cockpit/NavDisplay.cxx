@@ -58,6 +58,7 @@ using std::endl;
 using std::map;
 using std::string;
 
+#include <AIModel/AIManager.hxx>
 #include <Main/fg_props.hxx>
 #include <Main/globals.hxx>
 #include "panel.hxx"
@@ -436,11 +437,21 @@ NavDisplay::NavDisplay(SGPropertyNode *node) :
     _odg(0),
     _scale(0),
     _view_heading(0),
+    _quadVertexCount(0),
+    _lineVertexCount(0),
+    _textCount(0),
+    _quadsChanged(false),
+    _linesChanged(false),
     _font_size(0),
     _font_spacing(0),
     _rangeNm(0),
+    _updateCount(0),
+    _stateNav1(nullptr),
+    _stateNav2(nullptr),
     _maxSymbols(100)
 {
+    std::fill(_stateEndpoints, _stateEndpoints + 4, nullptr);
+
     _Instrument = fgGetNode(string("/instrumentation/" + _name).c_str(), _num, true);
     _font_node = _Instrument->getNode("font", true);
 
@@ -707,12 +718,13 @@ NavDisplay::update (double delta_time_sec)
         _cachedItemsValid = (movedNm < 1.0);
     }
     
-  _vertices->clear();
-  _lineVertices->clear();
-  _lineColors->clear();
-  _quadColors->clear();
-  _texCoords->clear();
-  _textGeode->removeDrawables(0, _textGeode->getNumDrawables());
+  // geometry is rewritten in place; see finishGeometry
+  _quadVertexCount = 0;
+  _lineVertexCount = 0;
+  _textCount = 0;
+  _quadsChanged = false;
+  _linesChanged = false;
+  ++_updateCount;
   
   for (SymbolInstance* si : _symbols) {
       delete si;
@@ -732,6 +744,8 @@ NavDisplay::update (double delta_time_sec)
   if (enableChanged) {
     SG_LOG(SG_INSTR, SG_INFO, "NS rule enables changed, rebuilding cache");
     _cachedItemsValid = false;
+    _ruleCache.clear();
+    _positionedSymbols.clear();
   }
   
   if (_testModeNode->getBoolValue()) {
@@ -746,11 +760,72 @@ NavDisplay::update (double delta_time_sec)
   }
 
   addSymbolsToScene();
-  
-  _symbolPrimSet->set(osg::PrimitiveSet::QUADS, 0, _vertices->size());
-  _symbolPrimSet->dirty();
-  _linePrimSet->set(osg::PrimitiveSet::LINES, 0, _lineVertices->size());
-  _linePrimSet->dirty();
+  finishGeometry();
+
+  // drop positioned items which were neither queried nor displayed
+  for (auto it = _positionedSymbols.begin(); it != _positionedSymbols.end(); ) {
+    if (it->second.lastUsed != _updateCount) {
+      it = _positionedSymbols.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+template <class ArrayType>
+static void storeElement(ArrayType* array, size_t index,
+                         const typename ArrayType::ElementDataType& value,
+                         bool& changed)
+{
+    if (index < array->size()) {
+        if ((*array)[index] != value) {
+            (*array)[index] = value;
+            changed = true;
+        }
+    } else {
+        array->push_back(value);
+        changed = true;
+    }
+}
+
+template <class ArrayType>
+static void truncateArray(ArrayType* array, size_t count, bool& changed)
+{
+    if (array->size() > count) {
+        array->resize(count);
+        changed = true;
+    }
+}
+
+void NavDisplay::finishGeometry()
+{
+    truncateArray(_vertices, _quadVertexCount, _quadsChanged);
+    truncateArray(_texCoords, _quadVertexCount, _quadsChanged);
+    truncateArray(_quadColors, _quadVertexCount, _quadsChanged);
+    if (_quadsChanged) {
+        _vertices->dirty();
+        _texCoords->dirty();
+        _quadColors->dirty();
+        _symbolPrimSet->set(osg::PrimitiveSet::QUADS, 0, _vertices->size());
+        _symbolPrimSet->dirty();
+        _geom->dirtyBound();
+    }
+
+    truncateArray(_lineVertices, _lineVertexCount, _linesChanged);
+    truncateArray(_lineColors, _lineVertexCount, _linesChanged);
+    if (_linesChanged) {
+        _lineVertices->dirty();
+        _lineColors->dirty();
+        _linePrimSet->set(osg::PrimitiveSet::LINES, 0, _lineVertices->size());
+        _linePrimSet->dirty();
+        _lineGeometry->dirtyBound();
+    }
+
+    unsigned int numText = _textGeode->getNumDrawables();
+    if (_textCount < numText) {
+        _textGeode->removeDrawables(_textCount, numText - _textCount);
+        _textStrings.resize(_textCount);
+    }
 }
 
 
@@ -815,15 +890,10 @@ void NavDisplay::addSymbolToScene(SymbolInstance* sym)
         pos = osg::Vec2((int) pos.x(), (int) pos.y());
     }
     
-    _texCoords->push_back(def->uv0);
-    _texCoords->push_back(osg::Vec2(def->uv1.x(), def->uv0.y()));
-    _texCoords->push_back(def->uv1);
-    _texCoords->push_back(osg::Vec2(def->uv0.x(), def->uv1.y()));
-
-    for (int i=0; i<4; ++i) {
-        _vertices->push_back(verts[i] + pos);
-        _quadColors->push_back(def->color);
-    }
+    addQuadVertex(verts[0] + pos, def->uv0, def->color);
+    addQuadVertex(verts[1] + pos, osg::Vec2(def->uv1.x(), def->uv0.y()), def->color);
+    addQuadVertex(verts[2] + pos, def->uv1, def->color);
+    addQuadVertex(verts[3] + pos, osg::Vec2(def->uv0.x(), def->uv1.y()), def->color);
     
     if (def->stretchSymbol) {
         osg::Vec2 stretchVerts[4];
@@ -838,30 +908,16 @@ void NavDisplay::addSymbolToScene(SymbolInstance* sym)
         }
         
     // stretched quad
-        _vertices->push_back(verts[2] + pos);
-        _vertices->push_back(stretchVerts[1] + sym->endPos);
-        _vertices->push_back(stretchVerts[0] + sym->endPos);
-        _vertices->push_back(verts[3] + pos);
-        
-        _texCoords->push_back(def->uv1);
-        _texCoords->push_back(osg::Vec2(def->uv1.x(), def->stretchV2));
-        _texCoords->push_back(osg::Vec2(def->uv0.x(), def->stretchV2));
-        _texCoords->push_back(osg::Vec2(def->uv0.x(), def->uv1.y()));
-        
-        for (int i=0; i<4; ++i) {
-            _quadColors->push_back(def->color);
-        }
+        addQuadVertex(verts[2] + pos, def->uv1, def->color);
+        addQuadVertex(stretchVerts[1] + sym->endPos, osg::Vec2(def->uv1.x(), def->stretchV2), def->color);
+        addQuadVertex(stretchVerts[0] + sym->endPos, osg::Vec2(def->uv0.x(), def->stretchV2), def->color);
+        addQuadVertex(verts[3] + pos, osg::Vec2(def->uv0.x(), def->uv1.y()), def->color);
         
     // quad three, for the end portion
-        for (int i=0; i<4; ++i) {
-            _vertices->push_back(stretchVerts[i] + sym->endPos);
-            _quadColors->push_back(def->color);
-        }
-        
-        _texCoords->push_back(osg::Vec2(def->uv0.x(), def->stretchV2));
-        _texCoords->push_back(osg::Vec2(def->uv1.x(), def->stretchV2));
-        _texCoords->push_back(osg::Vec2(def->uv1.x(), def->stretchV3));
-        _texCoords->push_back(osg::Vec2(def->uv0.x(), def->stretchV3));
+        addQuadVertex(stretchVerts[0] + sym->endPos, osg::Vec2(def->uv0.x(), def->stretchV2), def->color);
+        addQuadVertex(stretchVerts[1] + sym->endPos, osg::Vec2(def->uv1.x(), def->stretchV2), def->color);
+        addQuadVertex(stretchVerts[2] + sym->endPos, osg::Vec2(def->uv1.x(), def->stretchV3), def->color);
+        addQuadVertex(stretchVerts[3] + sym->endPos, osg::Vec2(def->uv0.x(), def->stretchV3), def->color);
     }
     
     if (def->drawLine) {
@@ -872,20 +928,64 @@ void NavDisplay::addSymbolToScene(SymbolInstance* sym)
         return;
     }
     
-    osgText::Text* t = new osgText::Text;
-    t->setFont(_font.get());
-    t->setFontResolution(12, 12);
-    t->setCharacterSize(_font_size);
-    t->setLineSpacing(_font_spacing);
-    t->setColor(def->textColor);
-    t->setAlignment(def->alignment);
-    t->setText(sym->text());
-
-
     osg::Vec2 textPos = def->textOffset + pos;
 // ensure we use ints here, or text visual quality goes bad
-    t->setPosition(osg::Vec3((int)textPos.x(), (int)textPos.y(), 0));
-    _textGeode->addDrawable(t);
+    addText(def, sym->text(), osg::Vec3((int)textPos.x(), (int)textPos.y(), 0));
+}
+
+void NavDisplay::addQuadVertex(const osg::Vec2& v, const osg::Vec2& uv, const osg::Vec4& color)
+{
+    storeElement(_vertices, _quadVertexCount, v, _quadsChanged);
+    storeElement(_texCoords, _quadVertexCount, uv, _quadsChanged);
+    storeElement(_quadColors, _quadVertexCount, color, _quadsChanged);
+    ++_quadVertexCount;
+}
+
+void NavDisplay::addText(SymbolDef* def, const string& text, const osg::Vec3& pos)
+{
+    osgText::Text* t;
+    if (_textCount < _textGeode->getNumDrawables()) {
+        t = static_cast<osgText::Text*>(_textGeode->getDrawable(_textCount));
+    } else {
+        t = new osgText::Text;
+        t->setFontResolution(12, 12);
+        // reused and modified in later updates, while a draw may be running
+        t->setDataVariance(osg::Object::DYNAMIC);
+        _textGeode->addDrawable(t);
+        _textStrings.push_back(string());
+    }
+    
+// each setter re-lays out the glyphs, so only touch what changed
+    if (t->getFont() != _font.get()) {
+        t->setFont(_font.get());
+    }
+    
+    if (t->getCharacterHeight() != _font_size) {
+        t->setCharacterSize(_font_size);
+    }
+    
+    if (t->getLineSpacing() != _font_spacing) {
+        t->setLineSpacing(_font_spacing);
+    }
+    
+    if (t->getColor() != def->textColor) {
+        t->setColor(def->textColor);
+    }
+    
+    if (t->getAlignment() != def->alignment) {
+        t->setAlignment(def->alignment);
+    }
+    
+    if (_textStrings[_textCount] != text) {
+        t->setText(text);
+        _textStrings[_textCount] = text;
+    }
+    
+    if (t->getPosition() != pos) {
+        t->setPosition(pos);
+    }
+    
+    ++_textCount;
 }
 
 class OrderByPriority
@@ -906,7 +1006,7 @@ void NavDisplay::limitDisplayedSymbols()
         return;
     }
     
-    std::sort(_symbols.begin(), _symbols.end(), OrderByPriority());
+    std::stable_sort(_symbols.begin(), _symbols.end(), OrderByPriority());
     _symbols.resize(_maxSymbols);
     _excessDataNode->setBoolValue(true);
 }
@@ -922,7 +1022,8 @@ public:
 
 void NavDisplay::addSymbolsToScene()
 {
-    std::sort(_symbols.begin(), _symbols.end(), OrderByZ());
+// stable, so unchanged symbols keep their vertex ranges between updates
+    std::stable_sort(_symbols.begin(), _symbols.end(), OrderByZ());
     for (SymbolInstance* sym : _symbols) {
         addSymbolToScene(sym);
     }
@@ -930,10 +1031,12 @@ void NavDisplay::addSymbolsToScene()
 
 void NavDisplay::addLine(osg::Vec2 a, osg::Vec2 b, const osg::Vec4& color)
 {    
-    _lineVertices->push_back(a);
-    _lineVertices->push_back(b);
-    _lineColors->push_back(color);
-    _lineColors->push_back(color);
+    storeElement(_lineVertices, _lineVertexCount, a, _linesChanged);
+    storeElement(_lineColors, _lineVertexCount, color, _linesChanged);
+    ++_lineVertexCount;
+    storeElement(_lineVertices, _lineVertexCount, b, _linesChanged);
+    storeElement(_lineColors, _lineVertexCount, color, _linesChanged);
+    ++_lineVertexCount;
 }
 
 osg::Vec2 NavDisplay::projectBearingRange(double bearingDeg, double rangeNm) const
@@ -1096,6 +1199,7 @@ void NavDisplay::processNavRadios()
 {
     _nav1Station = processNavRadio(_navRadio1Node);
     _nav2Station = processNavRadio(_navRadio2Node);
+    validatePositionedCache();
     
     foundPositionedItem(_nav1Station);
     foundPositionedItem(_nav2Station);
@@ -1131,15 +1235,53 @@ bool NavDisplay::anyRuleForType(const string& type) const
 
 void NavDisplay::findRules(const string& type, const string_set& states, SymbolRuleVector& rules)
 {
-    for (SymbolRule* candidate : _rules) {
-        if (!candidate->enabled || (candidate->type != type)) {
-            continue;
+    // string_set is ordered, so joining it gives a canonical key
+    string key(type);
+    for (const string& st : states) {
+        key.push_back('\n');
+        key.append(st);
+    }
+    
+    auto it = _ruleCache.find(key);
+    if (it == _ruleCache.end()) {
+        SymbolRuleVector matched;
+        for (SymbolRule* candidate : _rules) {
+            if (!candidate->enabled || (candidate->type != type)) {
+                continue;
+            }
+            
+            if (candidate->matches(states)) {
+                matched.push_back(candidate);
+            }
         }
         
-        if (candidate->matches(states)) {
-            rules.push_back(candidate);
-        }
+        it = _ruleCache.insert(std::make_pair(key, matched)).first;
+    }
+    
+    rules.insert(rules.end(), it->second.begin(), it->second.end());
+}
+
+void NavDisplay::validatePositionedCache()
+{
+    flightgear::FlightPlan* fp = _route->flightPlan();
+    FGPositioned* endpoints[4] = {
+        fp->departureAirport().get(), fp->destinationAirport().get(),
+        fp->departureRunway(), fp->destinationRunway()
+    };
+    
+    bool changed = (_stateNav1 != _nav1Station) || (_stateNav2 != _nav2Station) ||
+        !std::equal(endpoints, endpoints + 4, _stateEndpoints) ||
+        (_stateRouteSources != _routeSources);
+    if (!changed) {
+        return;
     }
+    
+    // positioned states depend on all of the above; recompute them lazily
+    _positionedSymbols.clear();
+    _stateNav1 = _nav1Station;
+    _stateNav2 = _nav2Station;
+    std::copy(endpoints, endpoints + 4, _stateEndpoints);
+    _stateRouteSources = _routeSources;
 }
 
 bool NavDisplay::isPositionedShown(FGPositioned* pos)
@@ -1151,15 +1293,24 @@ bool NavDisplay::isPositionedShown(FGPositioned* pos)
 
 void NavDisplay::isPositionedShownInner(FGPositioned* pos, SymbolRuleVector& rules)
 {
-  string type = simgear::strutils::lowercase(FGPositioned::nameForType(pos->type()));
-  if (!anyRuleForType(type)) {
-    return; // not diplayed at all, we're done
+  if (pos->guid() != FGPositioned::TRANSIENT_ID) {
+    auto it = _positionedSymbols.find(pos->guid());
+    if (it != _positionedSymbols.end()) {
+      rules = it->second.rules;
+      return;
+    }
   }
   
-  string_set states;
-  computePositionedState(pos, states);
+  string type = simgear::strutils::lowercase(FGPositioned::nameForType(pos->type()));
+  if (anyRuleForType(type)) {
+    string_set states;
+    computePositionedState(pos, states);
+    findRules(type, states, rules);
+  }
   
-  findRules(type, states, rules);
+  if (pos->guid() != FGPositioned::TRANSIENT_ID) {
+    _positionedSymbols[pos->guid()].rules = rules;
+  }
 }
 
 void NavDisplay::foundPositionedItem(FGPositioned* pos)
@@ -1174,9 +1325,21 @@ void NavDisplay::foundPositionedItem(FGPositioned* pos)
       return;
     }
   
-    SGPropertyNode_ptr vars(new SGPropertyNode);
-    double heading;
-    computePositionedPropsAndHeading(pos, vars, heading);
+    PositionedSymbols transient;
+    PositionedSymbols& entry = (pos->guid() == FGPositioned::TRANSIENT_ID) ?
+        transient : _positionedSymbols[pos->guid()];
+    entry.lastUsed = _updateCount;
+    
+    // props are static, except the radial of a tuned station
+    if (!entry.vars || (pos == _nav1Station) || (pos == _nav2Station)) {
+        if (!entry.vars) {
+            entry.vars = new SGPropertyNode;
+        }
+        computePositionedPropsAndHeading(pos, entry.vars, entry.heading);
+    }
+    
+    SGPropertyNode_ptr vars(entry.vars);
+    double heading = entry.heading;
     
     osg::Vec2 projected = projectGeod(pos->geod());
     if (pos->type() == FGPositioned::RUNWAY) {
@@ -1302,25 +1465,28 @@ void NavDisplay::computePositionedState(FGPositioned* pos, string_set& states)
     } // FGPositioned::Type switch
 }
 
-static string mapAINodeToType(SGPropertyNode* model)
+static string mapAINodeToType(const FGTrafficEntry& model)
 {
   // assume all multiplayer items are aircraft for the moment. Not ideal.
-  if (!strcmp(model->getName(), "multiplayer")) {
+  if (model.typeName == "multiplayer") {
     return "ai-aircraft";
   }
   
-  return string("ai-") + model->getName();
+  return string("ai-") + model.typeName;
 }
 
 void NavDisplay::processAI()
 {
-    SGPropertyNode *ai = fgGetNode("/ai/models", true);
-    for (int i = ai->nChildren() - 1; i >= 0; i--) {
-        SGPropertyNode *model = ai->getChild(i);
-        if (!model->nChildren()) {
-            continue;
-        }
-        
+    FGAIManager* aiManager = globals->get_subsystem<FGAIManager>();
+    FGTrafficSnapshotRef traffic = aiManager ? aiManager->trafficSnapshot() : FGTrafficSnapshotRef();
+    if (!traffic) {
+        return;
+    }
+
+    const auto& entries = traffic->entries();
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        const FGTrafficEntry& model = *it;
+
     // prefix types with 'ai-', to avoid any chance of namespace collisions
     // with fg-positioned.
         string_set ss;
@@ -1331,24 +1497,22 @@ void NavDisplay::processAI()
             return; // no rules matched, we can skip this item
         }
 
-        double heading = model->getDoubleValue("orientation/true-heading-deg");
-        SGGeod aiModelPos = SGGeod::fromDegFt(model->getDoubleValue("position/longitude-deg"), 
-                                            model->getDoubleValue("position/latitude-deg"), 
-                                            model->getDoubleValue("position/altitude-ft"));
+        double heading = model.headingDeg;
+        const SGGeod& aiModelPos = model.position;
     // compute some additional props
         int fl = (aiModelPos.getElevationFt() / 1000);
-        model->setIntValue("flight-level", fl * 10);
+        model.props->setIntValue("flight-level", fl * 10);
                                             
         osg::Vec2 projected = projectGeod(aiModelPos);
         for (SymbolRule* r : rules) {
-            addSymbolInstance(projected, heading, r->getDefinition(), (SGPropertyNode*) model);
+            addSymbolInstance(projected, heading, r->getDefinition(), model.props);
         }
     } // of ai models iteration
 }
 
-void NavDisplay::computeAIStates(const SGPropertyNode* ai, string_set& states)
+void NavDisplay::computeAIStates(const FGTrafficEntry& ai, string_set& states)
 {
-    int threatLevel = ai->getIntValue("tcas/threat-level",-1);
+    int threatLevel = ai.props->getIntValue("tcas/threat-level",-1);
     if (threatLevel < 1)
       threatLevel = 0;
   
@@ -1358,7 +1522,7 @@ void NavDisplay::computeAIStates(const SGPropertyNode* ai, string_set& states)
     os << "tcas-threat-level-" << threatLevel;
     states.insert(os.str());
 
-    double vspeed = ai->getDoubleValue("velocities/vertical-speed-fps");
+    double vspeed = ai.verticalSpeedFps;
     if (vspeed < -3.0) {
         states.insert("descending");
     } else if (vspeed > 3.0) {
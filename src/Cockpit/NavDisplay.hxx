@@ -35,12 +35,15 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <map>
+#include <unordered_map>
 
 #include <Navaids/positioned.hxx>
 
 class FGODGauge;
 class FGRouteMgr;
 class FGNavRecord;
+struct FGTrafficEntry;
 
 class SymbolInstance;
 class SymbolDef;
@@ -124,12 +127,17 @@ private:
     void processNavRadios();
     FGNavRecord* processNavRadio(const SGPropertyNode_ptr& radio);
     void processAI();
-    void computeAIStates(const SGPropertyNode* ai, string_set& states);
+    void computeAIStates(const FGTrafficEntry& ai, string_set& states);
 
     void computeCustomSymbolStates(const SGPropertyNode* sym, string_set& states);
     void processCustomSymbols();
 
     void findRules(const std::string& type, const string_set& states, SymbolRuleVector& rules);
+    void validatePositionedCache();
+
+    void addQuadVertex(const osg::Vec2& v, const osg::Vec2& uv, const osg::Vec4& color);
+    void addText(SymbolDef* def, const std::string& text, const osg::Vec3& pos);
+    void finishGeometry();
 
     SymbolInstance* addSymbolInstance(const osg::Vec2& proj, double heading, SymbolDef* def, SGPropertyNode* vars);
     void addLine(osg::Vec2 a, osg::Vec2 b, const osg::Vec4& color);
@@ -173,6 +181,14 @@ private:
     osg::Vec2Array* _lineVertices;
     osg::Vec4Array* _lineColors;
 
+    // geometry is rewritten in place each update; these track how much
+    // of each array was written, and whether any element differed
+    size_t _quadVertexCount;
+    size_t _lineVertexCount;
+    unsigned int _textCount;
+    bool _quadsChanged;
+    bool _linesChanged;
+    std::vector<std::string> _textStrings; ///< text of each drawable in _textGeode
 
     osg::Matrixf _centerTrans;
     osg::Matrixf _projectMat;
@@ -197,6 +213,31 @@ private:
     bool _cachedItemsValid;
     SGVec3d _cachedPos;
     FGPositionedList _itemsInRange;
+
+    // rule matches are a pure function of (type, states) while the rule
+    // enables are unchanged, so cache them keyed by both
+    std::map<std::string, SymbolRuleVector> _ruleCache;
+
+    // per-positioned symbol state, kept across updates and re-queries.
+    // Entries not seen during an update are dropped at the end of it.
+    struct PositionedSymbols
+    {
+        SymbolRuleVector rules;
+        SGPropertyNode_ptr vars; ///< null until the item is first displayed
+        double heading = 0.0;
+        unsigned int lastUsed = 0;
+    };
+
+    std::unordered_map<PositionedID, PositionedSymbols> _positionedSymbols;
+    unsigned int _updateCount;
+
+    // inputs of computePositionedState as of the last update, so cached
+    // positioned states can be dropped when any of them changes
+    std::set<FGPositioned*> _stateRouteSources;
+    FGPositioned* _stateNav1;
+    FGPositioned* _stateNav2;
+    FGPositioned* _stateEndpoints[4];
+
     SGPropertyNode_ptr _excessDataNode;
     int _maxSymbols;
     SGPropertyNode_ptr _customSymbols;
@@ -207,38 +207,30 @@ agRadar::setUserVec(double az, double el)
 
 }
 
-bool
-agRadar::getMaterial(){
-
-    const simgear::BVHMaterial* mat = 0;
-    if (globals->get_scenery()->get_elevation_m(hitpos, _elevation_m, &mat)){
-        //_ht_agl_ft = pos.getElevationFt() - _elevation_m * SG_METER_TO_FEET;
-        const SGMaterial* material = dynamic_cast<const SGMaterial*>(mat);
-        if (material) {
-            const std::vector<std::string>& names = material->get_names();
-
-            _solid = material->get_solid();
-            _load_resistance = material->get_load_resistance();
-            _frictionFactor = material->get_friction_factor();
-            _bumpinessFactor = material->get_bumpiness();
-
-            if (!names.empty()) 
-                _mat_name = names[0];
-            else
-                _mat_name = "";
+void
+agRadar::setMaterial(const simgear::BVHMaterial* mat)
+{
+    const SGMaterial* material = dynamic_cast<const SGMaterial*>(mat);
+    if (material) {
+        const std::vector<std::string>& names = material->get_names();
 
-        }
-        /*cout << "material " << mat_name 
-        << " solid " << _solid 
-        << " load " << _load_resistance
-        << " frictionFactor " << frictionFactor 
-        << " _bumpinessFactor " << _bumpinessFactor
-        << endl;*/
-        return true;
-    } else {
-        return false;
-    }
+        _solid = material->get_solid();
+        _load_resistance = material->get_load_resistance();
+        _frictionFactor = material->get_friction_factor();
+        _bumpinessFactor = material->get_bumpiness();
 
+        if (!names.empty()) 
+            _mat_name = names[0];
+        else
+            _mat_name = "";
+
+    }
+    /*cout << "material " << mat_name 
+    << " solid " << _solid 
+    << " load " << _load_resistance
+    << " frictionFactor " << frictionFactor 
+    << " _bumpinessFactor " << _bumpinessFactor
+    << endl;*/
 }
 
 void
@@ -279,46 +271,53 @@ agRadar::update_terrain()
     setUserPos();
     setAntennaPos();
     SGVec3d cartantennapos = getCartAntennaPos();
-    
+
+    // cast the whole scan pattern in one pass over the scenery
+    std::vector<SGVec3d> dirs;
     for(double brg = -az_limit; brg <= az_limit; brg += az_step){
         for(double elev = el_limit; elev >= - el_limit; elev -= el_step){
             setUserVec(brg, elev);
-            SGVec3d nearestHit;
-            globals->get_scenery()->get_cart_ground_intersection(cartantennapos, uservec, nearestHit);
-            SGGeodesy::SGCartToGeod(nearestHit, hitpos);
+            dirs.push_back(uservec);
+        }
+    }
 
-            double course1, course2, distance;
+    FGTerrainSamples hits;
+    globals->get_scenery()->get_cart_ground_intersections(cartantennapos, dirs, hits);
 
+    for (size_t i = 0; i < hits.size(); ++i) {
+        double course1 = 0.0, course2 = 0.0, distance = 0.0;
+        if (hits.valid[i]) {
+            SGGeodesy::SGCartToGeod(hits.hit[i], hitpos);
             SGGeodesy::inverse(hitpos, antennapos, course1, course2, distance);
+        }
 
-            if (distance >= min_range && distance <= max_range) {
-                _terrain_warning_node->setBoolValue(true);
-                getMaterial();
-                _brgDegNode->setDoubleValue(course2);
-                _rangeMNode->setDoubleValue(distance);
-                _materialNode->setStringValue(_mat_name.c_str());
-                _bumpinessNode->setDoubleValue(_bumpinessFactor);
-                _elevationMNode->setDoubleValue(_elevation_m);
-            } else {
-                _terrain_warning_node->setBoolValue(false);
-                _brgDegNode->setDoubleValue(0);
-                _rangeMNode->setDoubleValue(0);
-                _materialNode->setStringValue("");
-                _bumpinessNode->setDoubleValue(0);
-                _elevationMNode->setDoubleValue(0);
-            }
-
-            //cout  << "usr hdg " << _user_hdg_deg_node->getDoubleValue()
-            //    << " ant brg " << course2 
-            //    << " elev " << _Instrument->getDoubleValue("tilt")
-            //    << " gnd rng nm " << distance * SG_METER_TO_NM
-            //    << " ht " << hitpos.getElevationFt()
-            //    << " mat " << _mat_name
-            //    << " solid " << _solid
-            //    << " bumpiness " << _bumpinessFactor
-            //    << endl;
-
+        if (hits.valid[i] && distance >= min_range && distance <= max_range) {
+            _terrain_warning_node->setBoolValue(true);
+            _elevation_m = hits.elevation_m[i];
+            setMaterial(hits.getMaterial(i));
+            _brgDegNode->setDoubleValue(course2);
+            _rangeMNode->setDoubleValue(distance);
+            _materialNode->setStringValue(_mat_name.c_str());
+            _bumpinessNode->setDoubleValue(_bumpinessFactor);
+            _elevationMNode->setDoubleValue(_elevation_m);
+        } else {
+            _terrain_warning_node->setBoolValue(false);
+            _brgDegNode->setDoubleValue(0);
+            _rangeMNode->setDoubleValue(0);
+            _materialNode->setStringValue("");
+            _bumpinessNode->setDoubleValue(0);
+            _elevationMNode->setDoubleValue(0);
         }
+
+        //cout  << "usr hdg " << _user_hdg_deg_node->getDoubleValue()
+        //    << " ant brg " << course2 
+        //    << " elev " << _Instrument->getDoubleValue("tilt")
+        //    << " gnd rng nm " << distance * SG_METER_TO_NM
+        //    << " ht " << hitpos.getElevationFt()
+        //    << " mat " << _mat_name
+        //    << " solid " << _solid
+        //    << " bumpiness " << _bumpinessFactor
+        //    << endl;
     }
 }
 
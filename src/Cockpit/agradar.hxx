@@ -26,6 +26,7 @@
 
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <Scenery/scenery.hxx>
+#include <Scenery/terrain.hxx>
 #include <simgear/scene/material/mat.hxx>
 
 #include "wxradar.hxx"
@@ -49,7 +50,7 @@ public:
     void update_terrain();
     void setAntennaPos();
 
-    bool getMaterial();
+    void setMaterial(const simgear::BVHMaterial* mat);
 
     double _load_resistance;    // ground load resistanc N/m^2
     double _frictionFactor;     // dimensionless modifier for Coefficient of Friction
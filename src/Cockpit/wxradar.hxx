@@ -35,6 +35,7 @@
 #include <string>
 
 class FGODGauge;
+struct FGTrafficEntry;
 
 class wxRadarBg : public SGSubsystem,
                   public SGPropertyChangeListener
@@ -158,9 +159,9 @@ private:
     void update_aircraft();
     void update_tacan();
     void update_heading_marker();
-    void update_data(const SGPropertyNode *ac, double alt, double heading,
+    void update_data(const FGTrafficEntry& ac, double alt, double heading,
         double radius, double bearing, bool selected);
-    bool update_tcas(const SGPropertyNode *model,double range,double user_alt,double alt,
+    bool update_tcas(const FGTrafficEntry& model,double range,double user_alt,double alt,
                      double bearing,double radius, bool absMode);
     void center_map();
     void apply_map_offset();
@@ -34,7 +34,9 @@
 #include <Main/globals.hxx>
 #include <Main/util.hxx>
 #include <Scenery/scenery.hxx>
+#include <Scenery/terrain.hxx>
 #include <string>
+#include <vector>
 #include <cmath>
 #include <simgear/sg_inlines.h>
 
@@ -139,14 +141,26 @@ void FGRidgeLift::update(double dt) {
 		SGGeoc myGeocPos = SGGeoc::fromGeod( myGeodPos );
 		double ground_wind_from_rad = _surface_wind_from_deg_node->getDoubleValue() * SG_DEGREES_TO_RADIANS;
 
-		// compute the remaining probes
-		for (unsigned i = 1; i < sizeof(probe_elev_m)/sizeof(probe_elev_m[0]); i++) {
+		// compute the remaining probes, querying the scenery for all of them
+		// at once
+		const unsigned numProbes = sizeof(probe_elev_m)/sizeof(probe_elev_m[0]);
+		std::vector<SGGeod> probes;
+		probes.reserve(numProbes - 1);
+		for (unsigned i = 1; i < numProbes; i++) {
 			SGGeoc probe = myGeocPos.advanceRadM( ground_wind_from_rad, dist_probe_m[i] );
 			// convert to geodetic position for ground level computation
 			SGGeod probeGeod = SGGeod::fromGeoc( probe );
 			probe_lat_deg[i] = probeGeod.getLatitudeDeg();
 			probe_lon_deg[i] = probeGeod.getLongitudeDeg();
-			if (!globals->get_scenery()->get_elevation_m( probeGeod, probe_elev_m[i], NULL )) {
+			probes.push_back(probeGeod);
+		}
+
+		FGTerrainSamples samples;
+		globals->get_scenery()->get_elevations_m( probes, samples );
+		for (unsigned i = 1; i < numProbes; i++) {
+			if (samples.valid[i-1]) {
+				probe_elev_m[i] = samples.elevation_m[i-1];
+			} else {
 				// no ground found? use elevation of previous probe :-(
 				probe_elev_m[i] = probe_elev_m[i-1];
 			}
@@ -43,6 +43,7 @@
 #include <Aircraft/controls.hxx>
 #include <Main/globals.hxx>
 #include <Main/fg_props.hxx>
+#include <Main/FrameProfiler.hxx>
 
 #include "JSBSim.hxx"
 #include <FDM/JSBSim/FGFDMExec.h>
@@ -84,6 +85,10 @@ FMAX (double a, double b)
   return a > b ? a : b;
 }
 
+// Distance in meters above the contact points from where the ground below
+// them is searched for.
+static const double GROUND_QUERY_ALT_OFF_M = 2;
+
 class FGFSGroundCallback : public FGGroundCallback {
 public:
   FGFSGroundCallback(FGJSBsim* ifc) : mInterface(ifc) {}
@@ -104,8 +109,9 @@ public:
                     FGColumnVector3& n, FGColumnVector3& v, FGColumnVector3& w)
       const override {
     double contact[3], normal[3], vel[3], angularVel[3];
-    double agl = mInterface->get_agl_ft(t, l, SG_METER_TO_FEET*2, contact,
-                                        normal, vel, angularVel);
+    double agl = mInterface->get_agl_ft(t, l,
+                                        SG_METER_TO_FEET*GROUND_QUERY_ALT_OFF_M,
+                                        contact, normal, vel, angularVel, true);
     n = FGColumnVector3( normal[0], normal[1], normal[2] );
     v = FGColumnVector3( vel[0], vel[1], vel[2] );
     w = FGColumnVector3( angularVel[0], angularVel[1], angularVel[2] );
@@ -548,6 +554,7 @@ void FGJSBsim::update( double dt )
     trimmed->setBoolValue(false);
 
     for ( int i=0; i < multiloop; i++ ) {
+      flightgear::FrameProfiler::Zone zone("fdm-iteration", "jsbsim");
       if (!fdmex->Run()) {
         // The property fdm/jsbsim/simulation/terminate has been set to true
         // by the user. The sim is considered crashed.
@@ -1336,6 +1343,8 @@ bool FGJSBsim::update_ground_cache(const FGLocation& cart, double dt)
   double t0 = fdmex->GetSimTime();
   bool cache_ok = prepare_ground_cache_ft( t0, t0 + dt, cart_pos,
                                            groundCacheRadius );
+  // The prefetched gear queries refer to the previous cache contents.
+  ground_query_time = -1;
   if (!cache_ok) {
     //SG_LOG(SG_FLIGHT, SG_WARN,
     //       "FGInterface is being called without scenery below the aircraft!");
@@ -1356,17 +1365,79 @@ bool FGJSBsim::update_ground_cache(const FGLocation& cart, double dt)
   return cache_ok;
 }
 
+// JSBSim asks for the ground below each gear unit separately. Once per
+// time step and aircraft position, query the ground below all gear units
+// that are down with a single batched ground cache lookup and answer the
+// single gear queries from that.
+void
+FGJSBsim::prefetch_ground(double t, const SGVec3d& cg)
+{
+  ground_query_time = t;
+  ground_query_cg = cg;
+  ground_queries.clear();
+
+  const FGLocation& location = Propagate->GetLocation();
+  const FGMatrix33& Tb2l = Propagate->GetTb2l();
+  int n_gears = GroundReactions->GetNumGearUnits();
+  for (int i=0; i<n_gears; ++i) {
+    FGLGear* gear = GroundReactions->GetGearUnit(i);
+    if (!gear->GetGearUnitDown())
+      continue;
+    // Same as the location computed in FGLGear::GetBodyForces()
+    FGLocation gearLoc = location.LocalToLocation(Tb2l * gear->GetBodyLocation());
+    FGGroundCache::AglQuery query;
+    query.pt = SG_FEET_TO_METER*SGVec3d(gearLoc(1), gearLoc(2), gearLoc(3));
+    ground_queries.push_back(query);
+  }
+
+  if (!ground_queries.empty())
+    FGInterface::get_agl_m(t, ground_queries.data(), ground_queries.size(),
+                           GROUND_QUERY_ALT_OFF_M);
+}
+
+const FGGroundCache::AglQuery*
+FGJSBsim::find_ground_query(double t, const double pt[3])
+{
+  const FGLocation& location = Propagate->GetLocation();
+  SGVec3d cg(location(1), location(2), location(3));
+  if (t != ground_query_time || cg != ground_query_cg)
+    prefetch_ground(t, cg);
+
+  SGVec3d pt_m = SG_FEET_TO_METER*SGVec3d(pt);
+  for (const auto& query : ground_queries) {
+    if (distSqr(query.pt, pt_m) < 1e-6)
+      return &query;
+  }
+  return nullptr;
+}
+
 double
 FGJSBsim::get_agl_ft(double t, const FGColumnVector3& loc, double alt_off,
                      double contact[3], double normal[3], double vel[3],
-                     double angularVel[3])
+                     double angularVel[3], bool prefetched)
 {
   const simgear::BVHMaterial* material = nullptr;
   simgear::BVHNode::Id id;
   double pt[3] {loc(1), loc(2), loc(3)};
 
-  if (!FGInterface::get_agl_ft(t, pt, alt_off, contact, normal, vel,
-                          angularVel, material, id))
+  bool found;
+  const FGGroundCache::AglQuery* query = nullptr;
+  if (prefetched)
+    query = find_ground_query(t, pt);
+  if (query) {
+    for (int i=0; i<3; ++i) {
+      contact[i] = SG_METER_TO_FEET*query->contact[i];
+      normal[i] = query->normal[i];
+      vel[i] = SG_METER_TO_FEET*query->linearVel[i];
+      angularVel[i] = query->angularVel[i];
+    }
+    material = query->material;
+    found = query->found;
+  } else {
+    found = FGInterface::get_agl_ft(t, pt, alt_off, contact, normal, vel,
+                                    angularVel, material, id);
+  }
+  if (!found)
     material = nullptr; // Discard the material data when FGInterface reports an problem.
 
   SGGeod geodPt = SGGeod::fromCart(SG_FEET_TO_METER*SGVec3d(pt));
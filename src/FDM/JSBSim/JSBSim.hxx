@@ -52,6 +52,8 @@ DEFINITIONS
 FORWARD DECLARATIONS
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
+#include <vector>
+
 #include <simgear/props/props.hxx>
 
 #include <FDM/JSBSim/FGFDMExec.h>
@@ -212,9 +214,14 @@ public:
     bool ToggleDataLogging(bool state);
     bool ToggleDataLogging(void);
 
+    /** Queries the ground below loc. With prefetched set, the answer is
+        taken from the batched gear lookup of prefetch_ground() if loc is
+        one of the gear units, which requires alt_off to be the offset
+        used there. */
     double get_agl_ft(double t, const JSBSim::FGColumnVector3& loc,
                       double alt_off, double contact[3], double normal[3],
-                      double vel[3], double angularVel[3]);
+                      double vel[3], double angularVel[3],
+                      bool prefetched = false);
 
 private:
     JSBSim::FGFDMExec *fdmex;
@@ -299,6 +306,16 @@ private:
 
     double last_hook_tip[3];
     double last_hook_root[3];
+
+    // Ground queries for all gear units that are answered with one
+    // batched ground cache lookup, see prefetch_ground().
+    std::vector<FGGroundCache::AglQuery> ground_queries;
+    double ground_query_time = -1;
+    SGVec3d ground_query_cg;
+
+    void prefetch_ground(double t, const SGVec3d& cg);
+    const FGGroundCache::AglQuery* find_ground_query(double t,
+                                                     const double pt[3]);
     JSBSim::FGColumnVector3 hook_root_struct;
     double hook_length;
 
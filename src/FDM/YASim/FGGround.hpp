@@ -1,6 +1,10 @@
 #ifndef _FGGROUND_HPP
 #define _FGGROUND_HPP
 
+#include <vector>
+
+#include <FDM/groundcache.hxx>
+
 #include "Ground.hpp"
 
 class FGInterface;
@@ -27,6 +31,8 @@ public:
                                 const simgear::BVHMaterial **material,
                                 unsigned int &body) override;
 
+    void getGroundPlanes(GroundQuery* queries, int count) override;
+
     bool getBody(double t, double bodyToWorld[16], double linearVel[3],
                          double angularVel[3], unsigned int &id) override;
 
@@ -44,6 +50,7 @@ public:
 private:
     FGInterface *_iface;
     double _toff;
+    std::vector<FGGroundCache::AglQuery> _queries;
 };
 
 }; // namespace yasim
@@ -36,6 +36,14 @@ void Ground::getGroundPlane(const double pos[3],
     getGroundPlane(pos,plane,vel,body);
 }
 
+void Ground::getGroundPlanes(GroundQuery* queries, int count)
+{
+    for(int i=0; i<count; i++) {
+        GroundQuery& q = queries[i];
+        getGroundPlane(q.pos, q.plane, q.vel, &q.material, q.body);
+    }
+}
+
 bool Ground::getBody(double t, double bodyToWorld[16], double linearVel[3],
                      double angularVel[3], unsigned int &body)
 {
@@ -6,6 +6,16 @@ class BVHMaterial;
 }
 namespace yasim {
 
+// One point of a batched ground plane query, see
+// Ground::getGroundPlanes().  pos is the input, the rest is output.
+struct GroundQuery {
+    double pos[3];
+    double plane[4];
+    float vel[3];
+    const simgear::BVHMaterial* material;
+    unsigned int body;
+};
+
 class Ground {
 public:
     virtual ~Ground() = default;
@@ -19,6 +29,9 @@ public:
                                 const simgear::BVHMaterial **material,
                                 unsigned int &body);
 
+    // Same as getGroundPlane, but for count points at once.
+    virtual void getGroundPlanes(GroundQuery* queries, int count);
+
    virtual bool getBody(double t, double bodyToWorld[16], double linearVel[3],
                         double angularVel[3], unsigned int &id);
 
@@ -72,6 +72,8 @@ Model::Model()
     _gefyN = fgGetNode("/fdm/yasim/debug/ground-effect/ge-f-y", true);
     _gefzN = fgGetNode("/fdm/yasim/debug/ground-effect/ge-f-z", true);
     _wgdistN = fgGetNode("/fdm/yasim/debug/ground-effect/wing-gnd-dist", true);
+
+    _batchSurfaces = fgGetBool("/fdm/yasim/batch-surfaces", true);
 }
 
 Model::~Model()
@@ -191,13 +193,19 @@ void Model::setGroundEffect(const float* pos, float span, float mul)
 
 void Model::updateGround(State* s)
 {
-    float dummy[3];
-    unsigned int body;
-    _ground_cb->getGroundPlane(s->pos, _global_ground, dummy, body);
+    // Query the ground below all contact points with one call, so that
+    // the ground cache is walked once instead of once per point.
+    int numGears = _gears.size();
+    int numHitches = _hitches.size();
+    int count = 1 + numGears + numHitches + (_hook ? 1 : 0) + (_launchbar ? 1 : 0);
+    _groundQueries.resize(count);
+    GroundQuery* q = _groundQueries.data();
 
     int i;
+    Math::set3(s->pos, q[0].pos);
+
     // The landing gear
-    for(i=0; i<_gears.size(); i++) {
+    for(i=0; i<numGears; i++) {
 	Gear* g = (Gear*)_gears.get(i);
 
 	// Get the point of ground contact
@@ -209,18 +217,10 @@ void Model::updateGround(State* s)
 	Math::add3(cmpr, pos, pos);
         // Transform the local coordinates of the contact point to
         // global coordinates.
-        double pt[3];
-        s->posLocalToGlobal(pos, pt);
-
-        // Ask for the ground plane in the global coordinate system
-        double global_ground[4];
-        float global_vel[3];
-        const simgear::BVHMaterial* material;
-        _ground_cb->getGroundPlane(pt, global_ground, global_vel, &material, body);
-        g->setGlobalGround(global_ground, global_vel, pt[0], pt[1], material, body);
+        s->posLocalToGlobal(pos, q[1 + i].pos);
     }
 
-    for(i=0; i<_hitches.size(); i++) {
+    for(i=0; i<numHitches; i++) {
         Hitch* h = (Hitch*)_hitches.get(i);
 
         // Get the point of interest
@@ -229,14 +229,34 @@ void Model::updateGround(State* s)
 
         // Transform the local coordinates of the contact point to
         // global coordinates.
-        double pt[3];
-        s->posLocalToGlobal(pos, pt);
-
-        // Ask for the ground plane in the global coordinate system
-        double global_ground[4];
-        float global_vel[3];
-        _ground_cb->getGroundPlane(pt, global_ground, global_vel, body);
-        h->setGlobalGround(global_ground, global_vel);
+        s->posLocalToGlobal(pos, q[1 + numGears + i].pos);
+    }
+
+    int next = 1 + numGears + numHitches;
+    // The arrester hook
+    if(_hook)
+        _hook->getTipGlobalPosition(s, q[next++].pos);
+
+    // The launchbar/holdback
+    if(_launchbar)
+        _launchbar->getTipGlobalPosition(s, q[next++].pos);
+
+    // Ask for the ground planes in the global coordinate system
+    _ground_cb->getGroundPlanes(q, count);
+
+    for(i=0; i<4; i++) _global_ground[i] = q[0].plane[i];
+
+    for(i=0; i<numGears; i++) {
+        Gear* g = (Gear*)_gears.get(i);
+        GroundQuery& gq = q[1 + i];
+        g->setGlobalGround(gq.plane, gq.vel, gq.pos[0], gq.pos[1],
+                           gq.material, gq.body);
+    }
+
+    for(i=0; i<numHitches; i++) {
+        Hitch* h = (Hitch*)_hitches.get(i);
+        GroundQuery& hq = q[1 + numGears + i];
+        h->setGlobalGround(hq.plane, hq.vel);
     }
 
     for(i=0; i<_rotorgear.getRotors()->size(); i++) {
@@ -244,23 +264,12 @@ void Model::updateGround(State* s)
         r->findGroundEffectAltitude(_ground_cb,s);
     }
 
-    // The arrester hook
-    if(_hook) {
-        double pt[3];
-        _hook->getTipGlobalPosition(s, pt);
-        double global_ground[4];
-        _ground_cb->getGroundPlane(pt, global_ground, dummy, body);
-        _hook->setGlobalGround(global_ground);
-    }
+    next = 1 + numGears + numHitches;
+    if(_hook)
+        _hook->setGlobalGround(q[next++].plane);
 
-    // The launchbar/holdback
-    if(_launchbar) {
-        double pt[3];
-        _launchbar->getTipGlobalPosition(s, pt);
-        double global_ground[4];
-        _ground_cb->getGroundPlane(pt, global_ground, dummy, body);
-        _launchbar->setGlobalGround(global_ground);
-    }
+    if(_launchbar)
+        _launchbar->setGlobalGround(q[next++].plane);
 }
 
 void Model::calcForces(State* s)
@@ -304,18 +313,39 @@ void Model::calcForces(State* s)
         float vs[3] {0,0,0}, pos[3] {0,0,0};
         localWind(pos, s, vs, alt);
         float mach = _atmo.machFromSpeed(Math::mag3(vs));
-        for (i=0; i<_surfaces.size(); i++) {
-            Surface* sf = (Surface*)_surfaces.get(i);
+        if (_batchSurfaces) {
             // Vsurf = wind - velocity + (rot cross (cg - pos))
-            sf->getPosition(pos);
-            localWind(pos, s, vs, alt);
-
-            float force[3], torque[3];
-            sf->calcForce(vs, _atmo.getDensity(), mach, force, torque);
-            Math::add3(faero, force, faero);
-
-            _body.addForce(pos, force);
-            _body.addTorque(torque);
+            _surfaceBatch.sync(_surfaces);
+            for (i=0; i<_surfaceBatch.size(); i++) {
+                _surfaceBatch.getPosition(i, pos);
+                localWind(pos, s, vs, alt);
+                _surfaceBatch.setWind(i, vs);
+            }
+            _surfaceBatch.calcForces(_atmo.getDensity(), mach);
+            for (i=0; i<_surfaceBatch.size(); i++) {
+                float force[3], torque[3];
+                _surfaceBatch.getPosition(i, pos);
+                _surfaceBatch.getForce(i, force);
+                _surfaceBatch.getTorque(i, torque);
+                Math::add3(faero, force, faero);
+
+                _body.addForce(pos, force);
+                _body.addTorque(torque);
+            }
+        } else {
+            for (i=0; i<_surfaces.size(); i++) {
+                Surface* sf = (Surface*)_surfaces.get(i);
+                // Vsurf = wind - velocity + (rot cross (cg - pos))
+                sf->getPosition(pos);
+                localWind(pos, s, vs, alt);
+
+                float force[3], torque[3];
+                sf->calcForce(vs, _atmo.getDensity(), mach, force, torque);
+                Math::add3(faero, force, faero);
+
+                _body.addForce(pos, force);
+                _body.addTorque(torque);
+            }
         }
     }
     for (j=0; j<_rotorgear.getRotors()->size();j++)
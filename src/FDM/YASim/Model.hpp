@@ -8,8 +8,12 @@
 #include "Turbulence.hpp"
 #include "Rotor.hpp"
 #include "Atmosphere.hpp"
+#include "Ground.hpp"
+#include "SurfaceBatch.hpp"
 #include <simgear/props/props.hxx>
 
+#include <vector>
+
 namespace yasim {
 
 // Declare the types whose pointers get passed around here
@@ -58,6 +62,7 @@ public:
 
     // Semi-private methods for use by the Airplane solver.
     int numThrusters() const { return _thrusters.size(); }
+    int numSurfaces() const { return _surfaces.size(); }
     Thruster* getThruster(int handle) { return (Thruster*)_thrusters.get(handle); }
     void setThruster(int handle, Thruster* t) { _thrusters.set(handle, t); }
     void initIteration();
@@ -76,6 +81,11 @@ public:
 
     void updateGround(State* s);
 
+    // Compute the surface forces in one SurfaceBatch pass rather than
+    // surface by surface (default, see /fdm/yasim/batch-surfaces)
+    void setBatchSurfaces(bool batch) { _batchSurfaces = batch; }
+    bool getBatchSurfaces() const { return _batchSurfaces; }
+
     // BodyEnvironment callbacks
     virtual void calcForces(State* s);
     virtual void newState(State* s);
@@ -93,6 +103,8 @@ private:
 
     Vector _thrusters;
     Vector _surfaces;
+    SurfaceBatch _surfaceBatch;
+    bool _batchSurfaces {true};
     Rotorgear _rotorgear;
     Vector _gears;
     Hook* _hook {nullptr};
@@ -105,6 +117,8 @@ private:
 
     Ground* _ground_cb;
     double _global_ground[4] {0,0,1, -1e5};
+    // Scratch space for the batched ground query in updateGround()
+    std::vector<GroundQuery> _groundQueries;
     Atmosphere _atmo;
     float _wind[3] {0,0,0};
     
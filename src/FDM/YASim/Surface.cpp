@@ -52,6 +52,7 @@ Surface::Surface(Version* version, const float* pos, float c0 = 1 ) :
 void Surface::setPosition(const float* pos)
 {
     Math::set3(pos, _pos);
+    ++_serial;
     if (_surfN != 0) {
         _surfN->getNode("pos-x", true)->setFloatValue(pos[0]);
         _surfN->getNode("pos-y", true)->setFloatValue(pos[1]);
@@ -62,6 +63,7 @@ void Surface::setPosition(const float* pos)
 void Surface::setChord(float chord) 
 {
     _chord = chord;
+    ++_serial;
     if (_surfN != 0) {
         _surfN->getNode("chord",true)->setFloatValue(_chord);
     }
@@ -70,6 +72,7 @@ void Surface::setChord(float chord)
 void Surface::setOrientation(const float* o)
 {
     for(int i=0; i<9; i++) _orient[i] = o[i];
+    ++_serial;
     if (_surfN) {
         // export the chord line (transformed into aircraft coordiantes)
         float xaxis[3] {1,0,0};
@@ -85,24 +88,28 @@ void Surface::setSlatParams(float stallDelta, float dragPenalty)
 {
     _slatAlpha = stallDelta;
     _slatDrag = dragPenalty;
+    ++_serial;
 }
 
 void Surface::setFlapParams(float liftAdd, float dragPenalty)
 {
     _flapLift = liftAdd;
     _flapDrag = dragPenalty;
+    ++_serial;
 }
 
 void Surface::setSpoilerParams(float liftPenalty, float dragPenalty)
 {
     _spoilerLift = liftPenalty;
     _spoilerDrag = dragPenalty;
+    ++_serial;
 }
 
 void Surface::setFlapPos(float pos)
 {
   if (_flapPos != pos) {
     _flapPos = pos;
+    ++_serial;
     if (_surfN != 0) {
         _flapN->setFloatValue(pos);
     }
@@ -113,6 +120,7 @@ void Surface::setSlatPos(float pos)
 {
   if (_slatPos != pos) {
     _slatPos = pos;
+    ++_serial;
     if (_surfN != 0) {
         _slatN->setFloatValue(pos);
     }
@@ -123,6 +131,7 @@ void Surface::setSpoilerPos(float pos)
 {
   if (_spoilerPos != pos) {
     _spoilerPos = pos;
+    ++_serial;
     if (_surfN != 0) _spoilerN->setFloatValue(pos);
   }
 }
@@ -241,12 +250,17 @@ void Surface::calcForce(const float* v, const float rho, float mach, float* out,
     float scale = 0.5f*rho*vel*vel*_c0;
     Math::mul3(scale, out, out);
     Math::mul3(scale, torque, torque);
-    // if we have a property tree, export info
+    exportForce(out, pg_correction, wavedrag);
+}
+
+// if we have a property tree, export info
+void Surface::exportForce(const float* force, float pg_correction, float wavedrag)
+{
     if (_surfN != 0) {
-      _fabsN->setFloatValue(Math::mag3(out));
-      _fxN->setFloatValue(out[0]);
-      _fyN->setFloatValue(out[1]);
-      _fzN->setFloatValue(out[2]);
+      _fabsN->setFloatValue(Math::mag3(force));
+      _fxN->setFloatValue(force[0]);
+      _fyN->setFloatValue(force[1]);
+      _fzN->setFloatValue(force[2]);
       _alphaN->setFloatValue(_alpha);
       _stallAlphaN->setFloatValue(_stallAlpha);      
       _pgCorrectionN->setFloatValue(pg_correction);
@@ -375,6 +389,7 @@ float Surface::controlDrag(float lift, float drag)
 
 void Surface::setIncidence(float angle) {
     _incidence = angle * -1;
+    ++_serial;
     if (_surfN != 0) {
         _incidenceN->setFloatValue(angle * RAD2DEG);
     }
@@ -383,6 +398,7 @@ void Surface::setIncidence(float angle) {
 
 void Surface::setTwist(float angle) {
     _twist = angle * -1;
+    ++_serial;
     if (_surfN != 0) {
         _twistN->setFloatValue(angle * RAD2DEG);
     }
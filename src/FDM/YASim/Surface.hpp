@@ -8,6 +8,8 @@
 
 namespace yasim {
 
+class SurfaceBatch;
+
 // FIXME: need a "chord" member for calculating moments.  Generic
 // forces act at the center, but "pre-stall" lift acts towards the
 // front, and flaps act (in both lift and drag) toward the back.
@@ -46,7 +48,7 @@ public:
     void setSpoilerPos(float pos);
 
     // Modifier for flap lift coefficient, useful for simulating flap blowing etc.
-    void setFlapEffectiveness(float effectiveness) { _flapEffectiveness = effectiveness; }
+    void setFlapEffectiveness(float effectiveness) { _flapEffectiveness = effectiveness; ++_serial; }
     double getFlapEffectiveness() const { return _flapEffectiveness; }
 
     // local -> Surface coords
@@ -60,48 +62,57 @@ public:
     // The offset from base incidence for this surface.
     void setTwist(float angle);
 
-    void  setTotalForceCoefficient(float c0) { _c0 = c0; }
-    void  mulTotalForceCoefficient(float factor) { _c0 *= factor; }
+    void  setTotalForceCoefficient(float c0) { _c0 = c0; ++_serial; }
+    void  mulTotalForceCoefficient(float factor) { _c0 *= factor; ++_serial; }
     float getTotalForceCoefficient() const { return _c0; }
     
-    void  setDragCoefficient(float cx) { _cx = cx; }
-    void  mulDragCoefficient(float factor) { _cx *= factor; }
+    void  setDragCoefficient(float cx) { _cx = cx; ++_serial; }
+    void  mulDragCoefficient(float factor) { _cx *= factor; ++_serial; }
     float getDragCoefficient() const { return _cx; }
-    void  setYDrag(float cy) { _cy = cy; }
-    void  setLiftCoefficient(float cz) { _cz = cz; }
+    void  setYDrag(float cy) { _cy = cy; ++_serial; }
+    void  setLiftCoefficient(float cz) { _cz = cz; ++_serial; }
     float getLiftCoefficient() const { return _cz; }
 
     // zero-alpha Z drag ("camber") specified as a fraction of cz
-    void setZeroAlphaLift(float cz0) { _cz0 = cz0; }
+    void setZeroAlphaLift(float cz0) { _cz0 = cz0; ++_serial; }
 
     // i: 0 == forward, 1 == backwards
-    void setStallPeak(int i, float peak) { _peaks[i] = peak; }
+    void setStallPeak(int i, float peak) { _peaks[i] = peak; ++_serial; }
 
     // i: 0 == fwd/+z, 1 == fwd/-z, 2 == rev/+z, 3 == rev/-z
-    void setStall(int i, float alpha) { _stalls[i] = alpha; }
-    void setStallWidth(int i, float width) { _widths[i] = width; }
+    void setStall(int i, float alpha) { _stalls[i] = alpha; ++_serial; }
+    void setStallWidth(int i, float width) { _widths[i] = width; ++_serial; }
 
     // Induced drag multiplier
-    void setInducedDrag(float mul) { _inducedDrag = mul; }
+    void setInducedDrag(float mul) { _inducedDrag = mul; ++_serial; }
 
     void calcForce(const float* v, const float rho, float mach, float* out, float* torque);
 
     float getAlpha() const { return _alpha; };
     float getStallAlpha() const { return _stallAlpha; };
     
-    void setFlowRegime(FlowRegime flow) { _flow = flow; };
+    void setFlowRegime(FlowRegime flow) { _flow = flow; ++_serial; };
     FlowRegime getFlowRegime() { return _flow; };
     
-    void setCriticalMachNumber(float mach) { _Mcrit = mach; };
+    void setCriticalMachNumber(float mach) { _Mcrit = mach; ++_serial; };
     float getCriticalMachNumber() const { return _Mcrit; };
     
+    // Bumped by every setter, so a SurfaceBatch knows when to copy the
+    // parameters again.
+    unsigned getSerial() const { return _serial; }
+
 private:
+    friend class SurfaceBatch;
+
     SGPropertyNode_ptr _surfN;
     Version * _version;
     
     float stallFunc(float* v);
     float flapLift(float alpha);
     float controlDrag(float lift, float drag);
+    void exportForce(const float* force, float pg_correction, float wavedrag);
+
+    unsigned _serial {0};
 
     float _chord {0};     // X-axis size
     float _c0 {1};        // total force coefficient
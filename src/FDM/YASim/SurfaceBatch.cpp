@@ -0,0 +1,314 @@
+#include <cmath>
+
+#include "yasim-common.hpp"
+#include "Math.hpp"
+#include "Surface.hpp"
+#include "SurfaceBatch.hpp"
+
+namespace yasim {
+
+// c ? a : b, computed so that a and b are both evaluated; the compiler
+// would otherwise move loads into branches and give up vectorizing
+static inline float blend(bool c, float a, float b)
+{
+    const float w = c ? 1.0f : 0.0f;
+    return a*w + b*(1-w);
+}
+
+void SurfaceBatch::sync(const Vector& surfaces)
+{
+    const int n = surfaces.size();
+    if (n != size()) {
+        resize(n);
+    }
+
+    for (int i = 0; i < n; i++) {
+        Surface* s = (Surface*)surfaces.get(i);
+        if (s != _surfaces[i] || s->getSerial() != _serials[i]) {
+            _surfaces[i] = s;
+            load(i);
+        }
+    }
+}
+
+void SurfaceBatch::resize(int n)
+{
+    std::vector<float>* arrays[] = {
+        &_posX, &_posY, &_posZ,
+        &_orient[0], &_orient[1], &_orient[2],
+        &_orient[3], &_orient[4], &_orient[5],
+        &_orient[6], &_orient[7], &_orient[8],
+        &_chord, &_c0, &_cx, &_cy, &_cz, &_cz0,
+        &_peaks[0], &_peaks[1],
+        &_stalls[0], &_stalls[1], &_stalls[2], &_stalls[3],
+        &_widths[0], &_widths[1], &_widths[2], &_widths[3],
+        &_slatAlpha, &_slatDrag, &_flapLift, &_flapDrag,
+        &_flapEffectiveness, &_spoilerLift, &_spoilerDrag,
+        &_slatPos, &_flapPos, &_spoilerPos,
+        &_incidence, &_inducedDrag, &_Mcrit,
+        &_transonic, &_version32, &_active,
+        &_alpha, &_stallAlpha, &_updated,
+        &_vX, &_vY, &_vZ, &_fX, &_fY, &_fZ, &_tX, &_tY, &_tZ,
+        &_vel, &_wavedrag
+    };
+    for (auto a : arrays) {
+        a->assign(n, 0.0f);
+    }
+    _surfaces.assign(n, nullptr);
+    _serials.assign(n, 0);
+}
+
+void SurfaceBatch::load(int i)
+{
+    const Surface* s = _surfaces[i];
+    _serials[i] = s->getSerial();
+
+    _posX[i] = s->_pos[0]; _posY[i] = s->_pos[1]; _posZ[i] = s->_pos[2];
+    for (int j = 0; j < 9; j++) {
+        _orient[j][i] = s->_orient[j];
+    }
+    _chord[i] = s->_chord;
+    _c0[i] = s->_c0;
+    _cx[i] = s->_cx;
+    _cy[i] = s->_cy;
+    _cz[i] = s->_cz;
+    _cz0[i] = s->_cz0;
+    for (int j = 0; j < 2; j++) {
+        _peaks[j][i] = s->_peaks[j];
+    }
+    for (int j = 0; j < 4; j++) {
+        _stalls[j][i] = s->_stalls[j];
+        _widths[j][i] = s->_widths[j];
+    }
+    _slatAlpha[i] = s->_slatAlpha;
+    _slatDrag[i] = s->_slatDrag;
+    _flapLift[i] = s->_flapLift;
+    _flapDrag[i] = s->_flapDrag;
+    _flapEffectiveness[i] = s->_flapEffectiveness;
+    _spoilerLift[i] = s->_spoilerLift;
+    _spoilerDrag[i] = s->_spoilerDrag;
+    _slatPos[i] = s->_slatPos;
+    _flapPos[i] = s->_flapPos;
+    _spoilerPos[i] = s->_spoilerPos;
+    _incidence[i] = s->_incidence + s->_twist;
+    _inducedDrag[i] = s->_inducedDrag;
+    _Mcrit[i] = s->_Mcrit;
+    _transonic[i] = s->_flow == FLOW_TRANSONIC ? 1 : 0;
+    _version32[i] = s->_version->isVersionOrNewer(Version::YASIM_VERSION_32) ? 1 : 0;
+    _active[i] = (s->_cx == 0. && s->_cy == 0. && s->_cz == 0.) ? 0 : 1;
+}
+
+void SurfaceBatch::calcForces(float rho, float mach)
+{
+    const int n = size();
+    if (n == 0) {
+        return;
+    }
+
+    // Prandtl/Glauert compressibility factor, for transonic surfaces
+    float pg_correction {1};
+    if (mach < 0.8f) {
+        pg_correction = 1.0f/Math::sqrt(1.0f-(mach*mach));
+    }
+    if ((mach >= 0.8f) && (mach < 1.2f)) {
+        pg_correction = Math::polynomial(_surfaces[0]->pg_coefficients, mach);
+    }
+    if (mach >= 1.2f) {
+        pg_correction = 2.0f/(((mach*mach)-1.0f)*YASIM_PI);
+    }
+
+    // Airspeed and mach dependent wave drag (Perkins and Hage) first, as
+    // sqrt() and pow() keep the main loop from being vectorized
+    const float m = mach > 1.0f ? 1.0f : mach;
+    for (int i = 0; i < n; i++) {
+        _vel[i] = Math::sqrt(_vX[i]*_vX[i] + _vY[i]*_vY[i] + _vZ[i]*_vZ[i]);
+        _wavedrag[i] = 0;
+        if (_transonic[i] != 0 && mach > _Mcrit[i]) {
+            _wavedrag[i] = 9.5f * Math::pow(m-_Mcrit[i], 2.8f) + 0.00193f;
+        }
+    }
+
+    calcLanes(n, rho, pg_correction,
+              _fX.data(), _fY.data(), _fZ.data(),
+              _tX.data(), _tY.data(), _tZ.data(),
+              _alpha.data(), _stallAlpha.data(), _updated.data());
+
+    for (int i = 0; i < n; i++) {
+        Surface* sf = _surfaces[i];
+        if (_updated[i] != 0) {
+            sf->_alpha = _alpha[i];
+            sf->_stallAlpha = _stallAlpha[i];
+        }
+        if (sf->_surfN != 0 && _active[i] != 0 && _vel[i] != 0) {
+            const float force[3] = { _fX[i], _fY[i], _fZ[i] };
+            sf->exportForce(force, _transonic[i] != 0 ? pg_correction : 1, _wavedrag[i]);
+        }
+    }
+}
+
+// Surface::calcForce(), stallFunc(), flapLift() and controlDrag() for
+// all surfaces at once.  Branches are written as selects so the loop
+// stays vectorizable; divisors are replaced where the scalar code would
+// not have divided at all.  The outputs are restrict-qualified
+// parameters so the compiler needs no run-time aliasing checks.
+void SurfaceBatch::calcLanes(int n, float rho, float pg_correction,
+                             float* __restrict fX, float* __restrict fY, float* __restrict fZ,
+                             float* __restrict tX, float* __restrict tY, float* __restrict tZ,
+                             float* __restrict alpha, float* __restrict stallAlpha,
+                             float* __restrict updated) const
+{
+    const float* o0 = _orient[0].data(); const float* o1 = _orient[1].data();
+    const float* o2 = _orient[2].data(); const float* o3 = _orient[3].data();
+    const float* o4 = _orient[4].data(); const float* o5 = _orient[5].data();
+    const float* o6 = _orient[6].data(); const float* o7 = _orient[7].data();
+    const float* o8 = _orient[8].data();
+    const float* chord = _chord.data();
+    const float* c0 = _c0.data();
+    const float* cx = _cx.data();
+    const float* cy = _cy.data();
+    const float* cz = _cz.data();
+    const float* cz0 = _cz0.data();
+    const float* peak0 = _peaks[0].data(); const float* peak1 = _peaks[1].data();
+    const float* stall0 = _stalls[0].data(); const float* stall1 = _stalls[1].data();
+    const float* stall2 = _stalls[2].data(); const float* stall3 = _stalls[3].data();
+    const float* width0 = _widths[0].data(); const float* width1 = _widths[1].data();
+    const float* width2 = _widths[2].data(); const float* width3 = _widths[3].data();
+    const float* slatAlpha = _slatAlpha.data();
+    const float* slatDrag = _slatDrag.data();
+    const float* flapLift = _flapLift.data();
+    const float* flapDrag = _flapDrag.data();
+    const float* flapEffectiveness = _flapEffectiveness.data();
+    const float* spoilerLift = _spoilerLift.data();
+    const float* spoilerDrag = _spoilerDrag.data();
+    const float* slatPos = _slatPos.data();
+    const float* flapPos = _flapPos.data();
+    const float* spoilerPos = _spoilerPos.data();
+    const float* incidence = _incidence.data();
+    const float* inducedDrag = _inducedDrag.data();
+    const float* transonic = _transonic.data();
+    const float* version32 = _version32.data();
+    const float* active = _active.data();
+    const float* wavedrag = _wavedrag.data();
+    const float* velocity = _vel.data();
+    const float* vX = _vX.data(); const float* vY = _vY.data(); const float* vZ = _vZ.data();
+
+    for (int i = 0; i < n; i++) {
+        // everything up front: conditional loads defeat vectorization
+        const float st0 = stall0[i], st1 = stall1[i], st2 = stall2[i], st3 = stall3[i];
+        const float w0 = width0[i], w1 = width1[i], w2 = width2[i], w3 = width3[i];
+        const float pk0 = peak0[i], pk1 = peak1[i];
+        const float slatP = slatPos[i], slatA = slatAlpha[i];
+        const float flap = flapPos[i], flapL = flapLift[i];
+        const float c_z = cz[i], c_z0 = cz0[i];
+
+        const float vel = velocity[i];
+        const bool live = active[i] != 0 && vel != 0;
+
+        // Normalize wind and convert to the surface's coordinates
+        const float inv = 1/(vel != 0 ? vel : 1);
+        const float nx = inv*vX[i], ny = inv*vY[i], nz = inv*vZ[i];
+        float ox = nx*o0[i] + ny*o1[i] + nz*o2[i];
+        float oy = nx*o3[i] + ny*o4[i] + nz*o5[i];
+        float oz = nx*o6[i] + ny*o7[i] + nz*o8[i];
+
+        const float inc = incidence[i];
+        oz += inc * ox;
+        const float lwx = ox, lwy = oy, lwz = oz;
+
+        // stallFunc()
+        const bool v32 = version32[i] != 0;
+        const bool moving = ox != 0;
+        const float a = std::fabs(oz/(moving ? ox : 1));
+        const bool fwdBak = ox > 0;
+        const bool posNeg = oz < 0;
+        const float stallFwd = blend(posNeg, st1, st0);
+        const float stallBak = blend(posNeg, st3, st2);
+        const float stall = blend(fwdBak, stallBak, stallFwd);
+        const float widthFwd = blend(posNeg, w1, w0);
+        const float widthBak = blend(posNeg, w3, w2);
+        const float width = blend(fwdBak, widthBak, widthFwd);
+        const float slatV32 = slatP * slatA;
+        const float slatStall = stall + blend(v32, slatV32, slatA);
+        const float sa = (!fwdBak && !posNeg) ? slatStall : stall;
+        const bool stalls = moving && stall != 0;
+        const float peak = blend(fwdBak, pk1, pk0);
+        const float positive = blend(fwdBak, st2, st0);
+        const float scale = 0.5f*peak / (stalls ? positive : 1);
+        const bool inside = stalls && a > sa && !(a > sa + width);
+        float frac = (a - sa) / (inside ? width : 1);
+        frac = frac*frac*(3-2*frac);
+        const float interpolated = scale*(1-frac) + frac;
+        float stallMul = a <= sa ? scale : interpolated;
+        stallMul = a > sa + width ? 1 : stallMul;
+        stallMul = stalls ? stallMul : 1;
+        alpha[i] = a;
+        stallAlpha[i] = stall == 0 ? stall : sa;
+        updated[i] = (live && moving) ? 1 : 0;
+
+        stallMul *= 1 + spoilerPos[i] * (spoilerLift[i] - 1);
+        const float stallLift = (stallMul - 1) * c_z * oz;
+
+        // flapLift()
+        const float maxFlapLift = c_z * flap * (flapL-1) * flapEffectiveness[i];
+        const float fa = std::fabs(oz);
+        const bool flapInside = st0 != 0 && !(fa < st0) && !(fa > st0 + w0);
+        float flapFrac = (fa - st0) / (flapInside ? w0 : 1);
+        flapFrac = flapFrac*flapFrac*(3-2*flapFrac);
+        const float fadedFlapLift = maxFlapLift * (1-flapFrac);
+        float flaplift = fa > st0 + w0 ? 0 : fadedFlapLift;
+        flaplift = fa < st0 ? maxFlapLift : flaplift;
+        flaplift = st0 == 0 ? 0 : flaplift;
+
+        oz *= c_z;
+        oz += c_z*c_z0;
+        oz += stallLift;
+        oz += flaplift;
+
+        const float pgz = oz * pg_correction;
+        oz = transonic[i] != 0 ? pgz : oz;
+        ox += wavedrag[i];
+
+        const float pitch = 0.1667f * chord[i] * (flaplift - (c_z*c_z0 + stallLift));
+
+        // controlDrag()
+        const bool negFlap = flap < 0;
+        float fp = -flap - c_z0/(negFlap ? flapL-1 : 1);
+        fp = fp < 0 ? 0 : fp;
+        fp = negFlap ? fp : flap;
+        const float flapDragAoA = (flapL - 1 - c_z0) * st0;
+        float drag = cx[i] * ox;
+        const float fd = std::fabs(oz * flapDragAoA * fp);
+        drag += drag < 0 ? -fd : fd;
+        drag *= 1 + fp * (flapDrag[i] - 1);
+        drag *= 1 + spoilerPos[i] * (spoilerDrag[i] - 1);
+        drag *= 1 + slatP * (slatDrag[i] - 1);
+        ox = drag;
+
+        oy *= cy[i];
+
+        // induced drag
+        const float induced = -1*inducedDrag[i]*oz*lwz;
+        ox += induced*lwx;
+        oy += induced*lwy;
+        oz += induced*lwz;
+
+        // reverse the incidence rotation
+        const float rx = ox + inc * oz;
+        const float rz = oz - inc * ox;
+        ox = v32 ? rx : ox;
+        oz = v32 ? oz : rz;
+
+        // back to external coordinates, and into a real force
+        const float dynamic = 0.5f*rho*vel*vel*c0[i];
+        const float s = live ? dynamic : 0;
+        fX[i] = s * (ox*o0[i] + oy*o3[i] + oz*o6[i]);
+        fY[i] = s * (ox*o1[i] + oy*o4[i] + oz*o7[i]);
+        fZ[i] = s * (ox*o2[i] + oy*o5[i] + oz*o8[i]);
+        tX[i] = s * (pitch*o3[i]);
+        tY[i] = s * (pitch*o4[i]);
+        tZ[i] = s * (pitch*o5[i]);
+    }
+
+}
+
+}; // namespace yasim
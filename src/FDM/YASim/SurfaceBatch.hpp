@@ -0,0 +1,85 @@
+#ifndef _SURFACEBATCH_HPP
+#define _SURFACEBATCH_HPP
+
+#include <vector>
+
+#include "Vector.hpp"
+
+namespace yasim {
+
+class Surface;
+
+// Computes the forces of all surfaces of a model in one pass.  The
+// surface parameters are kept as a structure of arrays, one array per
+// parameter, so that the loop in calcForces() works on contiguous data
+// the compiler can vectorize.  The results match Surface::calcForce()
+// to within rounding.
+//
+// The parameters are copied from the Surface objects by sync(), again
+// only for surfaces whose setters have been called since.
+class SurfaceBatch
+{
+public:
+    // Makes the batch mirror the given list of Surface pointers
+    void sync(const Vector& surfaces);
+
+    int size() const { return (int)_surfaces.size(); }
+
+    void getPosition(int i, float* out) const {
+        out[0] = _posX[i]; out[1] = _posY[i]; out[2] = _posZ[i];
+    }
+
+    // Wind vector at the surface, in local coordinates
+    void setWind(int i, const float* v) {
+        _vX[i] = v[0]; _vY[i] = v[1]; _vZ[i] = v[2];
+    }
+
+    // Computes force and torque of every surface, like
+    // Surface::calcForce(), and hands the angle of attack and the
+    // debug output back to the surfaces.
+    void calcForces(float rho, float mach);
+
+    void getForce(int i, float* out) const {
+        out[0] = _fX[i]; out[1] = _fY[i]; out[2] = _fZ[i];
+    }
+    void getTorque(int i, float* out) const {
+        out[0] = _tX[i]; out[1] = _tY[i]; out[2] = _tZ[i];
+    }
+
+private:
+    void resize(int n);
+    void load(int i);
+    void calcLanes(int n, float rho, float pg_correction,
+                   float* __restrict fX, float* __restrict fY, float* __restrict fZ,
+                   float* __restrict tX, float* __restrict tY, float* __restrict tZ,
+                   float* __restrict alpha, float* __restrict stallAlpha,
+                   float* __restrict updated) const;
+
+    std::vector<Surface*> _surfaces;
+    std::vector<unsigned> _serials;
+
+    // parameters, see Surface
+    std::vector<float> _posX, _posY, _posZ;
+    std::vector<float> _orient[9];
+    std::vector<float> _chord, _c0, _cx, _cy, _cz, _cz0;
+    std::vector<float> _peaks[2], _stalls[4], _widths[4];
+    std::vector<float> _slatAlpha, _slatDrag, _flapLift, _flapDrag;
+    std::vector<float> _flapEffectiveness, _spoilerLift, _spoilerDrag;
+    std::vector<float> _slatPos, _flapPos, _spoilerPos;
+    std::vector<float> _incidence; // incidence plus twist
+    std::vector<float> _inducedDrag, _Mcrit;
+    std::vector<float> _transonic;  // 1 for FLOW_TRANSONIC, else 0
+    std::vector<float> _version32;  // 1 if YASIM_VERSION_32 or newer
+    std::vector<float> _active;     // 0 if all coefficients are zero
+
+    // inputs and results; _alpha and _stallAlpha are handed back to the
+    // Surface where _updated is set
+    std::vector<float> _vX, _vY, _vZ;
+    std::vector<float> _fX, _fY, _fZ;
+    std::vector<float> _tX, _tY, _tZ;
+    std::vector<float> _alpha, _stallAlpha, _updated;
+    std::vector<float> _vel, _wavedrag;
+};
+
+}; // namespace yasim
+#endif // _SURFACEBATCH_HPP
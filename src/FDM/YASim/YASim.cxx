@@ -14,6 +14,7 @@
 
 #include <Main/globals.hxx>
 #include <Main/fg_props.hxx>
+#include <Main/FrameProfiler.hxx>
 
 #include "yasim-common.hpp"
 #include "FGFDM.hpp"
@@ -272,6 +273,7 @@ void YASim::update(double dt)
 
     int i;
     for(i=0; i<iterations; i++) {
+        flightgear::FrameProfiler::Zone zone("fdm-iteration", "yasim");
         gr->setTimeOffset(_simTime + i*_dt);
         copyToYASim(false);
         _fdm->iterate(_dt);
@@ -1,5 +1,6 @@
 #include <stdio.h>
 
+#include <chrono>
 #include <cstring>
 #include <cstdlib>
 
@@ -302,6 +303,41 @@ void report(Airplane* a)
     printf("  %7.0f, %7.0f, %7.0f\n", SI_inertia[6], SI_inertia[7], SI_inertia[8]);
 }
 
+// Times Model::calcForces() at cruise with scalar and batched surfaces,
+// and prints how far apart the resulting accelerations are.
+void yasim_bench(Airplane* a, const float alt, const float kts, int iterations)
+{
+    Model* m = a->getModel();
+    _setup(a, Airplane::CRUISE, alt);
+    State s;
+    s.setupState(a->getCruiseAoA(), kts * KTS2MPS, 0);
+    m->initIteration();
+
+    float accel[2][3], rot[2][3];
+    double usec[2];
+    for (int batch = 0; batch < 2; batch++) {
+        m->setBatchSurfaces(batch != 0);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            m->getBody()->reset();
+            m->calcForces(&s);
+        }
+        std::chrono::duration<double, std::micro> t = std::chrono::steady_clock::now() - start;
+        usec[batch] = t.count() / iterations;
+        m->getBody()->getAccel(accel[batch]);
+        m->getBody()->getAngularAccel(rot[batch]);
+    }
+
+    float da[3], dr[3];
+    Math::sub3(accel[1], accel[0], da);
+    Math::sub3(rot[1], rot[0], dr);
+    printf("surfaces          : %d\n", m->numSurfaces());
+    printf("calcForces scalar : %.3f us\n", usec[0]);
+    printf("calcForces batch  : %.3f us\n", usec[1]);
+    printf("accel difference  : %g (of %g)\n", Math::mag3(da), Math::mag3(accel[0]));
+    printf("rot. accel diff.  : %g (of %g)\n", Math::mag3(dr), Math::mag3(rot[0]));
+}
+
 int usage()
 {
     fprintf(stderr, "Usage: \n");
@@ -309,6 +345,7 @@ int usage()
     fprintf(stderr, "  yasim <aircraft.xml> [-d [-a meters] [-approach | -cruise] ]\n");
     fprintf(stderr, "  yasim <aircraft.xml> [-m]\n");
     fprintf(stderr, "  yasim <aircraft.xml> [-test] [-a meters] [-s kts] [-approach | -cruise] ]\n");
+    fprintf(stderr, "  yasim <aircraft.xml> [--bench [-n iterations] [-a meters] [-s kts] ]\n");
     fprintf(stderr, "                       -g print lift/drag table: aoa, lift, drag, lift/drag \n");
     fprintf(stderr, "                       -d print drag over TAS: kts, drag\n");
     fprintf(stderr, "                       -D print kts at lowest drag at specified altitude\n");
@@ -317,6 +354,7 @@ int usage()
     fprintf(stderr, "                       -s set speed in knots\n");
     fprintf(stderr, "                       -m print mass distribution table: id, x, y, z, mass \n");
     fprintf(stderr, "                       -test print summary and output like -g -m \n");
+    fprintf(stderr, "                       --bench time scalar and batched surface forces\n");
     return 1;
 }
 
@@ -417,6 +455,23 @@ int main(int argc, char** argv)
             }
             findMinSpeed(a, alt);
         }
+        else if(strcmp(argv[2], "--bench") == 0) {
+            int iterations = 100000;
+            for(int i=3; i<argc; i++) {
+                if (std::strcmp(argv[i], "-n") == 0) {
+                    if (i+1 < argc) iterations = std::atoi(argv[++i]);
+                }
+                else if (std::strcmp(argv[i], "-a") == 0) {
+                    if (i+1 < argc) alt = std::atof(argv[++i]);
+                }
+                else if(std::strcmp(argv[i], "-s") == 0) {
+                    if(i+1 < argc) kts = std::atof(argv[++i]);
+                }
+                else return usage();
+            }
+            if (iterations < 1) return usage();
+            yasim_bench(a, alt, kts, iterations);
+        }
     }
     else {
         report(a);
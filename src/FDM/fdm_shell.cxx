@@ -29,6 +29,7 @@
 #include <simgear/props/props_io.hxx>
 
 #include <FDM/fdm_shell.hxx>
+#include <FDM/fdm_thread.hxx>
 #include <FDM/flight.hxx>
 #include <Aircraft/replay.hxx>
 #include <Main/globals.hxx>
@@ -68,6 +69,24 @@
 
 using std::string;
 
+/**
+ * Passes pauses, replays and speed-ups on to the FDM thread, which the
+ * fixed-step FDM group would not call update() for while paused.
+ */
+class FDMShell::TimeScaleListener : public SGPropertyChangeListener
+{
+public:
+    explicit TimeScaleListener(FDMShell* shell) : _shell(shell) {}
+
+    void valueChanged(SGPropertyNode*) override
+    {
+        _shell->updateThreadTimeScale();
+    }
+
+private:
+    FDMShell* _shell;
+};
+
 FDMShell::FDMShell() : _tankProperties(fgGetNode("/consumables/fuel", true))
 {
 }
@@ -95,6 +114,12 @@ void FDMShell::init()
   _max_radius_nm    = _props->getNode("fdm/ai-wake/max-radius-nm",          true);
   _ai_wake_enabled  = _props->getNode("fdm/ai-wake/enabled",                true);
 
+  // FDM thread, only read here, so changes take effect on reset
+  _threadProps      = _props->getNode("sim/fdm-thread",                     true);
+  _freeze_master    = _props->getNode("sim/freeze/master",                  true);
+  _speed_up         = _props->getNode("sim/speed-up",                       true);
+  _threaded         = _threadProps->getBoolValue("enabled", false);
+
   _nanCheckFailed = false;
   fgSetBool("/sim/fdm-nan-failure", false);
   _lastValidPos = SGGeod::invalid();
@@ -120,6 +145,8 @@ void FDMShell::postinit()
 
 void FDMShell::shutdown()
 {
+    stopThread();
+
     if (_impl) {
         fgSetBool("/sim/fdm-initialized", false);
         _impl->unbind();
@@ -136,6 +163,8 @@ void FDMShell::shutdown()
     _density_slugft .clear();
     _data_logging.clear();
     _replay_master.clear();
+    _freeze_master.clear();
+    _speed_up.clear();
 }
 
 void FDMShell::reinit()
@@ -166,6 +195,7 @@ void FDMShell::bind()
 
 void FDMShell::unbind()
 {
+  stopThread();
   if( _impl ) _impl->unbind();
   _tankProperties.unbind();
 }
@@ -213,6 +243,9 @@ void FDMShell::update(double dt)
     const auto startUpPositionFialized = fgGetBool("/sim/position-finalized", false);
     if (startUpPositionFialized && globals->get_scenery()->scenery_available(geod, range)) {
         doInitAndBind();
+        if (_threaded) {
+            startThread();
+        }
     }
   }
 
@@ -222,15 +255,17 @@ void FDMShell::update(double dt)
 
   // AI aerodynamic wake interaction
   if (_ai_wake_enabled->getBoolValue()) {
-      for (FGAIBase* base : _ai_mgr->get_ai_list()) {
+      const SGVec3d pos = _impl->getCartPosition();
+      _wakeCandidates.clear();
+      _ai_mgr->spatialGrid().findInRange(pos, _max_radius_nm->getDoubleValue()*SG_NM_TO_METER,
+                                         _wakeCandidates);
+
+      for (const auto& candidate : _wakeCandidates) {
+          FGAIBase* base = candidate.object;
           try {
               if (base->isa(FGAIBase::otAircraft) ) {
-                  SGVec3d pos = _impl->getCartPosition();
-                  const SGSharedPtr<FGAIAircraft> aircraft = dynamic_cast<FGAIAircraft*>(base);
-                  double range = _ai_mgr->calcRangeFt(pos, aircraft)*SG_FEET_TO_METER;
-
-                  if (!aircraft->onGround() && aircraft->getSpeed() > 0.0
-                      && range < _max_radius_nm->getDoubleValue()*SG_NM_TO_METER) {
+                  const SGSharedPtr<FGAIAircraft> aircraft = static_cast<FGAIAircraft*>(base);
+                  if (!aircraft->onGround() && aircraft->getSpeed() > 0.0) {
                       _impl->add_ai_wake(aircraft);
                   }
               }
@@ -270,8 +305,10 @@ void FDMShell::update(double dt)
   switch(_replay_master->getIntValue())
   {
       case 0:
-          // normal FDM operation
-          _impl->update(dt);
+          // normal FDM operation, unless the thread does it
+          if (!_thread) {
+              _impl->update(dt);
+          }
           break;
       case 3:
           // resume FDM operation at current replay position
@@ -283,6 +320,10 @@ void FDMShell::update(double dt)
   }
 
   validateOutputProperties();
+
+  if (_thread) {
+      publishThreadStatistics();
+  }
 }
 
 FGInterface* FDMShell::getInterface() const
@@ -290,11 +331,109 @@ FGInterface* FDMShell::getInterface() const
     return _impl;
 }
 
+bool FDMShell::getSnapshot(FDMSnapshot& snapshot) const
+{
+    return _thread && _thread->latest(snapshot);
+}
+
+void FDMShell::startThread()
+{
+    _thread.reset(new FDMThread(_threadRateHz, [this](double dt) { stepThread(dt); }));
+
+    _timeScaleListener.reset(new TimeScaleListener(this));
+    _freeze_master->addChangeListener(_timeScaleListener.get());
+    _speed_up->addChangeListener(_timeScaleListener.get());
+    _replay_master->addChangeListener(_timeScaleListener.get());
+    updateThreadTimeScale();
+
+    _thread->start(_threadProps->getBoolValue("realtime", false),
+                   _threadProps->getDoubleValue("spin-us", 0.0),
+                   _threadProps->getDoubleValue("max-lag-sec", 0.1));
+    _threadProps->setBoolValue("running", true);
+    _threadStatsStamp.stamp();
+
+    SG_LOG(SG_FLIGHT, SG_INFO, "FDM runs on its own thread at " << _threadRateHz << " Hz");
+}
+
+void FDMShell::stopThread()
+{
+    if (!_thread) {
+        return;
+    }
+
+    _thread->stop();
+    _thread.reset();
+
+    _freeze_master->removeChangeListener(_timeScaleListener.get());
+    _speed_up->removeChangeListener(_timeScaleListener.get());
+    _replay_master->removeChangeListener(_timeScaleListener.get());
+    _timeScaleListener.reset();
+
+    _threadProps->setBoolValue("running", false);
+}
+
+// Called by the FDM thread, while the main loop is waiting or rendering.
+void FDMShell::stepThread(double dt)
+{
+    _impl->update(dt);
+
+    FDMSnapshot snapshot;
+    snapshot.position = _impl->getPosition();
+    snapshot.eulerAnglesRad = SGVec3d(_impl->get_Phi(), _impl->get_Theta(), _impl->get_Psi());
+    snapshot.velocityBodyFps = SGVec3d(_impl->get_U_body(), _impl->get_V_body(), _impl->get_W_body());
+    snapshot.omegaBodyRadSec = SGVec3d(_impl->get_P_body(), _impl->get_Q_body(), _impl->get_R_body());
+    snapshot.accelPilotBodyFps2 = SGVec3d(_impl->get_A_X_pilot(), _impl->get_A_Y_pilot(), _impl->get_A_Z_pilot());
+    snapshot.vTrueKts = _impl->get_V_true_kts();
+    snapshot.altitudeAglFt = _impl->get_Altitude_AGL();
+    _thread->publish(snapshot);
+}
+
+void FDMShell::updateThreadTimeScale()
+{
+    const bool stopped = _freeze_master->getBoolValue() ||
+                         (_replay_master->getIntValue() != 0) ||
+                         _nanCheckFailed;
+    _thread->setTimeScale(stopped ? 0.0 : _speed_up->getDoubleValue());
+}
+
+void FDMShell::publishThreadStatistics()
+{
+    if (_threadStatsStamp.elapsedMSec() < 1000) {
+        return;
+    }
+    _threadStatsStamp.stamp();
+
+    const FDMThread::Statistics stats = _thread->takeStatistics();
+    SGPropertyNode* node = _threadProps->getNode("stats", true);
+
+    // totals
+    node->setLongValue("steps", node->getLongValue("steps") + stats.steps);
+    node->setLongValue("overruns", node->getLongValue("overruns") + stats.overruns);
+    node->setLongValue("skipped-ticks", node->getLongValue("skipped-ticks") + stats.skippedTicks);
+
+    // over the last interval
+    node->setDoubleValue("rate-hz", stats.elapsedSec > 0.0 ? stats.steps / stats.elapsedSec : 0.0);
+    node->setDoubleValue("jitter-mean-us", stats.jitterMeanUSec);
+    node->setDoubleValue("jitter-max-us", stats.jitterMaxUSec);
+    node->setDoubleValue("step-mean-us", stats.stepMeanUSec);
+    node->setDoubleValue("step-max-us", stats.stepMaxUSec);
+
+    if (!_thread->isAlive()) {
+        _threadProps->setBoolValue("running", false);
+    }
+}
+
 void FDMShell::createImplementation()
 {
   assert(!_impl);
   
   double dt = 1.0 / fgGetInt("/sim/model-hz");
+  if (_threaded) {
+    // the FDM thread runs exactly one iteration per step
+    const int rateHz = _threadProps->getIntValue("rate-hz", fgGetInt("/sim/model-hz"));
+    _threadRateHz = SGMiscd::clip(rateHz, 10, 10000);
+    dt = 1.0 / _threadRateHz;
+  }
   string model = fgGetString("/sim/flight-model");
 
   bool fdmUnavailable = false;
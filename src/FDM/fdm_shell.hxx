@@ -23,14 +23,20 @@
 #ifndef FG_FDM_SHELL_HXX
 #define FG_FDM_SHELL_HXX
 
+#include <memory>
+
 #include <simgear/math/SGGeod.hxx>
 #include <simgear/structure/subsystem_mgr.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include "TankProperties.hxx"
+#include "AIModel/AISpatialGrid.hxx"
 
 // forward decls
 class FGInterface;
 class FGAIManager;
+class FDMThread;
+struct FDMSnapshot;
 
 /**
  * Wrap an FDM implementation in a subsystem with standard semantics
@@ -39,6 +45,11 @@ class FGAIManager;
  *
  * This class also provides the factory method which creates the
  * specific FDM class (createImplementation)
+ *
+ * With /sim/fdm-thread/enabled set at initialisation, the FDM is stepped
+ * by an FDMThread at /sim/fdm-thread/rate-hz instead of in update(), which
+ * then only passes the environment to the FDM and publishes the thread's
+ * jitter and overrun statistics.
  */
 class FDMShell : public SGSubsystem
 {
@@ -60,6 +71,12 @@ public:
 
     FGInterface* getInterface() const;
 
+    /**
+     * The outputs of the latest step of the FDM thread; false if there is
+     * no thread, or it has not stepped yet. May be called from any thread.
+     */
+    bool getSnapshot(FDMSnapshot& snapshot) const;
+
 private:
     void createImplementation();
 
@@ -67,6 +84,14 @@ private:
 
     void doInitAndBind();
 
+    void startThread();
+    void stopThread();
+    void stepThread(double dt);
+    void updateThreadTimeScale();
+    void publishThreadStatistics();
+
+    class TimeScaleListener;
+
 private:
     TankPropertiesList _tankProperties;
     SGSharedPtr<FGInterface> _impl;
@@ -85,6 +110,15 @@ private:
     SGSharedPtr<FGAIManager> _ai_mgr;
     SGPropertyNode_ptr _max_radius_nm;
     SGPropertyNode_ptr _ai_wake_enabled;
+    FGAISpatialGrid::ResultList _wakeCandidates;
+
+    SGPropertyNode_ptr _threadProps;
+    SGPropertyNode_ptr _freeze_master, _speed_up;
+    bool _threaded = false;
+    double _threadRateHz = 0.0;
+    std::unique_ptr<FDMThread> _thread;
+    std::unique_ptr<TimeScaleListener> _timeScaleListener;
+    SGTimeStamp _threadStatsStamp;
 };
 
 #endif // of FG_FDM_SHELL_HXX
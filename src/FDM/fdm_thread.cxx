@@ -0,0 +1,290 @@
+// fdm_thread.cxx -- step an FDM at a fixed rate on a dedicated thread
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "fdm_thread.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <exception>
+
+#if !defined(_WIN32)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+#include <simgear/debug/logstream.hxx>
+
+std::atomic<int> FDMThread::s_running{0};
+std::atomic<int> FDMThread::s_stepsPending{0};
+
+namespace {
+
+double toUSec(std::chrono::steady_clock::duration d)
+{
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+} // of anonymous namespace
+
+FDMThread::FDMThread(double rateHz, const StepFunc& step) :
+    _rateHz(rateHz),
+    _step(step)
+{
+}
+
+FDMThread::~FDMThread()
+{
+    stop();
+}
+
+std::timed_mutex& FDMThread::mainLoopMutex()
+{
+    static std::timed_mutex mutex;
+    return mutex;
+}
+
+void FDMThread::yieldMainLoop()
+{
+    // the mutex is not fair, so without this the main loop could take it
+    // again right away and starve the thread
+    while (s_stepsPending.load() > 0) {
+        std::this_thread::yield();
+    }
+}
+
+void FDMThread::start(bool realtime, double spinUSec, double maxLagSec)
+{
+    if (_thread.joinable()) {
+        return;
+    }
+
+    _realtime = realtime;
+    _spinUSec = std::max(0.0, spinUSec);
+    _maxLagSec = std::max(0.0, maxLagSec);
+    _stop = false;
+    _alive = true;
+
+    {
+        std::lock_guard<std::mutex> g(_statsLock);
+        _stats = Statistics();
+        _jitterSumUSec = _stepSumUSec = 0.0;
+        _statsStart = Clock::now();
+    }
+
+    ++s_running;
+    _thread = std::thread(&FDMThread::run, this);
+}
+
+void FDMThread::stop()
+{
+    if (!_thread.joinable()) {
+        return;
+    }
+
+    _stop = true;
+    _thread.join();
+    --s_running;
+}
+
+void FDMThread::setTimeScale(double scale)
+{
+    _timeScale.store(std::max(0.0, scale), std::memory_order_relaxed);
+}
+
+FDMThread::Statistics FDMThread::takeStatistics()
+{
+    std::lock_guard<std::mutex> g(_statsLock);
+    Statistics result = _stats;
+
+    const Clock::time_point now = Clock::now();
+    result.elapsedSec = toUSec(now - _statsStart) * 1e-6;
+    result.jitterMeanUSec = result.ticks ? _jitterSumUSec / result.ticks : 0.0;
+    result.stepMeanUSec = result.steps ? _stepSumUSec / result.steps : 0.0;
+
+    _stats = Statistics();
+    _jitterSumUSec = _stepSumUSec = 0.0;
+    _statsStart = now;
+    return result;
+}
+
+void FDMThread::publish(const FDMSnapshot& snapshot)
+{
+    // only the thread writes, so the back buffer is not being read
+    FDMSnapshot& back = _snapshots[1 - _front];
+    back = snapshot;
+    back.step = _stepCount + 1;
+    back.simTimeSec = back.step / _rateHz;
+
+    std::lock_guard<std::mutex> g(_snapshotLock);
+    _front = 1 - _front;
+    _havePublished = true;
+}
+
+bool FDMThread::latest(FDMSnapshot& snapshot) const
+{
+    std::lock_guard<std::mutex> g(_snapshotLock);
+    if (!_havePublished) {
+        return false;
+    }
+
+    snapshot = _snapshots[_front];
+    return true;
+}
+
+bool FDMThread::lockMainLoop()
+{
+    // rather than lock(), so that stop() may be called by the main loop
+    while (!_stop) {
+        if (mainLoopMutex().try_lock_for(std::chrono::milliseconds(1))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FDMThread::sleepUntil(Clock::time_point t) const
+{
+    if (_spinUSec <= 0.0) {
+        std::this_thread::sleep_until(t);
+        return;
+    }
+
+    const auto spin = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::micro>(_spinUSec));
+    std::this_thread::sleep_until(t - spin);
+    while ((Clock::now() < t) && !_stop) {
+        // busy wait for the last bit
+    }
+}
+
+void FDMThread::setRealtimePriority()
+{
+#if defined(_WIN32)
+    SG_LOG(SG_FLIGHT, SG_WARN, "FDM thread: real-time priority is not supported on this platform");
+#else
+    sched_param param;
+    param.sched_priority = (sched_get_priority_min(SCHED_FIFO) +
+                            sched_get_priority_max(SCHED_FIFO)) / 2;
+    const int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err) {
+        SG_LOG(SG_FLIGHT, SG_WARN, "FDM thread: could not set a real-time priority: "
+                                       << strerror(err));
+    }
+#endif
+}
+
+void FDMThread::run()
+{
+    if (_realtime) {
+        setRealtimePriority();
+    }
+
+    const double stepDt = 1.0 / _rateHz;
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(stepDt));
+    const int64_t maxLagTicks = std::max<int64_t>(1, std::llround(_maxLagSec * _rateHz));
+
+    double owedSteps = 0.0; // fractions of a step left over by the time scale
+    Clock::time_point due = Clock::now() + period;
+
+    while (!_stop) {
+        sleepUntil(due);
+        if (_stop) {
+            break;
+        }
+
+        // handle every tick which has fallen due in one go
+        int64_t ticks = 1 + (Clock::now() - due) / period;
+        uint64_t skipped = 0;
+        if (ticks > maxLagTicks) {
+            skipped = ticks - maxLagTicks;
+            due += skipped * period;
+            ticks = maxLagTicks;
+        }
+
+        owedSteps += ticks * _timeScale.load(std::memory_order_relaxed);
+        const int64_t steps = static_cast<int64_t>(owedSteps);
+        owedSteps -= steps;
+
+        Clock::time_point started = Clock::now();
+        uint64_t done = 0;
+        double stepSumUSec = 0.0, stepMaxUSec = 0.0;
+        bool failed = false;
+        if (steps > 0) {
+            ++s_stepsPending;
+        }
+        for (int64_t i = 0; (i < steps) && !_stop; ++i) {
+            if (!lockMainLoop()) {
+                break;
+            }
+
+            const Clock::time_point t0 = Clock::now();
+            if (i == 0) {
+                started = t0;
+            }
+
+            try {
+                _step(stepDt);
+            } catch (std::exception& e) {
+                SG_LOG(SG_FLIGHT, SG_ALERT, "FDM thread: step failed, stopping: " << e.what());
+                failed = true;
+            }
+
+            const double stepUSec = toUSec(Clock::now() - t0);
+            mainLoopMutex().unlock();
+
+            if (failed) {
+                break;
+            }
+
+            ++_stepCount;
+            ++done;
+            stepSumUSec += stepUSec;
+            stepMaxUSec = std::max(stepMaxUSec, stepUSec);
+        }
+
+        if (steps > 0) {
+            --s_stepsPending;
+        }
+
+        const double jitterUSec = toUSec(started - due);
+        due += ticks * period;
+        const bool overrun = Clock::now() > due;
+
+        {
+            std::lock_guard<std::mutex> g(_statsLock);
+            _stats.ticks += ticks;
+            _stats.steps += done;
+            _stats.overruns += overrun ? 1 : 0;
+            _stats.skippedTicks += skipped;
+            _stats.jitterMaxUSec = std::max(_stats.jitterMaxUSec, jitterUSec);
+            _stats.stepMaxUSec = std::max(_stats.stepMaxUSec, stepMaxUSec);
+            _jitterSumUSec += jitterUSec * ticks;
+            _stepSumUSec += stepSumUSec;
+        }
+
+        if (failed) {
+            break;
+        }
+    }
+
+    _alive = false;
+}
@@ -0,0 +1,158 @@
+// fdm_thread.hxx -- step an FDM at a fixed rate on a dedicated thread
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef FG_FDM_THREAD_HXX
+#define FG_FDM_THREAD_HXX
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <simgear/math/SGMath.hxx>
+
+/**
+ * The outputs of one FDM step, for readers on other threads such as
+ * motion platform or hardware-in-the-loop drivers.
+ */
+struct FDMSnapshot
+{
+    uint64_t step = 0;          ///< steps since the thread was started
+    double simTimeSec = 0.0;    ///< FDM time since the thread was started
+    SGGeod position;
+    SGVec3d eulerAnglesRad;     ///< phi, theta, psi
+    SGVec3d velocityBodyFps;    ///< u, v, w
+    SGVec3d omegaBodyRadSec;    ///< p, q, r
+    SGVec3d accelPilotBodyFps2; ///< at the pilot's eye point
+    double vTrueKts = 0.0;
+    double altitudeAglFt = 0.0;
+};
+
+/**
+ * Steps an FDM at a fixed rate on a dedicated thread.
+ *
+ * The thread and the main loop take turns on the FDM and the property tree:
+ * the main loop holds mainLoopMutex() for a whole frame, including cull and
+ * draw, which still read the property tree; the thread holds it for each
+ * step. Between frames, yieldMainLoop() lets the steps which have fallen due
+ * run back to back, up to maxLagSec; older ones are skipped. The FDM thus
+ * keeps its fixed step size and rate on average however long a frame takes.
+ *
+ * After each step, the step function may publish() the outputs, which
+ * latest() hands to any thread without waiting for the main loop.
+ */
+class FDMThread
+{
+public:
+    typedef std::function<void(double dt)> StepFunc;
+
+    /// Counted since the previous takeStatistics().
+    struct Statistics
+    {
+        uint64_t ticks = 0;
+        uint64_t steps = 0;
+        uint64_t overruns = 0;     ///< ticks finishing after the next one was due
+        uint64_t skippedTicks = 0; ///< dropped for being more than maxLagSec late
+        double jitterMeanUSec = 0.0; ///< delay between a tick falling due and its first step
+        double jitterMaxUSec = 0.0;
+        double stepMeanUSec = 0.0;
+        double stepMaxUSec = 0.0;
+        double elapsedSec = 0.0;
+    };
+
+    FDMThread(double rateHz, const StepFunc& step);
+    ~FDMThread();
+
+    FDMThread(const FDMThread&) = delete;
+    FDMThread& operator=(const FDMThread&) = delete;
+
+    double rateHz() const { return _rateHz; }
+
+    /**
+     * @param realtime  request a real-time scheduling priority
+     * @param spinUSec  busy-wait for this long before each tick, rather
+     *                  than relying on the resolution of the OS timer
+     * @param maxLagSec how far the thread may fall behind before it skips
+     *                  ticks
+     */
+    void start(bool realtime = false, double spinUSec = 0.0, double maxLagSec = 0.1);
+
+    /// Stops and joins the thread; may be called with mainLoopMutex() held.
+    void stop();
+
+    bool isAlive() const { return _alive; }
+
+    /// Steps per tick, e.g. the simulation speed-up; zero pauses the FDM.
+    void setTimeScale(double scale);
+
+    Statistics takeStatistics();
+
+    /// Called from the step function.
+    void publish(const FDMSnapshot& snapshot);
+
+    /// The snapshot of the latest step; false while there is none yet.
+    bool latest(FDMSnapshot& snapshot) const;
+
+    /// Held by the main loop whenever the FDM must not be stepped.
+    static std::timed_mutex& mainLoopMutex();
+
+    /// Called by the main loop between frames, before it takes
+    /// mainLoopMutex(): waits until the steps which are due have run.
+    static void yieldMainLoop();
+
+    /// Whether any FDM thread is running.
+    static bool isRunning() { return s_running.load(std::memory_order_relaxed) > 0; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void run();
+    bool lockMainLoop();
+    void sleepUntil(Clock::time_point t) const;
+    void setRealtimePriority();
+
+    const double _rateHz;
+    const StepFunc _step;
+
+    std::thread _thread;
+    std::atomic<bool> _stop{false};
+    std::atomic<bool> _alive{false};
+    std::atomic<double> _timeScale{1.0};
+    bool _realtime = false;
+    double _spinUSec = 0.0;
+    double _maxLagSec = 0.1;
+
+    uint64_t _stepCount = 0; ///< only used by the thread
+
+    mutable std::mutex _statsLock;
+    Statistics _stats;
+    double _jitterSumUSec = 0.0;
+    double _stepSumUSec = 0.0;
+    Clock::time_point _statsStart;
+
+    // double buffered snapshot: the thread fills the back one and then swaps
+    mutable std::mutex _snapshotLock;
+    FDMSnapshot _snapshots[2];
+    int _front = 0;
+    bool _havePublished = false;
+
+    static std::atomic<int> s_running;
+    static std::atomic<int> s_stepsPending; ///< threads with steps due
+};
+
+#endif // of FG_FDM_THREAD_HXX
@@ -141,6 +141,8 @@ FGInterface::common_init ()
     set_inited( true );
 
     ground_cache.set_cache_time_offset(globals->get_sim_time_sec());
+    // a reset or reposition must not reuse the scenery around the old position
+    ground_cache.invalidate_regions();
 
     // Set initial position
     SG_LOG( SG_FLIGHT, SG_INFO, "...initializing position..." );
@@ -422,6 +424,22 @@ FGInterface::bind ()
 
   _tiedProperties.Tie("/accelerations/n-z-cg-fps_sec",
                       this, &FGInterface::get_N_Z_cg); // read-only
+
+  // Ground cache statistics
+  _tiedProperties.Tie("/fdm/ground-cache/build-count", &ground_cache,
+                      &FGGroundCache::get_build_count); // read-only
+  _tiedProperties.Tie("/fdm/ground-cache/build-time-sec", &ground_cache,
+                      &FGGroundCache::get_build_time_sec); // read-only
+  _tiedProperties.Tie("/fdm/ground-cache/max-build-time-sec", &ground_cache,
+                      &FGGroundCache::get_max_build_time_sec); // read-only
+  _tiedProperties.Tie("/fdm/ground-cache/lookup-count", &ground_cache,
+                      &FGGroundCache::get_lookup_count); // read-only
+  _tiedProperties.Tie("/fdm/ground-cache/lookup-time-sec", &ground_cache,
+                      &FGGroundCache::get_lookup_time_sec); // read-only
+  _tiedProperties.Tie("/fdm/ground-cache/region-hit-count", &ground_cache,
+                      &FGGroundCache::get_region_hit_count); // read-only
+  _tiedProperties.Tie("/fdm/ground-cache/num-regions", &ground_cache,
+                      &FGGroundCache::get_num_regions); // read-only
 }
 
 
@@ -758,6 +776,26 @@ FGInterface::get_agl_m(double t, const double pt[3], double max_altoff,
   return ret;
 }
 
+void
+FGInterface::get_agl_m(double t, FGGroundCache::AglQuery* queries,
+                       unsigned count, double max_altoff)
+{
+  SGVec3d offset = max_altoff*ground_cache.get_down();
+  for (unsigned i = 0; i < count; ++i)
+    queries[i].pt -= offset;
+
+  ground_cache.get_agl(t, queries, count);
+
+  for (unsigned i = 0; i < count; ++i) {
+    FGGroundCache::AglQuery& query = queries[i];
+    // correct the linear velocity, since the line intersector delivers
+    // values for the start point and the get_agl function should
+    // traditionally deliver for the contact point
+    query.linearVel += cross(query.angularVel, query.contact - query.pt);
+    query.pt += offset;
+  }
+}
+
 bool
 FGInterface::get_agl_ft(double t, const double pt[3], double max_altoff,
                         double contact[3], double normal[3],
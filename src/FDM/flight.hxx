@@ -212,6 +212,9 @@ class FGInterface : public SGSubsystem
     // the ground cache object itself.
     FGGroundCache ground_cache;
 
+    // test class is a friend so it can fill the ground cache directly
+    friend class GroundCacheTests;
+
     AIWakeGroup wake_group;
 
     void set_A_X_pilot(double x)
@@ -721,6 +724,11 @@ public:
                     double contact[3], double normal[3], double linearVel[3],
                     double angularVel[3], simgear::BVHMaterial const*& material,
                     simgear::BVHNode::Id& id);
+    // Batched variant of get_agl_m for count points at once, see
+    // FGGroundCache::get_agl. The pt members of the queries are moved down
+    // by max_altoff like in get_agl_m and are left unchanged on return.
+    void get_agl_m(double t, FGGroundCache::AglQuery* queries, unsigned count,
+                   double max_altoff);
     double get_groundlevel_m(double lat, double lon, double alt);
     double get_groundlevel_m(const SGGeod& geod);
 
@@ -26,6 +26,8 @@
 
 #include "groundcache.hxx"
 
+#include <algorithm>
+#include <cstdint>
 #include <utility>
 
 #include <osg/Drawable>
@@ -72,11 +74,37 @@
 
 using namespace simgear;
 
+namespace {
+// Maximum number of static regions kept around.
+const unsigned maxRegions = 3;
+// Static regions older than this are collected again, so that scenery
+// tiles that were loaded in the meantime show up in the cache.
+const double maxRegionAge = 5;
+// New regions are stretched along the velocity vector to cover that many
+// seconds of flight.
+const double regionLookahead = 2;
+// Additional margin around the requested ball and the maximum region size.
+const double minRegionMargin = 50;
+const double maxRegionRadius = 2000;
+}
+
 class FGGroundCache::CacheFill : public osg::NodeVisitor {
 public:
+    enum Mode {
+        // Collect everything, moving and static geometry
+        AllGeometry,
+        // Only collect geometry that is not below a velocity transform
+        StaticGeometry,
+        // Only collect geometry below a velocity transform
+        MovingGeometry
+    };
+
     CacheFill(const SGVec3d& center, const SGVec3d& down, const double& radius,
-              const double& startTime, const double& endTime) :
+              const double& startTime, const double& endTime,
+              Mode mode = AllGeometry) :
         osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ACTIVE_CHILDREN),
+        _mode(mode),
+        _movingDepth(0),
         _center(center),
         _down(down),
         _radius(radius),
@@ -144,6 +172,8 @@ public:
 
         // Look for a velocity note
         const SGSceneUserData::Velocity* velocity = getVelocity(transform);
+        if (velocity && _mode == StaticGeometry)
+            return;
 
         SGVec3d center = _center;
         SGVec3d down = _down;
@@ -175,8 +205,12 @@ public:
         simgear::BVHSubTreeCollector::NodeList parentNodeList;
         mSubTreeCollector.pushNodeList(parentNodeList);
 
+        if (velocity)
+            ++_movingDepth;
         addBoundingVolume(transform);
         traverse(transform);
+        if (velocity)
+            --_movingDepth;
 
         if (mSubTreeCollector.haveChildren()) {
             if (velocity) {
@@ -240,7 +274,7 @@ public:
         if (!bvNode)
             return;
 
-        // Find a croase ground intersection 
+        // Find a coarse ground intersection 
         SGLineSegmentd line(_center + _radius*_down, _center + _maxDown*_down);
         simgear::BVHLineSegmentVisitor lineSegmentVisitor(line, _startTime);
         bvNode->accept(lineSegmentVisitor);
@@ -251,6 +285,11 @@ public:
             _haveHit = true;
         }
 
+        // The static scenery is taken from elsewhere, but we still want the
+        // coarse ground intersection above.
+        if (_mode == MovingGeometry && _movingDepth == 0)
+            return;
+
         // Get that part of the local bv tree that intersects our sphere
         // of interrest.
         mSubTreeCollector.setSphere(SGSphered(_center, _radius));
@@ -279,6 +318,9 @@ public:
     { return _material; }
     
 private:
+    Mode _mode;
+    unsigned _movingDepth;
+
     SGVec3d _center;
     SGVec3d _down;
     double _radius;
@@ -301,13 +343,23 @@ FGGroundCache::FGGroundCache() :
     reference_wgs84_point(SGVec3d(0, 0, 0)),
     reference_vehicle_radius(0),
     down(0.0, 0.0, 0.0),
-    found_ground(false)
+    found_ground(false),
+    _regionUseCounter(0),
+    _lastPoint(SGVec3d(0, 0, 0)),
+    _lastTime(0),
+    _haveLastPoint(false),
+    _lookupTime(SGTimeStamp::fromSec(0.0)),
+    _lookupCount(0),
+    _buildTime(SGTimeStamp::fromSec(0.0)),
+    _maxBuildTime(SGTimeStamp::fromSec(0.0)),
+    _buildCount(0),
+    _regionHitCount(0)
 {
 #ifdef GROUNDCACHE_DEBUG
-    _lookupTime = SGTimeStamp::fromSec(0.0);
-    _lookupCount = 0;
-    _buildTime = SGTimeStamp::fromSec(0.0);
-    _buildCount = 0;
+    _debugLookupTime = SGTimeStamp::fromSec(0.0);
+    _debugLookupCount = 0;
+    _debugBuildTime = SGTimeStamp::fromSec(0.0);
+    _debugBuildCount = 0;
 #endif
 }
 
@@ -315,6 +367,81 @@ FGGroundCache::~FGGroundCache()
 {
 }
 
+void
+FGGroundCache::invalidate_regions()
+{
+    _regions.clear();
+}
+
+const FGGroundCache::Region*
+FGGroundCache::find_region(const SGVec3d& pt, double rad, double t)
+{
+    for (auto& region : _regions) {
+        // Regions are built for a sim time, if the simulation was reset
+        // or the region got too old, rebuild.
+        if (t < region.createTime || region.createTime + maxRegionAge < t)
+            continue;
+        double maxDist = region.sphere.getRadius() - rad;
+        if (maxDist < 0)
+            continue;
+        if (maxDist*maxDist < distSqr(region.sphere.getCenter(), pt))
+            continue;
+
+        region.lastUsed = ++_regionUseCounter;
+        return &region;
+    }
+    return 0;
+}
+
+const FGGroundCache::Region*
+FGGroundCache::build_region(const SGVec3d& pt, double rad,
+                            const SGVec3d& velocity, double t)
+{
+    // Stretch the region along the flight path, so that the region
+    // already contains the scenery we will need within the next seconds.
+    SGVec3d offset = (0.5*regionLookahead)*velocity;
+    double regionRadius = rad + norm(offset)
+        + SGMiscd::max(minRegionMargin, rad);
+    if (maxRegionRadius < regionRadius) {
+        // Too fast for a region of sensible size, just cover the ball
+        // with some margin around.
+        offset = SGVec3d::zeros();
+        regionRadius = SGMiscd::max(rad + minRegionMargin, maxRegionRadius);
+    }
+    SGVec3d center = pt + offset;
+
+    SGQuatd hlToEc = SGQuatd::fromLonLat(SGGeod::fromCart(center));
+    SGVec3d regionDown = hlToEc.rotate(SGVec3d(0, 0, 1));
+
+    CacheFill subtreeCollector(center, regionDown, regionRadius, t, t,
+                               CacheFill::StaticGeometry);
+    globals->get_scenery()->get_scene_graph()->accept(subtreeCollector);
+
+    SGSharedPtr<simgear::BVHNode> bvhTree = subtreeCollector.getBVHNode();
+    // Do not remember regions without scenery, these are most likely
+    // regions where the tiles are not yet loaded.
+    if (!bvhTree || !subtreeCollector.getHaveElevationBelowCache())
+        return 0;
+
+    Region* region = 0;
+    if (_regions.size() < maxRegions) {
+        _regions.push_back(Region());
+        region = &_regions.back();
+    } else {
+        // Replace the least recently used region
+        region = &_regions.front();
+        for (auto& r : _regions) {
+            if (r.lastUsed < region->lastUsed)
+                region = &r;
+        }
+    }
+    region->sphere = SGSphered(center, regionRadius);
+    region->createTime = t;
+    region->lastUsed = ++_regionUseCounter;
+    region->bvhTree = bvhTree;
+    return region;
+}
+
 bool
 FGGroundCache::prepare_ground_cache(double startSimTime, double endSimTime,
                                     const SGVec3d& pt, double rad)
@@ -324,9 +451,7 @@ FGGroundCache::prepare_ground_cache(double startSimTime, double endSimTime,
         rad = 10000.0;
     }
     
-#ifdef GROUNDCACHE_DEBUG
     SGTimeStamp t0 = SGTimeStamp::now();
-#endif
 
     // Empty cache.
     found_ground = false;
@@ -358,9 +483,43 @@ FGGroundCache::prepare_ground_cache(double startSimTime, double endSimTime,
     // Get the ground cache, that is a local collision tree of the environment
     startSimTime += cache_time_offset;
     endSimTime += cache_time_offset;
-    CacheFill subtreeCollector(pt, down, rad, startSimTime, endSimTime);
+
+    // Estimate where we are heading to, that is used to place new regions.
+    SGVec3d velocity = SGVec3d::zeros();
+    if (_haveLastPoint && _lastTime < startSimTime)
+        velocity = (pt - _lastPoint)/(startSimTime - _lastTime);
+    // Do not extrapolate from position resets.
+    if (!(norm(velocity) < 2000))
+        velocity = SGVec3d::zeros();
+    _lastPoint = pt;
+    _lastTime = startSimTime;
+    _haveLastPoint = true;
+
+    // The static part of the scenery comes from one of the cached regions.
+    const Region* region = find_region(pt, rad, startSimTime);
+    if (region)
+        ++_regionHitCount;
+    else
+        region = build_region(pt, rad, velocity, startSimTime);
+
+    // Moving geometry is always collected freshly for the current time
+    // interval. If we have no region, collect everything.
+    CacheFill::Mode mode = region ? CacheFill::MovingGeometry
+                                  : CacheFill::AllGeometry;
+    CacheFill subtreeCollector(pt, down, rad, startSimTime, endSimTime, mode);
     globals->get_scenery()->get_scene_graph()->accept(subtreeCollector);
-    _localBvhTree = subtreeCollector.getBVHNode();
+    SGSharedPtr<simgear::BVHNode> movingTree = subtreeCollector.getBVHNode();
+
+    if (region && movingTree) {
+        simgear::BVHGroup* group = new simgear::BVHGroup;
+        group->addChild(region->bvhTree);
+        group->addChild(movingTree);
+        _localBvhTree = group;
+    } else if (region) {
+        _localBvhTree = region->bvhTree;
+    } else {
+        _localBvhTree = movingTree;
+    }
 
     if (subtreeCollector.getHaveElevationBelowCache()) {
         // Use the altitude value below the cache that we gathered during
@@ -370,7 +529,7 @@ FGGroundCache::prepare_ground_cache(double startSimTime, double endSimTime,
         found_ground = true;
     } else if (_localBvhTree) {
         // We have nothing below us, so try starting with the lowest point
-        // upwards for a croase altitude value
+        // upwards for a coarse altitude value
         SGLineSegmentd line(pt + reference_vehicle_radius*down, pt - 1e3*down);
         simgear::BVHLineSegmentVisitor lineSegmentVisitor(line, startSimTime);
         _localBvhTree->accept(lineSegmentVisitor);
@@ -400,24 +559,30 @@ FGGroundCache::prepare_ground_cache(double startSimTime, double endSimTime,
     //    SG_LOG(SG_FLIGHT, SG_WARN, "prepare_ground_cache(): trying to build "
     //           "cache without any scenery below the aircraft");
 
-#ifdef GROUNDCACHE_DEBUG
     t0 = SGTimeStamp::now() - t0;
     _buildTime += t0;
     _buildCount++;
+    if (_maxBuildTime < t0)
+        _maxBuildTime = t0;
+
+#ifdef GROUNDCACHE_DEBUG
+    _debugBuildTime += t0;
+    _debugBuildCount++;
 
-    if (_buildCount > 60) {
+    if (_debugBuildCount > 60) {
         double buildTime = 0;
-        if (_buildCount)
-            buildTime = _buildTime.toSecs()/_buildCount;
+        if (_debugBuildCount)
+            buildTime = _debugBuildTime.toSecs()/_debugBuildCount;
         double lookupTime = 0;
-        if (_lookupCount)
-            lookupTime = _lookupTime.toSecs()/_lookupCount;
-        _buildTime = SGTimeStamp::fromSec(0.0);
-        _buildCount = 0;
-        _lookupTime = SGTimeStamp::fromSec(0.0);
-        _lookupCount = 0;
+        if (_debugLookupCount)
+            lookupTime = _debugLookupTime.toSecs()/_debugLookupCount;
+        _debugBuildTime = SGTimeStamp::fromSec(0.0);
+        _debugBuildCount = 0;
+        _debugLookupTime = SGTimeStamp::fromSec(0.0);
+        _debugLookupCount = 0;
         SG_LOG(SG_FLIGHT, SG_ALERT, "build time = " << buildTime
-               << ", lookup Time = " << lookupTime);
+               << ", lookup Time = " << lookupTime
+               << ", region hits = " << _regionHitCount);
     }
 
     if (!_group.valid()) {
@@ -702,9 +867,7 @@ FGGroundCache::get_agl(double t, const SGVec3d& pt, SGVec3d& contact,
                        SGVec3d& normal, SGVec3d& linearVel, SGVec3d& angularVel,
                        simgear::BVHNode::Id& id, const simgear::BVHMaterial*& material)
 {
-#ifdef GROUNDCACHE_DEBUG
     SGTimeStamp t0 = SGTimeStamp::now();
-#endif
 
     // Just set up a ground intersection query for the given point
     SGLineSegmentd line(pt, pt + 10*reference_vehicle_radius*down);
@@ -713,10 +876,12 @@ FGGroundCache::get_agl(double t, const SGVec3d& pt, SGVec3d& contact,
     if (_localBvhTree)
         _localBvhTree->accept(lineSegmentVisitor);
 
-#ifdef GROUNDCACHE_DEBUG
     t0 = SGTimeStamp::now() - t0;
     _lookupTime += t0;
     _lookupCount++;
+#ifdef GROUNDCACHE_DEBUG
+    _debugLookupTime += t0;
+    _debugLookupCount++;
 #endif
 
     if (!lineSegmentVisitor.empty()) {
@@ -749,6 +914,265 @@ FGGroundCache::get_agl(double t, const SGVec3d& pt, SGVec3d& contact,
 }
 
 
+
+class FGGroundCache::BatchLineSegmentVisitor : public BVHVisitor {
+public:
+    // The active line segments of a subtree are tracked in a bit mask,
+    // so that is the maximum number of segments per traversal.
+    enum { MaxSegments = 64 };
+    typedef uint64_t Mask;
+
+    struct Segment {
+        SGLineSegmentd lineSegment;
+        SGVec3d normal;
+        SGVec3d linearVelocity;
+        SGVec3d angularVelocity;
+        const BVHMaterial* material;
+        BVHNode::Id id;
+        bool haveHit;
+    };
+
+    BatchLineSegmentVisitor(Segment* segments, unsigned count,
+                            const double& t) :
+        _segments(segments),
+        _count(count),
+        _time(t)
+    {
+        if (count < MaxSegments)
+            _mask = (Mask(1) << count) - 1;
+        else
+            _mask = ~Mask(0);
+    }
+
+    virtual void apply(BVHGroup& leaf)
+    {
+        Mask mask = _filter(leaf.getBoundingSphere());
+        if (!mask)
+            return;
+        Mask parentMask = _mask;
+        _mask = mask;
+        leaf.traverse(*this);
+        _mask = parentMask;
+    }
+    virtual void apply(BVHPageNode& leaf)
+    {
+        Mask mask = _filter(leaf.getBoundingSphere());
+        if (!mask)
+            return;
+        Mask parentMask = _mask;
+        _mask = mask;
+        leaf.traverse(*this);
+        _mask = parentMask;
+    }
+    virtual void apply(BVHTransform& transform)
+    {
+        Mask mask = _filter(transform.getBoundingSphere());
+        if (!mask)
+            return;
+
+        SGLineSegmentd lineSegments[MaxSegments];
+        bool haveHits[MaxSegments];
+        SGMatrixd toLocal = transform.getToLocalTransform();
+        for (unsigned i = 0; i < _count; ++i) {
+            if (!(mask & (Mask(1) << i)))
+                continue;
+            Segment& segment = _segments[i];
+            lineSegments[i] = segment.lineSegment;
+            haveHits[i] = segment.haveHit;
+            segment.lineSegment = segment.lineSegment.transform(toLocal);
+            segment.haveHit = false;
+        }
+
+        Mask parentMask = _mask;
+        _mask = mask;
+        transform.traverse(*this);
+        _mask = parentMask;
+
+        for (unsigned i = 0; i < _count; ++i) {
+            if (!(mask & (Mask(1) << i)))
+                continue;
+            Segment& segment = _segments[i];
+            if (segment.haveHit) {
+                segment.lineSegment = transform.lineSegmentToWorld(segment.lineSegment);
+                segment.normal = transform.vecToWorld(segment.normal);
+                segment.linearVelocity = transform.vecToWorld(segment.linearVelocity);
+                segment.angularVelocity = transform.vecToWorld(segment.angularVelocity);
+            } else {
+                segment.lineSegment = lineSegments[i];
+                segment.haveHit = haveHits[i];
+            }
+        }
+    }
+    virtual void apply(BVHMotionTransform& transform)
+    {
+        Mask mask = _filter(transform.getBoundingSphere());
+        if (!mask)
+            return;
+
+        SGLineSegmentd lineSegments[MaxSegments];
+        bool haveHits[MaxSegments];
+        SGMatrixd toLocal = transform.getToLocalTransform(_time);
+        for (unsigned i = 0; i < _count; ++i) {
+            if (!(mask & (Mask(1) << i)))
+                continue;
+            Segment& segment = _segments[i];
+            lineSegments[i] = segment.lineSegment;
+            haveHits[i] = segment.haveHit;
+            segment.lineSegment = segment.lineSegment.transform(toLocal);
+            segment.haveHit = false;
+        }
+
+        Mask parentMask = _mask;
+        _mask = mask;
+        transform.traverse(*this);
+        _mask = parentMask;
+
+        SGMatrixd toWorld = transform.getToWorldTransform(_time);
+        for (unsigned i = 0; i < _count; ++i) {
+            if (!(mask & (Mask(1) << i)))
+                continue;
+            Segment& segment = _segments[i];
+            if (segment.haveHit) {
+                segment.linearVelocity
+                    += transform.getLinearVelocityAt(segment.lineSegment.getStart());
+                segment.angularVelocity += transform.getAngularVelocity();
+                segment.linearVelocity = toWorld.xformVec(segment.linearVelocity);
+                segment.angularVelocity = toWorld.xformVec(segment.angularVelocity);
+                segment.normal = toWorld.xformVec(segment.normal);
+                segment.lineSegment = segment.lineSegment.transform(toWorld);
+                if (!segment.id)
+                    segment.id = transform.getId();
+            } else {
+                segment.lineSegment = lineSegments[i];
+                segment.haveHit = haveHits[i];
+            }
+        }
+    }
+    virtual void apply(BVHLineGeometry&) { }
+    virtual void apply(BVHStaticGeometry& node)
+    { node.traverse(*this); }
+
+    virtual void apply(const BVHStaticBinary& node, const BVHStaticData& data)
+    {
+        Mask mask = 0;
+        for (unsigned i = 0; i < _count; ++i) {
+            if (!(_mask & (Mask(1) << i)))
+                continue;
+            SGLineSegmentf lineSegment(_segments[i].lineSegment);
+            if (intersects(lineSegment, node.getBoundingBox()))
+                mask |= Mask(1) << i;
+        }
+        if (!mask)
+            return;
+        Mask parentMask = _mask;
+        _mask = mask;
+        node.traverse(*this, data);
+        _mask = parentMask;
+    }
+    virtual void apply(const BVHStaticTriangle& triangle,
+                       const BVHStaticData& data)
+    {
+        SGTrianglef tri = triangle.getTriangle(data);
+        for (unsigned i = 0; i < _count; ++i) {
+            if (!(_mask & (Mask(1) << i)))
+                continue;
+            Segment& segment = _segments[i];
+            SGVec3f point;
+            if (!intersects(point, tri, SGLineSegmentf(segment.lineSegment), 1e-4f))
+                continue;
+            // Shorten the segment, so that only nearer triangles can hit
+            segment.lineSegment = SGLineSegmentd(segment.lineSegment.getStart(),
+                                                 SGVec3d(point));
+            segment.normal = SGVec3d(tri.getNormal());
+            segment.linearVelocity = SGVec3d::zeros();
+            segment.angularVelocity = SGVec3d::zeros();
+            segment.material = data.getMaterial(triangle.getMaterialIndex());
+            segment.id = 0;
+            segment.haveHit = true;
+        }
+    }
+
+private:
+    Mask _filter(const SGSphered& sphere) const
+    {
+        Mask mask = 0;
+        for (unsigned i = 0; i < _count; ++i) {
+            if (!(_mask & (Mask(1) << i)))
+                continue;
+            if (intersects(_segments[i].lineSegment, sphere))
+                mask |= Mask(1) << i;
+        }
+        return mask;
+    }
+
+    Segment* _segments;
+    unsigned _count;
+    Mask _mask;
+    double _time;
+};
+
+void
+FGGroundCache::get_agl(double t, AglQuery* queries, unsigned count)
+{
+    SGTimeStamp t0 = SGTimeStamp::now();
+
+    t += cache_time_offset;
+    BatchLineSegmentVisitor::Segment segments[BatchLineSegmentVisitor::MaxSegments];
+    while (count) {
+        unsigned n = std::min(count, unsigned(BatchLineSegmentVisitor::MaxSegments));
+        // Set up the same ground intersection query as in get_agl
+        for (unsigned i = 0; i < n; ++i) {
+            const SGVec3d& pt = queries[i].pt;
+            segments[i].lineSegment =
+                SGLineSegmentd(pt, pt + 10*reference_vehicle_radius*down);
+            segments[i].material = 0;
+            segments[i].id = 0;
+            segments[i].haveHit = false;
+        }
+        BatchLineSegmentVisitor visitor(segments, n, t);
+        if (_localBvhTree)
+            _localBvhTree->accept(visitor);
+
+        for (unsigned i = 0; i < n; ++i) {
+            const BatchLineSegmentVisitor::Segment& segment = segments[i];
+            AglQuery& query = queries[i];
+            if (segment.haveHit) {
+                query.contact = segment.lineSegment.getEnd();
+                query.normal = normalize(segment.normal);
+                if (0 < dot(query.normal, down))
+                    query.normal = -query.normal;
+                query.linearVel = segment.linearVelocity;
+                query.angularVel = segment.angularVelocity;
+                query.material = segment.material;
+                query.id = segment.id;
+                query.found = true;
+            } else {
+                // Same fallback as in the single point get_agl
+                SGGeod geodPt = SGGeod::fromCart(query.pt);
+                geodPt.setElevationM(_altitude);
+                query.contact = SGVec3d::fromGeod(geodPt);
+                query.normal = -down;
+                query.linearVel = SGVec3d(0, 0, 0);
+                query.angularVel = SGVec3d(0, 0, 0);
+                query.material = _material;
+                query.id = 0;
+                query.found = found_ground;
+            }
+        }
+
+        queries += n;
+        count -= n;
+    }
+
+    t0 = SGTimeStamp::now() - t0;
+    _lookupTime += t0;
+    _lookupCount++;
+#ifdef GROUNDCACHE_DEBUG
+    _debugLookupTime += t0;
+    _debugLookupCount++;
+#endif
+}
+
 bool
 FGGroundCache::get_nearest(double t, const SGVec3d& pt, double maxDist,
                            SGVec3d& contact, SGVec3d& linearVel,
@@ -758,9 +1182,7 @@ FGGroundCache::get_nearest(double t, const SGVec3d& pt, double maxDist,
     if (!_localBvhTree)
         return false;
 
-#ifdef GROUNDCACHE_DEBUG
     SGTimeStamp t0 = SGTimeStamp::now();
-#endif
 
     // Just set up a ground intersection query for the given point
     SGSphered sphere(pt, maxDist);
@@ -768,10 +1190,12 @@ FGGroundCache::get_nearest(double t, const SGVec3d& pt, double maxDist,
     simgear::BVHNearestPointVisitor nearestPointVisitor(sphere, t);
     _localBvhTree->accept(nearestPointVisitor);
 
-#ifdef GROUNDCACHE_DEBUG
     t0 = SGTimeStamp::now() - t0;
     _lookupTime += t0;
     _lookupCount++;
+#ifdef GROUNDCACHE_DEBUG
+    _debugLookupTime += t0;
+    _debugLookupCount++;
 #endif
 
     if (nearestPointVisitor.empty())
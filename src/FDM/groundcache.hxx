@@ -29,12 +29,14 @@
 #include <simgear/math/SGGeometry.hxx>
 #include <simgear/bvh/BVHNode.hxx>
 #include <simgear/structure/SGSharedPtr.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <vector>
 
 // #define GROUNDCACHE_DEBUG
 #ifdef GROUNDCACHE_DEBUG
 #include <osg/Group>
 #include <osg/ref_ptr>
-#include <simgear/timing/timestamp.hxx>
 #endif
 
 namespace simgear {
@@ -92,6 +94,26 @@ public:
                  simgear::BVHNode::Id& id,
                  const simgear::BVHMaterial*& material);
 
+    // One point of a batched ground query, see below.
+    struct AglQuery {
+        // The query point, the only input value.
+        SGVec3d pt;
+        SGVec3d contact;
+        SGVec3d normal;
+        SGVec3d linearVel;
+        SGVec3d angularVel;
+        simgear::BVHNode::Id id;
+        const simgear::BVHMaterial* material;
+        // The return value of the equivalent single point get_agl call.
+        bool found;
+    };
+
+    // Does the same as get_agl above for count query points at once.
+    // The cache is walked once for up to 64 points instead of once per
+    // point, which pays off for the gear, hooks and contact points of
+    // the FDMs that are all queried at the same time.
+    void get_agl(double t, AglQuery* queries, unsigned count);
+
     bool get_nearest(double t, const SGVec3d& pt, double maxDist,
                      SGVec3d& contact, SGVec3d& linearVel, SGVec3d& angularVel,
                      simgear::BVHNode::Id& id,
@@ -111,12 +133,37 @@ public:
     // the wire end position.
     void release_wire(void);
 
+    // Drop all cached static regions, the next call to
+    // prepare_ground_cache will collect the scenery again.
+    void invalidate_regions();
+
+    // Statistics about cache builds and lookups, accumulated since
+    // construction. Times are in seconds.
+    int get_build_count() const
+    { return static_cast<int>(_buildCount); }
+    double get_build_time_sec() const
+    { return _buildTime.toSecs(); }
+    double get_max_build_time_sec() const
+    { return _maxBuildTime.toSecs(); }
+    int get_lookup_count() const
+    { return static_cast<int>(_lookupCount); }
+    double get_lookup_time_sec() const
+    { return _lookupTime.toSecs(); }
+    int get_region_hit_count() const
+    { return static_cast<int>(_regionHitCount); }
+    int get_num_regions() const
+    { return static_cast<int>(_regions.size()); }
+
 private:
+    // test class is a friend so it can install a synthetic scenery tree
+    friend class GroundCacheTests;
+
     class CacheFill;
     class BodyFinder;
     class CatapultFinder;
     class WireIntersector;
     class WireFinder;
+    class BatchLineSegmentVisitor;
 
     // Approximate ground radius.
     // In case the aircraft is too high above ground.
@@ -140,11 +187,41 @@ private:
 
     SGSharedPtr<simgear::BVHNode> _localBvhTree;
 
-#ifdef GROUNDCACHE_DEBUG
+    // A ball of static scenery that was collected once and is reused
+    // as long as the requested cache ball stays inside of it.
+    // Moving geometry like carrier decks is never part of a region,
+    // that is collected freshly on every prepare_ground_cache call.
+    struct Region {
+        SGSphered sphere;
+        double createTime;
+        unsigned lastUsed;
+        SGSharedPtr<simgear::BVHNode> bvhTree;
+    };
+    std::vector<Region> _regions;
+    unsigned _regionUseCounter;
+
+    // Used to estimate the vehicle velocity for stretching new regions
+    // along the flight path.
+    SGVec3d _lastPoint;
+    double _lastTime;
+    bool _haveLastPoint;
+
+    const Region* find_region(const SGVec3d& pt, double rad, double t);
+    const Region* build_region(const SGVec3d& pt, double rad,
+                               const SGVec3d& velocity, double t);
+
     SGTimeStamp _lookupTime;
     unsigned _lookupCount;
     SGTimeStamp _buildTime;
+    SGTimeStamp _maxBuildTime;
     unsigned _buildCount;
+    unsigned _regionHitCount;
+
+#ifdef GROUNDCACHE_DEBUG
+    SGTimeStamp _debugLookupTime;
+    unsigned _debugLookupCount;
+    SGTimeStamp _debugBuildTime;
+    unsigned _debugBuildCount;
 
     osg::ref_ptr<osg::Group> _group;
 #endif
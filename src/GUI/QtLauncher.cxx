@@ -176,12 +176,17 @@ bool initNavCache()
             
             auto it = std::find_if(progressStrings.begin(), progressStrings.end(), [phase]
                                    (const ProgressLabel& l) { return l.phase == phase; });
-            if (it == progressStrings.end()) {
-                rebuildProgress.setLabelText(baseLabel);
-            } else {
-                QString trans = qApp->translate("initNavCache", it->label);
-                rebuildProgress.setLabelText(trans);
+            QString label = baseLabel;
+            if (it != progressStrings.end()) {
+                label = qApp->translate("initNavCache", it->label);
+            }
+
+            // show how long the phase has been running, some take minutes
+            const unsigned int elapsedSec = cache->rebuildPhaseElapsedMSec() / 1000;
+            if (elapsedSec > 0) {
+                label += QString(" (%1 s)").arg(elapsedSec);
             }
+            rebuildProgress.setLabelText(label);
 
             if (phase == NavDataCache::REBUILD_UNKNOWN) {
                 rebuildProgress.setValue(0);
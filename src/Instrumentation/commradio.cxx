@@ -68,11 +68,21 @@ public:
 
   void setStationId(const string & stationId)
   {
+    if (_stationId == stationId)
+      return;
+
     _stationId = stationId;
+    prepareVoice();
   }
 
 
 private:
+  // pick the station's voice, speed and pitch for _synthesizeRequest
+  string selectVoice();
+  // create the station's synthesizer, which loads its voice in the
+  // background, before the first ATIS text arrives
+  void prepareVoice();
+
   SynthesizeRequest _synthesizeRequest;
   SGLockedQueue<SGSharedPtr<SGSoundSample> > _spokenAtis;
   string _stationId;
@@ -92,8 +102,6 @@ AtisSpeaker::~AtisSpeaker()
 }
 void AtisSpeaker::valueChanged(SGPropertyNode * node)
 {
-  using namespace simgear::strutils;
-
   if (!fgGetBool("/sim/sound/working", false))
     return;
 
@@ -101,6 +109,22 @@ void AtisSpeaker::valueChanged(SGPropertyNode * node)
   if (_synthesizeRequest.text == newText) return;
 
   _synthesizeRequest.text = newText;
+  string voice = selectVoice();
+
+  FGSoundManager * smgr = globals->get_subsystem<FGSoundManager>();
+  if (!smgr) {
+      return;
+  }
+
+  SG_LOG(SG_INSTR, SG_DEBUG,"node->getPath()=" << node->getPath() << " AtisSpeaker voice is " << voice );
+  FLITEVoiceSynthesizer * synthesizer = dynamic_cast<FLITEVoiceSynthesizer*>(smgr->getSynthesizer(voice));
+
+  synthesizer->synthesize(_synthesizeRequest);
+}
+
+string AtisSpeaker::selectVoice()
+{
+  using namespace simgear::strutils;
 
   string voice = "cmu_us_arctic_slt";
 
@@ -133,15 +157,18 @@ void AtisSpeaker::valueChanged(SGPropertyNode * node)
     }
   }
 
-  FGSoundManager * smgr = globals->get_subsystem<FGSoundManager>();
-  if (!smgr) {
-      return;
-  }
+  return voice;
+}
 
-  SG_LOG(SG_INSTR, SG_DEBUG,"node->getPath()=" << node->getPath() << " AtisSpeaker voice is " << voice );
-  FLITEVoiceSynthesizer * synthesizer = dynamic_cast<FLITEVoiceSynthesizer*>(smgr->getSynthesizer(voice));
+void AtisSpeaker::prepareVoice()
+{
+  if (_stationId.empty() || !fgGetBool("/sim/sound/working", false))
+    return;
 
-  synthesizer->synthesize(_synthesizeRequest);
+  FGSoundManager * smgr = globals->get_subsystem<FGSoundManager>();
+  if (smgr) {
+    smgr->getSynthesizer(selectVoice());
+  }
 }
 
 void AtisSpeaker::SoundSampleReady(SGSharedPtr<SGSoundSample> sample)
@@ -114,6 +114,7 @@ using std::string;
 //#define FEATURE_TCAS_DEBUG_ADV_GENERATOR
 //#define FEATURE_TCAS_DEBUG_PROPERTIES
 
+#include <AIModel/AIManager.hxx>
 #include <Main/fg_props.hxx>
 #include <Main/globals.hxx>
 #include "instrument_mgr.hxx"
@@ -584,49 +585,46 @@ TCAS::ThreatDetector::update(void)
 // If plane's transponder is enabled, return true with o_altFt set to
 // altitude. Otherwise return false.
 //
-static bool checkTransponderLocal(const SGPropertyNode* pModel, float velocityKt, float& o_altFt)
+static bool checkTransponderLocal(const FGTrafficEntry& model, float velocityKt, float& o_altFt)
 {
-    if (pModel->getBoolValue("controls/invisible", false /*default*/))
+    if (model.invisible)
     {
         // For MP aircraft (name='multiplayer') that are being ignored.
         return false;
     }
-    if (pModel->getNameString() == "aircraft")
+    if (model.typeName == "aircraft")
     {
         /* assume all non-MP and non-Swift (i.e. AI) aircraft have their transponder switched off while taxiing/parking
          * (at low speed) */
         if (velocityKt < 40.0)  return false;
-        o_altFt = pModel->getDoubleValue("position/altitude-ft");
+        o_altFt = model.position.getElevationFt();
         return true;
     }
-    o_altFt = pModel->getIntValue("instrumentation/transponder/altitude", -9999);
+    o_altFt = model.transponderAltitudeFt;
     // must have Mode C (altitude) transponder to be visible.
     // "-9999" is a special value used by src/Instrumentation/transponder.cxx to indicate the non-transmission of a value.
-    return (o_altFt != -9999);
+    return (o_altFt != FGTrafficEntry::NO_ALTITUDE);
 }
 
 /** Check if plane's transponder is enabled. */
 bool
-TCAS::ThreatDetector::checkTransponder(const SGPropertyNode* pModel, float velocityKt)
+TCAS::ThreatDetector::checkTransponder(const FGTrafficEntry& model, float velocityKt)
 {
     float altFt;
-    return checkTransponderLocal(pModel, velocityKt, altFt);
+    return checkTransponderLocal(model, velocityKt, altFt);
 }
 
 /** Check if plane is a threat. */
 int
-TCAS::ThreatDetector::checkThreat(int mode, const SGPropertyNode* pModel)
+TCAS::ThreatDetector::checkThreat(int mode, const FGTrafficEntry& model)
 {
 #ifdef FEATURE_TCAS_DEBUG_THREAT_DETECTOR
     checkCount++;
 #endif
-    if (!pModel->getBoolValue("valid", true))
-        return ThreatInvisible;
-
-    float velocityKt  = pModel->getDoubleValue("velocities/true-airspeed-kt");
+    float velocityKt  = model.trueAirspeedKt;
 
     float altFt;
-    if (!checkTransponderLocal(pModel, velocityKt, altFt))
+    if (!checkTransponderLocal(model, velocityKt, altFt))
         return ThreatInvisible;
 
     int threatLevel = ThreatNone;
@@ -637,9 +635,9 @@ TCAS::ThreatDetector::checkThreat(int mode, const SGPropertyNode* pModel)
         return threatLevel;
 
     // position data of current intruder
-    double lat        = pModel->getDoubleValue("position/latitude-deg");
-    double lon        = pModel->getDoubleValue("position/longitude-deg");
-    float heading     = pModel->getDoubleValue("orientation/true-heading-deg");
+    double lat        = model.position.getLatitudeDeg();
+    double lon        = model.position.getLongitudeDeg();
+    float heading     = model.headingDeg;
 
     double distanceNm, bearing;
     calcRangeBearing(self.lat, self.lon, lat, lon, distanceNm, bearing);
@@ -648,7 +646,7 @@ TCAS::ThreatDetector::checkThreat(int mode, const SGPropertyNode* pModel)
     if ((distanceNm > tcas->_lateralRange) || (distanceNm < 0))
         return threatLevel;
 
-    currentThreat.verticalFps = pModel->getDoubleValue("velocities/vertical-speed-fps");
+    currentThreat.verticalFps = model.verticalSpeedFps;
 
     /* Detect proximity targets
      * [TCASII]: "Any target that is less than 6 nmi in range and within +/-1200ft
@@ -669,7 +667,7 @@ TCAS::ThreatDetector::checkThreat(int mode, const SGPropertyNode* pModel)
 
     if (tcas->tracker.active())
     {
-        currentThreat.callsign = pModel->getStringValue("callsign");
+        currentThreat.callsign = model.callsign;
         currentThreat.isTracked = tcas->tracker.isTracked(currentThreat.callsign);
     }
     else
@@ -696,14 +694,14 @@ TCAS::ThreatDetector::checkThreat(int mode, const SGPropertyNode* pModel)
             (currentThreat.verticalTau < 0))
         {
             // do not trigger new alerts when Tau is negative, but keep existing alerts
-            int previousThreatLevel = pModel->getIntValue("tcas/threat-level", 0);
+            int previousThreatLevel = model.props->getIntValue("tcas/threat-level", 0);
             if (previousThreatLevel == 0)
                 return threatLevel;
         }
     }
 
 #ifdef FEATURE_TCAS_DEBUG_THREAT_DETECTOR
-    cout << "#" << checkCount << ": " << pModel->getStringValue("callsign") << endl;
+    cout << "#" << checkCount << ": " << model.callsign << endl;
 #endif
 
 
@@ -717,7 +715,7 @@ TCAS::ThreatDetector::checkThreat(int mode, const SGPropertyNode* pModel)
         threatLevel = ThreatRA;
 
     if (!tcas->tracker.active())
-        currentThreat.callsign = pModel->getStringValue("callsign");
+        currentThreat.callsign = model.callsign;
 
     tcas->tracker.add(currentThreat.callsign, threatLevel);
 
@@ -1324,20 +1322,22 @@ TCAS::update(double dt)
         else
 #endif
         {
-            SGPropertyNode* pAi = fgGetNode("/ai/models", true);
+            FGAIManager* aiManager = globals->get_subsystem<FGAIManager>();
+            FGTrafficSnapshotRef traffic;
+            if (aiManager)
+                traffic = aiManager->trafficSnapshot();
 
             // check all aircraft
-            for (int i = pAi->nChildren() - 1; i >= -1; i--)
+            if (traffic)
             {
-                SGPropertyNode* pModel = pAi->getChild(i);
-                if ((pModel)&&(pModel->nChildren()))
+                for (const FGTrafficEntry& model : traffic->entries())
                 {
-                    int threatLevel = threatDetector.checkThreat(mode, pModel);
+                    int threatLevel = threatDetector.checkThreat(mode, model);
                     /* expose aircraft threat-level (to be used by other instruments,
                      * i.e. TCAS display) */
                     if (threatLevel==ThreatRA)
-                        pModel->setIntValue("tcas/ra-sense", -threatDetector.getRASense());
-                    pModel->setIntValue("tcas/threat-level", threatLevel);
+                        model.props->setIntValue("tcas/ra-sense", -threatDetector.getRASense());
+                    model.props->setIntValue("tcas/threat-level", threatLevel);
                 }
             }
         }
@@ -36,6 +36,7 @@ using std::deque;
 using std::map;
 
 class SGSampleGroup;
+struct FGTrafficEntry;
 
 #include <Main/globals.hxx>
 
@@ -316,8 +317,8 @@ class TCAS : public SGSubsystem
         void  init                (void);
         void  update              (void);
 
-        bool  checkTransponder    (const SGPropertyNode* pModel, float velocityKt);
-        int   checkThreat         (int mode, const SGPropertyNode* pModel);
+        bool  checkTransponder    (const FGTrafficEntry& model, float velocityKt);
+        int   checkThreat         (int mode, const FGTrafficEntry& model);
         void  checkVerticalThreat (void);
         void  horizontalThreat    (float bearing, float distanceNm, float heading,
                                    float velocityKt);
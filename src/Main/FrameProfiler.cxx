@@ -0,0 +1,608 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "FrameProfiler.hxx"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/misc/sg_path.hxx>
+#include <simgear/props/props.hxx>
+#include <simgear/structure/SGSmplstat.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+
+namespace flightgear {
+
+namespace {
+
+// guards everything zones may touch from other threads
+std::mutex g_recordLock;
+
+int64_t nowUSec()
+{
+    return SGTimeStamp::now().toUSecs();
+}
+
+const char* groupName(int group)
+{
+    switch (group) {
+    case SGSubsystemMgr::INIT:      return "init";
+    case SGSubsystemMgr::GENERAL:   return "general";
+    case SGSubsystemMgr::FDM:       return "fdm";
+    case SGSubsystemMgr::POST_FDM:  return "post-fdm";
+    case SGSubsystemMgr::DISPLAY:   return "display";
+    case SGSubsystemMgr::SOUND:     return "sound";
+    default:                        return "other";
+    }
+}
+
+// property names start with a letter or '_', followed by letters, digits,
+// '_', '-' or '.'
+std::string propertyName(const std::string& name)
+{
+    std::string result(name);
+    for (char& c : result) {
+        if (!isalnum(static_cast<unsigned char>(c)) && (c != '_') && (c != '-') && (c != '.'))
+            c = '_';
+    }
+    if (result.empty() || !(isalpha(static_cast<unsigned char>(result[0])) || (result[0] == '_')))
+        result.insert(0, "_");
+    return result;
+}
+
+void writeJSONString(std::ostream& out, const std::string& s)
+{
+    out << '"';
+    for (char c : s) {
+        const unsigned char u = static_cast<unsigned char>(c);
+        if ((c == '"') || (c == '\\')) {
+            out << '\\' << c;
+        } else if (u < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", u);
+            out << buf;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+/// The most recent samples of one timed thing, in milliseconds
+class Window
+{
+public:
+    void add(double ms, size_t capacity, const std::string* name = nullptr)
+    {
+        if (_samples.size() > capacity) {
+            _samples.clear();
+            _next = 0;
+        }
+
+        if (_samples.size() < capacity) {
+            _samples.push_back(ms);
+        } else {
+            _samples[_next] = ms;
+            _next = (_next + 1) % capacity;
+        }
+
+        if (ms > _slowestMs) {
+            _slowestMs = ms;
+            if (name)
+                _slowest = *name;
+        }
+    }
+
+    /// Writes the statistics, and starts over looking for the slowest sample.
+    void publish(SGPropertyNode* node, std::vector<float>& scratch)
+    {
+        if (_samples.empty())
+            return;
+
+        scratch.assign(_samples.begin(), _samples.end());
+        const double sum = std::accumulate(scratch.begin(), scratch.end(), 0.0);
+        node->setDoubleValue("mean-ms", sum / scratch.size());
+        node->setDoubleValue("max-ms", *std::max_element(scratch.begin(), scratch.end()));
+        node->setDoubleValue("p50-ms", percentile(scratch, 0.5));
+        node->setDoubleValue("p99-ms", percentile(scratch, 0.99));
+        node->setIntValue("samples", scratch.size());
+
+        if (!_slowest.empty()) {
+            node->setStringValue("slowest", _slowest);
+            _slowest.clear();
+        }
+        _slowestMs = 0.0;
+    }
+
+private:
+    static double percentile(std::vector<float>& values, double p)
+    {
+        const size_t rank = static_cast<size_t>(std::ceil(p * values.size()));
+        const auto it = values.begin() + std::min(values.size(), std::max<size_t>(rank, 1)) - 1;
+        std::nth_element(values.begin(), it, values.end());
+        return *it;
+    }
+
+    std::vector<float> _samples;
+    size_t _next = 0;
+    double _slowestMs = 0.0;
+    std::string _slowest;
+};
+
+struct Event
+{
+    const char* category;
+    std::string name;
+    int64_t startUSec;
+    int64_t durationUSec;
+    int thread;
+};
+
+bool writeTrace(const SGPath& path, const std::vector<Event>& events,
+                int threadCount, int64_t originUSec)
+{
+    sg_ofstream out(path);
+    if (!out) {
+        SG_LOG(SG_GENERAL, SG_ALERT, "Frame profiler: cannot write " << path);
+        return false;
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (int t = 0; t < threadCount; ++t) {
+        if (t)
+            out << ",\n";
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+            << ",\"args\":{\"name\":";
+        writeJSONString(out, t ? "thread-" + std::to_string(t) : std::string("main"));
+        out << "}}";
+    }
+
+    for (const auto& e : events) {
+        out << ",\n{\"name\":";
+        writeJSONString(out, e.name);
+        out << ",\"cat\":\"" << e.category << "\",\"ph\":\"X\",\"ts\":"
+            << (e.startUSec - originUSec) << ",\"dur\":" << e.durationUSec
+            << ",\"pid\":1,\"tid\":" << e.thread << "}";
+    }
+    out << "\n]}\n";
+
+    out.close();
+    return !out.fail();
+}
+
+} // of anonymous namespace
+
+class FrameProfiler::FrameProfilerPrivate
+{
+public:
+    // Sits in the subsystem manager's single timing hook, in front of
+    // whatever was installed before (the performance monitor, if it is
+    // enabled). Statistics are only reset by the previous hook, on its own
+    // schedule, so the profiler works out each frame's time from the
+    // change of the total.
+    static void timingHook(void* userData, const std::string& name, SampleStatistic* stat)
+    {
+        auto self = static_cast<FrameProfilerPrivate*>(userData);
+        SubsystemTotal& total = self->subsystemTotals[name];
+        const double now = stat->mean() * stat->count();
+        // less than before: someone else reset it without us seeing it
+        total.pending += (now >= total.seen) ? now - total.seen : now;
+
+        if (self->collecting) {
+            if (total.pending > 0.0)
+                self->frameSubsystems.emplace_back(name, static_cast<int64_t>(total.pending));
+            total.pending = 0.0;
+            if (!self->previousHook)
+                stat->reset();
+        } else if (self->previousHook) {
+            self->previousHook(self->previousUserData, name, stat);
+        }
+        total.seen = stat->mean() * stat->count();
+    }
+
+    // put the profiler's hook in front of the installed one; also called
+    // when someone else, e.g. the performance monitor being enabled or
+    // disabled, has replaced it since
+    void chainTimingHook(SGSubsystemTimingCb current, void* currentUserData)
+    {
+        if (current == &FrameProfilerPrivate::timingHook)
+            return;
+
+        previousHook = current;
+        previousUserData = currentUserData;
+        globals->get_subsystem_mgr()->setReportTimingCb(this, &FrameProfilerPrivate::timingHook);
+    }
+
+    void setActive(bool active, SGSubsystemTimingCb current, void* currentUserData)
+    {
+        if (active) {
+            subsystemTotals.clear();
+            chainTimingHook(current, currentUserData);
+            findGroups();
+
+            std::lock_guard<std::mutex> g(g_recordLock);
+            frame = Window();
+            subsystems.clear();
+            zones.clear();
+        } else {
+            // hand the hook back, unless it was replaced meanwhile
+            if (current == &FrameProfilerPrivate::timingHook)
+                globals->get_subsystem_mgr()->setReportTimingCb(previousUserData, previousHook);
+            previousHook = nullptr;
+            previousUserData = nullptr;
+        }
+
+        this->active = active;
+        s_active = active;
+    }
+
+    void findGroups()
+    {
+        groups.clear();
+        auto mgr = globals->get_subsystem_mgr();
+        for (int g = 0; g < SGSubsystemMgr::MAX_GROUPS; ++g) {
+            auto group = mgr->get_group(static_cast<SGSubsystemMgr::GroupType>(g));
+            for (const auto& name : group->member_names())
+                groups[name] = g;
+        }
+    }
+
+    int groupOf(const std::string& name)
+    {
+        auto it = groups.find(name);
+        if (it == groups.end()) {
+            // added since; don't look again if it still isn't found
+            findGroups();
+            it = groups.insert(std::make_pair(name, -1)).first;
+        }
+        return it->second;
+    }
+
+    // the following require g_recordLock
+
+    int threadIndex()
+    {
+        const auto id = std::this_thread::get_id();
+        auto it = threads.find(id);
+        if (it == threads.end())
+            it = threads.insert(std::make_pair(id, static_cast<int>(threads.size()))).first;
+        return it->second;
+    }
+
+    void record(const char* category, const std::string& name,
+                int64_t startUSec, int64_t durationUSec)
+    {
+        if (events.size() >= maxEvents) {
+            ++droppedEvents;
+            return;
+        }
+        events.push_back(Event{category, name, startUSec, durationUSec, threadIndex()});
+    }
+
+    void addZone(const char* category, const std::string& name,
+                 int64_t startUSec, int64_t durationUSec)
+    {
+        zones[category].add(durationUSec / 1000.0, window, &name);
+        if (capture)
+            record(category, name, startUSec, durationUSec);
+    }
+
+    void publish()
+    {
+        std::lock_guard<std::mutex> g(g_recordLock);
+        frame.publish(root->getNode("frame", true), scratch);
+
+        SGPropertyNode* node = root->getNode("subsystems", true);
+        for (auto& s : subsystems)
+            s.second.publish(node->getNode(propertyName(s.first), true), scratch);
+
+        node = root->getNode("zones", true);
+        for (auto& z : zones)
+            z.second.publish(node->getNode(z.first, true), scratch);
+
+        if (capture) {
+            captureNode->setIntValue("events", events.size());
+            captureNode->setIntValue("dropped-events", droppedEvents);
+        }
+    }
+
+    SGPropertyNode_ptr root;
+    SGPropertyNode_ptr enabled;
+    SGPropertyNode_ptr windowFrames;
+    SGPropertyNode_ptr updateInterval;
+    SGPropertyNode_ptr captureNode;
+
+    bool active = false;
+    int64_t frameStart = 0;
+    SGTimeStamp lastPublish;
+
+    // main thread only: subsystem update times in update order, as
+    // reported by the subsystem manager
+    std::vector<std::pair<std::string, int64_t>> frameSubsystems;
+
+    // main thread only: the timing hook chain
+    struct SubsystemTotal
+    {
+        double seen = 0.0;    ///< total update time at the last report
+        double pending = 0.0; ///< not yet attributed to a frame
+    };
+    std::map<std::string, SubsystemTotal> subsystemTotals;
+    SGSubsystemTimingCb previousHook = nullptr;
+    void* previousUserData = nullptr;
+    bool collecting = false;
+    std::map<std::string, int> groups;
+
+    // guarded by g_recordLock
+    size_t window = 600;
+    Window frame;
+    std::map<std::string, Window> subsystems;
+    std::map<std::string, Window> zones;
+    std::map<std::thread::id, int> threads;
+    std::vector<float> scratch;
+
+    bool capture = false;
+    SGPath capturePath;
+    int64_t captureStart = 0;
+    int64_t captureEnd = 0; // zero: until stopped
+    size_t maxEvents = 0;
+    size_t droppedEvents = 0;
+    std::vector<Event> events;
+};
+
+std::atomic<bool> FrameProfiler::s_active{false};
+FrameProfiler::FrameProfilerPrivate* FrameProfiler::s_instance = nullptr;
+
+FrameProfiler::FrameProfiler() :
+    d(new FrameProfilerPrivate)
+{
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    std::lock_guard<std::mutex> g(g_recordLock);
+    if (s_instance == d.get()) {
+        s_instance = nullptr;
+        s_active = false;
+    }
+}
+
+void FrameProfiler::init()
+{
+    d->root = fgGetNode("/sim/performance", true);
+    d->enabled = d->root->getNode("enabled", true);
+    d->windowFrames = d->root->getNode("window-frames", true);
+    if (!d->windowFrames->hasValue())
+        d->windowFrames->setIntValue(600);
+    d->updateInterval = d->root->getNode("update-interval-sec", true);
+    if (!d->updateInterval->hasValue())
+        d->updateInterval->setDoubleValue(1.0);
+    d->captureNode = d->root->getNode("capture", true);
+    d->captureNode->setBoolValue("active", false);
+
+    std::lock_guard<std::mutex> g(g_recordLock);
+    d->threads.clear();
+    d->threadIndex(); // the main thread is always the first
+    s_instance = d.get();
+}
+
+void FrameProfiler::shutdown()
+{
+    if (isCapturing())
+        stopCapture();
+    if (d->active)
+        d->setActive(false, reportTimingCb, reportTimingUserData);
+
+    std::lock_guard<std::mutex> g(g_recordLock);
+    s_instance = nullptr;
+}
+
+void FrameProfiler::update(double)
+{
+    if (!d->active)
+        return;
+
+    if (d->capture && d->captureEnd && (nowUSec() >= d->captureEnd))
+        stopCapture();
+
+    if (d->lastPublish.elapsedMSec() >= 1000 * d->updateInterval->getDoubleValue()) {
+        d->publish();
+        d->lastPublish.stamp();
+    }
+}
+
+void FrameProfiler::beginFrame()
+{
+    const bool wanted = d->enabled->getBoolValue() || d->capture;
+    if (wanted != d->active)
+        d->setActive(wanted, reportTimingCb, reportTimingUserData);
+    else if (d->active)
+        d->chainTimingHook(reportTimingCb, reportTimingUserData);
+
+    if (d->active) {
+        const int frames = d->windowFrames->getIntValue();
+        std::lock_guard<std::mutex> g(g_recordLock);
+        d->window = std::max(frames, 1);
+        d->frameStart = nowUSec();
+    }
+}
+
+void FrameProfiler::endFrame()
+{
+    if (!d->active)
+        return;
+
+    const int64_t frameEnd = nowUSec();
+
+    // collects the time of each subsystem updated this frame
+    d->frameSubsystems.clear();
+    d->collecting = true;
+    globals->get_subsystem_mgr()->reportTiming();
+    d->collecting = false;
+
+    std::lock_guard<std::mutex> g(g_recordLock);
+    d->frame.add((frameEnd - d->frameStart) / 1000.0, d->window);
+    for (const auto& s : d->frameSubsystems)
+        d->subsystems[s.first].add(s.second / 1000.0, d->window);
+
+    if (!d->capture)
+        return;
+
+    // The manager only reports durations, so subsystems (and their groups)
+    // are placed back to back from the start of the frame, in update order.
+    // The durations are exact, the start times are not.
+    d->record("frame", "frame", d->frameStart, frameEnd - d->frameStart);
+
+    int64_t t = d->frameStart;
+    int64_t groupStart = t;
+    int group = -2;
+    for (const auto& s : d->frameSubsystems) {
+        const int g = d->groupOf(s.first);
+        if (g != group) {
+            if (group != -2)
+                d->record("group", groupName(group), groupStart, t - groupStart);
+            group = g;
+            groupStart = t;
+        }
+
+        d->record("subsystem", s.first, t, s.second);
+        t += s.second;
+    }
+    if (group != -2)
+        d->record("group", groupName(group), groupStart, t - groupStart);
+}
+
+bool FrameProfiler::startCapture(const SGPath& path, double durationSec)
+{
+    {
+        std::lock_guard<std::mutex> g(g_recordLock);
+        if (d->capture) {
+            SG_LOG(SG_GENERAL, SG_WARN, "Frame profiler: already capturing to " << d->capturePath);
+            return false;
+        }
+
+        d->capturePath = path;
+        d->captureStart = nowUSec();
+        d->captureEnd = (durationSec > 0.0) ? d->captureStart + static_cast<int64_t>(durationSec * 1e6) : 0;
+        d->maxEvents = d->captureNode->getIntValue("max-events", 2000000);
+        d->droppedEvents = 0;
+        d->events.clear();
+        d->capture = true;
+    }
+
+    d->captureNode->setBoolValue("active", true);
+    d->captureNode->setStringValue("filename", path.utf8Str());
+    d->captureNode->setIntValue("events", 0);
+    d->captureNode->setIntValue("dropped-events", 0);
+    if (!d->active)
+        d->setActive(true, reportTimingCb, reportTimingUserData);
+
+    SG_LOG(SG_GENERAL, SG_INFO, "Frame profiler: capturing to " << path);
+    return true;
+}
+
+bool FrameProfiler::stopCapture()
+{
+    std::vector<Event> events;
+    SGPath path;
+    size_t dropped;
+    int threadCount;
+    int64_t origin;
+    {
+        std::lock_guard<std::mutex> g(g_recordLock);
+        if (!d->capture)
+            return false;
+
+        d->capture = false;
+        events.swap(d->events);
+        path = d->capturePath;
+        dropped = d->droppedEvents;
+        threadCount = d->threads.size();
+        origin = d->captureStart;
+    }
+
+    d->captureNode->setBoolValue("active", false);
+    d->captureNode->setIntValue("events", events.size());
+    d->captureNode->setIntValue("dropped-events", dropped);
+    if (dropped) {
+        SG_LOG(SG_GENERAL, SG_WARN, "Frame profiler: capture was full, dropped "
+               << dropped << " events");
+    }
+
+    SGTimeStamp st;
+    st.stamp();
+    const bool ok = writeTrace(path, events, threadCount, origin);
+    if (ok) {
+        SG_LOG(SG_GENERAL, SG_INFO, "Frame profiler: wrote " << events.size()
+               << " events to " << path << " in " << st.elapsedMSec() << "ms");
+    }
+    return ok;
+}
+
+bool FrameProfiler::isCapturing() const
+{
+    std::lock_guard<std::mutex> g(g_recordLock);
+    return d->capture;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Implementation of FrameProfiler::Zone
+////////////////////////////////////////////////////////////////////////
+
+FrameProfiler::Zone::Zone(const char* category, const char* name)
+{
+    if (isActive()) {
+        _category = category;
+        _name = name;
+        _startUSec = nowUSec();
+    }
+}
+
+FrameProfiler::Zone::Zone(const char* category, const std::string& name)
+{
+    if (isActive()) {
+        _category = category;
+        _name = name;
+        _startUSec = nowUSec();
+    }
+}
+
+FrameProfiler::Zone::~Zone()
+{
+    if (!_category)
+        return;
+
+    const int64_t end = nowUSec();
+    std::lock_guard<std::mutex> g(g_recordLock);
+    if (s_instance)
+        s_instance->addZone(_category, _name, _startUSec, end - _startUSec);
+}
+
+} // namespace flightgear
@@ -0,0 +1,101 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <simgear/structure/subsystem_mgr.hxx>
+
+class SGPath;
+
+namespace flightgear {
+
+/**
+ * Frame time profiler.
+ *
+ * While /sim/performance/enabled is set, the update time of every subsystem
+ * and the duration of profiled zones (Nasal timers and listeners, tile loads,
+ * FDM iterations) are kept over the last window-frames samples, and their
+ * median, 99th percentile and maximum are published below /sim/performance.
+ *
+ * A capture additionally records every sample as an event, and writes them
+ * as Chrome trace JSON (chrome://tracing, Perfetto) when it is stopped.
+ */
+class FrameProfiler : public SGSubsystem
+{
+public:
+    FrameProfiler();
+    ~FrameProfiler();
+
+    void init() override;
+    void shutdown() override;
+    void update(double dt) override;
+
+    static const char* staticSubsystemClassId() { return "frame-profiler"; }
+
+    /// Called by the main loop around the update of all subsystems.
+    void beginFrame();
+    void endFrame();
+
+    /**
+     * Start recording trace events. The capture stops by itself after
+     * durationSec, if that is positive.
+     */
+    bool startCapture(const SGPath& path, double durationSec = 0.0);
+
+    /// Stop recording and write the trace file.
+    bool stopCapture();
+
+    bool isCapturing() const;
+
+    /// Whether zones are recorded at all; cheap enough to test per call.
+    static bool isActive() { return s_active.load(std::memory_order_relaxed); }
+
+    /**
+     * Times the enclosing scope, on any thread. Does nothing but a flag test
+     * while the profiler is inactive.
+     */
+    class Zone
+    {
+    public:
+        Zone(const char* category, const char* name);
+        Zone(const char* category, const std::string& name);
+        ~Zone();
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* _category = nullptr;
+        std::string _name;
+        int64_t _startUSec = 0;
+    };
+
+private:
+    class FrameProfilerPrivate;
+
+    static std::atomic<bool> s_active;
+    static FrameProfilerPrivate* s_instance; ///< guarded by the recording lock
+
+    std::unique_ptr<FrameProfilerPrivate> d;
+};
+
+} // namespace flightgear
@@ -42,6 +42,7 @@
 #include "fg_os.hxx"
 #include "fg_commands.hxx"
 #include "fg_props.hxx"
+#include "FrameProfiler.hxx"
 #include "globals.hxx"
 #include "logger.hxx"
 #include "util.hxx"
@@ -996,6 +997,44 @@ do_profiler_stop(const SGPropertyNode *arg, SGPropertyNode *root)
 #endif
 }
 
+/**
+ * Built-in command: start recording a frame profiler trace.
+ *
+ * filename: the trace file to write, by default Export/frame-trace.json
+ *           below $FG_HOME.
+ * duration-sec: stop after this many seconds, if given.
+ */
+static bool
+do_frame_capture_start(const SGPropertyNode *arg, SGPropertyNode *root)
+{
+  auto profiler = globals->get_subsystem<flightgear::FrameProfiler>();
+  if (!profiler)
+    return false;
+
+  SGPath file(globals->get_fg_home() / "Export" / "frame-trace.json");
+  if (arg->hasValue("filename"))
+    file = SGPath::fromUtf8(arg->getStringValue("filename"));
+
+  SGPath validated_path = fgValidatePath(file, true);
+  if (validated_path.isNull()) {
+    SG_LOG(SG_IO, SG_ALERT, "frame-capture-start: writing '" << file << "' denied "
+           "(unauthorized access)");
+    return false;
+  }
+
+  return profiler->startCapture(validated_path, arg->getDoubleValue("duration-sec"));
+}
+
+/**
+ * Built-in command: stop recording the frame profiler trace, and write it.
+ */
+static bool
+do_frame_capture_stop(const SGPropertyNode *arg, SGPropertyNode *root)
+{
+  auto profiler = globals->get_subsystem<flightgear::FrameProfiler>();
+  return profiler && profiler->stopCapture();
+}
+
 
 ////////////////////////////////////////////////////////////////////////
 // Command setup.
@@ -1053,6 +1092,8 @@ static struct {
 
     { "profiler-start", do_profiler_start },
     { "profiler-stop",  do_profiler_stop },
+    { "frame-capture-start", do_frame_capture_start },
+    { "frame-capture-stop", do_frame_capture_stop },
 
     { 0, 0 }			// zero-terminated
 };
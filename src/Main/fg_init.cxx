@@ -157,6 +157,7 @@
 #include "AircraftDirVisitorBase.hxx"
 #include <Main/sentryIntegration.hxx>
 #include <Main/ErrorReporter.hxx>
+#include <Main/FrameProfiler.hxx>
 
 #if defined(SG_MAC)
 #include <GUI/CocoaHelpers.h> // for Mac impl of platformDefaultDataPath()
@@ -906,6 +907,14 @@ fgInitNav ()
             fgSplashProgress(splashIdentsByRebuildPhase[phase],
                              cache->rebuildPhaseCompletionPercentage());
 
+            // show how long the phase has been running next to its percentage
+            const unsigned int elapsedSec = cache->rebuildPhaseElapsedMSec() / 1000;
+            if (elapsedSec > 0) {
+                const std::string spinner = fgGetString("/sim/startup/splash-progress-spinner");
+                fgSetString("/sim/startup/splash-progress-spinner",
+                            spinner + " - " + std::to_string(elapsedSec) + "s");
+            }
+
             // sleep to give the rebuild thread more time
             SGTimeStamp::sleepForMSec(50);
             return false;
@@ -989,6 +998,7 @@ void fgCreateSubsystems(bool duringReset) {
         // group because the "nasal" subsystem may need it at GENERAL take-down.
         globals->add_subsystem("prop-interpolator", new FGInterpolator, SGSubsystemMgr::INIT);
         globals->add_subsystem("gui", new NewGUI, SGSubsystemMgr::INIT);
+        globals->add_new_subsystem<flightgear::FrameProfiler>(SGSubsystemMgr::INIT);
     }
 
     // SGSubsystemMgr::GENERAL
@@ -9,20 +9,238 @@
 
 #include "logger.hxx"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <ios>
+#include <mutex>
 #include <string>
 #include <cstdlib>
 
 #include <simgear/debug/logstream.hxx>
 #include <simgear/io/iostreams/sgstream.hxx>
 #include <simgear/misc/sg_path.hxx>
+#include <simgear/threads/SGThread.hxx>
 
 #include "fg_props.hxx"
 #include "globals.hxx"
 #include "util.hxx"
 
 using std::string;
-using std::endl;
+
+namespace logformat = flightgear::logformat;
+using logformat::Column;
+using logformat::Row;
+using logformat::Value;
+
+////////////////////////////////////////////////////////////////////////
+// Implementation of FGLogger::Writer
+////////////////////////////////////////////////////////////////////////
+
+/**
+ * Formats and writes the rows of one log. update() fills the slots of a
+ * single producer, single consumer ring; the thread empties it whenever a
+ * block is complete, and at least once a second.
+ */
+class FGLogger::Writer : public SGThread
+{
+public:
+  enum Format { CSV, BINARY };
+
+  Writer (std::unique_ptr<sg_ofstream> output, Format format, char delimiter,
+          const std::vector<Column>& columns, size_t capacity,
+          size_t block_rows);
+  ~Writer ();
+
+  /// The slot for the next row, or nullptr if the ring is full and the
+  /// row has to be dropped.
+  Row* beginRow ();
+  void commitRow ();
+
+  unsigned long dropped () const { return _dropped; }
+
+protected:
+  void run () override;
+
+private:
+  void writeRows (size_t begin, size_t end);
+
+  std::unique_ptr<sg_ofstream> _output;
+  Format _format;
+  char _delimiter;
+  std::vector<Column> _columns;
+  std::vector<Row> _ring;
+  size_t _block_rows;
+  std::vector<const Row*> _block;
+
+  std::atomic<size_t> _head; // rows committed by update()
+  std::atomic<size_t> _tail; // rows written by the thread
+  unsigned long _dropped;    // only used by update()
+
+  std::mutex _lock;
+  std::condition_variable _wake;
+  bool _stop;
+};
+
+FGLogger::Writer::Writer (std::unique_ptr<sg_ofstream> output, Format format,
+                          char delimiter, const std::vector<Column>& columns,
+                          size_t capacity, size_t block_rows)
+  : _output(std::move(output)),
+    _format(format),
+    _delimiter(delimiter),
+    _columns(columns),
+    _ring(std::max<size_t>(capacity, 1), Row(columns.size())),
+    _block_rows(std::max<size_t>(1, std::min(block_rows, _ring.size()))),
+    _head(0),
+    _tail(0),
+    _dropped(0),
+    _stop(false)
+{
+  if (_format == BINARY) {
+    logformat::writeHeader(*_output, _columns);
+  } else {
+    for (size_t c = 0; c < _columns.size(); ++c) {
+      if (c > 0)
+        (*_output) << _delimiter;
+      (*_output) << _columns[c].name;
+    }
+    (*_output) << '\n';
+  }
+  _output->flush();
+
+  start();
+}
+
+FGLogger::Writer::~Writer ()
+{
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    _stop = true;
+  }
+  _wake.notify_all();
+  join();
+}
+
+Row*
+FGLogger::Writer::beginRow ()
+{
+  const size_t head = _head.load(std::memory_order_relaxed);
+  if (head - _tail.load(std::memory_order_acquire) >= _ring.size()) {
+    ++_dropped;
+    return nullptr;
+  }
+  return &_ring[head % _ring.size()];
+}
+
+void
+FGLogger::Writer::commitRow ()
+{
+  const size_t head = _head.load(std::memory_order_relaxed) + 1;
+  _head.store(head, std::memory_order_release);
+
+  // only wake the thread once per complete block
+  if (head - _tail.load(std::memory_order_acquire) == _block_rows) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _wake.notify_one();
+  }
+}
+
+void
+FGLogger::Writer::run ()
+{
+  for (;;) {
+    bool stopping;
+    {
+      std::unique_lock<std::mutex> lock(_lock);
+      _wake.wait_for(lock, std::chrono::seconds(1), [this] {
+        return _stop || (_head.load(std::memory_order_acquire) -
+                         _tail.load(std::memory_order_relaxed) >= _block_rows);
+      });
+      stopping = _stop;
+    }
+
+    const size_t head = _head.load(std::memory_order_acquire);
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    while (tail != head) {
+      const size_t end = tail + std::min(head - tail, _block_rows);
+      writeRows(tail, end);
+      tail = end;
+      _tail.store(tail, std::memory_order_release);
+    }
+    _output->flush();
+
+    if (stopping)
+      return;
+  }
+}
+
+void
+FGLogger::Writer::writeRows (size_t begin, size_t end)
+{
+  if (_format == BINARY) {
+    _block.clear();
+    for (size_t i = begin; i < end; ++i)
+      _block.push_back(&_ring[i % _ring.size()]);
+    logformat::writeBlock(*_output, _columns, _block);
+    return;
+  }
+
+  for (size_t i = begin; i < end; ++i) {
+    const Row& row = _ring[i % _ring.size()];
+    for (size_t c = 0; c < _columns.size(); ++c) {
+      if (c > 0)
+        (*_output) << _delimiter;
+      logformat::formatValue(*_output, _columns[c].type, row[c]);
+    }
+    (*_output) << '\n';
+  }
+}
+
+static logformat::ColumnType
+columnType (const SGPropertyNode * node)
+{
+  switch (node->getType()) {
+  case simgear::props::BOOL:
+    return logformat::BOOL;
+  case simgear::props::INT:
+    return logformat::INT;
+  case simgear::props::LONG:
+    return logformat::LONG;
+  case simgear::props::FLOAT:
+    return logformat::FLOAT;
+  case simgear::props::NONE:   // not set yet, most likely a number
+  case simgear::props::DOUBLE:
+    return logformat::DOUBLE;
+  default:
+    return logformat::STRING;
+  }
+}
+
+static void
+sampleValue (const SGPropertyNode * node, logformat::ColumnType type, Value& value)
+{
+  switch (type) {
+  case logformat::BOOL:
+    value.b = node->getBoolValue();
+    break;
+  case logformat::INT:
+    value.i = node->getIntValue();
+    break;
+  case logformat::LONG:
+    value.l = node->getLongValue();
+    break;
+  case logformat::FLOAT:
+    value.f = node->getFloatValue();
+    break;
+  case logformat::DOUBLE:
+    value.d = node->getDoubleValue();
+    break;
+  case logformat::STRING:
+    value.s = node->getStringValue();
+    break;
+  }
+}
 
 ////////////////////////////////////////////////////////////////////////
 // Implementation of FGLogger
@@ -45,9 +263,20 @@ FGLogger::init ()
     _logs.emplace_back(new Log());
     Log &log = *_logs.back();
 
+    string format = child->getStringValue("format");
+    if (format.empty()) {
+        format = "csv";
+        child->setStringValue("format", format.c_str());
+    }
+    const bool binary = (format == "binary");
+    if (!binary && (format != "csv")) {
+        SG_LOG(SG_GENERAL, SG_ALERT, "Unknown log format '" << format
+               << "', writing CSV");
+    }
+
     string filename = child->getStringValue("filename");
     if (filename.empty()) {
-        filename = "fg_log.csv";
+        filename = binary ? "fg_log.fglog" : "fg_log.csv";
         child->setStringValue("filename", filename.c_str());
     }
 
@@ -80,8 +309,11 @@ FGLogger::init ()
     log.last_time_ms = globals->get_sim_time_sec() * 1000;
     log.delimiter = delimiter.c_str()[0];
     // Security: use the return value of fgValidatePath()
-    log.output.reset(new sg_ofstream(authorizedPath, std::ios_base::out));
-    if ( !(*log.output) ) {
+    std::ios_base::openmode mode = std::ios_base::out;
+    if (binary)
+        mode |= std::ios_base::binary;
+    std::unique_ptr<sg_ofstream> output(new sg_ofstream(authorizedPath, mode));
+    if ( !(*output) ) {
       SG_LOG(SG_GENERAL, SG_ALERT, "Cannot write log to " << filename);
       _logs.pop_back();
       continue;
@@ -91,7 +323,7 @@ FGLogger::init ()
     // Process the individual entries (Time is automatic).
     //
     std::vector<SGPropertyNode_ptr> entries = child->getChildren("entry");
-    (*log.output) << "Time";
+    log.columns.push_back(Column{"Time", logformat::DOUBLE});
     for (unsigned int j = 0; j < entries.size(); j++) {
       SGPropertyNode * entry = entries[j];
 
@@ -109,10 +341,18 @@ FGLogger::init ()
       SGPropertyNode * node =
 	fgGetNode(entry->getStringValue("property"), true);
       log.nodes.push_back(node);
-      (*log.output) << log.delimiter
-		    << entry->getStringValue("title", node->getPath().c_str());
+      // the type is fixed when the log starts
+      log.columns.push_back(Column{entry->getStringValue("title", node->getPath().c_str()),
+                                   columnType(node)});
     }
-    (*log.output) << endl;
+
+    log.dropped_rows = child->getNode("dropped-rows", true);
+    log.dropped_rows->setLongValue(0);
+    log.writer.reset(new Writer(std::move(output),
+                                binary ? Writer::BINARY : Writer::CSV,
+                                log.delimiter, log.columns,
+                                std::max(child->getIntValue("buffer-rows", 4096), 1),
+                                std::max(child->getIntValue("block-rows", 256), 1)));
   }
 }
 
@@ -139,20 +379,26 @@ FGLogger::update (double dt)
     double sim_time_sec = globals->get_sim_time_sec();
     double sim_time_ms = sim_time_sec * 1000;
     for (unsigned int i = 0; i < _logs.size(); i++) {
-        while ((sim_time_ms - _logs[i]->last_time_ms) >= _logs[i]->interval_ms) {
-            _logs[i]->last_time_ms += _logs[i]->interval_ms;
-            (*_logs[i]->output) << sim_time_sec;
-            for (unsigned int j = 0; j < _logs[i]->nodes.size(); j++) {
-                (*_logs[i]->output) << _logs[i]->delimiter
-                                    << _logs[i]->nodes[j]->getStringValue();
+        Log &log = *_logs[i];
+        while ((sim_time_ms - log.last_time_ms) >= log.interval_ms) {
+            log.last_time_ms += log.interval_ms;
+            Row *row = log.writer->beginRow();
+            if (!row)
+                continue;
+
+            (*row)[0].d = sim_time_sec;
+            for (unsigned int j = 0; j < log.nodes.size(); j++) {
+                sampleValue(log.nodes[j], log.columns[j + 1].type,
+                            (*row)[j + 1]);
             }
-            (*_logs[i]->output) << endl;
+            log.writer->commitRow();
         }
+        log.dropped_rows->setLongValue(log.writer->dropped());
     }
 }
 
 
-
+
 ////////////////////////////////////////////////////////////////////////
 // Implementation of FGLogger::Log
 ////////////////////////////////////////////////////////////////////////
@@ -164,6 +410,10 @@ FGLogger::Log::Log ()
 {
 }
 
+FGLogger::Log::~Log ()
+{
+}
+
 
 // Register the subsystem.
 SGSubsystemMgr::Registrant<FGLogger> registrantFGLogger;
@@ -14,8 +14,13 @@
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/props/props.hxx>
 
+#include "logger_format.hxx"
+
 /**
- * Log any property values to any number of CSV files.
+ * Log any property values to any number of CSV or binary files.
+ *
+ * The values are only sampled in update(); formatting and writing them is
+ * done by a thread per log, which is fed through a ring buffer.
  */
 class FGLogger : public SGSubsystem
 {
@@ -31,14 +36,19 @@ public:
     static const char* staticSubsystemClassId() { return "logger"; }
 
 private:
+    class Writer;
+
     /**
      * A single instance of a log file (the logger can contain many).
      */
     struct Log {
       Log ();
+      ~Log ();
 
       std::vector<SGPropertyNode_ptr> nodes;
-      std::unique_ptr<sg_ofstream> output;
+      std::vector<flightgear::logformat::Column> columns; // including Time
+      std::unique_ptr<Writer> writer;
+      SGPropertyNode_ptr dropped_rows;
       long interval_ms;
       double last_time_ms;
       char delimiter;
@@ -0,0 +1,384 @@
+// logger_format.cxx - the binary log format written by FGLogger.
+//
+// This file is in the Public Domain, and comes with no warranty.
+//
+// Only depends on the standard library, so that the log converter in
+// utils/ can build it as well.
+
+#include "logger_format.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace flightgear
+{
+namespace logformat
+{
+
+namespace
+{
+
+// the usual CRC-32 (IEEE 802.3) table
+struct CRCTable
+{
+    CRCTable()
+    {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : (c >> 1);
+            entries[n] = c;
+        }
+    }
+
+    uint32_t entries[256];
+};
+
+// larger payloads are taken as a damaged size field
+const uint32_t MAX_PAYLOAD = 1u << 28;
+
+void put8(std::string& buf, uint8_t v)
+{
+    buf.push_back(static_cast<char>(v));
+}
+
+void put16(std::string& buf, uint16_t v)
+{
+    put8(buf, v & 0xff);
+    put8(buf, v >> 8);
+}
+
+void put32(std::string& buf, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        put8(buf, (v >> (8 * i)) & 0xff);
+}
+
+void put64(std::string& buf, uint64_t v)
+{
+    for (int i = 0; i < 8; ++i)
+        put8(buf, (v >> (8 * i)) & 0xff);
+}
+
+/// Bounds checked reading from a buffer
+class Cursor
+{
+public:
+    Cursor(const std::string& buf) : _buf(buf) {}
+
+    bool ok() const { return _ok; }
+
+    uint64_t get(int bytes)
+    {
+        if (_pos + bytes > _buf.size()) {
+            _ok = false;
+            return 0;
+        }
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; ++i)
+            v |= uint64_t(static_cast<uint8_t>(_buf[_pos++])) << (8 * i);
+        return v;
+    }
+
+    std::string getString(uint32_t len)
+    {
+        if (_pos + len > _buf.size()) {
+            _ok = false;
+            return std::string();
+        }
+        std::string s = _buf.substr(_pos, len);
+        _pos += len;
+        return s;
+    }
+
+private:
+    const std::string& _buf;
+    size_t _pos = 0;
+    bool _ok = true;
+};
+
+bool read32(std::istream& in, uint32_t& v)
+{
+    unsigned char b[4];
+    if (!in.read(reinterpret_cast<char*>(b), 4))
+        return false;
+    v = b[0] | (b[1] << 8) | (b[2] << 16) | (uint32_t(b[3]) << 24);
+    return true;
+}
+
+bool knownType(uint8_t t)
+{
+    return (t >= BOOL) && (t <= STRING);
+}
+
+} // of anonymous namespace
+
+uint32_t crc32(const void* data, size_t size, uint32_t crc)
+{
+    static const CRCTable table;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table.entries[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+void writeHeader(std::ostream& out, const std::vector<Column>& columns)
+{
+    std::string buf(MAGIC, sizeof(MAGIC));
+    put32(buf, VERSION);
+    put32(buf, columns.size());
+    for (const auto& c : columns) {
+        put8(buf, c.type);
+        put16(buf, c.name.size());
+        buf += c.name;
+    }
+    put32(buf, crc32(buf.data(), buf.size()));
+    out.write(buf.data(), buf.size());
+}
+
+void writeBlock(std::ostream& out, const std::vector<Column>& columns,
+                const std::vector<const Row*>& rows)
+{
+    std::string payload;
+    for (size_t c = 0; c < columns.size(); ++c) {
+        for (const Row* row : rows) {
+            const Value& v = (*row)[c];
+            switch (columns[c].type) {
+            case BOOL:
+                put8(payload, v.b ? 1 : 0);
+                break;
+            case INT:
+                put32(payload, static_cast<uint32_t>(v.i));
+                break;
+            case LONG:
+                put64(payload, static_cast<uint64_t>(v.l));
+                break;
+            case FLOAT: {
+                uint32_t bits;
+                memcpy(&bits, &v.f, sizeof(bits));
+                put32(payload, bits);
+                break;
+            }
+            case DOUBLE: {
+                uint64_t bits;
+                memcpy(&bits, &v.d, sizeof(bits));
+                put64(payload, bits);
+                break;
+            }
+            case STRING:
+                put32(payload, v.s.size());
+                payload += v.s;
+                break;
+            }
+        }
+    }
+
+    std::string head;
+    put32(head, BLOCK_MARKER);
+    put32(head, rows.size());
+    put32(head, payload.size());
+    std::string tail;
+    put32(tail, crc32(payload.data(), payload.size()));
+
+    out.write(head.data(), head.size());
+    out.write(payload.data(), payload.size());
+    out.write(tail.data(), tail.size());
+}
+
+void formatValue(std::ostream& out, ColumnType type, const Value& value)
+{
+    switch (type) {
+    case BOOL:
+        out << (value.b ? "true" : "false");
+        break;
+    case INT:
+        out << value.i;
+        break;
+    case LONG:
+        out << value.l;
+        break;
+    case FLOAT:
+        out << value.f;
+        break;
+    case DOUBLE: {
+        // the precision the property tree uses for its string values
+        const std::streamsize old = out.precision(10);
+        out << value.d;
+        out.precision(old);
+        break;
+    }
+    case STRING:
+        out << value.s;
+        break;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////
+// Implementation of Reader
+////////////////////////////////////////////////////////////////////////
+
+Reader::Reader(std::istream& in) :
+    _in(in)
+{
+}
+
+Reader::Status Reader::readHeader()
+{
+    char magic[sizeof(MAGIC)];
+    if (!_in.read(magic, sizeof(magic)))
+        return END;
+    if (memcmp(magic, MAGIC, sizeof(MAGIC)))
+        return CORRUPT;
+
+    uint32_t version, count;
+    if (!read32(_in, version) || !read32(_in, count))
+        return CORRUPT;
+    if (version != VERSION)
+        return CORRUPT;
+
+    std::string buf(MAGIC, sizeof(MAGIC));
+    put32(buf, version);
+    put32(buf, count);
+
+    _columns.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        unsigned char head[3];
+        if (!_in.read(reinterpret_cast<char*>(head), 3))
+            return CORRUPT;
+        const uint16_t len = head[1] | (head[2] << 8);
+        std::string name(len, '\0');
+        if (len && !_in.read(&name[0], len))
+            return CORRUPT;
+        if (!knownType(head[0]))
+            return CORRUPT;
+
+        buf.append(reinterpret_cast<char*>(head), 3);
+        buf += name;
+        _columns.push_back(Column{name, static_cast<ColumnType>(head[0])});
+    }
+
+    uint32_t crc;
+    if (!read32(_in, crc) || (crc != crc32(buf.data(), buf.size())))
+        return CORRUPT;
+
+    return OK;
+}
+
+size_t Reader::minRowBytes() const
+{
+    size_t bytes = 0;
+    for (const Column& c : _columns) {
+        switch (c.type) {
+        case BOOL:
+            bytes += 1;
+            break;
+        case LONG:
+        case DOUBLE:
+            bytes += 8;
+            break;
+        default: // INT, FLOAT and the length of a STRING
+            bytes += 4;
+            break;
+        }
+    }
+    return bytes;
+}
+
+bool Reader::findMarker()
+{
+    uint32_t window;
+    if (!read32(_in, window))
+        return false;
+
+    while (window != BLOCK_MARKER) {
+        const int c = _in.get();
+        if (c == std::char_traits<char>::eof())
+            return false;
+        window = (window >> 8) | (uint32_t(c) << 24);
+    }
+    return true;
+}
+
+Reader::Status Reader::readBlock(std::vector<Row>& rows)
+{
+    rows.clear();
+
+    if (_resync) {
+        if (!findMarker())
+            return END;
+    }
+    else {
+        uint32_t marker;
+        if (!read32(_in, marker))
+            return END;
+        if (marker != BLOCK_MARKER) {
+            _resync = true;
+            return CORRUPT;
+        }
+    }
+
+    // until this block turned out fine, look for the next marker
+    _resync = true;
+
+    uint32_t count, size;
+    if (!read32(_in, count) || !read32(_in, size) || (size > MAX_PAYLOAD))
+        return CORRUPT;
+
+    _payload.resize(size);
+    uint32_t crc;
+    if ((size && !_in.read(&_payload[0], size)) || !read32(_in, crc))
+        return CORRUPT;
+    if (crc != crc32(_payload.data(), _payload.size()))
+        return CORRUPT;
+
+    // the row count is outside the CRC, so check it against the smallest
+    // payload that many rows could take
+    if (uint64_t(count) * std::max<size_t>(minRowBytes(), 1) > size)
+        return CORRUPT;
+
+    rows.resize(count, Row(_columns.size()));
+    Cursor cursor(_payload);
+    for (size_t c = 0; c < _columns.size(); ++c) {
+        for (uint32_t r = 0; r < count; ++r) {
+            Value& v = rows[r][c];
+            switch (_columns[c].type) {
+            case BOOL:
+                v.b = cursor.get(1) != 0;
+                break;
+            case INT:
+                v.i = static_cast<int32_t>(cursor.get(4));
+                break;
+            case LONG:
+                v.l = static_cast<int64_t>(cursor.get(8));
+                break;
+            case FLOAT: {
+                const uint32_t bits = cursor.get(4);
+                memcpy(&v.f, &bits, sizeof(bits));
+                break;
+            }
+            case DOUBLE: {
+                const uint64_t bits = cursor.get(8);
+                memcpy(&v.d, &bits, sizeof(bits));
+                break;
+            }
+            case STRING:
+                v.s = cursor.getString(cursor.get(4));
+                break;
+            }
+        }
+    }
+
+    if (!cursor.ok()) {
+        rows.clear();
+        return CORRUPT;
+    }
+
+    _resync = false;
+    return OK;
+}
+
+} // of namespace logformat
+} // of namespace flightgear
@@ -0,0 +1,124 @@
+// logger_format.hxx - the binary log format written by FGLogger.
+//
+// This file is in the Public Domain, and comes with no warranty.
+
+#ifndef __LOGGER_FORMAT_HXX
+#define __LOGGER_FORMAT_HXX 1
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace flightgear
+{
+namespace logformat
+{
+
+/**
+ * A binary log is a header, describing the columns, followed by any
+ * number of blocks of rows. All numbers are little endian.
+ *
+ * Header:
+ *   char[8]   "FGLOGBIN"
+ *   uint32    format version
+ *   uint32    number of columns
+ *   per column: uint8 type, uint16 name length, the name (UTF-8)
+ *   uint32    CRC-32 of all of the above
+ *
+ * Block:
+ *   uint32    BLOCK_MARKER
+ *   uint32    number of rows
+ *   uint32    payload size in bytes
+ *   payload   column after column, each holding the values of all rows:
+ *             bools as one byte, INT and FLOAT as four bytes, LONG and
+ *             DOUBLE as eight, strings as a uint32 length and the bytes
+ *   uint32    CRC-32 of the payload
+ *
+ * A truncated or damaged block only loses the rows it contains; a reader
+ * resynchronises by scanning for the next BLOCK_MARKER.
+ */
+const char MAGIC[8] = { 'F', 'G', 'L', 'O', 'G', 'B', 'I', 'N' };
+const uint32_t VERSION = 1;
+const uint32_t BLOCK_MARKER = 0x4b4c4246; // "FBLK"
+
+enum ColumnType : uint8_t {
+    BOOL = 1,
+    INT = 2,
+    LONG = 3,
+    FLOAT = 4,
+    DOUBLE = 5,
+    STRING = 6
+};
+
+struct Column
+{
+    std::string name;
+    ColumnType type;
+};
+
+/**
+ * One sampled value; which member is valid depends on the column type.
+ */
+struct Value
+{
+    union {
+        bool b;
+        int32_t i;
+        int64_t l;
+        float f;
+        double d;
+    };
+    std::string s;
+};
+
+typedef std::vector<Value> Row;
+
+uint32_t crc32(const void* data, size_t size, uint32_t crc = 0);
+
+/// Writes the header for the given columns.
+void writeHeader(std::ostream& out, const std::vector<Column>& columns);
+
+/// Encodes the rows as one block and writes it.
+void writeBlock(std::ostream& out, const std::vector<Column>& columns,
+                const std::vector<const Row*>& rows);
+
+/// Formats a value the way the CSV log does.
+void formatValue(std::ostream& out, ColumnType type, const Value& value);
+
+class Reader
+{
+public:
+    enum Status {
+        OK,
+        END,      ///< no more data
+        CORRUPT   ///< checksum or structure error
+    };
+
+    explicit Reader(std::istream& in);
+
+    /// Reads and checks the header, which must be done first.
+    Status readHeader();
+
+    const std::vector<Column>& columns() const { return _columns; }
+
+    /**
+     * Reads the next block, replacing the contents of rows. On CORRUPT,
+     * the next call looks for the following block.
+     */
+    Status readBlock(std::vector<Row>& rows);
+
+private:
+    bool findMarker();
+    size_t minRowBytes() const;
+
+    std::istream& _in;
+    bool _resync = false;
+    std::vector<Column> _columns;
+    std::string _payload;
+};
+
+} // of namespace logformat
+} // of namespace flightgear
+
+#endif // __LOGGER_FORMAT_HXX
@@ -78,6 +78,7 @@
 #include "subsystemFactory.hxx"
 #include "util.hxx"
 #include <Main/ErrorReporter.hxx>
+#include <Main/FrameProfiler.hxx>
 #include <Main/sentryIntegration.hxx>
 
 #include <simgear/embedded_resources/EmbeddedResourceManager.hxx>
@@ -162,8 +163,15 @@ static void fgMainLoop( void )
     timeManager->computeTimeDeltas(sim_dt, real_dt);
 
     // update all subsystems
+    auto frameProfiler = globals->get_subsystem<flightgear::FrameProfiler>();
+    if (frameProfiler)
+        frameProfiler->beginFrame();
+
     globals->get_subsystem_mgr()->update(sim_dt);
 
+    if (frameProfiler)
+        frameProfiler->endFrame();
+
     // flush commands waiting in the queue
     SGCommandMgr::instance()->executedQueuedCommands();
     simgear::AtomicChangeListener::fireChangeListeners();
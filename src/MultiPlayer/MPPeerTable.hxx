@@ -0,0 +1,191 @@
+//////////////////////////////////////////////////////////////////////
+//
+// MPPeerTable.hxx
+//
+// Flat open addressing hash map from a multiplayer callsign to the
+// per-peer state kept by FGMultiplayMgr.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+//////////////////////////////////////////////////////////////////////
+
+#ifndef MPPEERTABLE_H
+#define MPPEERTABLE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mpmessages.hxx"
+
+/**
+ * Hash map from callsign to T.
+ *
+ * Callsigns on the wire are at most MAX_CALLSIGN_LEN bytes, so they are
+ * packed into a single 64 bit key and looked up with linear probing in a
+ * power of two sized slot array. Erasing uses backward shift deletion, so
+ * there are no tombstones and lookups stay short however much the peer
+ * population churns.
+ */
+template <typename T>
+class MPPeerTable
+{
+public:
+    /**
+     * Packs the first maxLen bytes of a callsign, stopping at a NUL, into
+     * a key. The callsign in a message header need not be NUL terminated.
+     * Returns false for an empty callsign.
+     */
+    static bool makeKey(const char* callsign, size_t maxLen, uint64_t& key)
+    {
+        key = 0;
+        size_t i = 0;
+        for (; i < maxLen && i < MAX_CALLSIGN_LEN && callsign[i]; ++i)
+            key |= uint64_t(uint8_t(callsign[i])) << (8 * i);
+        return i > 0;
+    }
+
+    /// Returns false if callsign cannot be a multiplayer callsign.
+    static bool makeKey(const std::string& callsign, uint64_t& key)
+    {
+        if (callsign.size() > MAX_CALLSIGN_LEN)
+            return false;
+        return makeKey(callsign.c_str(), callsign.size(), key);
+    }
+
+    /// Inverse of makeKey().
+    static std::string keyToCallsign(uint64_t key)
+    {
+        std::string ret;
+        for (; key; key >>= 8)
+            ret += char(key & 0xff);
+        return ret;
+    }
+
+    T* find(uint64_t key)
+    {
+        if (_size == 0)
+            return nullptr;
+        for (size_t i = home(key);; i = (i + 1) & _mask) {
+            Slot& s = _slots[i];
+            if (!s.used)
+                return nullptr;
+            if (s.key == key)
+                return &s.value;
+        }
+    }
+
+    /// Returns the entry for key, default constructing it if necessary.
+    T& insert(uint64_t key)
+    {
+        if ((_size + 1) * 2 > _slots.size())
+            rehash(_slots.empty() ? 16 : _slots.size() * 2);
+        size_t i = home(key);
+        for (;; i = (i + 1) & _mask) {
+            Slot& s = _slots[i];
+            if (!s.used)
+                break;
+            if (s.key == key)
+                return s.value;
+        }
+        _slots[i].used = true;
+        _slots[i].key = key;
+        _slots[i].value = T();
+        ++_size;
+        return _slots[i].value;
+    }
+
+    bool erase(uint64_t key)
+    {
+        if (_size == 0)
+            return false;
+        size_t i = home(key);
+        for (;; i = (i + 1) & _mask) {
+            if (!_slots[i].used)
+                return false;
+            if (_slots[i].key == key)
+                break;
+        }
+        // Shift later members of the probe run back into the hole until we
+        // reach an empty slot or an entry already at its home position.
+        size_t hole = i;
+        for (size_t j = (i + 1) & _mask; _slots[j].used; j = (j + 1) & _mask) {
+            size_t h = home(_slots[j].key);
+            if (((j - h) & _mask) >= ((j - hole) & _mask)) {
+                _slots[hole].key = _slots[j].key;
+                _slots[hole].value = std::move(_slots[j].value);
+                hole = j;
+            }
+        }
+        _slots[hole].used = false;
+        _slots[hole].value = T();
+        --_size;
+        return true;
+    }
+
+    void clear()
+    {
+        _slots.clear();
+        _mask = 0;
+        _size = 0;
+    }
+
+    size_t size() const { return _size; }
+
+    /// Calls f(key, value) for every entry. f must not modify the table.
+    template <typename F>
+    void forEach(F f)
+    {
+        for (Slot& s : _slots) {
+            if (s.used)
+                f(s.key, s.value);
+        }
+    }
+
+private:
+    struct Slot
+    {
+        uint64_t key = 0;
+        bool used = false;
+        T value;
+    };
+
+    size_t home(uint64_t key) const
+    {
+        // Fibonacci hashing; callsigns differ mostly in their low bytes.
+        return size_t((key * 0x9E3779B97F4A7C15ull) >> 32) & _mask;
+    }
+
+    void rehash(size_t capacity)
+    {
+        std::vector<Slot> old;
+        old.swap(_slots);
+        _slots.resize(capacity);
+        _mask = capacity - 1;
+        _size = 0;
+        for (Slot& s : old) {
+            if (s.used)
+                insert(s.key) = std::move(s.value);
+        }
+    }
+
+    std::vector<Slot> _slots;
+    size_t _mask = 0;
+    size_t _size = 0;
+};
+
+#endif
@@ -221,7 +221,7 @@ static xdr_data_t *decode_received_launchbar_state(const IdPropertyList *propDef
 // A static map of protocol property id values to property paths,
 // This should be extendable dynamically for every specific aircraft ...
 // For now only that static list
-static const IdPropertyList sIdPropertyList[] = {
+static constexpr IdPropertyList sIdPropertyList[] = {
     { 10,  "sim/multiplay/protocol-version",          simgear::props::INT,   TT_SHORTINT,  V2_PROP_ID_PROTOCOL, NULL, NULL },
     { 100, "surface-positions/left-aileron-pos-norm",  simgear::props::FLOAT, TT_SHORT_FLOAT_NORM,  V1_1_PROP_ID, NULL, NULL },
     { 101, "surface-positions/right-aileron-pos-norm", simgear::props::FLOAT, TT_SHORT_FLOAT_NORM,  V1_1_PROP_ID, NULL, NULL },
@@ -686,41 +686,77 @@ static const IdPropertyList sIdPropertyList[] = {
  * first V2 property based on ID.
  */
 const int MAX_PARTITIONS = 2;
-const unsigned int numProperties = (sizeof(sIdPropertyList) / sizeof(sIdPropertyList[0]));
+constexpr unsigned int numProperties = (sizeof(sIdPropertyList) / sizeof(sIdPropertyList[0]));
 
-// Look up a property ID using binary search.
+// Look up a property ID in a dense id -> sIdPropertyList index table that is
+// generated at compile time, so decoding a property does no searching.
 namespace
 {
-  struct ComparePropertyId
+  constexpr uint16_t NO_PROPERTY_INDEX = 0xffff;
+
+  constexpr unsigned maxPropertyId()
   {
-    bool operator()(const IdPropertyList& lhs,
-                    const IdPropertyList& rhs)
-    {
-      return lhs.id < rhs.id;
+    unsigned ret = 0;
+    for (unsigned i = 0; i < numProperties; ++i) {
+      if (sIdPropertyList[i].id > ret)
+        ret = sIdPropertyList[i].id;
     }
-    bool operator()(const IdPropertyList& lhs,
-                    unsigned id)
-    {
-      return lhs.id < id;
-    }
-    bool operator()(unsigned id,
-                    const IdPropertyList& rhs)
-    {
-      return id < rhs.id;
+    return ret;
+  }
+
+  constexpr bool propertyIdsAreUnique()
+  {
+    for (unsigned i = 1; i < numProperties; ++i) {
+      if (sIdPropertyList[i].id <= sIdPropertyList[i - 1].id)
+        return false;
     }
+    return true;
+  }
+
+  constexpr unsigned MAX_PROPERTY_ID = maxPropertyId();
+
+  static_assert(propertyIdsAreUnique(), "sIdPropertyList must be sorted by id without duplicates");
+  static_assert(numProperties < NO_PROPERTY_INDEX, "sIdPropertyList too large for the index table");
+
+  struct PropertyIndexTable
+  {
+    uint16_t index[MAX_PROPERTY_ID + 1];
   };
+
+  constexpr PropertyIndexTable makePropertyIndexTable()
+  {
+    PropertyIndexTable table{};
+    for (unsigned id = 0; id <= MAX_PROPERTY_ID; ++id)
+      table.index[id] = NO_PROPERTY_INDEX;
+    for (unsigned i = 0; i < numProperties; ++i)
+      table.index[sIdPropertyList[i].id] = static_cast<uint16_t>(i);
+    return table;
+  }
+
+  constexpr PropertyIndexTable sPropertyIndex = makePropertyIndexTable();
+
+  inline int propertyIndex(unsigned id)
+  {
+    if (id > MAX_PROPERTY_ID || sPropertyIndex.index[id] == NO_PROPERTY_INDEX)
+      return -1;
+    return sPropertyIndex.index[id];
+  }
 }
 
-const IdPropertyList* findProperty(unsigned id)
+static const IdPropertyList* findProperty(unsigned id)
 {
-  std::pair<const IdPropertyList*, const IdPropertyList*> result
-    = std::equal_range(sIdPropertyList, sIdPropertyList + numProperties, id,
-                       ComparePropertyId());
-  if (result.first == result.second) {
-    return 0;
-  } else {
-    return result.first;
-  }
+  int index = propertyIndex(id);
+  return index < 0 ? nullptr : &sIdPropertyList[index];
+}
+
+int FGMultiplayMgr::getPropertyIndex(unsigned id)
+{
+  return propertyIndex(id);
+}
+
+unsigned FGMultiplayMgr::getNumPropertyIds()
+{
+  return numProperties;
 }
 
 namespace
@@ -1059,6 +1095,29 @@ FGMultiplayMgr::FGMultiplayMgr()
   pReplayState = fgGetNode("/sim/replay/replay-state", true);
   pLogRawSpeedMultiplayer = fgGetNode("/sim/replay/log-raw-speed-multiplayer", true);
 
+  // Interest management of incoming traffic, see ProcessPosMsg().
+  SGPropertyNode* interest = fgGetNode("/sim/multiplay/interest", true);
+  pInterestEnabled = interest->getNode("enabled", true);
+  if (!pInterestEnabled->hasValue())
+    pInterestEnabled->setBoolValue(true);
+  pInterestNearRange = interest->getNode("near-range-nm", true);
+  if (!pInterestNearRange->hasValue())
+    pInterestNearRange->setDoubleValue(30.0);
+  pInterestFarInterval = interest->getNode("far-interval-sec", true);
+  if (!pInterestFarInterval->hasValue())
+    pInterestFarInterval->setDoubleValue(1.0);
+  pInterestFarPropertiesInterval = interest->getNode("far-properties-interval-sec", true);
+  if (!pInterestFarPropertiesInterval->hasValue())
+    pInterestFarPropertiesInterval->setDoubleValue(5.0);
+  pInterestFarPropertiesPerFrame = interest->getNode("far-properties-per-frame", true);
+  if (!pInterestFarPropertiesPerFrame->hasValue())
+    pInterestFarPropertiesPerFrame->setIntValue(4);
+  const char* tierNames[NUM_TIERS] = {"near", "far"};
+  for (int i = 0; i < NUM_TIERS; ++i) {
+    pInterestDecoded[i] = interest->getNode(std::string(tierNames[i]) + "/decoded", true);
+    pInterestSkipped[i] = interest->getNode(std::string(tierNames[i]) + "/skipped", true);
+  }
+
 
 } // FGMultiplayMgr::FGMultiplayMgr()
 //////////////////////////////////////////////////////////////////////
@@ -1212,11 +1271,9 @@ FGMultiplayMgr::shutdown (void)
     mSocket.reset();
   }
 
-  MultiPlayerMap::iterator it = mMultiPlayerMap.begin(),
-    end = mMultiPlayerMap.end();
-  for (; it != end; ++it) {
-    it->second->setDie(true);
-  }
+  mMultiPlayerMap.forEach([](uint64_t, Peer& peer) {
+    peer.multiplayer->setDie(true);
+  });
   mMultiPlayerMap.clear();
 
   if (mListener) {
@@ -1972,6 +2029,8 @@ FGMultiplayMgr::update(double dt)
       Send(mpTime);
   }
 
+  mOwnPositionCart = globals->get_aircraft_position_cart();
+
   //////////////////////////////////////////////////
   //  Read from receive socket and/or multiplayer
   //  replay, and process any data.
@@ -2037,17 +2096,33 @@ FGMultiplayMgr::update(double dt)
     }
   } while (bytes > 0);
 
-  // check for expiry
-  MultiPlayerMap::iterator it = mMultiPlayerMap.begin();
-  while (it != mMultiPlayerMap.end()) {
-    if (it->second->getLastTimestamp() + 10 < stamp) {
-      std::string name = it->first;
-      it->second->setDie(true);
-      mMultiPlayerMap.erase(it);
-      it = mMultiPlayerMap.upper_bound(name);
-    } else
-      ++it;
+  // Decode a few of the property blobs held back from far peers. Peers
+  // that have just been decoded wait out the interval, so everybody gets
+  // a turn even when the per-frame budget is small.
+  {
+    double now = SGTimeStamp::now().toSecs();
+    double interval = pInterestFarPropertiesInterval->getDoubleValue();
+    int budget = pInterestFarPropertiesPerFrame->getIntValue();
+    mMultiPlayerMap.forEach([&](uint64_t, Peer& peer) {
+      if (budget > 0 && !peer.pendingMsg.empty()
+          && now >= peer.propertiesTime + interval) {
+        decodePendingProperties(peer, now);
+        --budget;
+      }
+    });
   }
+  updateInterestStats();
+
+  // check for expiry
+  std::vector<uint64_t> expired;
+  mMultiPlayerMap.forEach([&](uint64_t key, Peer& peer) {
+    if (peer.multiplayer->getLastTimestamp() + 10 < stamp) {
+      peer.multiplayer->setDie(true);
+      expired.push_back(key);
+    }
+  });
+  for (uint64_t key : expired)
+    mMultiPlayerMap.erase(key);
 
   if (_mpirc) {
       _mpirc->update();
@@ -2061,9 +2136,9 @@ FGMultiplayMgr::update(double dt)
 void FGMultiplayMgr::ClearMotion()
 {
     SG_LOG(SG_NETWORK, SG_DEBUG, "Clearing all motion info");
-    for (auto it: mMultiPlayerMap) {
-        it.second->clearMotionInfo();
-    }
+    mMultiPlayerMap.forEach([](uint64_t, Peer& peer) {
+        peer.multiplayer->clearMotionInfo();
+    });
 }
 
 void FGMultiplayMgr::Send(double mpTime)
@@ -2207,6 +2282,14 @@ FGMultiplayMgr::ProcessPosMsg(const FGMultiplayMgr::MsgBuf& Msg,
          << "Position message received with insufficient data");
       return;
    }
+   uint64_t key;
+   if (!MultiPlayerMap::makeKey(MsgHdr->Callsign, MAX_CALLSIGN_LEN, key)) {
+      SG_LOG(SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::MP_ProcessData - "
+         << "Position message received with empty callsign");
+      return;
+   }
+   Peer* peer = mMultiPlayerMap.find(key);
+
    const T_PositionMsg* PosMsg = Msg.posMsg();
    FGExternalMotionData motionInfo;
    int fallback_model_index = 0;
@@ -2230,6 +2313,7 @@ FGMultiplayMgr::ProcessPosMsg(const FGMultiplayMgr::MsgBuf& Msg,
    // sanity check: do not allow injection of corrupted data (NaNs)
    if (!isSane(motionInfo))
    {
+      ++mInterestSkipped[peer ? peer->tier : TIER_NEAR];
       // drop this message, keep old position until receiving valid data
       SG_LOG(SG_NETWORK, SG_DEBUG, "FGMultiplayMgr::ProcessPosMsg - "
          << "Position message with invalid data (NaN) received from "
@@ -2237,7 +2321,90 @@ FGMultiplayMgr::ProcessPosMsg(const FGMultiplayMgr::MsgBuf& Msg,
       return;
    }
 
-   //cout << "INPUT MESSAGE\n";
+   // Interest management. New peers are always fully decoded, as creating
+   // the model needs the fallback model index from the properties.
+   if (peer && pInterestEnabled->getBoolValue()) {
+      peer->tier = classifyPeer(*peer, motionInfo.position);
+   } else if (peer) {
+      peer->tier = TIER_NEAR;
+   }
+
+   if (peer && peer->tier == TIER_FAR) {
+      double now = SGTimeStamp::now().toSecs();
+      if (now < peer->farDecodeTime) {
+         ++mInterestSkipped[TIER_FAR];
+         return;
+      }
+      peer->farDecodeTime = now + pInterestFarInterval->getDoubleValue();
+      ++mInterestDecoded[TIER_FAR];
+
+      // Keep the raw message; update() decodes its properties when they
+      // are due. Any older pending message is simply superseded.
+      peer->pendingMsg.assign(Msg.Msg, Msg.Msg + MsgHdr->MsgLen);
+   } else {
+      ++mInterestDecoded[TIER_NEAR];
+      fallback_model_index = decodeProperties(Msg, motionInfo.properties);
+      if (peer) {
+         peer->pendingMsg.clear();
+         peer->propertiesTime = SGTimeStamp::now().toSecs();
+      }
+   }
+
+  FGAIMultiplayer* mp = peer ? peer->multiplayer.get() : nullptr;
+  if (!mp) {
+    mp = addMultiplayer(MultiPlayerMap::keyToCallsign(key), PosMsg->Model, fallback_model_index);
+    if (!mp)
+      return;
+  }
+  mp->addMotionInfo(motionInfo, stamp);
+  
+  // Optionally gather information about the raw speed of a selected
+  // multiplayer aircraft. This is for scripts/python/recordreplay.py
+  // --test-motion-mp.
+  //
+  {
+    const char* callsign = pLogRawSpeedMultiplayer->getStringValue();
+    if (callsign && callsign[0] && !strcmp(callsign, MsgHdr->Callsign)) {
+        static SGVec3d s_pos_prev;
+        static double s_simtime_prev = -1;
+        SGVec3d pos = motionInfo.position;
+        double dt = motionInfo.time - s_simtime_prev;
+        if (s_simtime_prev != -1 && dt > 0) {
+            double distance = length(pos - s_pos_prev);
+            double speed = distance / dt;
+            SGPropertyNode* n = fgGetNode("/sim/replay/log-raw-speed-multiplayer-values", true /*create*/);
+            n = n->addChild("value");
+            n->setDoubleValue(speed);
+            SG_LOG(SG_GENERAL, SG_DEBUG, "Multiplayer aircraft callsign=" << callsign << ":"
+                    << " motionInfo.time=" << motionInfo.time
+                    << " dt=" << dt
+                    << " distance=" << distance
+                    << " speed=" << speed
+                    << " s_pos_prev=" << s_pos_prev
+                    << " pos=" << pos
+                    << " n->getPath()=" << n->getPath(true /*simplify*/)
+                    );
+        }
+        s_simtime_prev = motionInfo.time;
+        s_pos_prev = pos;
+    }
+  }
+} // FGMultiplayMgr::ProcessPosMsg()
+
+
+//////////////////////////////////////////////////////////////////////
+//
+//  Decode the property list of a position message, returns the
+//  fallback model index if the message carries one
+//
+//////////////////////////////////////////////////////////////////////
+int
+FGMultiplayMgr::decodeProperties(const FGMultiplayMgr::MsgBuf& Msg,
+                                 std::vector<FGPropertyData*>& properties)
+{
+   const T_MsgHdr* MsgHdr = Msg.msgHdr();
+   const T_PositionMsg* PosMsg = Msg.posMsg();
+   int fallback_model_index = 0;
 
    // There was a bug in 1.9.0 and before: T_PositionMsg was 196 bytes
    // on 32 bit architectures and 200 bytes on 64 bit, and this
@@ -2267,7 +2434,7 @@ FGMultiplayMgr::ProcessPosMsg(const FGMultiplayMgr::MsgBuf& Msg,
         if (verifyProperties(&PosMsg->pad, Msg.propsRecvdEnd()))
             xdr = &PosMsg->pad;
         else if (!verifyProperties(xdr, Msg.propsRecvdEnd()))
-            goto noprops;
+            return 0;
     }
     while (xdr < Msg.propsRecvdEnd()) {
         // First element is always the ID
@@ -2342,7 +2509,7 @@ FGMultiplayMgr::ProcessPosMsg(const FGMultiplayMgr::MsgBuf& Msg,
                           pData->id = id + bitidx;
                           pData->int_value = (val & (1 << bitidx)) != 0;
                           pData->type = simgear::props::BOOL;
-                          motionInfo.properties.push_back(pData);
+                          properties.push_back(pData);
 
                           // ensure that this is null because this section of code manages the property data and list directly
                           // it has to be this way because one MP value results in multiple properties being set.
@@ -2454,7 +2621,7 @@ FGMultiplayMgr::ProcessPosMsg(const FGMultiplayMgr::MsgBuf& Msg,
           }
       }
       if (pData) {
-        motionInfo.properties.push_back(pData);
+        properties.push_back(pData);
 
         // Special case - we need the /sim/model/fallback-model-index to create
         // the MP model
@@ -2476,44 +2643,54 @@ FGMultiplayMgr::ProcessPosMsg(const FGMultiplayMgr::MsgBuf& Msg,
       break;
     }
   }
- noprops:
-  FGAIMultiplayer* mp = getMultiplayer(MsgHdr->Callsign);
-  if (!mp)
-    mp = addMultiplayer(MsgHdr->Callsign, PosMsg->Model, fallback_model_index);
-  mp->addMotionInfo(motionInfo, stamp);
-  
-  // Optionally gather information about the raw speed of a selected
-  // multiplayer aircraft. This is for scripts/python/recordreplay.py
-  // --test-motion-mp.
-  //
-  {
-    const char* callsign = pLogRawSpeedMultiplayer->getStringValue();
-    if (callsign && callsign[0] && !strcmp(callsign, MsgHdr->Callsign)) {
-        static SGVec3d s_pos_prev;
-        static double s_simtime_prev = -1;
-        SGVec3d pos = motionInfo.position;
-        double dt = motionInfo.time - s_simtime_prev;
-        if (s_simtime_prev != -1 && dt > 0) {
-            double distance = length(pos - s_pos_prev);
-            double speed = distance / dt;
-            SGPropertyNode* n = fgGetNode("/sim/replay/log-raw-speed-multiplayer-values", true /*create*/);
-            n = n->addChild("value");
-            n->setDoubleValue(speed);
-            SG_LOG(SG_GENERAL, SG_DEBUG, "Multiplayer aircraft callsign=" << callsign << ":"
-                    << " motionInfo.time=" << motionInfo.time
-                    << " dt=" << dt
-                    << " distance=" << distance
-                    << " speed=" << speed
-                    << " s_pos_prev=" << s_pos_prev
-                    << " pos=" << pos
-                    << " n->getPath()=" << n->getPath(true /*simplify*/)
-                    );
-        }
-        s_simtime_prev = motionInfo.time;
-        s_pos_prev = pos;
-    }
+  return fallback_model_index;
+} // FGMultiplayMgr::decodeProperties()
+
+
+FGMultiplayMgr::PeerTier
+FGMultiplayMgr::classifyPeer(const Peer& peer, const SGVec3d& position) const
+{
+  double nearRange = pInterestNearRange->getDoubleValue() * SG_NM_TO_METER;
+  if (nearRange <= 0)
+    return TIER_NEAR;
+
+  // A little hysteresis so that peers hovering around the boundary do not
+  // switch tiers on every message.
+  if (peer.tier == TIER_FAR)
+    nearRange *= 0.9;
+  if (distSqr(position, mOwnPositionCart) > nearRange * nearRange)
+    return TIER_FAR;
+  return TIER_NEAR;
+}
+
+
+void
+FGMultiplayMgr::decodePendingProperties(Peer& peer, double now)
+{
+  MsgBuf msgBuf;
+  size_t len = std::min(peer.pendingMsg.size(), sizeof(msgBuf.Msg));
+  memcpy(msgBuf.Msg, peer.pendingMsg.data(), len);
+  peer.pendingMsg.clear();
+  peer.propertiesTime = now;
+
+  // The motion frames of far peers carry no properties, so the values are
+  // applied directly and stay until the next decode.
+  std::vector<FGPropertyData*> properties;
+  decodeProperties(msgBuf, properties);
+  peer.multiplayer->applyProperties(properties);
+  for (FGPropertyData* pData : properties)
+    delete pData;
+}
+
+
+void
+FGMultiplayMgr::updateInterestStats()
+{
+  for (int i = 0; i < NUM_TIERS; ++i) {
+    pInterestDecoded[i]->setLongValue(mInterestDecoded[i]);
+    pInterestSkipped[i]->setLongValue(mInterestSkipped[i]);
   }
-} // FGMultiplayMgr::ProcessPosMsg()
+}
 
 
 std::shared_ptr<std::vector<char>> FGMultiplayMgr::popMessageHistory()
@@ -2619,14 +2796,18 @@ FGMultiplayMgr::addMultiplayer(const std::string& callsign,
                                const std::string& modelName,
                                const int fallback_model_index)
 {
-  if (0 < mMultiPlayerMap.count(callsign))
-    return mMultiPlayerMap[callsign].get();
+  uint64_t key;
+  if (!MultiPlayerMap::makeKey(callsign, key))
+    return nullptr;
+  Peer& peer = mMultiPlayerMap.insert(key);
+  if (peer.multiplayer)
+    return peer.multiplayer.get();
 
   FGAIMultiplayer* mp = new FGAIMultiplayer;
   mp->setPath(modelName.c_str());
   mp->setFallbackModelIndex(fallback_model_index);
   mp->setCallSign(callsign);
-  mMultiPlayerMap[callsign] = mp;
+  peer.multiplayer = mp;
 
   FGAIManager *aiMgr = (FGAIManager*)globals->get_subsystem("ai-model");
   if (aiMgr) {
@@ -2800,10 +2981,11 @@ FGMultiplayMgr::addMultiplayer(const std::string& callsign,
 FGAIMultiplayer*
 FGMultiplayMgr::getMultiplayer(const std::string& callsign)
 {
-  if (0 < mMultiPlayerMap.count(callsign))
-    return mMultiPlayerMap[callsign].get();
-  else
-    return 0;
+  uint64_t key;
+  if (!MultiPlayerMap::makeKey(callsign, key))
+    return nullptr;
+  Peer* peer = mMultiPlayerMap.find(key);
+  return peer ? peer->multiplayer.get() : nullptr;
 }
 
 void
@@ -44,6 +44,8 @@ const int MAX_MP_PROTOCOL_VERSION = 2;
 #include <simgear/io/raw_socket.hxx>
 #include <simgear/structure/subsystem_mgr.hxx>
 
+#include "MPPeerTable.hxx"
+
 class IRCConnection;
 class CPDLCManager;
 
@@ -80,6 +82,12 @@ public:
 
     FGAIMultiplayer* getMultiplayer(const std::string& callsign);
 
+    // Dense index of a multiplayer property id in the table of known
+    // properties, or -1 if the id is unknown. Valid indices are less than
+    // getNumPropertyIds(), so they can be used to index per-peer caches.
+    static int getPropertyIndex(unsigned id);
+    static unsigned getNumPropertyIds();
+
     std::shared_ptr<vector<char>> popMessageHistory();
     void pushMessageHistory(std::shared_ptr<vector<char>> message);
     
@@ -119,13 +127,43 @@ private:
     void FillMsgHdr(T_MsgHdr *MsgHdr, int iMsgId, unsigned _len = 0u);
     void ProcessPosMsg(const MsgBuf& Msg, const simgear::IPAddress& SenderAddress,
                        long stamp);
+    int decodeProperties(const MsgBuf& Msg, std::vector<FGPropertyData*>& properties);
     void ProcessChatMsg(const MsgBuf& Msg, const simgear::IPAddress& SenderAddress);
     bool isSane(const FGExternalMotionData& motionInfo);
     int GetMsgNetwork(MsgBuf& msgBuf, simgear::IPAddress& SenderAddress);
     int GetMsg(MsgBuf& msgBuf, simgear::IPAddress& SenderAddress);
 
-    /// maps from the callsign string to the FGAIMultiplayer
-    typedef std::map<std::string, SGSharedPtr<FGAIMultiplayer> > MultiPlayerMap;
+    /**
+     * Interest management tiers for incoming position messages. Near peers
+     * get every message fully decoded. Far peers get position only decode
+     * at a reduced rate, and the properties of their newest accepted
+     * message are decoded lazily from a copy of the raw message.
+     */
+    enum PeerTier
+    {
+        TIER_NEAR,
+        TIER_FAR,
+        NUM_TIERS
+    };
+
+    struct Peer
+    {
+        SGSharedPtr<FGAIMultiplayer> multiplayer;
+        PeerTier tier = TIER_NEAR;
+        /// Local time before which far tier messages are skipped.
+        double farDecodeTime = 0.0;
+        /// Local time the properties were last decoded.
+        double propertiesTime = 0.0;
+        /// Newest far tier message whose properties have not been decoded.
+        std::vector<char> pendingMsg;
+    };
+
+    PeerTier classifyPeer(const Peer& peer, const SGVec3d& position) const;
+    void decodePendingProperties(Peer& peer, double now);
+    void updateInterestStats();
+
+    /// maps from the callsign to the peer state
+    typedef MPPeerTable<Peer> MultiPlayerMap;
     MultiPlayerMap mMultiPlayerMap;
 
     std::unique_ptr<simgear::Socket> mSocket;
@@ -145,6 +183,19 @@ private:
     SGPropertyNode *pMultiPlayTransmitPropertyBase;
     SGPropertyNode *pReplayState;
     SGPropertyNode *pLogRawSpeedMultiplayer;
+
+    SGPropertyNode_ptr pInterestEnabled;
+    SGPropertyNode_ptr pInterestNearRange;
+    SGPropertyNode_ptr pInterestFarInterval;
+    SGPropertyNode_ptr pInterestFarPropertiesInterval;
+    SGPropertyNode_ptr pInterestFarPropertiesPerFrame;
+    SGPropertyNode_ptr pInterestDecoded[NUM_TIERS];
+    SGPropertyNode_ptr pInterestSkipped[NUM_TIERS];
+    long mInterestDecoded[NUM_TIERS] = {0, 0};
+    long mInterestSkipped[NUM_TIERS] = {0, 0};
+
+    // Our own position, refreshed once per update() for tier classification.
+    SGVec3d mOwnPositionCart;
    
     typedef std::map<unsigned int, const struct IdPropertyList*> PropertyDefinitionMap;
     PropertyDefinitionMap mPropertyDefinition;
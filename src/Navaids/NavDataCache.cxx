@@ -66,6 +66,7 @@
 
 #include "CacheSchema.h"
 #include "PositionedOctree.hxx"
+#include "PositionedSpatialIndex.hxx"
 #include "fix.hxx"
 #include "markerbeacon.hxx"
 #include "navrecord.hxx"
@@ -201,10 +202,22 @@ public:
   {
     SGTimeStamp st;
     st.stamp();
+    {
+        std::lock_guard<std::mutex> g(_lock);
+        _phaseStart.stamp();
+    }
     _cache->doRebuild();
     SG_LOG(SG_NAVCACHE, SG_INFO, "cache rebuild took:" << st.elapsedMSec() << "msec");
 
     std::lock_guard<std::mutex> g(_lock);
+    _phaseMSec[_phase] += _phaseStart.elapsedMSec();
+    for (int ph = 0; ph < NavDataCache::REBUILD_DONE; ++ph) {
+        if (_phaseMSec[ph] > 0) {
+            SG_LOG(SG_NAVCACHE, SG_INFO, "  rebuild phase " << rebuildPhaseName(ph)
+                   << " took:" << _phaseMSec[ph] << "msec");
+        }
+    }
+
     _isFinished = true;
     _phase = NavDataCache::REBUILD_DONE;
   }
@@ -225,17 +238,37 @@ public:
         return perc;
     }
 
+    unsigned int phaseElapsedMSec() const
+    {
+        std::lock_guard<std::mutex> g(_lock);
+        return _phaseStart.elapsedMSec();
+    }
+
     void setProgress(NavDataCache::RebuildPhase ph, unsigned int percent)
     {
         std::lock_guard<std::mutex> g(_lock);
+        if (ph != _phase) {
+            _phaseMSec[_phase] += _phaseStart.elapsedMSec();
+            _phaseStart.stamp();
+        }
         _phase = ph;
         _completionPercent = percent;
     }
 
 private:
+    static const char* rebuildPhaseName(int ph)
+    {
+        static const char* names[] = {"other", "reading apt.dat", "loading airports",
+                                      "navaids", "fixes", "POIs"};
+        return names[ph];
+    }
+
   NavDataCache* _cache;
     NavDataCache::RebuildPhase _phase;
     unsigned int _completionPercent;
+    // time spent in each phase so far, and when the current one started
+    unsigned int _phaseMSec[NavDataCache::REBUILD_DONE] = {0};
+    SGTimeStamp _phaseStart;
   mutable std::mutex _lock;
   bool _isFinished;
 };
@@ -995,6 +1028,24 @@ public:
 
     std::set<Octree::Branch*> deferredOctreeUpdates;
 
+    // snapshot of the spatially indexed items, opened on first use
+    std::unique_ptr<PositionedSpatialIndex> spatialIndex;
+    bool spatialIndexOpened = false;
+    bool useSpatialIndex = true;
+
+    SGPath spatialIndexPath() const
+    {
+        return SGPath::fromUtf8(path.utf8Str() + ".spatial");
+    }
+
+    void resetSpatialIndex()
+    {
+        spatialIndex.reset();
+        spatialIndexOpened = false;
+    }
+
+    void writeSpatialIndex();
+
     // if we're performing a rebuild, the thread that is doing the work.
     // otherwise, NULL
     std::unique_ptr<RebuildThread> rebuilder;
@@ -1002,6 +1053,35 @@ public:
 
 //////////////////////////////////////////////////////////////////////
 
+void NavDataCache::NavDataCachePrivate::writeSpatialIndex()
+{
+    SGTimeStamp st;
+    st.stamp();
+
+    sqlite3_stmt_ptr q = prepare("SELECT rowid, type, cart_x, cart_y, cart_z "
+                                 "FROM positioned WHERE octree_node IS NOT NULL");
+    std::vector<PositionedSpatialIndex::Record> records;
+    while (stepSelect(q)) {
+        PositionedSpatialIndex::Record r;
+        r.id = sqlite3_column_int64(q, 0);
+        r.type = sqlite3_column_int(q, 1);
+        r.x = static_cast<float>(sqlite3_column_double(q, 2));
+        r.y = static_cast<float>(sqlite3_column_double(q, 3));
+        r.z = static_cast<float>(sqlite3_column_double(q, 4));
+        records.push_back(r);
+    }
+    reset(q);
+
+    // the stamp ties the file to this particular rebuild of the cache
+    std::ostringstream os;
+    os << SGTimeStamp::now().toUSecs();
+    const bool ok = PositionedSpatialIndex::write(spatialIndexPath(), os.str(), records);
+    outer->writeStringProperty("spatial-index-stamp", ok ? os.str() : string());
+
+    SG_LOG(SG_NAVCACHE, SG_INFO, "writing spatial index of " << records.size()
+           << " items took:" << st.elapsedMSec());
+}
+
 FGPositioned* NavDataCache::NavDataCachePrivate::loadById(sqlite3_int64 rowid,
                                                           sqlite3_int64& aptId)
 {
@@ -1538,6 +1618,7 @@ NavDataCache::RebuildPhase NavDataCache::rebuild()
                                                 "Failed to initialise NavCache rebuild protection");
         }
 
+        d->resetSpatialIndex();
         d->rebuilder.reset(new RebuildThread(this));
         d->rebuilder->start();
     }
@@ -1621,6 +1702,15 @@ unsigned int NavDataCache::rebuildPhaseCompletionPercentage() const
     return d->rebuilder->completionPercent();
 }
 
+unsigned int NavDataCache::rebuildPhaseElapsedMSec() const
+{
+    if (!d->rebuilder.get()) {
+        return 0;
+    }
+
+    return d->rebuilder->phaseElapsedMSec();
+}
+
 void NavDataCache::setRebuildPhaseProgress(RebuildPhase ph, unsigned int percent)
 {
     if (!d->rebuilder.get()) {
@@ -1738,6 +1828,7 @@ void NavDataCache::doRebuild()
           SG_LOG(SG_NAVCACHE, SG_INFO, "awy.dat load took:" << st.elapsedMSec());
 
           d->flushDeferredOctreeUpdates();
+          d->writeSpatialIndex();
 
           string sceneryPaths = SGPath::join(globals->get_fg_scenery(), ";");
           writeStringProperty("scenery_paths", sceneryPaths);
@@ -2054,6 +2145,12 @@ void NavDataCache::updatePosition(PositionedID item, const SGGeod &pos)
   Octree::Leaf* octreeLeaf = Octree::globalPersistentOctree()->findLeafForPos(cartPos);
   sqlite3_bind_int64(d->setAirportPos, 5, octreeLeaf->guid());
 
+  // the snapshot can't move items; fall back to the octree from now on
+  if (!rebuildInProgress) {
+      d->resetSpatialIndex();
+      d->useSpatialIndex = false;
+  }
+
   sqlite3_bind_double(d->setAirportPos, 6, cartPos.x());
   sqlite3_bind_double(d->setAirportPos, 7, cartPos.y());
   sqlite3_bind_double(d->setAirportPos, 8, cartPos.z());
@@ -2193,13 +2290,23 @@ PositionedID NavDataCache::insertFix(const std::string& ident, const SGGeod& aPo
 
 PositionedID NavDataCache::createPOI(FGPositioned::Type ty, const std::string& ident, const SGGeod& aPos)
 {
-  return d->insertPositioned(ty, ident, string(), aPos, 0,
-                             true /* spatial index */);
+  PositionedID id = d->insertPositioned(ty, ident, string(), aPos, 0,
+                                        true /* spatial index */);
+  // open the snapshot first, otherwise a later open would miss this item
+  if (!rebuildInProgress && spatialIndex()) {
+      d->spatialIndex->add(ty, id, SGVec3d::fromGeod(aPos));
+  }
+  return id;
 }
 
 bool NavDataCache::removePOI(FGPositioned::Type ty, const std::string& aIdent)
 {
   d->removePositionedWithIdent(ty, aIdent);
+  // the snapshot can't drop items; fall back to the octree from now on
+  if (!rebuildInProgress) {
+      d->resetSpatialIndex();
+      d->useSpatialIndex = false;
+  }
   // should remove from the live cache too?
 
     return true;
@@ -2320,6 +2427,31 @@ NavDataCache::getOctreeLeafChildren(int64_t octreeNodeId)
   return r;
 }
 
+const PositionedSpatialIndex* NavDataCache::spatialIndex()
+{
+  if (!d->useSpatialIndex || rebuildInProgress || d->rebuilder) {
+    return nullptr;
+  }
+
+  if (!d->spatialIndexOpened) {
+    d->spatialIndexOpened = true;
+    std::unique_ptr<PositionedSpatialIndex> index(new PositionedSpatialIndex);
+    if (index->open(d->spatialIndexPath(), readStringProperty("spatial-index-stamp"))) {
+      d->spatialIndex = std::move(index);
+    }
+  }
+
+  return d->spatialIndex.get();
+}
+
+void NavDataCache::setUseSpatialIndex(bool use)
+{
+  d->useSpatialIndex = use;
+  if (!use) {
+    d->resetSpatialIndex();
+  }
+}
+
 
 /**
  * A special purpose helper (used by FGAirport::searchNamesAndIdents) to
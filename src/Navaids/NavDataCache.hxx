@@ -53,6 +53,8 @@ namespace Octree {
   class Branch;
 }
 
+class PositionedSpatialIndex;
+
     class Airway;
     using AirwayRef = SGSharedPtr<Airway>;
 
@@ -130,6 +132,9 @@ public:
   RebuildPhase rebuild();
 
   unsigned int rebuildPhaseCompletionPercentage() const;
+  /// time spent in the current phase so far; the time taken by each phase
+  /// is logged once the rebuild is done
+  unsigned int rebuildPhaseElapsedMSec() const;
   void setRebuildPhaseProgress(RebuildPhase ph, unsigned int percent = 0);
 
   bool isCachedFileModified(const SGPath& path) const;
@@ -284,6 +289,16 @@ public:
    */
   TypedPositionedVec getOctreeLeafChildren(int64_t octreeNodeId);
 
+  /**
+   * the memory-mapped snapshot of the spatially indexed items, written at
+   * the end of each rebuild. Returns nullptr while rebuilding, if the
+   * snapshot is missing or stale, or if its use is disabled; the octree
+   * should be searched instead.
+   */
+  const PositionedSpatialIndex* spatialIndex();
+
+  void setUseSpatialIndex(bool use);
+
 // airways
   int findAirway(int network, const std::string& aName, bool create);
 
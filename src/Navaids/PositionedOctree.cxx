@@ -30,12 +30,14 @@
 #include <algorithm> // for sort
 #include <cstring> // for memset
 #include <iostream>
+#include <limits>
 
 #include <simgear/debug/logstream.hxx>
 #include <simgear/structure/exception.hxx>
 #include <simgear/timing/timestamp.hxx>
 
 #include "PolyLine.hxx"
+#include "PositionedSpatialIndex.hxx"
 
 namespace flightgear
 {
@@ -331,9 +333,112 @@ int Branch::childMask() const
   return result;
 }
 
+namespace {
+
+// Collects the results of a spatial index query. Only the candidates the
+// index finds within the cutoff are loaded, unlike Leaf::visit which has to
+// load every child of each leaf it visits.
+class IndexVisitor : public PositionedSpatialIndex::Visitor
+{
+public:
+  static const unsigned int UNLIMITED = std::numeric_limits<unsigned int>::max();
+
+  IndexVisitor(const SGVec3d& aPos, double aCutoffM, FGPositioned::Filter* aFilter,
+               unsigned int aN) :
+    _pos(aPos),
+    _cutoff(aCutoffM),
+    _filter(aFilter),
+    _maxResults(aN),
+    _cache(NavDataCache::instance())
+  {
+  }
+
+  double cutoff() const override
+  {
+    // once we have enough results, only closer items are of interest
+    if (!_results.empty() && (_results.size() >= _maxResults)) {
+      return _results.back().order();
+    }
+
+    return _cutoff;
+  }
+
+  void visit(const PositionedSpatialIndex::Record& rec, double) override
+  {
+    FGPositioned* p = _cache->loadById(rec.id);
+    if (!p) {
+      return;
+    }
+
+    double d = dist(_pos, p->cart());
+    if (d > cutoff()) {
+      return;
+    }
+
+    if (_filter && !_filter->pass(p)) {
+      return;
+    }
+
+    OrderedPositioned op(p, d);
+    if (_maxResults == UNLIMITED) {
+      // range query; sorted once at the end
+      _results.push_back(op);
+      return;
+    }
+
+    _results.insert(std::upper_bound(_results.begin(), _results.end(), op), op);
+    if (_results.size() > _maxResults) {
+      _results.pop_back();
+    }
+  }
+
+  void copyResults(FGPositionedList& aResults)
+  {
+    if (_maxResults == UNLIMITED) {
+      std::sort(_results.begin(), _results.end());
+    }
+
+    aResults.resize(_results.size());
+    for (unsigned int r=0; r<_results.size(); ++r) {
+      aResults[r] = _results[r].get();
+    }
+  }
+
+private:
+  const SGVec3d _pos;
+  const double _cutoff;
+  FGPositioned::Filter* _filter;
+  const unsigned int _maxResults;
+  NavDataCache* _cache;
+  FindNearestResults _results;
+};
+
+bool queryIndex(const PositionedSpatialIndex* aIndex, const SGVec3d& aPos,
+                FGPositioned::Filter* aFilter, IndexVisitor& aVisitor,
+                FGPositionedList& aResults, int aCutoffMsec)
+{
+  FGPositioned::Type minType = aFilter ? aFilter->minType() : FGPositioned::INVALID;
+  FGPositioned::Type maxType = aFilter ? aFilter->maxType() : FGPositioned::LAST_TYPE;
+  bool partial = aIndex->query(aPos, minType, maxType, aVisitor, aCutoffMsec);
+  aVisitor.copyResults(aResults);
+  return partial;
+}
+
+} // of anonymous namespace
+
 bool findNearestN(const SGVec3d& aPos, unsigned int aN, double aCutoffM, FGPositioned::Filter* aFilter, FGPositionedList& aResults, int aCutoffMsec)
 {
   aResults.clear();
+  if (aN == 0) {
+    return false;
+  }
+
+  const PositionedSpatialIndex* index = NavDataCache::instance()->spatialIndex();
+  if (index) {
+    IndexVisitor visitor(aPos, aCutoffM, aFilter, aN);
+    return queryIndex(index, aPos, aFilter, visitor, aResults, aCutoffMsec);
+  }
+
   FindNearestPQueue pq;
   FindNearestResults results;
   pq.push(Ordered<Node*>(globalPersistentOctree(), 0));
@@ -375,6 +480,12 @@ bool findNearestN(const SGVec3d& aPos, unsigned int aN, double aCutoffM, FGPosit
 bool findAllWithinRange(const SGVec3d& aPos, double aRangeM, FGPositioned::Filter* aFilter, FGPositionedList& aResults, int aCutoffMsec)
 {
   aResults.clear();
+  const PositionedSpatialIndex* index = NavDataCache::instance()->spatialIndex();
+  if (index) {
+    IndexVisitor visitor(aPos, aRangeM, aFilter, IndexVisitor::UNLIMITED);
+    return queryIndex(index, aPos, aFilter, visitor, aResults, aCutoffMsec);
+  }
+
   FindNearestPQueue pq;
   FindNearestResults results;
   pq.push(Ordered<Node*>(globalPersistentOctree(), 0));
@@ -0,0 +1,422 @@
+// PositionedSpatialIndex.cxx - memory-mapped snapshot of the spatial index
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "config.h"
+
+#include "PositionedSpatialIndex.hxx"
+
+#include <algorithm>
+#include <cstring>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#if !defined(SG_WINDOWS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace flightgear
+{
+
+namespace
+{
+
+const char FILE_MAGIC[8] = {'F', 'G', 'S', 'P', 'I', 'D', 'X', '\0'};
+const uint32_t FILE_VERSION = 1;
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t count;
+    char stamp[40];
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0, "records must stay aligned");
+static_assert(sizeof(PositionedSpatialIndex::Record) == 32, "unexpected record padding");
+
+// Same extent as the persistent octree; 21 bits per axis gives cells of
+// about 7m, and all three fit into a 63 bit key.
+const double EXTENT_M = 7000 * 1000.0;
+const int LEVELS = 21;
+const uint32_t CELLS = 1u << LEVELS;
+
+// the records hold single precision positions, which are within half a
+// metre of the real ones; searches are widened by this much, so visitors
+// can check the exact distance themselves
+const double POSITION_SLACK_M = 1.0;
+
+// nodes with no more items than this are scanned, not split further
+const size_t SCAN_THRESHOLD = 32;
+
+uint64_t spreadBits(uint32_t v)
+{
+    uint64_t x = v & (CELLS - 1);
+    x = (x | x << 32) & 0x1f00000000ffffULL;
+    x = (x | x << 16) & 0x1f0000ff0000ffULL;
+    x = (x | x << 8) & 0x100f00f00f00f00fULL;
+    x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+    x = (x | x << 2) & 0x1249249249249249ULL;
+    return x;
+}
+
+uint32_t quantise(double v)
+{
+    const double t = (v + EXTENT_M) / (2.0 * EXTENT_M) * CELLS;
+    if (t <= 0.0) {
+        return 0;
+    }
+    return std::min(static_cast<uint32_t>(t), CELLS - 1);
+}
+
+struct KeyLess
+{
+    bool operator()(const PositionedSpatialIndex::Record& r, uint64_t key) const
+    {
+        return r.key < key;
+    }
+};
+
+// A node of the implied octree: the cell (ix, iy, iz) at the given level,
+// and the range of records inside it.
+struct QueryNode
+{
+    uint64_t prefix;
+    uint32_t ix, iy, iz;
+    int level;
+    size_t begin, end;
+    double dist;    ///< from the query position to the cell
+};
+
+double distToCell(const SGVec3d& pos, uint32_t ix, uint32_t iy, uint32_t iz, int level)
+{
+    const double size = 2.0 * EXTENT_M / (1u << level);
+    const uint32_t cell[3] = {ix, iy, iz};
+    double d2 = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        const double lo = -EXTENT_M + cell[i] * size;
+        const double hi = lo + size;
+        double d = 0.0;
+        if (pos[i] < lo) {
+            d = lo - pos[i];
+        } else if (pos[i] > hi) {
+            d = pos[i] - hi;
+        }
+        d2 += d * d;
+    }
+    return sqrt(d2);
+}
+
+} // of anonymous namespace
+
+/**
+ * Read-only view of the index file. On Windows the file is simply read
+ * into memory.
+ */
+class PositionedSpatialIndex::Mapping
+{
+public:
+    ~Mapping()
+    {
+#if !defined(SG_WINDOWS)
+        if (_data) {
+            munmap(const_cast<char*>(_data), _size);
+        }
+#endif
+    }
+
+    bool open(const SGPath& path)
+    {
+#if defined(SG_WINDOWS)
+        sg_ifstream in(path, std::ios::in | std::ios::binary);
+        if (!in.is_open()) {
+            return false;
+        }
+        _buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        _data = _buffer.data();
+        _size = _buffer.size();
+        return true;
+#else
+        const std::string ps = path.utf8Str();
+        int fd = ::open(ps.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st;
+        if ((fstat(fd, &st) != 0) || (st.st_size == 0)) {
+            ::close(fd);
+            return false;
+        }
+
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // the mapping stays valid
+        if (p == MAP_FAILED) {
+            return false;
+        }
+
+        _data = static_cast<const char*>(p);
+        _size = st.st_size;
+        return true;
+#endif
+    }
+
+    const char* data() const { return _data; }
+    size_t size() const { return _size; }
+
+private:
+    const char* _data = nullptr;
+    size_t _size = 0;
+#if defined(SG_WINDOWS)
+    std::vector<char> _buffer;
+#endif
+};
+
+PositionedSpatialIndex::PositionedSpatialIndex()
+{
+}
+
+PositionedSpatialIndex::~PositionedSpatialIndex()
+{
+}
+
+uint64_t PositionedSpatialIndex::mortonKey(const SGVec3d& cart)
+{
+    return (spreadBits(quantise(cart.x())) << 2) |
+           (spreadBits(quantise(cart.y())) << 1) |
+           spreadBits(quantise(cart.z()));
+}
+
+bool PositionedSpatialIndex::write(const SGPath& path, const std::string& stamp,
+                                   std::vector<Record>& records)
+{
+    // key the stored (single precision) position, otherwise rounding could
+    // put an item just outside the cell the queries expect it in
+    for (Record& r : records) {
+        r.key = mortonKey(SGVec3d(r.x, r.y, r.z));
+    }
+
+    std::sort(records.begin(), records.end(),
+              [](const Record& a, const Record& b) { return a.key < b.key; });
+
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+    header.version = FILE_VERSION;
+    header.recordSize = sizeof(Record);
+    header.count = records.size();
+    strncpy(header.stamp, stamp.c_str(), sizeof(header.stamp) - 1);
+
+    // write to a temporary file, so a crash can't leave a truncated index
+    // with a valid header behind
+    SGPath tmpPath = SGPath::fromUtf8(path.utf8Str() + ".tmp");
+    {
+        sg_ofstream out(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            SG_LOG(SG_NAVCACHE, SG_WARN, "Unable to write spatial index " << tmpPath);
+            return false;
+        }
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()),
+                  records.size() * sizeof(Record));
+        if (!out.good()) {
+            SG_LOG(SG_NAVCACHE, SG_WARN, "Failed writing spatial index " << tmpPath);
+            return false;
+        }
+    }
+
+    if (path.exists()) {
+        SGPath(path).remove();
+    }
+    if (!tmpPath.rename(path)) {
+        SG_LOG(SG_NAVCACHE, SG_WARN, "Unable to rename spatial index to " << path);
+        return false;
+    }
+
+    return true;
+}
+
+bool PositionedSpatialIndex::open(const SGPath& path, const std::string& stamp)
+{
+    _mapping.reset();
+    _records = nullptr;
+    _count = 0;
+
+    std::unique_ptr<Mapping> mapping(new Mapping);
+    if (!mapping->open(path)) {
+        return false;
+    }
+
+    if (mapping->size() < sizeof(FileHeader)) {
+        return false;
+    }
+
+    FileHeader header;
+    memcpy(&header, mapping->data(), sizeof(header));
+    header.stamp[sizeof(header.stamp) - 1] = 0;
+    if (memcmp(header.magic, FILE_MAGIC, sizeof(header.magic)) ||
+        (header.version != FILE_VERSION) ||
+        (header.recordSize != sizeof(Record)) ||
+        (stamp != header.stamp) ||
+        (mapping->size() != sizeof(FileHeader) + header.count * sizeof(Record)))
+    {
+        SG_LOG(SG_NAVCACHE, SG_INFO, "Ignoring stale or invalid spatial index " << path);
+        return false;
+    }
+
+    _mapping = std::move(mapping);
+    _records = reinterpret_cast<const Record*>(_mapping->data() + sizeof(FileHeader));
+    _count = header.count;
+    SG_LOG(SG_NAVCACHE, SG_INFO, "Mapped spatial index with " << _count << " items");
+    return true;
+}
+
+void PositionedSpatialIndex::add(FGPositioned::Type ty, PositionedID id, const SGVec3d& cart)
+{
+    Record r;
+    r.id = id;
+    r.x = static_cast<float>(cart.x());
+    r.y = static_cast<float>(cart.y());
+    r.z = static_cast<float>(cart.z());
+    r.key = mortonKey(SGVec3d(r.x, r.y, r.z));
+    r.type = ty;
+    _added.push_back(r);
+}
+
+void PositionedSpatialIndex::visitRange(size_t begin, size_t end, const SGVec3d& pos,
+                                        FGPositioned::Type minType,
+                                        FGPositioned::Type maxType,
+                                        Visitor& visitor) const
+{
+    for (size_t i = begin; i < end; ++i) {
+        const Record& r = _records[i];
+        if ((r.type < static_cast<uint32_t>(minType)) ||
+            (r.type > static_cast<uint32_t>(maxType))) {
+            continue;
+        }
+
+        const double d = dist(pos, SGVec3d(r.x, r.y, r.z));
+        if (d <= visitor.cutoff() + POSITION_SLACK_M) {
+            visitor.visit(r, d);
+        }
+    }
+}
+
+bool PositionedSpatialIndex::query(const SGVec3d& pos, FGPositioned::Type minType,
+                                   FGPositioned::Type maxType, Visitor& visitor,
+                                   int cutoffMSec) const
+{
+    for (const Record& r : _added) {
+        if ((r.type < static_cast<uint32_t>(minType)) ||
+            (r.type > static_cast<uint32_t>(maxType))) {
+            continue;
+        }
+
+        const double d = dist(pos, SGVec3d(r.x, r.y, r.z));
+        if (d <= visitor.cutoff() + POSITION_SLACK_M) {
+            visitor.visit(r, d);
+        }
+    }
+
+    if (_count == 0) {
+        return false;
+    }
+
+    SGTimeStamp tm;
+    tm.stamp();
+
+    // Depth first, nearest child first. Each level pushes at most eight
+    // nodes and pops one, so this bounds the stack depth.
+    QueryNode stack[8 * (LEVELS + 1)];
+    int top = 0;
+    stack[top++] = QueryNode{0, 0, 0, 0, 0, 0, _count, 0.0};
+    unsigned int popCount = 0;
+
+    while (top > 0) {
+        if ((++popCount % 64) == 0 && (tm.elapsedMSec() >= cutoffMSec)) {
+            return true;
+        }
+
+        const QueryNode node = stack[--top];
+        if (node.dist > visitor.cutoff() + POSITION_SLACK_M) {
+            continue; // the cutoff shrank since this was pushed
+        }
+
+        if ((node.end - node.begin <= SCAN_THRESHOLD) || (node.level == LEVELS)) {
+            visitRange(node.begin, node.end, pos, minType, maxType, visitor);
+            continue;
+        }
+
+        // split the node's range at the child boundaries
+        const int childShift = 3 * (LEVELS - node.level - 1);
+        size_t bounds[9];
+        bounds[0] = node.begin;
+        bounds[8] = node.end;
+        for (int c = 1; c < 8; ++c) {
+            const uint64_t childKey = ((node.prefix << 3) | c) << childShift;
+            bounds[c] = std::lower_bound(_records + bounds[c - 1], _records + node.end,
+                                         childKey, KeyLess()) - _records;
+        }
+
+        QueryNode children[8];
+        double childDist[8];
+        int numChildren = 0;
+        for (int c = 0; c < 8; ++c) {
+            if (bounds[c] == bounds[c + 1]) {
+                continue;
+            }
+
+            QueryNode child;
+            child.prefix = (node.prefix << 3) | c;
+            child.ix = (node.ix << 1) | ((c >> 2) & 1);
+            child.iy = (node.iy << 1) | ((c >> 1) & 1);
+            child.iz = (node.iz << 1) | (c & 1);
+            child.level = node.level + 1;
+            child.begin = bounds[c];
+            child.end = bounds[c + 1];
+
+            child.dist = distToCell(pos, child.ix, child.iy, child.iz, child.level);
+            const double d = child.dist;
+            if (d > visitor.cutoff() + POSITION_SLACK_M) {
+                continue;
+            }
+
+            // insertion sort, furthest first, so the nearest ends up on top
+            int i = numChildren++;
+            while ((i > 0) && (childDist[i - 1] < d)) {
+                children[i] = children[i - 1];
+                childDist[i] = childDist[i - 1];
+                --i;
+            }
+            children[i] = child;
+            childDist[i] = d;
+        }
+
+        for (int i = 0; i < numChildren; ++i) {
+            stack[top++] = children[i];
+        }
+    }
+
+    return false;
+}
+
+} // of namespace flightgear
@@ -0,0 +1,117 @@
+/**
+ * PositionedSpatialIndex - a read-only, memory-mapped snapshot of the
+ * spatially indexed FGPositioned items, for queries which don't need to
+ * touch the database.
+ */
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef FG_POSITIONED_SPATIAL_INDEX_HXX
+#define FG_POSITIONED_SPATIAL_INDEX_HXX
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <simgear/math/SGMath.hxx>
+#include <simgear/misc/sg_path.hxx>
+
+#include <Navaids/positioned.hxx>
+
+namespace flightgear
+{
+
+/**
+ * The items are stored as fixed size records, sorted by the Morton code of
+ * their (quantised) cartesian position. Every node of the implied octree is
+ * then a contiguous range of records, which is found by binary search, so
+ * queries walk the tree without loading or allocating anything.
+ *
+ * The file is written at the end of a cache rebuild, and only used when its
+ * stamp matches the one recorded in the cache.
+ */
+class PositionedSpatialIndex
+{
+public:
+    struct Record
+    {
+        uint64_t key;      ///< Morton code of the position
+        int64_t id;        ///< PositionedID
+        float x, y, z;     ///< cartesian position, metres
+        uint32_t type;     ///< FGPositioned::Type
+    };
+
+    /**
+     * Receives the items found by a query, nearest first (roughly: the
+     * order is by octree node). cutoff() may shrink while the query runs,
+     * which prunes the search. The distances are computed from the stored
+     * single precision positions, so items up to a metre beyond the cutoff
+     * may be visited.
+     */
+    class Visitor
+    {
+    public:
+        virtual ~Visitor() = default;
+
+        virtual double cutoff() const = 0;
+        virtual void visit(const Record& rec, double distanceM) = 0;
+    };
+
+    PositionedSpatialIndex();
+    ~PositionedSpatialIndex();
+
+    /// Keys and sorts the records, then writes them to path; returns false
+    /// on error.
+    static bool write(const SGPath& path, const std::string& stamp,
+                      std::vector<Record>& records);
+
+    /// Maps the file at path, if it exists and carries the given stamp.
+    bool open(const SGPath& path, const std::string& stamp);
+
+    size_t size() const { return _count + _added.size(); }
+
+    /// Items inserted after the snapshot was written, e.g. POIs created
+    /// at runtime. They are searched linearly.
+    void add(FGPositioned::Type ty, PositionedID id, const SGVec3d& cart);
+
+    /**
+     * Calls the visitor for each item with a type in [minType, maxType]
+     * closer than visitor.cutoff(). Returns true if the time limit ran out
+     * before the search was complete.
+     */
+    bool query(const SGVec3d& pos, FGPositioned::Type minType,
+               FGPositioned::Type maxType, Visitor& visitor,
+               int cutoffMSec) const;
+
+    static uint64_t mortonKey(const SGVec3d& cart);
+
+private:
+    class Mapping;
+
+    void visitRange(size_t begin, size_t end, const SGVec3d& pos,
+                    FGPositioned::Type minType, FGPositioned::Type maxType,
+                    Visitor& visitor) const;
+
+    std::unique_ptr<Mapping> _mapping;
+    const Record* _records = nullptr;
+    size_t _count = 0;
+
+    std::vector<Record> _added;
+};
+
+} // of namespace flightgear
+
+#endif // of FG_POSITIONED_SPATIAL_INDEX_HXX
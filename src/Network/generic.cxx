@@ -26,6 +26,7 @@
 
 #include <string.h>                // strstr()
 #include <stdlib.h>                // strtod(), atoi()
+#include <algorithm>
 #include <cstdio>
 
 #include <simgear/debug/logstream.hxx>
@@ -62,6 +63,7 @@ public:
   virtual int wrap( size_t n, uint8_t * buf );
   virtual int unwrap( size_t n, uint8_t * buf );
 private:
+  std::vector<uint8_t> dest; // reused for every message
   static const uint8_t  FEND;
   static const uint8_t  FESC;
   static const uint8_t  TFEND;
@@ -75,7 +77,7 @@ const uint8_t  FGKissWrapper::TFESC = 0xDD;
 
 int FGKissWrapper::wrap( size_t n, uint8_t * buf )
 {
-  std::vector<uint8_t> dest;
+  dest.clear();
   uint8_t *sp = buf;
 
   dest.push_back(FEND);
@@ -122,7 +124,7 @@ int FGKissWrapper::unwrap( size_t n, uint8_t * buf )
 
   if( 0 == n ) return 0;
 
-  std::vector<uint8_t> dest;
+  dest.clear();
   {
     bool escaped = false;
 
@@ -184,6 +186,8 @@ public:
   static const uint8_t  STX;
   static const uint8_t  ETX;
   static const uint8_t  DLE;
+private:
+  std::vector<uint8_t> dest; // reused for every message
 };
 
 const uint8_t  FGSTXETXWrapper::STX  = 0x02;
@@ -195,7 +199,7 @@ int FGSTXETXWrapper::wrap( size_t n, uint8_t * buf )
   // stuff payload as
   // <dle><stx>payload<dle><etx>
   // if payload contains <dle>, stuff <dle> as <dle><dle>
-  std::vector<uint8_t> dest;
+  dest.clear();
   uint8_t *sp = buf;
 
   dest.push_back(DLE);
@@ -265,21 +269,31 @@ union u64 {
     double doubleVal;
 };
 
+// copies as much of str as fits between p and end
+static inline void append_chars(char *&p, const char *end, const string &str)
+{
+    const size_t n = std::min(str.size(), static_cast<size_t>(end - p));
+    memcpy(p, str.data(), n);
+    p += n;
+}
+
 // generate the message
 bool FGGeneric::gen_message_binary() {
-    string generic_sentence;
+    const bool swap = (binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER);
+    // leave room for the footer and for what the wrappers add
+    const int footer_size = (binary_footer_type != FOOTER_NONE) ? sizeof(int32_t) : 0;
+    const int max_length = (wrapper ? FG_MAX_MSG_SIZE / 2 - 4 : FG_MAX_MSG_SIZE) - footer_size;
     length = 0;
 
     double val;
-    for (unsigned int i = 0; i < _out_message.size(); i++) {
+    for (const _out_op &op : _out_ops) {
 
-        switch (_out_message[i].type) {
+        switch (op.type) {
         case FG_INT:
         {
-            val = _out_message[i].offset +
-                  _out_message[i].prop->getFloatValue() * _out_message[i].factor;
+            val = op.offset + op.node->getFloatValue() * op.factor;
             int32_t intVal = val;
-            if (binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER) {
+            if (swap) {
                 intVal = (int32_t) sg_bswap_32((uint32_t)intVal);
             }
             memcpy(&buf[length], &intVal, sizeof(int32_t));
@@ -288,17 +302,16 @@ bool FGGeneric::gen_message_binary() {
         }
 
         case FG_BOOL:
-            buf[length] = (char) (_out_message[i].prop->getBoolValue() ? true : false);
+            buf[length] = (char) (op.node->getBoolValue() ? true : false);
             length += 1;
             break;
 
         case FG_FIXED:
         {
-            val = _out_message[i].offset +
-                 _out_message[i].prop->getFloatValue() * _out_message[i].factor;
+            val = op.offset + op.node->getFloatValue() * op.factor;
 
             int32_t fixed = (int)(val * 65536.0f);
-            if (binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER) {
+            if (swap) {
                 fixed = (int32_t) sg_bswap_32((uint32_t)fixed);
             } 
             memcpy(&buf[length], &fixed, sizeof(int32_t));
@@ -308,12 +321,11 @@ bool FGGeneric::gen_message_binary() {
 
         case FG_FLOAT:
         {
-            val = _out_message[i].offset +
-                 _out_message[i].prop->getFloatValue() * _out_message[i].factor;
+            val = op.offset + op.node->getFloatValue() * op.factor;
             u32 tmpun32;
             tmpun32.floatVal = static_cast<float>(val);
 
-            if (binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER) {
+            if (swap) {
                 tmpun32.intVal = sg_bswap_32(tmpun32.intVal);
             }
             memcpy(&buf[length], &tmpun32.intVal, sizeof(uint32_t));
@@ -323,12 +335,11 @@ bool FGGeneric::gen_message_binary() {
 
         case FG_DOUBLE:
         {
-            val = _out_message[i].offset +
-                 _out_message[i].prop->getDoubleValue() * _out_message[i].factor;
+            val = op.offset + op.node->getDoubleValue() * op.factor;
             u64 tmpun64;
             tmpun64.doubleVal = val;
 
-            if (binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER) {
+            if (swap) {
                 tmpun64.longVal = sg_bswap_64(tmpun64.longVal);
             }
             memcpy(&buf[length], &tmpun64.longVal, sizeof(uint64_t));
@@ -338,8 +349,7 @@ bool FGGeneric::gen_message_binary() {
 
         case FG_BYTE:
         {
-            val = _out_message[i].offset +
-                  _out_message[i].prop->getFloatValue() * _out_message[i].factor;
+            val = op.offset + op.node->getFloatValue() * op.factor;
             int8_t byteVal = val;
             memcpy(&buf[length], &byteVal, sizeof(int8_t));
             length += sizeof(int8_t);
@@ -348,8 +358,7 @@ bool FGGeneric::gen_message_binary() {
 
         case FG_WORD:
         {
-            val = _out_message[i].offset +
-                  _out_message[i].prop->getFloatValue() * _out_message[i].factor;
+            val = op.offset + op.node->getFloatValue() * op.factor;
             int16_t wordVal = val;
             memcpy(&buf[length], &wordVal, sizeof(int16_t));
             length += sizeof(int16_t);
@@ -357,27 +366,29 @@ bool FGGeneric::gen_message_binary() {
         }
 
         default: // SG_STRING
-            const char *strdata = _out_message[i].prop->getStringValue();
-            int32_t strlength = strlen(strdata);
+        {
+            const char *strdata = op.node->getStringValue();
+            // strings are the only chunks of variable size, truncate them
+            // rather than overrunning the buffer
+            int32_t strlength = std::min<size_t>(strlen(strdata),
+                                    std::max(0, max_length - length - (int)sizeof(int32_t)));
 
-            if (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) {
-                SG_LOG( SG_IO, SG_ALERT, "Generic protocol: "
-                        "FG_STRING will be written in host byte order.");
-            }
             /* Format for strings is 
              * [length as int, 4 bytes][ASCII data, length bytes]
              */
-            if (binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER) {
-                strlength = sg_bswap_32(strlength);
+            int32_t wire_length = strlength;
+            if (swap) {
+                wire_length = sg_bswap_32(strlength);
             }
-            memcpy(&buf[length], &strlength, sizeof(int32_t));
+            memcpy(&buf[length], &wire_length, sizeof(int32_t));
             length += sizeof(int32_t);
-            strncpy(&buf[length], strdata, strlength);
+            memcpy(&buf[length], strdata, strlength);
             length += strlength; 
             /* FIXME padding for alignment? Something like: 
              * length += (strlength % 4 > 0 ? sizeof(int32_t) - strlength % 4 : 0;
              */
             break;
+        }
 
         }
     }
@@ -395,7 +406,7 @@ bool FGGeneric::gen_message_binary() {
 
     if (binary_footer_type != FOOTER_NONE) {
         int32_t intValue = binary_footer_value;
-        if (binary_byte_order != BYTE_ORDER_MATCHES_NETWORK_ORDER) {
+        if (swap) {
             intValue = sg_bswap_32(binary_footer_value);
         }
         memcpy(&buf[length], &intValue, sizeof(int32_t));
@@ -408,66 +419,63 @@ bool FGGeneric::gen_message_binary() {
 }
 
 bool FGGeneric::gen_message_ascii() {
-    string generic_sentence;
-    char tmp[255];
-    length = 0;
+    // the values are printed straight into buf; as before, each one is
+    // limited to 254 characters
+    char *p = buf;
+    const char *end = buf + FG_MAX_MSG_SIZE;
 
     double val;
-    for (unsigned int i = 0; i < _out_message.size(); i++) {
+    for (unsigned int i = 0; i < _out_ops.size(); i++) {
+        const _out_op &op = _out_ops[i];
 
         if (i > 0) {
-            generic_sentence += var_separator;
+            append_chars(p, end, var_separator);
+        }
+
+        const size_t room = std::min<size_t>(255, end - p);
+        if (room == 0) {
+            break;
         }
-        
-        string format = simgear::strutils::sanitizePrintfFormat(_out_message[i].format);
 
-        switch (_out_message[i].type) {
+        int n;
+        switch (op.type) {
         case FG_BYTE:
         case FG_WORD:
         case FG_INT:
-            val = _out_message[i].offset +
-                  _out_message[i].prop->getFloatValue() * _out_message[i].factor;
-            snprintf(tmp, 255, format.c_str(), (int)val);
+            val = op.offset + op.node->getFloatValue() * op.factor;
+            n = snprintf(p, room, op.format.c_str(), (int)val);
             break;
 
         case FG_BOOL:
-            snprintf(tmp, 255, format.c_str(),
-                               _out_message[i].prop->getBoolValue());
+            n = snprintf(p, room, op.format.c_str(), op.node->getBoolValue());
             break;
 
         case FG_FIXED:
-            val = _out_message[i].offset +
-                _out_message[i].prop->getFloatValue() * _out_message[i].factor;
-            snprintf(tmp, 255, format.c_str(), (float)val);
-            break;
-
         case FG_FLOAT:
-            val = _out_message[i].offset +
-                _out_message[i].prop->getFloatValue() * _out_message[i].factor;
-            snprintf(tmp, 255, format.c_str(), (float)val);
+            val = op.offset + op.node->getFloatValue() * op.factor;
+            n = snprintf(p, room, op.format.c_str(), (float)val);
             break;
 
         case FG_DOUBLE:
-            val = _out_message[i].offset +
-                _out_message[i].prop->getDoubleValue() * _out_message[i].factor;
-            snprintf(tmp, 255, format.c_str(), (double)val);
+            val = op.offset + op.node->getDoubleValue() * op.factor;
+            n = snprintf(p, room, op.format.c_str(), (double)val);
             break;
 
         default: // SG_STRING
-            snprintf(tmp, 255, format.c_str(),
-                                   _out_message[i].prop->getStringValue());
+            n = snprintf(p, room, op.format.c_str(), op.node->getStringValue());
         }
 
-        generic_sentence += tmp;
+        if (n > 0) {
+            p += std::min<size_t>(n, room - 1);
+        }
     }
 
     /* After each lot of variables has been added, put the line separator
      * char/string
      */
-    generic_sentence += line_separator;
+    append_chars(p, end, line_separator);
 
-    length =  generic_sentence.length();
-    strncpy( buf, generic_sentence.c_str(), length );
+    length = p - buf;
 
     return true;
 }
@@ -484,13 +492,14 @@ bool FGGeneric::parse_message_binary(int length) {
     char *p2, *p1 = buf;
     int32_t tmp32;
     int i = -1;
+    const bool swap = (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION);
 
     p2 = p1 + length;
     while ((++i < (int)_in_message.size()) && (p1  < p2)) {
 
         switch (_in_message[i].type) {
         case FG_INT:
-            if (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) {
+            if (swap) {
                 tmp32 = sg_bswap_32(*(int32_t *)p1);
             } else {
                 tmp32 = *(int32_t *)p1;
@@ -505,7 +514,7 @@ bool FGGeneric::parse_message_binary(int length) {
             break;
 
         case FG_FIXED:
-            if (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) {
+            if (swap) {
                 tmp32 = sg_bswap_32(*(int32_t *)p1);
             } else {
                 tmp32 = *(int32_t *)p1;
@@ -516,7 +525,7 @@ bool FGGeneric::parse_message_binary(int length) {
 
         case FG_FLOAT:
             u32 tmpun32;
-            if (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) {
+            if (swap) {
                 tmpun32.intVal = sg_bswap_32(*(uint32_t *)p1);
             } else {
                 tmpun32.floatVal = *(float *)p1;
@@ -527,7 +536,7 @@ bool FGGeneric::parse_message_binary(int length) {
 
         case FG_DOUBLE:
             u64 tmpun64;
-            if (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) {
+            if (swap) {
                 tmpun64.longVal = sg_bswap_64(*(uint64_t *)p1);
             } else {
                 tmpun64.doubleVal = *(double *)p1;
@@ -543,7 +552,7 @@ bool FGGeneric::parse_message_binary(int length) {
             break;
 
         case FG_WORD:
-            if (binary_byte_order == BYTE_ORDER_NEEDS_CONVERSION) {
+            if (swap) {
                 tmp32 = sg_bswap_16(*(int16_t *)p1);
             } else {
                 tmp32 = *(int16_t *)p1;
@@ -664,6 +673,11 @@ bool FGGeneric::open() {
 bool FGGeneric::process() {
     SGIOChannel *io = get_io_channel();
 
+    if (!initOk) {
+        // configuration failed to (re)load, nothing valid to send or parse
+        return false;
+    }
+
     if ( (get_direction() == SG_IO_OUT) ||
          (get_direction() == SG_IO_BI) ) {
         gen_message();
@@ -775,11 +789,14 @@ FGGeneric::reinit()
         SGPropertyNode *output = root.getNode("generic/output");
         if (output) {
             _out_message.clear();
+            _out_ops.clear();
             if (!read_config(output, _out_message))
             {
                 // bad configuration
+                initOk = false;
                 return;
             }
+            compile_output();
         }
     }
 
@@ -790,6 +807,7 @@ FGGeneric::reinit()
             if (!read_config(input, _in_message))
             {
                 // bad configuration
+                initOk = false;
                 return;
             }
             if (!binary_mode && (line_separator.empty() ||
@@ -994,6 +1012,22 @@ FGGeneric::read_config(SGPropertyNode *root, vector<_serial_prot> &msg)
     return true;
 }
 
+void
+FGGeneric::compile_output()
+{
+    _out_ops.clear();
+    _out_ops.reserve(_out_message.size());
+    for (const _serial_prot &chunk : _out_message) {
+        _out_op op;
+        op.node = chunk.prop;
+        op.type = chunk.type;
+        op.offset = chunk.offset;
+        op.factor = chunk.factor;
+        op.format = simgear::strutils::sanitizePrintfFormat(chunk.format);
+        _out_ops.push_back(op);
+    }
+}
+
 void FGGeneric::updateValue(FGGeneric::_serial_prot& prot, bool val)
 {
   if( prot.rel )
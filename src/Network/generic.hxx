@@ -73,6 +73,19 @@ protected:
         SGPropertyNode_ptr prop;
     } _serial_prot;
 
+    /**
+     * An output chunk, compiled when the configuration is read, so that
+     * generating a message doesn't have to look anything up: the node is
+     * resolved and the printf format already sanitized.
+     */
+    struct _out_op {
+        SGPropertyNode_ptr node;
+        e_type type;
+        double offset;
+        double factor;
+        string format;
+    };
+
 private:
 
     string file_name;
@@ -88,6 +101,7 @@ private:
     string line_sep_string;
     vector<_serial_prot> _out_message;
     vector<_serial_prot> _in_message;
+    vector<_out_op> _out_ops;
 
     bool binary_mode;
     enum {FOOTER_NONE, FOOTER_LENGTH, FOOTER_MAGIC} binary_footer_type;
@@ -100,6 +114,7 @@ private:
     bool parse_message_ascii(int length);
     bool parse_message_binary(int length);
     bool read_config(SGPropertyNode *root, vector<_serial_prot> &msg);
+    void compile_output();
     bool exitOnError;
     bool initOk;
 
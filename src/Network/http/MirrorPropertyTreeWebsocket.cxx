@@ -19,6 +19,7 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "MirrorPropertyTreeWebsocket.hxx"
+#include "PropertyStreamWriter.hxx"
 #include "jsonprops.hxx"
 
 #include <algorithm>
@@ -126,19 +127,27 @@ using std::string;
 
         std::string path;
         unsigned int id = 0;
-        
+
         bool operator==(const RemovedNode& other) const
         {
             return (path == other.path);
         }
     };
     
+    /// What the client knows about a property, indexed by PropertyId
+    struct PropertyState
+    {
+        PropertyValue value;
+        SGPropertyNode* node = nullptr; ///< null once removed
+        bool dirty = false; ///< queued in changedIds
+    };
+
     class MirrorTreeListener : public SGPropertyChangeListener
     {
     public:
         MirrorTreeListener() : SGPropertyChangeListener(true /* recursive */)
         {
-            previousValues.resize(2);
+            states.resize(nextPropertyId);
         }
 
         virtual ~MirrorTreeListener()
@@ -152,13 +161,27 @@ using std::string;
                 // not new to the server, but new to the client
                 newNodes.insert(node);
             } else {
-                assert(previousValues.size() > it->second);
-                PropertyValue newVal(node);
-                if (!previousValues[it->second].equals(node, newVal)) {
-                    previousValues[it->second] = newVal;
-                    changedNodes.insert(node);
-                }
+                markChanged(it->second, node);
+            }
+        }
+
+        /// Queues id for sending if its value differs from what was last sent.
+        /// A dirty bit per id keeps this O(1) however often the node is written.
+        bool markChanged(PropertyId id, SGPropertyNode* node)
+        {
+            assert(states.size() > id);
+            PropertyState& state = states[id];
+            PropertyValue newVal(node);
+            if (state.value.equals(node, newVal)) {
+                return false;
             }
+
+            state.value = newVal;
+            if (!state.dirty) {
+                state.dirty = true;
+                changedIds.push_back(id);
+            }
+            return true;
         }
 
         void childAdded(SGPropertyNode* parent, SGPropertyNode* child) override
@@ -183,14 +206,12 @@ using std::string;
                 // each time a Nasal timer fires)
                 removedNodes.erase(id); // don't remove it!
                 idHash.insert(std::make_pair(node, id));
-                
+                states[id].node = node;
+
                 // we can still do change compression here, but this also
                 // deals with type mutation when removing + re-adding with a
                 // different type
-                PropertyValue newVal(node);
-                if (!previousValues[id].equals(node, newVal)) {
-                    previousValues[id] = newVal;
-                    changedNodes.insert(node);
+                if (markChanged(id, node)) {
 #if defined (MIRROR_DEBUG)
                     SG_LOG(SG_NETWORK, SG_INFO, "\tand will actually change" << node->getPath());
 #endif
@@ -211,12 +232,16 @@ using std::string;
 
         void childRemoved(SGPropertyNode* parent, SGPropertyNode* child) override
         {
-            changedNodes.erase(child); // have to do this here with the pointer valid
+            // have to do this here with the pointer valid
             newNodes.erase(child);
+            for (int c = 0; c < child->nChildren(); ++c) {
+                forgetSubtree(child->getChild(c));
+            }
 
             auto it = idHash.find(child);
             if (it != idHash.end()) {
                 removedNodes.insert(it->second);
+                states[it->second].node = nullptr;
                 idHash.erase(it);
                 // record so we can map removed+add of the same property into
                 // a simple value change (this happens commonly with the canvas
@@ -231,6 +256,22 @@ using std::string;
 #endif
         }
 
+        /// descendants of a removed node go with it on the client, but we
+        /// must not keep their pointers around
+        void forgetSubtree(SGPropertyNode* node)
+        {
+            newNodes.erase(node);
+            auto it = idHash.find(node);
+            if (it != idHash.end()) {
+                states[it->second].node = nullptr;
+                idHash.erase(it);
+            }
+
+            for (int c = 0; c < node->nChildren(); ++c) {
+                forgetSubtree(node->getChild(c));
+            }
+        }
+
         void registerSubtree(SGPropertyNode* node)
         {
 #if defined (MIRROR_DEBUG)              
@@ -246,115 +287,102 @@ using std::string;
         }
 
         std::set<SGPropertyNode*> newNodes;
-        std::set<SGPropertyNode*> changedNodes;
+        std::vector<PropertyId> changedIds;
         std::set<PropertyId> removedNodes;
-        
+
         PropertyId idForProperty(SGPropertyNode* prop)
         {
             auto it = idHash.find(prop);
             if (it == idHash.end()) {
                 it = idHash.insert(it, std::make_pair(prop, nextPropertyId++));
-                previousValues.push_back(PropertyValue(prop));
+                states.emplace_back();
+                states.back().value = PropertyValue(prop);
+                states.back().node = prop;
             }
             return it->second;
         }
 
-        cJSON* makeJSONData()
+        /// Streams everything not yet sent to the client into out and
+        /// resets the change tracking.
+        void writeChanges(PropertyStreamWriter& out)
         {
 #if defined (MIRROR_DEBUG)
             SGTimeStamp st;
             st.stamp();
-            
+
             int newSize = newNodes.size();
-            int changedSize = changedNodes.size();
+            int changedSize = changedIds.size();
             int removedSize = removedNodes.size();
 #endif
-            cJSON* result = cJSON_CreateObject();
+            out.beginObject();
             if (!newNodes.empty()) {
-                cJSON * newNodesArray = cJSON_CreateArray();
-                
-                // cJSON_AddItemToArray performance is O(N) due to use of a linked
-                // list, which dominates the performance here. To fix this we maintan
-                // a point to the tail of the array, keeping appends O(1)
-                cJSON* arrayTail = nullptr;
-                
+                out.key("created");
+                out.beginArray();
                 for (auto prop : newNodes) {
-                    changedNodes.erase(prop); // avoid duplicate send
-                    cJSON* newPropData = cJSON_CreateObject();
-                    cJSON_AddItemToObject(newPropData, "path", cJSON_CreateString(prop->getPath(true).c_str()));
-                    cJSON_AddItemToObject(newPropData, "type", cJSON_CreateString(JSON::getPropertyTypeString(prop->getType())));
-                    cJSON_AddItemToObject(newPropData, "index", cJSON_CreateNumber(prop->getIndex()));
-                    cJSON_AddItemToObject(newPropData, "position", cJSON_CreateNumber(prop->getPosition()));
-                    cJSON_AddItemToObject(newPropData, "id", cJSON_CreateNumber(idForProperty(prop)));
+                    out.beginObject();
+                    out.key("path");
+                    out.value(prop->getPath(true));
+                    out.key("type");
+                    out.value(JSON::getPropertyTypeString(prop->getType()));
+                    out.key("index");
+                    out.value(prop->getIndex());
+                    out.key("position");
+                    out.value(static_cast<int>(prop->getPosition()));
+                    out.key("id");
+                    out.value(idForProperty(prop));
                     if (prop->getType() != simgear::props::NONE) {
-                        cJSON_AddItemToObject(newPropData, "value", JSON::valueToJson(prop));
-                    }
-                    
-                    if (arrayTail) {
-                        arrayTail->next = newPropData;
-                        newPropData->prev = arrayTail;
-                        arrayTail = newPropData;
-                    } else {
-                        cJSON_AddItemToArray(newNodesArray, newPropData);
-                        arrayTail = newPropData;
+                        out.key("value");
+                        out.propertyValue(prop);
                     }
+                    out.endObject();
                 }
-
+                out.endArray();
                 newNodes.clear();
-                cJSON_AddItemToObject(result, "created", newNodesArray);
             }
 
-
             if (!removedNodes.empty()) {
-                cJSON * deletedNodesArray = cJSON_CreateArray();
+                out.key("removed");
+                out.beginArray();
                 for (auto propId : removedNodes) {
-                    cJSON_AddItemToArray(deletedNodesArray, cJSON_CreateNumber(propId));
+                    out.value(propId);
                 }
-                cJSON_AddItemToObject(result, "removed", deletedNodesArray);
+                out.endArray();
                 removedNodes.clear();
             }
 
-            if (!changedNodes.empty()) {
-                cJSON * changedNodesArray = cJSON_CreateArray();
-                
-                // see comment above about cJSON_AddItemToArray
-                cJSON* tail = nullptr;
-                
-                for (auto prop : changedNodes) {
-                    cJSON* propData = cJSON_CreateArray();
-                    cJSON_AddItemToArray(propData, cJSON_CreateNumber(idForProperty(prop)));
-                    cJSON_AddItemToArray(propData, JSON::valueToJson(prop));
-                    
-                    
-                    if (tail) {
-                        tail->next = propData;
-                        propData->prev = tail;
-                        tail = propData;
-                    } else {
-                        cJSON_AddItemToArray(changedNodesArray, propData);
-                        tail = propData;
+            if (!changedIds.empty()) {
+                out.key("changed");
+                out.beginArray();
+                for (auto propId : changedIds) {
+                    PropertyState& state = states[propId];
+                    state.dirty = false;
+                    if (!state.node) {
+                        continue; // removed since it changed
                     }
-                }
 
-                changedNodes.clear();
-                cJSON_AddItemToObject(result, "changed", changedNodesArray);
+                    out.beginArray();
+                    out.value(propId);
+                    out.propertyValue(state.node);
+                    out.endArray();
+                }
+                out.endArray();
+                changedIds.clear();
             }
+            out.endObject();
 #if defined (MIRROR_DEBUG)
             SG_LOG(SG_NETWORK, SG_INFO, "making JSON data took:" << st.elapsedMSec() << " for " << newSize << "/" << changedSize << "/" << removedSize);
 #endif
             recentlyRemoved.clear();
-
-            return result;
         }
 
         bool haveChangesToSend() const
         {
-            return !newNodes.empty() || !changedNodes.empty() || !removedNodes.empty();
+            return !newNodes.empty() || !changedIds.empty() || !removedNodes.empty();
         }
     private:
         PropertyId nextPropertyId = 1;
         std::unordered_map<SGPropertyNode*, PropertyId> idHash;
-        std::vector<PropertyValue> previousValues;
+        std::vector<PropertyState> states;
 
         /// track recently removed nodes in case they are re-created imemdiately
         /// after with the same type, since we can make this much more efficient
@@ -417,9 +445,11 @@ static void handleExecCommand(cJSON* json)
 }
 #endif
 
-MirrorPropertyTreeWebsocket::MirrorPropertyTreeWebsocket(const std::string& path) :
+MirrorPropertyTreeWebsocket::MirrorPropertyTreeWebsocket(const std::string& path,
+                                                         PropertyStreamWriter::Format format) :
     _rootPath(path),
     _listener(new MirrorTreeListener),
+    _stream(PropertyStreamWriter::create(format)),
     _minSendInterval(100)
 {
     checkNodeExists();
@@ -531,11 +561,10 @@ void MirrorPropertyTreeWebsocket::poll(WebsocketWriter & writer)
     // okay, we will send now, update the send stamp
     _lastSendTime.stamp();
 
-    cJSON * json = _listener->makeJSONData();
-    char * jsonString = cJSON_PrintUnformatted( json );
-    writer.writeText( jsonString );
-    free( jsonString );
-    cJSON_Delete( json );
+    // the buffer keeps its capacity, so steady state updates don't allocate
+    _stream->clear();
+    _listener->writeChanges(*_stream);
+    _stream->write(writer);
 }
 
 } // namespace http
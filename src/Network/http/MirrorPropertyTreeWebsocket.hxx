@@ -22,6 +22,7 @@
 #define MIRROR_PROP_TREE_WEBSOCKET_HXX_
 
 #include "Websocket.hxx"
+#include "PropertyStreamWriter.hxx"
 
 #include <simgear/props/props.hxx>
 #include <simgear/timing/timestamp.hxx>
@@ -37,7 +38,8 @@ namespace http {
 class MirrorPropertyTreeWebsocket : public Websocket
 {
 public:
-    MirrorPropertyTreeWebsocket(const std::string& path);
+    MirrorPropertyTreeWebsocket(const std::string& path,
+                                PropertyStreamWriter::Format format = PropertyStreamWriter::FORMAT_JSON);
     ~MirrorPropertyTreeWebsocket() override;
 
     void close() override;
@@ -52,6 +54,7 @@ private:
     std::string _rootPath;
     SGPropertyNode_ptr _subtreeRoot;
     std::unique_ptr<MirrorTreeListener> _listener;
+    std::unique_ptr<PropertyStreamWriter> _stream;
     int _minSendInterval;
     SGTimeStamp _lastSendTime;
 };
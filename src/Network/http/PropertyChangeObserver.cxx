@@ -21,84 +21,138 @@
 #include "PropertyChangeObserver.hxx"
 
 #include <Main/fg_props.hxx>
+
+#include <cmath>
+
 using std::string;
 namespace flightgear {
 namespace http {
 
 
 
-PropertyChangeObserver::PropertyChangeObserver()
+PropertyChangeObserverEntry::PropertyChangeObserverEntry(SGPropertyNode * node)
+    : _node(node),
+      _version(1),
+      _dirty(false),
+      _prevType(simgear::props::NONE),
+      _prevLong(0),
+      _prevDouble(0.0)
 {
+  updateValue();
+  _node->addChangeListener(this);
 }
 
-PropertyChangeObserver::~PropertyChangeObserver()
+PropertyChangeObserverEntry::~PropertyChangeObserverEntry()
 {
-  //
+  _node->removeChangeListener(this);
 }
 
-void PropertyChangeObserver::check()
+void PropertyChangeObserverEntry::valueChanged(SGPropertyNode *)
 {
+  _dirty = true;
+}
 
-  for (Entries_t::iterator it = _entries.begin(); it != _entries.end(); ++it) {
-    if (!(*it)->_node.isShared()) {
-      // node is no longer used but by us - remove the entry
-      it = _entries.erase(it);
-      continue;
+void PropertyChangeObserverEntry::check()
+{
+  // nodes can be tied or aliased after the observation started
+  if (!_dirty && !_node->isTied() && !_node->isAlias())
+    return;
+
+  _dirty = false;
+  if (updateValue())
+    ++_version;
+}
+
+// Stores the current value and returns true if it differs from the last
+// one. Listeners also fire for writes of an unchanged value, so this is
+// still needed for them, but only strings are compared as strings.
+bool PropertyChangeObserverEntry::updateValue()
+{
+  const simgear::props::Type type = _node->getType();
+  bool changed = type != _prevType;
+  _prevType = type;
+
+  switch (type) {
+    case simgear::props::BOOL:
+    case simgear::props::INT:
+    case simgear::props::LONG: {
+      const long v = _node->getLongValue();
+      changed = changed || v != _prevLong;
+      _prevLong = v;
+      break;
     }
 
-    if(!(*it)->_changed ) {
-      (*it)->_changed = (*it)->_prevValue != (*it)->_node->getStringValue();
-      if ((*it)->_changed)
-        (*it)->_prevValue = (*it)->_node->getStringValue();
+    case simgear::props::FLOAT:
+    case simgear::props::DOUBLE: {
+      const double v = _node->getDoubleValue();
+      // NaN compares unequal to itself but is still no change
+      changed = changed || (v != _prevDouble && !(std::isnan(v) && std::isnan(_prevDouble)));
+      _prevDouble = v;
+      break;
+    }
+
+    case simgear::props::NONE:
+      break;
 
+    default: {
+      const string v = _node->getStringValue();
+      if (changed || v != _prevString) {
+        changed = true;
+        _prevString = v;
+      }
+      break;
     }
   }
+
+  return changed;
+}
+
+PropertyChangeObserver::PropertyChangeObserver()
+{
 }
 
-void PropertyChangeObserver::uncheck()
+PropertyChangeObserver::~PropertyChangeObserver()
 {
-  for (Entries_t::iterator it = _entries.begin(); it != _entries.end(); ++it) {
-    (*it)->_changed = false;
-  }
+  //
 }
 
-const SGPropertyNode_ptr PropertyChangeObserver::addObservation( const string propertyName)
+void PropertyChangeObserver::check()
 {
-  for (Entries_t::iterator it = _entries.begin(); it != _entries.end(); ++it) {
-    if (propertyName == (*it)->_node->getPath(true) ) {
-      // if a new observer is added to a property, mark it as changed to ensure the observer
-      // gets notified on initial call. This also causes a notification for all other observers of this
-      // property.
-      (*it)->_changed = true;
-      return (*it)->_node;
+  size_t i = 0;
+  while (i < _entries.size()) {
+    if (!_entries[i].isShared()) {
+      // entry is no longer used but by us - remove it
+      _entries[i] = _entries.back();
+      _entries.pop_back();
+      continue;
     }
+
+    _entries[i]->check();
+    ++i;
   }
+}
 
+PropertyChangeObserverEntryRef PropertyChangeObserver::addObservation( const string & propertyName)
+{
+  SGPropertyNode_ptr node;
   try {
-    PropertyChangeObserverEntryRef entry = new PropertyChangeObserverEntry();
-    entry->_node = fgGetNode( propertyName, true );
-    _entries.push_back( entry );
-    return entry->_node;
+    node = fgGetNode( propertyName, true );
   }
   catch( string & s ) {
     SG_LOG(SG_NETWORK,SG_WARN,"httpd: can't observer '" << propertyName << "'. Invalid name." );
+    return PropertyChangeObserverEntryRef();
   }
 
-  SGPropertyNode_ptr empty;
-  return empty;
-}
-
-bool PropertyChangeObserver::isChangedValue(const SGPropertyNode_ptr node)
-{
+  // a new observer starts at version zero, so it gets the current value on
+  // its first poll without the other observers of this node being notified
   for (Entries_t::iterator it = _entries.begin(); it != _entries.end(); ++it) {
-    PropertyChangeObserverEntryRef entry = *it;
-
-    if( entry->_node == node && entry->_changed ) {
-      return true;
-    }
+    if ((*it)->_node == node)
+      return *it;
   }
 
-  return false;
+  PropertyChangeObserverEntryRef entry = new PropertyChangeObserverEntry(node);
+  _entries.push_back( entry );
+  return entry;
 }
 
 }  // namespace http
@@ -28,14 +28,39 @@
 namespace flightgear {
 namespace http {
 
-struct PropertyChangeObserverEntry : public SGReferenced {
-  PropertyChangeObserverEntry()
-      : _changed(true)
-  {
-  }
+/**
+ * A node watched on behalf of one or more websockets.
+ *
+ * Changes are picked up by a listener on the node, so check() only has to
+ * look at nodes which have actually been written to. Tied and aliased
+ * nodes do not fire listeners and are compared on every check instead.
+ * Each detected change bumps the version; observers remember the last
+ * version they sent, so no update is lost if they skip a poll.
+ */
+class PropertyChangeObserverEntry : public SGReferenced,
+                                    public SGPropertyChangeListener {
+public:
+  PropertyChangeObserverEntry(SGPropertyNode * node);
+  virtual ~PropertyChangeObserverEntry();
+
+  virtual void valueChanged(SGPropertyNode * node);
+
+  void check();
+
+  unsigned version() const { return _version; }
+
   SGPropertyNode_ptr _node;
-  std::string _prevValue;
-  bool _changed;
+
+private:
+  bool updateValue();
+
+  unsigned _version;
+  bool _dirty;
+
+  simgear::props::Type _prevType;
+  long _prevLong;
+  double _prevDouble;
+  std::string _prevString;
 };
 
 typedef SGSharedPtr<PropertyChangeObserverEntry> PropertyChangeObserverEntryRef;
@@ -45,11 +70,9 @@ public:
   PropertyChangeObserver();
   virtual ~PropertyChangeObserver();
 
-  const SGPropertyNode_ptr addObservation( const std::string propertyName);
-  bool isChangedValue(const SGPropertyNode_ptr node);
+  PropertyChangeObserverEntryRef addObservation( const std::string & propertyName);
 
   void check();
-  void uncheck();
 
   void clear() { _entries.clear(); }
 
@@ -117,9 +117,11 @@ static void handleExecCommand(cJSON* json)
   globals->get_commands()->execute(name->valuestring, arg, nullptr);
 }
   
-PropertyChangeWebsocket::PropertyChangeWebsocket(PropertyChangeObserver * propertyChangeObserver)
+PropertyChangeWebsocket::PropertyChangeWebsocket(PropertyChangeObserver * propertyChangeObserver,
+                                                 PropertyStreamWriter::Format format)
     : id(++nextid),
       _propertyChangeObserver(propertyChangeObserver),
+      _stream(PropertyStreamWriter::create(format)),
       _minTriggerInterval(fgGetDouble("/sim/http/property-websocket/update-interval-secs", 0.05)), // default 20Hz
       _lastTrigger(-1000)
 {
@@ -146,7 +148,9 @@ void PropertyChangeWebsocket::handleGetCommand(const string_list& nodes, Websock
       return;
     }
     
-    writer.writeText( JSON::toJsonString( false, n, 0, t ) );
+    _stream->clear();
+    _stream->propertyObject(n, t);
+    _stream->write(writer);
   } // of nodes iteration
 }
   
@@ -219,14 +223,16 @@ void PropertyChangeWebsocket::poll(WebsocketWriter & writer)
   }
 
   for (WatchedNodesList::iterator it = _watchedNodes.begin(); it != _watchedNodes.end(); ++it) {
-    SGPropertyNode_ptr node = *it;
+    const unsigned version = it->entry->version();
+    if (version == it->sentVersion)
+      continue;
 
-    string newValue;
-    if (_propertyChangeObserver->isChangedValue(node)) {
-      string out = JSON::toJsonString( false, node, 0, now );
-      SG_LOG(SG_NETWORK, SG_DEBUG, "PropertyChangeWebsocket::poll() new Value for " << node->getPath(true) << " '" << node->getStringValue() << "' #" << id << ": " << out );
-      writer.writeText( out );
-    }
+    it->sentVersion = version;
+    SGPropertyNode * node = it->entry->_node;
+    _stream->clear();
+    _stream->propertyObject(node, now);
+    SG_LOG(SG_NETWORK, SG_DEBUG, "PropertyChangeWebsocket::poll() new Value for " << node->getPath(true) << " '" << node->getStringValue() << "' #" << id);
+    _stream->write(writer);
   }
 }
 
@@ -235,18 +241,22 @@ void PropertyChangeWebsocket::WatchedNodesList::handleCommand(const string & com
 {
   if (command == "addListener") {
     for (iterator it = begin(); it != end(); ++it) {
-      if (node == (*it)->getPath(true)) {
+      if (node == it->entry->_node->getPath(true)) {
         SG_LOG(SG_NETWORK, SG_WARN, "httpd: " << command << " '" << node << "' ignored (duplicate)");
         return; // dupliate
       }
     }
-    SGPropertyNode_ptr n = propertyChangeObserver->addObservation(node);
-    if (n.valid()) push_back(n);
+    PropertyChangeObserverEntryRef entry = propertyChangeObserver->addObservation(node);
+    if (entry.valid()) {
+      // version zero was never sent, so the current value goes out first
+      WatchedNode watched = { entry, 0 };
+      push_back(watched);
+    }
     SG_LOG(SG_NETWORK, SG_INFO, "httpd: " << command << " '" << node << "' success");
 
   } else if (command == "removeListener") {
     for (iterator it = begin(); it != end(); ++it) {
-      if (node == (*it)->getPath(true)) {
+      if (node == it->entry->_node->getPath(true)) {
         this->erase(it);
         SG_LOG(SG_NETWORK, SG_INFO, "httpd: " << command << " '" << node << "' success");
         return;
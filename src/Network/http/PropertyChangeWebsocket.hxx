@@ -22,18 +22,20 @@
 #define PROPERTYCHANGEWEBSOCKET_HXX_
 
 #include "Websocket.hxx"
+#include "PropertyChangeObserver.hxx"
+#include "PropertyStreamWriter.hxx"
 #include <simgear/props/props.hxx>
 
+#include <memory>
 #include <vector>
 
 namespace flightgear {
 namespace http {
 
-class PropertyChangeObserver;
-
 class PropertyChangeWebsocket: public Websocket {
 public:
-  PropertyChangeWebsocket(PropertyChangeObserver * propertyChangeObserver);
+  PropertyChangeWebsocket(PropertyChangeObserver * propertyChangeObserver,
+                          PropertyStreamWriter::Format format = PropertyStreamWriter::FORMAT_JSON);
   virtual ~PropertyChangeWebsocket();
   virtual void close();
   virtual void handleRequest(const HTTPRequest & request, WebsocketWriter & writer);
@@ -45,12 +47,18 @@ private:
 
   void handleGetCommand(const string_list& nodes, WebsocketWriter &writer);
   
-  class WatchedNodesList: public std::vector<SGPropertyNode_ptr> {
+  struct WatchedNode {
+    PropertyChangeObserverEntryRef entry;
+    unsigned sentVersion;
+  };
+
+  class WatchedNodesList: public std::vector<WatchedNode> {
   public:
     void handleCommand(const std::string & command, const std::string & node, PropertyChangeObserver * propertyChangeObserver);
   };
 
   WatchedNodesList _watchedNodes;
+  std::unique_ptr<PropertyStreamWriter> _stream;
   double _minTriggerInterval;
   double _lastTrigger;
 };
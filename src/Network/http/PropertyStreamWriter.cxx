@@ -0,0 +1,285 @@
+// PropertyStreamWriter.cxx -- stream property data as JSON or CBOR
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "PropertyStreamWriter.hxx"
+#include "Websocket.hxx"
+#include "jsonprops.hxx"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace flightgear {
+namespace http {
+
+namespace {
+
+class JsonStreamWriter : public PropertyStreamWriter {
+public:
+  void beginObject() override { separate(); _buffer += '{'; }
+  void endObject() override { _buffer += '}'; }
+  void beginArray() override { separate(); _buffer += '['; }
+  void endArray() override { _buffer += ']'; }
+
+  void key(const char * name) override
+  {
+    separate();
+    appendString(name, strlen(name));
+    _buffer += ':';
+  }
+
+  void value(bool b) override
+  {
+    separate();
+    _buffer += b ? "true" : "false";
+  }
+
+  void value(double d) override
+  {
+    separate();
+    if (!std::isfinite(d)) {
+      _buffer += "null";
+      return;
+    }
+
+    char buf[32];
+    if (d == std::floor(d) && std::fabs(d) < 1e15)
+      snprintf(buf, sizeof(buf), "%.0f", d);
+    else
+      snprintf(buf, sizeof(buf), "%.15g", d);
+    _buffer += buf;
+  }
+
+  void value(const char * s, size_t len) override
+  {
+    separate();
+    appendString(s, len);
+  }
+
+  void nullValue() override
+  {
+    separate();
+    _buffer += "null";
+  }
+
+  bool isBinary() const override { return false; }
+
+private:
+  // Values need a comma unless they open the document or a container, or
+  // follow a member name. That is fully determined by the last character.
+  void separate()
+  {
+    if (_buffer.empty())
+      return;
+    switch (_buffer.back()) {
+      case '{':
+      case '[':
+      case ':':
+        return;
+      default:
+        _buffer += ',';
+    }
+  }
+
+  void appendString(const char * s, size_t len)
+  {
+    static const char hex[] = "0123456789abcdef";
+    _buffer += '"';
+    for (size_t i = 0; i < len; ++i) {
+      const unsigned char c = s[i];
+      switch (c) {
+        case '"':  _buffer += "\\\""; break;
+        case '\\': _buffer += "\\\\"; break;
+        case '\b': _buffer += "\\b"; break;
+        case '\f': _buffer += "\\f"; break;
+        case '\n': _buffer += "\\n"; break;
+        case '\r': _buffer += "\\r"; break;
+        case '\t': _buffer += "\\t"; break;
+        default:
+          if (c < 0x20) {
+            _buffer += "\\u00";
+            _buffer += hex[c >> 4];
+            _buffer += hex[c & 0xf];
+          } else {
+            _buffer += static_cast<char>(c);
+          }
+      }
+    }
+    _buffer += '"';
+  }
+};
+
+// Containers use the indefinite length encoding, so nothing has to be
+// counted up front and the output can be produced in a single pass.
+class CborStreamWriter : public PropertyStreamWriter {
+public:
+  enum MajorType {
+    CBOR_UNSIGNED = 0,
+    CBOR_NEGATIVE = 1,
+    CBOR_TEXT = 3,
+    CBOR_ARRAY = 4,
+    CBOR_MAP = 5,
+    CBOR_SIMPLE = 7
+  };
+
+  void beginObject() override { _buffer += char(0xbf); }
+  void endObject() override { _buffer += char(0xff); }
+  void beginArray() override { _buffer += char(0x9f); }
+  void endArray() override { _buffer += char(0xff); }
+
+  void key(const char * name) override { value(name, strlen(name)); }
+
+  void value(bool b) override { _buffer += char(b ? 0xf5 : 0xf4); }
+
+  void value(double d) override
+  {
+    if (std::isnan(d)) {
+      nullValue();
+      return;
+    }
+
+    // integers are the common case for ids, indices and int properties
+    if (d == std::floor(d) && std::fabs(d) < 9007199254740992.0) {
+      if (d >= 0)
+        head(CBOR_UNSIGNED, static_cast<uint64_t>(d));
+      else
+        head(CBOR_NEGATIVE, static_cast<uint64_t>(-1 - static_cast<int64_t>(d)));
+      return;
+    }
+
+    const float f = static_cast<float>(d);
+    if (static_cast<double>(f) == d) {
+      uint32_t bits;
+      memcpy(&bits, &f, sizeof(bits));
+      _buffer += char(0xfa);
+      appendBigEndian(bits, 4);
+    } else {
+      uint64_t bits;
+      memcpy(&bits, &d, sizeof(bits));
+      _buffer += char(0xfb);
+      appendBigEndian(bits, 8);
+    }
+  }
+
+  void value(const char * s, size_t len) override
+  {
+    head(CBOR_TEXT, len);
+    _buffer.append(s, len);
+  }
+
+  void nullValue() override { _buffer += char(0xf6); }
+
+  bool isBinary() const override { return true; }
+
+private:
+  void head(MajorType type, uint64_t arg)
+  {
+    const char major = static_cast<char>(type << 5);
+    if (arg < 24) {
+      _buffer += char(major | arg);
+    } else if (arg <= 0xff) {
+      _buffer += char(major | 24);
+      appendBigEndian(arg, 1);
+    } else if (arg <= 0xffff) {
+      _buffer += char(major | 25);
+      appendBigEndian(arg, 2);
+    } else if (arg <= 0xffffffffu) {
+      _buffer += char(major | 26);
+      appendBigEndian(arg, 4);
+    } else {
+      _buffer += char(major | 27);
+      appendBigEndian(arg, 8);
+    }
+  }
+
+  void appendBigEndian(uint64_t v, int bytes)
+  {
+    for (int i = bytes - 1; i >= 0; --i)
+      _buffer += static_cast<char>((v >> (8 * i)) & 0xff);
+  }
+};
+
+} // of anonymous namespace
+
+std::unique_ptr<PropertyStreamWriter> PropertyStreamWriter::create(Format format)
+{
+  if (format == FORMAT_CBOR)
+    return std::unique_ptr<PropertyStreamWriter>(new CborStreamWriter);
+  return std::unique_ptr<PropertyStreamWriter>(new JsonStreamWriter);
+}
+
+void PropertyStreamWriter::value(const char * s)
+{
+  value(s, strlen(s));
+}
+
+void PropertyStreamWriter::propertyValue(SGPropertyNode * n)
+{
+  if (!n->hasValue()) {
+    nullValue();
+    return;
+  }
+
+  switch (n->getType()) {
+    case simgear::props::BOOL:
+      value(n->getBoolValue());
+      break;
+    case simgear::props::INT:
+    case simgear::props::LONG:
+    case simgear::props::FLOAT:
+    case simgear::props::DOUBLE:
+      value(n->getDoubleValue());
+      break;
+    default:
+      value(n->getStringValue());
+      break;
+  }
+}
+
+void PropertyStreamWriter::propertyObject(SGPropertyNode * n, double timestamp)
+{
+  beginObject();
+  key("path");
+  value(n->getPath(true));
+  key("name");
+  value(n->getName());
+  if (n->hasValue()) {
+    key("value");
+    propertyValue(n);
+  }
+  key("type");
+  value(JSON::getPropertyTypeString(n->getType()));
+  key("index");
+  value(n->getIndex());
+  if (timestamp >= 0.0) {
+    key("ts");
+    value(timestamp);
+  }
+  key("nChildren");
+  value(n->nChildren());
+  endObject();
+}
+
+int PropertyStreamWriter::write(WebsocketWriter & writer) const
+{
+  if (isBinary())
+    return writer.writeBinary(_buffer.data(), _buffer.size());
+  return writer.writeText(_buffer.data(), _buffer.size());
+}
+
+}  // namespace http
+}  // namespace flightgear
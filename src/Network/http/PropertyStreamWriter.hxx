@@ -0,0 +1,87 @@
+// PropertyStreamWriter.hxx -- stream property data as JSON or CBOR
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef PROPERTYSTREAMWRITER_HXX_
+#define PROPERTYSTREAMWRITER_HXX_
+
+#include <simgear/props/props.hxx>
+
+#include <memory>
+#include <string>
+
+namespace flightgear {
+namespace http {
+
+class WebsocketWriter;
+
+/**
+ * Writes a document token by token straight into a reusable buffer, so
+ * websockets can send property updates without building a cJSON tree
+ * first. The same calls produce either JSON text or CBOR (RFC 7049),
+ * which is more compact and cheaper to parse for high rate clients.
+ */
+class PropertyStreamWriter {
+public:
+  enum Format {
+    FORMAT_JSON,
+    FORMAT_CBOR
+  };
+
+  static std::unique_ptr<PropertyStreamWriter> create(Format format);
+
+  virtual ~PropertyStreamWriter() {}
+
+  virtual void beginObject() = 0;
+  virtual void endObject() = 0;
+  virtual void beginArray() = 0;
+  virtual void endArray() = 0;
+
+  /// member name inside an object, must be followed by exactly one value
+  virtual void key(const char * name) = 0;
+
+  virtual void value(bool b) = 0;
+  virtual void value(double d) = 0;
+  virtual void value(const char * s, size_t len) = 0;
+  virtual void nullValue() = 0;
+
+  void value(int i) { value(static_cast<double>(i)); }
+  void value(unsigned int i) { value(static_cast<double>(i)); }
+  void value(const char * s);
+  void value(const std::string & s) { value(s.c_str(), s.size()); }
+
+  /// The value of a node, typed the same way as JSON::valueToJson
+  void propertyValue(SGPropertyNode * n);
+
+  /// A node object with the members written by JSON::toJson with depth 0
+  void propertyObject(SGPropertyNode * n, double timestamp = -1.0);
+
+  virtual bool isBinary() const = 0;
+
+  /// Sends the buffer as one text or binary websocket message
+  int write(WebsocketWriter & writer) const;
+
+  const std::string & data() const { return _buffer; }
+  bool empty() const { return _buffer.empty(); }
+  void clear() { _buffer.clear(); }
+
+protected:
+  std::string _buffer;
+};
+
+}  // namespace http
+}  // namespace flightgear
+
+#endif /* PROPERTYSTREAMWRITER_HXX_ */
@@ -554,7 +554,6 @@ void MongooseHttpd::update(double dt)
 {
   _propertyChangeObserver.check();
   mg_poll_server(_server, 0);
-  _propertyChangeObserver.uncheck();
 }
 
 int MongooseHttpd::poll(struct mg_connection * connection)
@@ -592,9 +591,17 @@ void MongooseHttpd::close(struct mg_connection * connection)
 }
 Websocket * MongooseHttpd::newWebsocket(const string & uri)
 {
-  if (uri.find("/PropertyListener") == 0) {
+  // the ...CBOR variants send binary CBOR messages instead of JSON text
+  if (uri.find("/PropertyListenerCBOR") == 0) {
+    SG_LOG(SG_NETWORK, SG_INFO, "new binary PropertyChangeWebsocket for: " << uri);
+    return new PropertyChangeWebsocket(&_propertyChangeObserver, PropertyStreamWriter::FORMAT_CBOR);
+  } else if (uri.find("/PropertyListener") == 0) {
     SG_LOG(SG_NETWORK, SG_INFO, "new PropertyChangeWebsocket for: " << uri);
     return new PropertyChangeWebsocket(&_propertyChangeObserver);
+  } else if (uri.find("/PropertyTreeMirrorCBOR/") == 0) {
+    const auto path = uri.substr(24);
+    SG_LOG(SG_NETWORK, SG_INFO, "new binary MirrorPropertyTreeWebsocket for: " << path);
+    return new MirrorPropertyTreeWebsocket(path, PropertyStreamWriter::FORMAT_CBOR);
   } else if (uri.find("/PropertyTreeMirror/") == 0) {
     const auto path = uri.substr(20);
     SG_LOG(SG_NETWORK, SG_INFO, "new MirrorPropertyTreeWebsocket for: " << path);
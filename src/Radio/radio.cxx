@@ -20,13 +20,24 @@
 
 #include <config.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <tuple>
 
 #include <stdlib.h>
-#include <deque>
+#include <vector>
 #include "radio.hxx"
 #include <simgear/scene/material/mat.hxx>
+#include <simgear/threads/SGThread.hxx>
+#include <simgear/timing/timestamp.hxx>
 #include <Scenery/scenery.hxx>
+#include <Scenery/terrain.hxx>
 
 #define WITH_POINT_TO_POINT 1
 #include "itm.cpp"
@@ -205,30 +216,192 @@ void FGRadioTransmission::receiveATC(SGGeod tx_pos, double freq, string text, in
 }
 
 
-double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, int transmission_type) {
+/** One ITM evaluation: the terrain profile and parameters, which are
+*	gathered on the main thread, and the results, which may be computed
+*	on a worker thread. The receiver and sender positions are kept to
+*	decide when the result is too old to be reused.
+**/
+struct FGITMJob
+{
+	std::vector<double> itm_elev;
+	std::vector<string> material_names;	// one per distinct material
+	std::vector<const string*> materials;	// per profile point, into material_names
+	double transmitter_height = 0.0;
+	double receiver_height = 0.0;
+	double rx_elev_angle = 0.0;
+	bool from_receiver = false;	// the profile starts at the receiver
+	bool use_clutter = false;
 
-	
-	if((freq < 40.0) || (freq > 20000.0))	// frequency out of recommended range 
-		return -1;
-	/** ITM default parameters 
-		TODO: take them from tile materials (especially for sea)?
-	**/
-	double eps_dielect=15.0;
+	double eps_dielect = 15.0;
 	double sgm_conductivity = 0.005;
 	double eno = 301.0;
-	double frq_mhz = freq;
-	
+	double frq_mhz = 0.0;
 	int radio_climate = 5;		// continental temperate
-	int pol= _polarization;	
+	int pol = 0;
 	double conf = 0.90;	// 90% of situations and time, take into account speed
-	double rel = 0.90;	
-	double dbloss;
+	double rel = 0.90;
+
+	SGVec3d receiver_cart;
+	double receiver_alt = 0.0;
+	SGVec3d sender_cart;
+
+	double dbloss = 0.0;
+	double clutter_loss = 0.0; 	// loss due to vegetation and urban
 	char strmode[150];
 	int p_mode = 0; // propgation mode selector: 0 LOS, 1 diffraction dominant, 2 troposcatter
 	double horizons[2];
-	int errnum;
+	int errnum = 0;
+	std::atomic<bool> done{false};
+};
+
+namespace {
+
+/** A few threads which run ITM jobs in the order they are submitted, so
+*	the main thread never waits for a profile to be evaluated.
+**/
+class ITMWorkerPool
+{
+public:
+	typedef std::function<void()> Task;
+
+	explicit ITMWorkerPool(unsigned num_threads)
+	{
+		for (unsigned i = 0; i < num_threads; ++i) {
+			_threads.emplace_back(new WorkerThread(this));
+			_threads.back()->start();
+		}
+	}
+
+	~ITMWorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_stop = true;
+		}
+		_wake.notify_all();
+		for (auto& t : _threads)
+			t->join();
+	}
+
+	void submit(Task task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_tasks.push_back(std::move(task));
+		}
+		_wake.notify_one();
+	}
+
+private:
+	class WorkerThread : public SGThread
+	{
+	public:
+		WorkerThread(ITMWorkerPool* pool) : _pool(pool) {}
+	protected:
+		void run() override { _pool->workerMain(); }
+	private:
+		ITMWorkerPool* _pool;
+	};
+
+	void workerMain()
+	{
+		for (;;) {
+			Task task;
+			{
+				std::unique_lock<std::mutex> lock(_lock);
+				_wake.wait(lock, [this] { return _stop || !_tasks.empty(); });
+				if (_stop)
+					return;
+				task = std::move(_tasks.front());
+				_tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+	std::vector<std::unique_ptr<WorkerThread>> _threads;
+	std::mutex _lock;
+	std::condition_variable _wake;
+	std::deque<Task> _tasks;
+	bool _stop = false;
+};
+
+/// Returns the pool, or nullptr if ITM should be evaluated synchronously.
+/// The number of threads is read once, on first use.
+ITMWorkerPool* itmWorkerPool()
+{
+	static const int num_threads = fgGetInt("/sim/radio/itm-worker-threads", 2);
+	if (num_threads <= 0)
+		return nullptr;
+
+	static ITMWorkerPool pool(num_threads);
+	return &pool;
+}
+
+/** Results are cached per transmitter cell and radio parameters. The
+*	receiver is always the user's aircraft; how far it may move before a
+*	result is considered stale is decided when looking it up.
+**/
+struct ITMCacheKey
+{
+	int lat, lon, alt;	// transmitter cell
+	int freq_khz;
+	int transmission_type;
+	int polarization;
+	int tx_antenna_cm, rx_antenna_cm;
+	bool use_clutter;
+
+	bool operator<(const ITMCacheKey& other) const
+	{
+		return std::tie(lat, lon, alt, freq_khz, transmission_type, polarization,
+						tx_antenna_cm, rx_antenna_cm, use_clutter) <
+			std::tie(other.lat, other.lon, other.alt, other.freq_khz, other.transmission_type,
+						other.polarization, other.tx_antenna_cm, other.rx_antenna_cm, other.use_clutter);
+	}
+};
+
+struct ITMCacheEntry
+{
+	std::shared_ptr<FGITMJob> result;	// the last completed evaluation
+	std::shared_ptr<FGITMJob> pending;	// running on a worker, if any
+	SGTimeStamp last_used;
+};
+
+typedef std::map<ITMCacheKey, ITMCacheEntry> ITMCache;
+
+// only used from the main thread
+ITMCache itm_cache;
+SGTimeStamp itm_cache_pruned;
+
+const double ITM_CACHE_CELL_DEG = 0.01;
+const double ITM_CACHE_ALT_BAND_M = 100.0;
+
+void pruneITMCache(const SGTimeStamp& now, double max_age_sec)
+{
+	if ((now - itm_cache_pruned).toSecs() < max_age_sec)
+		return;
+
+	itm_cache_pruned = now;
+	for (ITMCache::iterator it = itm_cache.begin(); it != itm_cache.end(); ) {
+		// a pending job keeps itself alive until it is finished
+		if ((now - it->second.last_used).toSecs() > max_age_sec)
+			it = itm_cache.erase(it);
+		else
+			++it;
+	}
+}
+
+} // of anonymous namespace
+
+
+double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, int transmission_type) {
+
+	
+	if((freq < 40.0) || (freq > 20000.0))	// frequency out of recommended range 
+		return -1;
+	double frq_mhz = freq;
+	double dbloss;
 	
-	double clutter_loss = 0.0; 	// loss due to vegetation and urban
 	double tx_pow = _transmitter_power;
 	double ant_gain = _rx_antenna_gain + _tx_antenna_gain;
 	double signal = 0.0;
@@ -239,39 +412,21 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	double tx_erp = dbm_to_watt(tx_pow + _tx_antenna_gain - _tx_line_losses);
 	
 
-	FGScenery * scenery = globals->get_scenery();
-	
 	double own_lat = fgGetDouble("/position/latitude-deg");
 	double own_lon = fgGetDouble("/position/longitude-deg");
 	double own_alt_ft = fgGetDouble("/position/altitude-ft");
 	double own_heading = fgGetDouble("/orientation/heading-deg");
 	double own_alt= own_alt_ft * SG_FEET_TO_METER;
 	
-	
-	
-	
 	SGGeod own_pos = SGGeod::fromDegM( own_lon, own_lat, own_alt );
-	SGGeod max_own_pos = SGGeod::fromDegM( own_lon, own_lat, SG_MAX_ELEVATION_M );
-	SGGeoc center = SGGeoc::fromGeod( max_own_pos );
 	SGGeoc own_pos_c = SGGeoc::fromGeod( own_pos );
 	
-	
-	double sender_alt_ft,sender_alt;
-	double transmitter_height=0.0;
-	double receiver_height=0.0;
 	SGGeod sender_pos = pos;
-	
-	sender_alt_ft = sender_pos.getElevationFt();
-	sender_alt = sender_alt_ft * SG_FEET_TO_METER;
-	SGGeod max_sender_pos = SGGeod::fromGeodM( pos, SG_MAX_ELEVATION_M );
 	SGGeoc sender_pos_c = SGGeoc::fromGeod( sender_pos );
 	
-	
-	double point_distance= _terrain_sampling_distance; 
 	double course = SGGeodesy::courseRad(own_pos_c, sender_pos_c);
 	double reverse_course = SGGeodesy::courseRad(sender_pos_c, own_pos_c);
 	double distance_m = SGGeodesy::distanceM(own_pos, sender_pos);
-	double probe_distance = 0.0;
 	/** If distance larger than this value (300 km), assume reception imposssible to spare CPU cycles */
 	if (distance_m > 300000)
 		return -1.0;
@@ -285,125 +440,77 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 		return signal;
 	}
 	
-		
-	int max_points = (int)floor(distance_m / point_distance);
-	//double delta_last = fmod(distance_m, point_distance);
-	
-	deque<double> elevations;
-	deque<string*> materials;
-	
+	/** Terrain profiles are expensive, so the last result for this transmitter
+	*	is reused until the receiver or the sender moved far enough to make a
+	*	difference. A stale result is then kept while a new one is computed
+	*	on a worker thread; only the first evaluation for a transmitter
+	*	blocks.
+	**/
+	const bool use_clutter = _root_node->getBoolValue( "use-clutter-attenuation", false );
+	ITMCacheKey key;
+	key.lat = (int)floor(sender_pos.getLatitudeDeg() / ITM_CACHE_CELL_DEG);
+	key.lon = (int)floor(sender_pos.getLongitudeDeg() / ITM_CACHE_CELL_DEG);
+	key.alt = (int)floor(sender_pos.getElevationM() / ITM_CACHE_ALT_BAND_M);
+	key.freq_khz = (int)floor(frq_mhz * 1000 + 0.5);
+	key.transmission_type = transmission_type;
+	key.polarization = _polarization;
+	key.tx_antenna_cm = (int)floor(_tx_antenna_height * 100 + 0.5);
+	key.rx_antenna_cm = (int)floor(_rx_antenna_height * 100 + 0.5);
+	key.use_clutter = use_clutter;
 
-	double elevation_under_pilot = 0.0;
-	if (scenery->get_elevation_m( max_own_pos, elevation_under_pilot, NULL )) {
-		receiver_height = own_alt - elevation_under_pilot; 
-	}
+	const SGTimeStamp now = SGTimeStamp::now();
+	ITMCacheEntry& entry = itm_cache[key];
+	entry.last_used = now;
 
-	double elevation_under_sender = 0.0;
-	if (scenery->get_elevation_m( max_sender_pos, elevation_under_sender, NULL )) {
-		transmitter_height = sender_alt - elevation_under_sender;
+	if (entry.pending && entry.pending->done.load(std::memory_order_acquire)) {
+		entry.result = entry.pending;
+		entry.pending.reset();
 	}
-	else {
-		transmitter_height = sender_alt;
+
+	if (!entry.result) {
+		entry.result = ITM_prepare(own_pos, sender_pos, frq_mhz, transmission_type, use_clutter);
+		ITM_evaluate(*entry.result);
 	}
-	
-	
-	transmitter_height += _tx_antenna_height;
-	receiver_height += _rx_antenna_height;
-	
-	//cerr << "ITM:: RX-height: " << receiver_height << " meters, TX-height: " << transmitter_height << " meters, Distance: " << distance_m << " meters" << endl;
-	_root_node->setDoubleValue("station[0]/rx-height", receiver_height);
-	_root_node->setDoubleValue("station[0]/tx-height", transmitter_height);
-	_root_node->setDoubleValue("station[0]/distance", distance_m / 1000);
-	
-	unsigned int e_size = (deque<unsigned>::size_type)max_points;
-	
-	while (elevations.size() <= e_size) {
-		probe_distance += point_distance;
-		SGGeod probe = SGGeod::fromGeoc(center.advanceRadM( course, probe_distance ));
-		const simgear::BVHMaterial *material = 0;
-		double elevation_m = 0.0;
-	
-		if (scenery->get_elevation_m( probe, elevation_m, &material )) {
-                        const SGMaterial *mat;
-                        mat = dynamic_cast<const SGMaterial*>(material);
-			if((transmission_type == 3) || (transmission_type == 4)) {
-				elevations.push_back(elevation_m);
-				if(mat) {
-					const std::vector<string> mat_names = mat->get_names();
-					string* name = new string(mat_names[0]);
-					materials.push_back(name);
-				}
-				else {
-					string* no_material = new string("None"); 
-					materials.push_back(no_material);
-				}
-			}
-			else {
-				 elevations.push_front(elevation_m);
-				 if(mat) {
-				 	 const std::vector<string> mat_names = mat->get_names();
-				 	 string* name = new string(mat_names[0]);
-				 	 materials.push_front(name);
-				}
-				else {
-					string* no_material = new string("None"); 
-					materials.push_front(no_material);
-				}
-			}
-		}
-		else {
-			if((transmission_type == 3) || (transmission_type == 4)) {
-				elevations.push_back(0.0);
-				string* no_material = new string("None"); 
-				materials.push_back(no_material);
+	else if (!entry.pending) {
+		const SGVec3d own_cart = SGVec3d::fromGeod(own_pos);
+		const SGVec3d sender_cart = SGVec3d::fromGeod(sender_pos);
+		const double max_move = std::max(_root_node->getDoubleValue("itm-cache/distance-m", 500.0),
+			_root_node->getDoubleValue("itm-cache/distance-fraction", 0.02) * distance_m);
+		const bool stale =
+			(dist(own_cart, entry.result->receiver_cart) > max_move) ||
+			(dist(sender_cart, entry.result->sender_cart) > max_move) ||
+			(fabs(own_alt - entry.result->receiver_alt) > _root_node->getDoubleValue("itm-cache/altitude-m", 50.0));
+
+		if (stale) {
+			std::shared_ptr<FGITMJob> job = ITM_prepare(own_pos, sender_pos, frq_mhz, transmission_type, use_clutter);
+			ITMWorkerPool* pool = itmWorkerPool();
+			if (pool) {
+				entry.pending = job;
+				pool->submit([job] {
+					ITM_evaluate(*job);
+					job->done.store(true, std::memory_order_release);
+				});
 			}
 			else {
-				string* no_material = new string("None"); 
-				elevations.push_front(0.0);
-				materials.push_front(no_material);
+				ITM_evaluate(*job);
+				entry.result = job;
 			}
 		}
 	}
-	if((transmission_type == 3) || (transmission_type == 4)) {
-		elevations.push_front(elevation_under_pilot);
-		//if (delta_last > (point_distance / 2) )			// only add last point if it's farther than half point_distance
-			elevations.push_back(elevation_under_sender);
-	}
-	else {
-		elevations.push_back(elevation_under_pilot);
-		//if (delta_last > (point_distance / 2) )
-			elevations.push_front(elevation_under_sender);
-	}
-	
-	
-	double num_points= (double)elevations.size();
-
 
-	elevations.push_front(point_distance);
-	elevations.push_front(num_points -1);
+	// hold a reference, the pruning below may drop the entry
+	const std::shared_ptr<FGITMJob> result = entry.result;
+	pruneITMCache(now, _root_node->getDoubleValue("itm-cache/max-age-sec", 120.0));
 
-	int size = elevations.size();
-    std::vector<double> itm_elev(size);
-
-	for(int i=0;i<size;i++) {
-		itm_elev[i]=elevations[i];
-	}
+	dbloss = result->dbloss;
+	double clutter_loss = result->clutter_loss;
+	double receiver_height = result->receiver_height;
+	double transmitter_height = result->transmitter_height;
 	
-	if((transmission_type == 3) || (transmission_type == 4)) {
-		// the sender and receiver roles are switched
-		ITM::point_to_point(itm_elev.data(), receiver_height, transmitter_height,
-			eps_dielect, sgm_conductivity, eno, frq_mhz, radio_climate,
-			pol, conf, rel, dbloss, strmode, p_mode, horizons, errnum);
-		if( _root_node->getBoolValue( "use-clutter-attenuation", false ) )
-			calculate_clutter_loss(frq_mhz, itm_elev.data(), materials, receiver_height, transmitter_height, p_mode, horizons, clutter_loss);
-	}
-	else {
-		ITM::point_to_point(itm_elev.data(), transmitter_height, receiver_height,
-			eps_dielect, sgm_conductivity, eno, frq_mhz, radio_climate,
-			pol, conf, rel, dbloss, strmode, p_mode, horizons, errnum);
-		if( _root_node->getBoolValue( "use-clutter-attenuation", false ) )
-			calculate_clutter_loss(frq_mhz, itm_elev.data(), materials, transmitter_height, receiver_height, p_mode, horizons, clutter_loss);
-	}
+	//cerr << "ITM:: RX-height: " << receiver_height << " meters, TX-height: " << transmitter_height << " meters, Distance: " << distance_m << " meters" << endl;
+	_root_node->setDoubleValue("station[0]/rx-height", receiver_height);
+	_root_node->setDoubleValue("station[0]/tx-height", transmitter_height);
+	_root_node->setDoubleValue("station[0]/distance", distance_m / 1000);
 	
 	double pol_loss = 0.0;
 	// TODO: remove this check after we check a bit the axis calculations in this function
@@ -415,7 +522,7 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	//cerr << "ITM:: Link budget: " << link_budget << ", Attenuation: " << dbloss << " dBm, " << strmode << ", Error: " << errnum << endl;
 	_root_node->setDoubleValue("station[0]/link-budget", link_budget);
 	_root_node->setDoubleValue("station[0]/terrain-attenuation", dbloss);
-	_root_node->setStringValue("station[0]/prop-mode", strmode);
+	_root_node->setStringValue("station[0]/prop-mode", result->strmode);
 	_root_node->setDoubleValue("station[0]/clutter-attenuation", clutter_loss);
 	_root_node->setDoubleValue("station[0]/polarization-attenuation", pol_loss);
 	//if (errnum == 4)	// if parameters are outside sane values for lrprop, bail out fast
@@ -427,7 +534,7 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	double sender_heading = 270.0; // due West
 	double tx_antenna_bearing = sender_heading - reverse_course * SGD_RADIANS_TO_DEGREES;
 	double rx_antenna_bearing = own_heading - course * SGD_RADIANS_TO_DEGREES;
-	double rx_elev_angle = atan((itm_elev[2] + transmitter_height - itm_elev[(int)itm_elev[0] + 2] + receiver_height) / distance_m) * SGD_RADIANS_TO_DEGREES;
+	double rx_elev_angle = result->rx_elev_angle;
 	double tx_elev_angle = 0.0 - rx_elev_angle;
 	if (_root_node->getBoolValue("use-tx-antenna-pattern", false)) {
 		FGRadioAntenna* TX_antenna;
@@ -457,16 +564,138 @@ double FGRadioTransmission::ITM_calculate_attenuation(SGGeod pos, double freq, i
 	//_root_node->setDoubleValue("station[0]/tx-pattern-gain", tx_pattern_gain);
 	//_root_node->setDoubleValue("station[0]/rx-pattern-gain", rx_pattern_gain);
 
-	for (unsigned i =0; i < materials.size(); i++) {
-		delete materials[i];
+	return signal;
+
+}
+
+
+std::shared_ptr<FGITMJob> FGRadioTransmission::ITM_prepare(const SGGeod& own_pos, const SGGeod& sender_pos,
+	double freq, int transmission_type, bool use_clutter) {
+
+	std::shared_ptr<FGITMJob> job = std::make_shared<FGITMJob>();
+	job->frq_mhz = freq;
+	job->pol = _polarization;
+	job->use_clutter = use_clutter;
+	job->receiver_cart = SGVec3d::fromGeod(own_pos);
+	job->receiver_alt = own_pos.getElevationM();
+	job->sender_cart = SGVec3d::fromGeod(sender_pos);
+
+	FGScenery * scenery = globals->get_scenery();
+	
+	double own_alt = own_pos.getElevationM();
+	SGGeod max_own_pos = SGGeod::fromGeodM( own_pos, SG_MAX_ELEVATION_M );
+	SGGeoc center = SGGeoc::fromGeod( max_own_pos );
+	SGGeoc own_pos_c = SGGeoc::fromGeod( own_pos );
+	
+	double sender_alt = sender_pos.getElevationM();
+	double transmitter_height=0.0;
+	double receiver_height=0.0;
+	SGGeod max_sender_pos = SGGeod::fromGeodM( sender_pos, SG_MAX_ELEVATION_M );
+	SGGeoc sender_pos_c = SGGeoc::fromGeod( sender_pos );
+	
+	double point_distance= _terrain_sampling_distance; 
+	double course = SGGeodesy::courseRad(own_pos_c, sender_pos_c);
+	double distance_m = SGGeodesy::distanceM(own_pos, sender_pos);
+	double probe_distance = 0.0;
+		
+	int max_points = (int)floor(distance_m / point_distance);
+	//double delta_last = fmod(distance_m, point_distance);
+	
+	unsigned int e_size = (unsigned int)max_points;
+
+	// the points under the receiver and the sender, with the profile points
+	// between them, all sampled in one pass over the scenery
+	std::vector<SGGeod> probes;
+	probes.reserve(e_size + 3);
+	probes.push_back(max_own_pos);
+	for (unsigned int i = 0; i <= e_size; ++i) {
+		probe_distance += point_distance;
+		probes.push_back(SGGeod::fromGeoc(center.advanceRadM( course, probe_distance )));
+	}
+	probes.push_back(max_sender_pos);
+
+	FGTerrainSamples profile;
+	scenery->get_elevations_m(probes, profile);
+	const unsigned int sender_index = probes.size() - 1;
+
+	double elevation_under_pilot = 0.0;
+	if (profile.valid[0]) {
+		elevation_under_pilot = profile.elevation_m[0];
+		receiver_height = own_alt - elevation_under_pilot; 
+	}
+
+	double elevation_under_sender = 0.0;
+	if (profile.valid[sender_index]) {
+		elevation_under_sender = profile.elevation_m[sender_index];
+		transmitter_height = sender_alt - elevation_under_sender;
+	}
+	else {
+		transmitter_height = sender_alt;
 	}
 	
-	return signal;
+	
+	transmitter_height += _tx_antenna_height;
+	receiver_height += _rx_antenna_height;
+	job->transmitter_height = transmitter_height;
+	job->receiver_height = receiver_height;
+	
+	// one name per distinct material rather than per point; the names are
+	// copied, the job may outlive the materials
+	static const string no_material("None");
+	job->material_names.resize(profile.materials.size() + 1, no_material);
+	for (unsigned int m = 0; m < profile.materials.size(); m++) {
+		const SGMaterial *mat = dynamic_cast<const SGMaterial*>(profile.materials[m]);
+		if (mat && !mat->get_names().empty())
+			job->material_names[m] = mat->get_names()[0];
+	}
+	const string* none_name = &job->material_names.back();
+
+	// ITM wants the number of intervals and their length, followed by the
+	// elevations from the transmitter to the receiver. Profile points
+	// without scenery count as sea level.
+	const unsigned int num_points = e_size + 3;
+	std::vector<double>& itm_elev = job->itm_elev;
+	itm_elev.resize(num_points + 2);
+	job->materials.resize(e_size + 1);
+	itm_elev[0] = num_points - 1;
+	itm_elev[1] = point_distance;
+
+	// the sender and receiver roles are switched for types 3 and 4
+	const bool from_receiver = (transmission_type == 3) || (transmission_type == 4);
+	job->from_receiver = from_receiver;
+	for (unsigned int i = 0; i < num_points; i++) {
+		const unsigned int probe = from_receiver ? i : num_points - 1 - i;
+		if ((probe == 0) || (probe == sender_index)) {
+			itm_elev[i + 2] = (probe == 0) ? elevation_under_pilot : elevation_under_sender;
+			continue;
+		}
+
+		itm_elev[i + 2] = profile.valid[probe] ? profile.elevation_m[probe] : 0.0;
+		const int mat = profile.valid[probe] ? profile.material[probe] : -1;
+		job->materials[i - 1] = (mat < 0) ? none_name : &job->material_names[mat];
+	}
+
+	job->rx_elev_angle = atan((itm_elev[2] + transmitter_height - itm_elev[(int)itm_elev[0] + 2] + receiver_height) / distance_m) * SGD_RADIANS_TO_DEGREES;
+	return job;
+}
+
+
+void FGRadioTransmission::ITM_evaluate(FGITMJob& job) {
+
+	// the heights are passed in profile order
+	const double start_height = job.from_receiver ? job.receiver_height : job.transmitter_height;
+	const double end_height = job.from_receiver ? job.transmitter_height : job.receiver_height;
 
+	ITM::point_to_point(job.itm_elev.data(), start_height, end_height,
+		job.eps_dielect, job.sgm_conductivity, job.eno, job.frq_mhz, job.radio_climate,
+		job.pol, job.conf, job.rel, job.dbloss, job.strmode, job.p_mode, job.horizons, job.errnum);
+	if (job.use_clutter)
+		calculate_clutter_loss(job.frq_mhz, job.itm_elev.data(), job.materials, start_height, end_height,
+			job.p_mode, job.horizons, job.clutter_loss);
 }
 
 
-void FGRadioTransmission::calculate_clutter_loss(double freq, double itm_elev[], deque<string*> &materials,
+void FGRadioTransmission::calculate_clutter_loss(double freq, double itm_elev[], const std::vector<const string*> &materials,
 	double transmitter_height, double receiver_height, int p_mode,
 	double horizons[], double &clutter_loss) {
 	
@@ -804,7 +1033,7 @@ void FGRadioTransmission::calculate_clutter_loss(double freq, double itm_elev[],
 }
 
 
-void FGRadioTransmission::get_material_properties(string* mat_name, double &height, double &density) {
+void FGRadioTransmission::get_material_properties(const string* mat_name, double &height, double &density) {
 	
 	if(!mat_name)
 		return;
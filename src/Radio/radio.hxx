@@ -23,7 +23,8 @@
 
 #include <simgear/compiler.h>
 #include <simgear/structure/subsystem_mgr.hxx>
-#include <deque>
+#include <memory>
+#include <vector>
 #include <Main/fg_props.hxx>
 
 #include <simgear/math/sg_geodesy.hxx>
@@ -32,6 +33,7 @@
 
 using std::string;
 
+struct FGITMJob;
 
 class FGRadioTransmission 
 {
@@ -62,6 +64,20 @@ private:
 ***/
 	double ITM_calculate_attenuation(SGGeod tx_pos, double freq, int ground_to_air);
 	
+/*** Sample the terrain profile between the receiver and the transmitter, on the main thread
+*	@param: receiver position, transmitter position, frequency, transmission type, clutter flag
+*	@return: the job to evaluate
+***/
+	std::shared_ptr<FGITMJob> ITM_prepare(const SGGeod& own_pos, const SGGeod& tx_pos,
+			double freq, int transmission_type, bool use_clutter);
+	
+/*** Run the ITM model on a prepared profile; does not touch the scenery or
+*	 the property tree, so it may run on any thread
+*	@param: the job, which receives the attenuation
+*	@return: none
+***/
+	static void ITM_evaluate(FGITMJob& job);
+	
 /*** a simple alternative LOS propagation model (WIP)
 *	@param: transmitter position, frequency, flag to indicate if the transmission is from a ground station
 *	@return: signal level above receiver treshhold sensitivity
@@ -74,7 +90,7 @@ private:
 *	@param: frequency, elevation data, terrain type, horizon distances, calculated loss
 *	@return: none
 ***/
-	void calculate_clutter_loss(double freq, double itm_elev[], std::deque<string*> &materials,
+	static void calculate_clutter_loss(double freq, double itm_elev[], const std::vector<const string*> &materials,
 			double transmitter_height, double receiver_height, int p_mode,
 			double horizons[], double &clutter_loss);
 	
@@ -82,7 +98,7 @@ private:
 *		@param: terrain type, median clutter height, radiowave attenuation factor
 *		@return: none
 ***/
-	void get_material_properties(string* mat_name, double &height, double &density);
+	static void get_material_properties(const string* mat_name, double &height, double &density);
 	
 	
 public:
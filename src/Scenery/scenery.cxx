@@ -27,6 +27,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include <osg/Camera>
 #include <osg/Transform>
 #include <osg/MatrixTransform>
@@ -552,6 +554,103 @@ FGScenery::get_cart_ground_intersection(const SGVec3d& pos, const SGVec3d& dir,
     return _terrain->get_cart_ground_intersection( pos, dir, nearestHit, butNotFrom );
 }
 
+static size_t countValid(const FGTerrainSamples& samples)
+{
+    return std::count(samples.valid.begin(), samples.valid.end(), 1);
+}
+
+size_t
+FGScenery::get_elevations_m(const std::vector<SGGeod>& points,
+                            FGTerrainSamples& samples,
+                            const osg::Node* butNotFrom)
+{
+    // the same segments as FGStgTerrain::get_elevation_m() uses
+    std::vector<SGLineSegmentd> segments;
+    segments.reserve(points.size());
+    for (const SGGeod& geod : points) {
+        if (!geod.isValid()) {
+            // can't hit anything
+            segments.push_back(SGLineSegmentd(SGVec3d::zeros(), SGVec3d::zeros()));
+            continue;
+        }
+
+        SGGeod geodEnd = geod;
+        geodEnd.setElevationM(SGMiscd::min(geod.getElevationM() - 10, -10000));
+        segments.push_back(SGLineSegmentd(SGVec3d::fromGeod(geod),
+                                          SGVec3d::fromGeod(geodEnd)));
+    }
+
+    _terrain->get_cart_ground_intersections(segments, samples, butNotFrom);
+    return countValid(samples);
+}
+
+size_t
+FGScenery::get_elevation_profile_m(const SGGeod& start, const SGGeod& end,
+                                   unsigned int count,
+                                   FGTerrainSamples& samples,
+                                   const osg::Node* butNotFrom)
+{
+    count = std::max(count, 2u);
+    double course, reverseCourse, distance;
+    SGGeodesy::inverse(start, end, course, reverseCourse, distance);
+
+    std::vector<SGGeod> points(count);
+    const double step = distance / (count - 1);
+    for (unsigned int i = 0; i < count; ++i) {
+        double az2;
+        SGGeodesy::direct(start, course, i * step, points[i], az2);
+        points[i].setElevationM(SG_MAX_ELEVATION_M);
+    }
+
+    return get_elevations_m(points, samples, butNotFrom);
+}
+
+size_t
+FGScenery::get_elevation_grid_m(const SGGeod& southWest, const SGGeod& northEast,
+                                unsigned int lonCount, unsigned int latCount,
+                                FGTerrainSamples& samples,
+                                const osg::Node* butNotFrom)
+{
+    const double lonStep = (lonCount > 1) ?
+        (northEast.getLongitudeDeg() - southWest.getLongitudeDeg()) / (lonCount - 1) : 0.0;
+    const double latStep = (latCount > 1) ?
+        (northEast.getLatitudeDeg() - southWest.getLatitudeDeg()) / (latCount - 1) : 0.0;
+
+    std::vector<SGGeod> points;
+    points.reserve(lonCount * latCount);
+    for (unsigned int j = 0; j < latCount; ++j) {
+        for (unsigned int i = 0; i < lonCount; ++i) {
+            points.push_back(SGGeod::fromDegM(southWest.getLongitudeDeg() + i * lonStep,
+                                              southWest.getLatitudeDeg() + j * latStep,
+                                              SG_MAX_ELEVATION_M));
+        }
+    }
+
+    return get_elevations_m(points, samples, butNotFrom);
+}
+
+size_t
+FGScenery::get_cart_ground_intersections(const SGVec3d& start,
+                                         const std::vector<SGVec3d>& dirs,
+                                         FGTerrainSamples& samples,
+                                         const osg::Node* butNotFrom)
+{
+    // as get_cart_ground_intersection(), starting positions in the center
+    // of the earth are invalid
+    if (norm1(start) < 1) {
+        samples.reset(dirs.size());
+        return 0;
+    }
+
+    std::vector<SGLineSegmentd> segments;
+    segments.reserve(dirs.size());
+    for (const SGVec3d& dir : dirs)
+        segments.push_back(SGLineSegmentd(start, start + 1e5*normalize(dir)));
+
+    _terrain->get_cart_ground_intersections(segments, samples, butNotFrom);
+    return countValid(samples);
+}
+
 bool FGScenery::scenery_available(const SGGeod& position, double range_m)
 {
     return _terrain->scenery_available( position, range_m );
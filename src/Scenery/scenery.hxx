@@ -29,6 +29,8 @@
 # error This library requires C++
 #endif
 
+#include <vector>
+
 #include <osg/ref_ptr>
 #include <osg/Switch>
 
@@ -45,6 +47,7 @@ class BVHMaterial;
 }
 
 class FGTerrain;
+struct FGTerrainSamples;
 
 // Define a structure containing global scenery parameters
 class FGScenery : public SGSubsystem
@@ -126,6 +129,39 @@ public:
                                       SGVec3d& nearestHit,
                                       const osg::Node* butNotFrom = 0);
 
+    /// Batched get_elevation_m(): the elevation below each of the points,
+    /// found in a single traversal of the scenery. As there, the points'
+    /// elevations are where the search starts. Elevations and interned
+    /// materials are returned in samples; the method returns the number of
+    /// points for which there is scenery.
+    size_t get_elevations_m(const std::vector<SGGeod>& points,
+                            FGTerrainSamples& samples,
+                            const osg::Node* butNotFrom = 0);
+
+    /// Elevation profile of count points (at least two) spaced evenly along
+    /// the geodesic from start to end, both included, searching down from
+    /// SG_MAX_ELEVATION_M. See get_elevations_m().
+    size_t get_elevation_profile_m(const SGGeod& start, const SGGeod& end,
+                                   unsigned int count,
+                                   FGTerrainSamples& samples,
+                                   const osg::Node* butNotFrom = 0);
+
+    /// Elevations of a lonCount by latCount grid of points spanning the
+    /// given corners, stored row by row starting in the south-west. See
+    /// get_elevations_m().
+    size_t get_elevation_grid_m(const SGGeod& southWest, const SGGeod& northEast,
+                                unsigned int lonCount, unsigned int latCount,
+                                FGTerrainSamples& samples,
+                                const osg::Node* butNotFrom = 0);
+
+    /// Batched get_cart_ground_intersection(): the nearest hits of the rays
+    /// from start in each of the directions dirs, with their materials.
+    /// Returns the number of rays which hit the terrain.
+    size_t get_cart_ground_intersections(const SGVec3d& start,
+                                         const std::vector<SGVec3d>& dirs,
+                                         FGTerrainSamples& samples,
+                                         const osg::Node* butNotFrom = 0);
+
     osg::Group *get_scene_graph () const { return scene_graph.get(); }
     osg::Group *get_terrain_branch () const { return terrain_branch.get(); }
     osg::Group *get_models_branch () const { return models_branch.get(); }
@@ -29,11 +29,14 @@
 # error This library requires C++
 #endif                                   
 
+#include <vector>
+
 #include <osg/ref_ptr>
 #include <osg/Switch>
 
 #include <simgear/compiler.h>
 #include <simgear/math/SGMath.hxx>
+#include <simgear/math/SGGeometry.hxx>
 #include <simgear/scene/model/particles.hxx>
 #include <simgear/structure/subsystem_mgr.hxx>
 
@@ -45,6 +48,55 @@ namespace simgear {
 class BVHMaterial;
 }
 
+/// Results of a batched terrain query, one entry per query point or ray,
+/// in contiguous arrays. Materials are interned: each distinct material is
+/// stored once in materials, and material holds indices into it.
+struct FGTerrainSamples
+{
+    std::vector<unsigned char> valid;   ///< zero where nothing was hit
+    std::vector<SGVec3d> hit;           ///< cartesian hit points
+    std::vector<double> elevation_m;    ///< elevation of the hit points
+    std::vector<int> material;          ///< index into materials, or -1
+    std::vector<const simgear::BVHMaterial*> materials;
+
+    /// Clears everything and sizes the arrays for n queries, none hit.
+    void reset(size_t n)
+    {
+        valid.assign(n, 0);
+        hit.assign(n, SGVec3d::zeros());
+        elevation_m.assign(n, 0.0);
+        material.assign(n, -1);
+        materials.clear();
+    }
+
+    size_t size() const { return valid.size(); }
+
+    const simgear::BVHMaterial* getMaterial(size_t i) const
+    { return (material[i] < 0) ? nullptr : materials[material[i]]; }
+
+    /// Records a hit for query i.
+    void setHit(size_t i, const SGVec3d& pos, const simgear::BVHMaterial* mat)
+    {
+        valid[i] = 1;
+        hit[i] = pos;
+        elevation_m[i] = SGGeod::fromCart(pos).getElevationM();
+        material[i] = internMaterial(mat);
+    }
+
+    int internMaterial(const simgear::BVHMaterial* mat)
+    {
+        if (!mat)
+            return -1;
+        // profiles cross few distinct materials, so a linear search wins
+        for (size_t m = 0; m < materials.size(); ++m) {
+            if (materials[m] == mat)
+                return static_cast<int>(m);
+        }
+        materials.push_back(mat);
+        return static_cast<int>(materials.size() - 1);
+    }
+};
+
 // Define a structure containing global scenery parameters
 class FGTerrain
 {
@@ -98,6 +150,14 @@ public:
     virtual bool get_cart_ground_intersection(const SGVec3d& start, const SGVec3d& dir,
                                               SGVec3d& nearestHit,
                                               const osg::Node* butNotFrom = 0) = 0;
+
+    /// Intersect a batch of line segments with the terrain, resetting
+    /// samples to hold the nearest hit (to the segment start) of each.
+    /// Implementations should share as much of the scene graph traversal
+    /// between the segments as they can.
+    virtual void get_cart_ground_intersections(const std::vector<SGLineSegmentd>& segments,
+                                               FGTerrainSamples& samples,
+                                               const osg::Node* butNotFrom = 0) = 0;
     
     /// Returns true if scenery is available for the given lat, lon position
     /// within a range of range_m.
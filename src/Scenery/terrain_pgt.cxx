@@ -222,6 +222,19 @@ bool FGPgtTerrain::get_cart_ground_intersection(const SGVec3d& pos, const SGVec3
     return true;
 }
 
+void FGPgtTerrain::get_cart_ground_intersections(const std::vector<SGLineSegmentd>& segments,
+                                                 FGTerrainSamples& samples,
+                                                 const osg::Node* butNotFrom)
+{
+    // same flat placeholder terrain as get_elevation_m()
+    samples.reset(segments.size());
+    for (size_t i = 0; i < segments.size(); ++i) {
+        SGGeod geod = SGGeod::fromCart(segments[i].getStart());
+        geod.setElevationM(100.0);
+        samples.setHit(i, SGVec3d::fromGeod(geod), &def_mat);
+    }
+}
+
 bool FGPgtTerrain::scenery_available(const SGGeod& position, double range_m)
 {
     if( schedule_scenery(position, range_m, 0.0) )
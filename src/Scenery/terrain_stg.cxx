@@ -219,6 +219,201 @@ private:
     bool _haveHit;
 };
 
+// Like FGSceneryIntersect, but for many line segments at once: the scene
+// graph is traversed once, and each node is only tested against the segments
+// which passed the bounding sphere test of its parent. That is what makes
+// long terrain profiles cheap, since most of their points share the same
+// tiles.
+class FGSceneryMultiIntersect : public osg::NodeVisitor {
+public:
+    FGSceneryMultiIntersect(const std::vector<SGLineSegmentd>& lineSegments,
+                            const osg::Node* skipNode) :
+        osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ACTIVE_CHILDREN),
+        _skipNode(skipNode)
+    {
+        _segments.reserve(lineSegments.size());
+        _active.reserve(4 * lineSegments.size());
+        for (unsigned i = 0; i < lineSegments.size(); ++i) {
+            _segments.push_back(Segment{lineSegments[i], 0, false});
+            _active.push_back(i);
+        }
+        _activeEnd = _active.size();
+    }
+
+    void getResults(FGTerrainSamples& samples) const
+    {
+        samples.reset(_segments.size());
+        for (unsigned i = 0; i < _segments.size(); ++i) {
+            if (_segments[i].haveHit)
+                samples.setHit(i, _segments[i].lineSegment.getEnd(), _segments[i].material);
+        }
+    }
+
+    virtual void apply(osg::Node& node)
+    {
+        if (&node == _skipNode)
+            return;
+        ActiveRange range(this, node.getBound());
+        if (range.empty())
+            return;
+
+        addBoundingVolume(node);
+    }
+
+    virtual void apply(osg::Group& group)
+    {
+        if (&group == _skipNode)
+            return;
+        ActiveRange range(this, group.getBound());
+        if (range.empty())
+            return;
+
+        traverse(group);
+        addBoundingVolume(group);
+    }
+
+    virtual void apply(osg::Transform& transform)
+    { handleTransform(transform); }
+    virtual void apply(osg::Camera& camera)
+    {
+        if (camera.getRenderOrder() != osg::Camera::NESTED_RENDER)
+            return;
+        handleTransform(camera);
+    }
+    virtual void apply(osg::CameraView& transform)
+    { handleTransform(transform); }
+    virtual void apply(osg::MatrixTransform& transform)
+    { handleTransform(transform); }
+    virtual void apply(osg::PositionAttitudeTransform& transform)
+    { handleTransform(transform); }
+
+private:
+    struct Segment {
+        SGLineSegmentd lineSegment;
+        const simgear::BVHMaterial* material;
+        bool haveHit;
+    };
+
+    // The segments passing a bounding sphere test are appended to _active,
+    // and are the active ones until the range goes out of scope, so the
+    // nested ranges form a stack and nothing is allocated per node.
+    class ActiveRange {
+    public:
+        ActiveRange(FGSceneryMultiIntersect* visitor, const osg::BoundingSphere& bound) :
+            _visitor(visitor),
+            _savedBegin(visitor->_activeBegin),
+            _savedEnd(visitor->_activeEnd)
+        {
+            std::vector<unsigned>& active = _visitor->_active;
+            const size_t begin = active.size();
+            if (bound.valid()) {
+                SGSphered sphere(toVec3d(toSG(bound._center)), bound._radius);
+                for (size_t i = _savedBegin; i < _savedEnd; ++i) {
+                    const unsigned s = active[i];
+                    if (intersects(_visitor->_segments[s].lineSegment, sphere))
+                        active.push_back(s);
+                }
+            }
+            _visitor->_activeBegin = begin;
+            _visitor->_activeEnd = active.size();
+        }
+
+        ~ActiveRange()
+        {
+            _visitor->_active.resize(_visitor->_activeBegin);
+            _visitor->_activeBegin = _savedBegin;
+            _visitor->_activeEnd = _savedEnd;
+        }
+
+        bool empty() const
+        { return _visitor->_activeBegin == _visitor->_activeEnd; }
+
+    private:
+        FGSceneryMultiIntersect* _visitor;
+        size_t _savedBegin, _savedEnd;
+    };
+
+    void handleTransform(osg::Transform& transform)
+    {
+        if (&transform == _skipNode)
+            return;
+        // Hmm, may be this needs to be refined somehow ...
+        if (transform.getReferenceFrame() != osg::Transform::RELATIVE_RF)
+            return;
+
+        ActiveRange range(this, transform.getBound());
+        if (range.empty())
+            return;
+
+        osg::Matrix inverseMatrix;
+        if (!transform.computeWorldToLocalMatrix(inverseMatrix, this))
+            return;
+        osg::Matrix matrix;
+        if (!transform.computeLocalToWorldMatrix(matrix, this))
+            return;
+
+        const SGMatrixd toLocal(inverseMatrix.ptr());
+        const SGMatrixd toWorld(matrix.ptr());
+
+        // intersect in the local frame; segments which hit nothing in here
+        // get their previous state back, as FGSceneryIntersect does
+        std::vector<Segment> saved;
+        saved.reserve(_activeEnd - _activeBegin);
+        for (size_t i = _activeBegin; i < _activeEnd; ++i) {
+            Segment& seg = _segments[_active[i]];
+            saved.push_back(seg);
+            seg.haveHit = false;
+            seg.lineSegment = seg.lineSegment.transform(toLocal);
+        }
+
+        addBoundingVolume(transform);
+        traverse(transform);
+
+        for (size_t i = _activeBegin; i < _activeEnd; ++i) {
+            Segment& seg = _segments[_active[i]];
+            if (seg.haveHit) {
+                seg.lineSegment = seg.lineSegment.transform(toWorld);
+            } else {
+                seg = saved[i - _activeBegin];
+            }
+        }
+    }
+
+    simgear::BVHNode* getNodeBoundingVolume(osg::Node& node)
+    {
+        SGSceneUserData* userData = SGSceneUserData::getSceneUserData(&node);
+        if (!userData)
+            return 0;
+        return userData->getBVHNode();
+    }
+    void addBoundingVolume(osg::Node& node)
+    {
+        simgear::BVHNode* bvNode = getNodeBoundingVolume(node);
+        if (!bvNode)
+            return;
+
+        // Find ground intersections on the bvh nodes
+        for (size_t i = _activeBegin; i < _activeEnd; ++i) {
+            Segment& seg = _segments[_active[i]];
+            simgear::BVHLineSegmentVisitor lineSegmentVisitor(seg.lineSegment,
+                                                              0/*startTime*/);
+            bvNode->accept(lineSegmentVisitor);
+            if (!lineSegmentVisitor.empty()) {
+                seg.lineSegment = lineSegmentVisitor.getLineSegment();
+                seg.material = lineSegmentVisitor.getMaterial();
+                seg.haveHit = true;
+            }
+        }
+    }
+
+    const osg::Node* _skipNode;
+
+    std::vector<Segment> _segments;
+    std::vector<unsigned> _active;
+    size_t _activeBegin = 0;
+    size_t _activeEnd = 0;
+};
+
 ////////////////////////////////////////////////////////////////////////////
 
 // Terrain Management system
@@ -361,6 +556,17 @@ FGStgTerrain::get_cart_ground_intersection(const SGVec3d& pos, const SGVec3d& di
   return true;
 }
 
+void
+FGStgTerrain::get_cart_ground_intersections(const std::vector<SGLineSegmentd>& segments,
+                                            FGTerrainSamples& samples,
+                                            const osg::Node* butNotFrom)
+{
+  FGSceneryMultiIntersect intersectVisitor(segments, butNotFrom);
+  intersectVisitor.setTraversalMask(SG_NODEMASK_TERRAIN_BIT);
+  terrain_branch->accept(intersectVisitor);
+  intersectVisitor.getResults(samples);
+}
+
 bool FGStgTerrain::scenery_available(const SGGeod& position, double range_m)
 {
   if( schedule_scenery(position, range_m, 0.0) )
@@ -99,6 +99,10 @@ public:
     bool get_cart_ground_intersection(const SGVec3d& start, const SGVec3d& dir,
                                       SGVec3d& nearestHit,
                                       const osg::Node* butNotFrom = 0);
+
+    void get_cart_ground_intersections(const std::vector<SGLineSegmentd>& segments,
+                                       FGTerrainSamples& samples,
+                                       const osg::Node* butNotFrom = 0);
     
     /// Returns true if scenery is available for the given lat, lon position
     /// within a range of range_m.
@@ -24,6 +24,8 @@
 #  include <config.h>
 #endif
 
+#include <algorithm>
+
 #include <simgear/bucket/newbucket.hxx>
 #include <simgear/debug/logstream.hxx>
 #include <simgear/misc/sg_path.hxx>
@@ -32,7 +34,8 @@
 #include "tilecache.hxx"
 
 TileCache::TileCache( void ) :
-    max_cache_size(100), current_time(0.0)
+    max_cache_size(100), max_memory_bytes(0), memory_bytes(0),
+    current_time(0.0)
 {
     tile_cache.clear();
 }
@@ -54,7 +57,7 @@ void TileCache::entry_free( long tile_index ) {
     SG_LOG( SG_TERRAIN, SG_DEBUG, "FREEING CACHE ENTRY = " << tile_index );
     TileEntry *tile = tile_cache[tile_index];
     tile->removeFromSceneGraph();
-    tile_cache.erase( tile_index );
+    clear_entry( tile_index );
     delete tile;
 }
 
@@ -83,64 +86,140 @@ bool TileCache::exists( const SGBucket& b ) const {
 }
 
 
+bool TileCache::drop_before( const TileEntry *a, const TileEntry *b )
+{
+    if ( a->is_current_view() != b->is_current_view() )
+        return !a->is_current_view();
+    if ( a->get_time_expired() != b->get_time_expired() )
+        return a->get_time_expired() < b->get_time_expired();
+    return a->get_priority() < b->get_priority();
+}
+
+void TileCache::heap_swap( size_t i, size_t j )
+{
+    std::swap( drop_heap[i], drop_heap[j] );
+    drop_heap[i]->_drop_heap_index = i;
+    drop_heap[j]->_drop_heap_index = j;
+}
+
+void TileCache::heap_sift_up( size_t i )
+{
+    while ( i > 0 ) {
+        size_t parent = (i - 1) / 2;
+        if ( !drop_before( drop_heap[i], drop_heap[parent] ) )
+            break;
+        heap_swap( i, parent );
+        i = parent;
+    }
+}
+
+void TileCache::heap_sift_down( size_t i )
+{
+    const size_t n = drop_heap.size();
+    for (;;) {
+        size_t best = i;
+        size_t left = 2 * i + 1, right = left + 1;
+        if ( left < n && drop_before( drop_heap[left], drop_heap[best] ) )
+            best = left;
+        if ( right < n && drop_before( drop_heap[right], drop_heap[best] ) )
+            best = right;
+        if ( best == i )
+            break;
+        heap_swap( i, best );
+        i = best;
+    }
+}
+
+// restore the heap order after the tile's expiry, priority or view flag changed
+void TileCache::heap_update( TileEntry *e )
+{
+    heap_sift_up( e->_drop_heap_index );
+    heap_sift_down( e->_drop_heap_index );
+}
+
+void TileCache::heap_remove( TileEntry *e )
+{
+    const size_t i = e->_drop_heap_index;
+    if ( i >= drop_heap.size() || drop_heap[i] != e )
+        return;
+
+    heap_swap( i, drop_heap.size() - 1 );
+    drop_heap.pop_back();
+    if ( i < drop_heap.size() )
+        heap_update( drop_heap[i] );
+}
+
+
 // Return the index of a tile to be dropped from the cache, return -1 if
 // nothing available to be removed.
 long TileCache::get_drop_tile() {
-    long min_index = -1;
-    double min_time = DBL_MAX;
-    float priority = FLT_MAX;
+    /* Immediately drop "empty" tiles which are no longer used/requested, and were last requested > 1 second ago...
+     * Allow a 1 second timeout since an empty tiles may just be loaded...
+     */
+    long index = get_unused_empty_tile();
+    if ( index > -1 ) {
+        SG_LOG( SG_TERRAIN, SG_DEBUG, "    dropping an unused and empty tile");
+        return index;
+    }
 
-    tile_map_iterator current = tile_cache.begin();
-    tile_map_iterator end = tile_cache.end();
+    // drop oldest tile with lowest priority
+    index = get_first_expired_tile();
+    SG_LOG( SG_TERRAIN, SG_DEBUG, "    index = " << index );
+    return index;
+}
 
-    for ( ; current != end; ++current ) {
-        long index = current->first;
-        TileEntry *e = current->second;
-        if (( !e->is_current_view() )&&
-            ( e->is_expired(current_time) ))
+long TileCache::get_first_expired_tile() const
+{
+  // the heap top expires first, unless it is in the current view
+  if ( drop_heap.empty() )
+    return -1;
+
+  const TileEntry *e = drop_heap.front();
+  if (!e->is_current_view() && e->is_expired(current_time))
+  {
+    return e->get_tile_bucket().gen_index();
+  }
+
+  return -1; // no expired tile found
+}
+
+long TileCache::get_unused_empty_tile() const
+{
+    for ( const TileEntry *e : pending ) {
+        if ( !e->is_current_view() && e->is_expired(current_time - 1.0) &&
+             !e->is_loaded() )
         {
-            if (e->is_expired(current_time - 1.0)&&
-                !e->is_loaded())
-            {
-                /* Immediately drop "empty" tiles which are no longer used/requested, and were last requested > 1 second ago...
-                 * Allow a 1 second timeout since an empty tiles may just be loaded...
-                 */
-                SG_LOG( SG_TERRAIN, SG_DEBUG, "    dropping an unused and empty tile");
-                min_index = index;
-                break;
-            }
-            if (( e->get_time_expired() < min_time )||
-                (( e->get_time_expired() == min_time)&&
-                 ( priority > e->get_priority())))
-            {
-                // drop oldest tile with lowest priority
-                min_time = e->get_time_expired();
-                priority = e->get_priority();
-                min_index = index;
-            }
+            return e->get_tile_bucket().gen_index();
         }
     }
 
-    SG_LOG( SG_TERRAIN, SG_DEBUG, "    index = " << min_index );
-    SG_LOG( SG_TERRAIN, SG_DEBUG, "    min_time = " << min_time );
-
-    return min_index;
+    return -1;
 }
 
-long TileCache::get_first_expired_tile() const
+bool TileCache::is_over_budget( bool far_over ) const
 {
-  const_tile_map_iterator current = tile_cache.begin();
-  const_tile_map_iterator end = tile_cache.end();
-
-  for ( ; current != end; ++current ) {
-    TileEntry *e = current->second;
-    if (!e->is_current_view() && e->is_expired(current_time))
-    {
-      return current->first;
+    if ( max_memory_bytes > 0 ) {
+        size_t limit = max_memory_bytes;
+        if ( far_over )
+            limit += max_memory_bytes / 10;
+        return memory_bytes > limit;
     }
-  }
 
-  return -1; // no expired tile found
+    int limit = max_cache_size;
+    if ( far_over )
+        limit += 10;
+    return (int)tile_cache.size() > limit;
+}
+
+void TileCache::collect_loaded( std::vector<TileEntry *>& newly_loaded )
+{
+    auto loaded = std::stable_partition( pending.begin(), pending.end(),
+                                         [](const TileEntry *e) { return !e->is_loaded(); } );
+    for ( auto it = loaded; it != pending.end(); ++it ) {
+        memory_bytes += (*it)->estimate_memory();
+        newly_loaded.push_back( *it );
+    }
+    pending.erase( loaded, pending.end() );
 }
 
 
@@ -157,6 +236,7 @@ void TileCache::clear_current_view()
             // update expiry time for tiles belonging to most recent position
             e->update_time_expired( current_time );
             e->set_current_view( false );
+            heap_update( e );
         }
     }
 }
@@ -164,7 +244,19 @@ void TileCache::clear_current_view()
 // Clear a cache entry, note that the cache only holds pointers
 // and this does not free the object which is pointed to.
 void TileCache::clear_entry( long tile_index ) {
-    tile_cache.erase( tile_index );
+    tile_map_iterator it = tile_cache.find( tile_index );
+    if ( it == tile_cache.end() )
+        return;
+
+    TileEntry *e = it->second;
+    heap_remove( e );
+    auto p = std::find( pending.begin(), pending.end(), e );
+    if ( p != pending.end() ) {
+        pending.erase( p );
+    } else {
+        memory_bytes -= std::min( memory_bytes, e->get_memory_bytes() );
+    }
+    tile_cache.erase( it );
 }
 
 
@@ -197,6 +289,11 @@ bool TileCache::insert_tile( TileEntry *e ) {
     tile_cache[tile_index] = e;
     e->update_time_expired(current_time);
 
+    e->_drop_heap_index = drop_heap.size();
+    drop_heap.push_back( e );
+    heap_sift_up( e->_drop_heap_index );
+    pending.push_back( e );
+
     return true;
 }
 
@@ -222,4 +319,6 @@ void TileCache::request_tile(TileEntry* t,float priority,bool current_view,doubl
     {
         t->update_time_expired( current_time+request_time );
     }
+
+    heap_update( t );
 }
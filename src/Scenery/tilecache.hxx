@@ -25,6 +25,7 @@
 #define _TILECACHE_HXX
 
 #include <map>
+#include <vector>
 
 #include <simgear/bucket/newbucket.hxx>
 #include "tileentry.hxx"
@@ -38,12 +39,29 @@ public:
     typedef tile_map::iterator tile_map_iterator;
     typedef tile_map::const_iterator const_tile_map_iterator;
 private:
+    // test class is a friend so it can check the drop heap directly
+    friend class TileCacheTests;
+
     // cache storage space
     tile_map tile_cache;
 
     // maximum cache size
     int max_cache_size;
 
+    // maximum memory used by loaded tiles, 0 to limit the tile count instead
+    size_t max_memory_bytes;
+
+    // memory used by the tiles which have finished loading
+    size_t memory_bytes;
+
+    // Binary heap of all tiles, the best one to drop first: tiles not in
+    // the current view before the others, then by expiry time and
+    // priority. TileEntry::_drop_heap_index is kept in sync.
+    std::vector<TileEntry *> drop_heap;
+
+    // tiles which have not finished loading yet
+    std::vector<TileEntry *> pending;
+
     // pointers to allow an external linear traversal of cache entries
     tile_map_iterator current;
 
@@ -52,6 +70,13 @@ private:
     // Free a tile cache entry
     void entry_free( long cache_index );
 
+    static bool drop_before( const TileEntry *a, const TileEntry *b );
+    void heap_swap( size_t i, size_t j );
+    void heap_sift_up( size_t i );
+    void heap_sift_down( size_t i );
+    void heap_update( TileEntry *e );
+    void heap_remove( TileEntry *e );
+
 public:
     tile_map_iterator begin() { return tile_cache.begin(); }
     tile_map_iterator end() { return tile_cache.end(); }
@@ -75,6 +100,10 @@ public:
     long get_drop_tile();
   
     long get_first_expired_tile() const;
+
+    // Return the index of a tile which never finished loading and has not
+    // been requested for over a second, -1 if there is none.
+    long get_unused_empty_tile() const;
   
     // Clear all flags indicating tiles belonging to the current view
     void clear_current_view();
@@ -116,6 +145,21 @@ public:
     inline int get_max_cache_size() const { return max_cache_size; }
     inline void set_max_cache_size( int m ) { max_cache_size = m; }
 
+    inline size_t get_max_memory() const { return max_memory_bytes; }
+    inline void set_max_memory( size_t bytes ) { max_memory_bytes = bytes; }
+    inline size_t get_memory_usage() const { return memory_bytes; }
+
+    // True when more tiles or memory are in use than the cache allows, with
+    // some slack when far_over is set, so dropping can wait for loads.
+    bool is_over_budget( bool far_over ) const;
+
+    // Tiles which have not finished loading, to be passed to the pager.
+    inline const std::vector<TileEntry *>& get_pending() const { return pending; }
+
+    // Move the tiles which finished loading since the last call out of the
+    // pending list and into newly_loaded, and account for their memory.
+    void collect_loaded( std::vector<TileEntry *>& newly_loaded );
+
     /**
      * Create a new tile and enqueue it for loading.
      * @param b
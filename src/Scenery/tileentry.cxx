@@ -24,11 +24,15 @@
 
 #include <simgear/compiler.h>
 
+#include <set>
 #include <string>
 #include <sstream>
 #include <istream>
 
+#include <osg/Geode>
+#include <osg/Geometry>
 #include <osg/LOD>
+#include <osg/NodeVisitor>
 
 #include <simgear/bucket/newbucket.hxx>
 #include <simgear/debug/logstream.hxx>
@@ -37,6 +41,58 @@
 
 using std::string;
 
+namespace {
+
+// Adds up the vertex attribute and index arrays below a node, counting
+// arrays shared between geometries once.
+class MemoryEstimateVisitor : public osg::NodeVisitor
+{
+public:
+    MemoryEstimateVisitor() :
+        osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN),
+        bytes(0)
+    {
+    }
+
+    void apply(osg::Geode& geode) override
+    {
+        for (unsigned i = 0; i < geode.getNumDrawables(); ++i) {
+            osg::Geometry* geom = geode.getDrawable(i)->asGeometry();
+            if (geom)
+                addGeometry(*geom);
+        }
+        traverse(geode);
+    }
+
+    size_t bytes;
+
+private:
+    void add(const osg::BufferData* data)
+    {
+        if (data && _seen.insert(data).second)
+            bytes += data->getTotalDataSize();
+    }
+
+    void addGeometry(const osg::Geometry& geom)
+    {
+        add(geom.getVertexArray());
+        add(geom.getNormalArray());
+        add(geom.getColorArray());
+        add(geom.getSecondaryColorArray());
+        add(geom.getFogCoordArray());
+        for (unsigned i = 0; i < geom.getNumTexCoordArrays(); ++i)
+            add(geom.getTexCoordArray(i));
+        for (unsigned i = 0; i < geom.getNumVertexAttribArrays(); ++i)
+            add(geom.getVertexAttribArray(i));
+        for (unsigned i = 0; i < geom.getNumPrimitiveSets(); ++i)
+            add(geom.getPrimitiveSet(i)->getDrawElements());
+    }
+
+    std::set<const osg::BufferData*> _seen;
+};
+
+} // of anonymous namespace
+
 // Constructor
 TileEntry::TileEntry ( const SGBucket& b )
     : tile_bucket( b ),
@@ -44,7 +100,9 @@ TileEntry::TileEntry ( const SGBucket& b )
       _node( new osg::LOD ),
       _priority(-FLT_MAX),
       _current_view(false),
-      _time_expired(-1.0)
+      _time_expired(-1.0),
+      _memory_bytes(0),
+      _drop_heap_index(0)
 {
     _create_orthophoto();
     
@@ -62,7 +120,9 @@ TileEntry::TileEntry( const TileEntry& t )
   _node( new osg::LOD ),
   _priority(t._priority),
   _current_view(t._current_view),
-  _time_expired(t._time_expired)
+  _time_expired(t._time_expired),
+  _memory_bytes(0),
+  _drop_heap_index(0)
 {
     _create_orthophoto();
 
@@ -99,6 +159,14 @@ void TileEntry::prep_ssg_node(float vis) {
     _node->setRange( 0, 0, vis + bounding_radius );
 }
 
+size_t TileEntry::estimate_memory()
+{
+    MemoryEstimateVisitor visitor;
+    _node->accept(visitor);
+    _memory_bytes = visitor.bytes;
+    return _memory_bytes;
+}
+
 void
 TileEntry::addToSceneGraph(osg::Group *terrain_branch)
 {
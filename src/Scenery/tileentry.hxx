@@ -77,6 +77,13 @@ private:
     bool _current_view;
     /** Time when tile expires. */
     double _time_expired;
+    /** Estimated memory use once loaded, see estimate_memory(). */
+    size_t _memory_bytes;
+    /** Position in the tile cache's drop heap. */
+    size_t _drop_heap_index;
+
+    friend class TileCache;
+    friend class TileCacheTests;
 
     void _create_orthophoto();
 
@@ -142,6 +149,14 @@ public:
      */
     inline bool is_expired(double current_time) const { return (_current_view) ? false : (current_time > _time_expired); }
 
+    /**
+     * Walk the loaded scene graph and record the size of its vertex and
+     * index data. Textures are left out since they are mostly shared
+     * between tiles through the material library.
+     */
+    size_t estimate_memory();
+    inline size_t get_memory_bytes() const { return _memory_bytes; }
+
     // Get the ref_ptr to the DatabaseRequest object, in order to pass
     // this to the pager.
     osg::ref_ptr<osg::Referenced>& getDatabaseRequest()
@@ -26,13 +26,17 @@
 #endif
 
 #include <algorithm>
+#include <cfloat>
 #include <functional>
+#include <memory>
+#include <set>
 
 #include <osgViewer/Viewer>
 #include <osgDB/Registry>
 
 #include <simgear/constants.h>
 #include <simgear/debug/logstream.hxx>
+#include <simgear/math/SGGeodesy.hxx>
 #include <simgear/structure/exception.hxx>
 #include <simgear/scene/model/modellib.hxx>
 #include <simgear/scene/util/SGReaderWriterOptions.hxx>
@@ -40,12 +44,15 @@
 #include <simgear/misc/strutils.hxx>
 #include <simgear/scene/material/matlib.hxx>
 
+#include <Autopilot/route_mgr.hxx>
 #include <Main/globals.hxx>
 #include <Main/fg_props.hxx>
+#include <Main/FrameProfiler.hxx>
 #include <Viewer/renderer.hxx>
 #include <Viewer/splash.hxx>
 #include <Scripting/NasalSys.hxx>
 #include <Scripting/NasalModelData.hxx>
+#include <Navaids/FlightPlan.hxx>
 
 #include "scenery.hxx"
 #include "SceneryPager.hxx"
@@ -53,6 +60,52 @@
 
 using flightgear::SceneryPager;
 
+namespace {
+
+/**
+ * Times tile loads, which happen on the pager threads, for the frame
+ * profiler. All reads are passed on to whatever the registry would use.
+ */
+class TileLoadTimer : public osgDB::ReadFileCallback
+{
+public:
+    osgDB::ReaderWriter::ReadResult
+    readNode(const std::string& fileName, const osgDB::Options* options) override
+    {
+        std::unique_ptr<flightgear::FrameProfiler::Zone> zone;
+        if (flightgear::FrameProfiler::isActive() && simgear::strutils::ends_with(fileName, ".stg"))
+            zone.reset(new flightgear::FrameProfiler::Zone("tile-load", fileName));
+
+        osgDB::Registry* registry = osgDB::Registry::instance();
+        if (registry->getReadFileCallback())
+            return registry->getReadFileCallback()->readNode(fileName, options);
+        return registry->readNodeImplementation(fileName, options);
+    }
+};
+
+void setDefault(SGPropertyNode* node, double value)
+{
+    if (node->getType() == simgear::props::NONE)
+        node->setDoubleValue(value);
+}
+
+// Appends points every spacingM along the great circle from start to end,
+// ending at end or after maxDistanceM. Returns the distance covered.
+double addTrackSegment(const SGGeod& start, const SGGeod& end, double maxDistanceM,
+                       double spacingM, std::vector<SGGeod>& track)
+{
+    double courseDeg, reverseCourseDeg, lengthM;
+    SGGeodesy::inverse(start, end, courseDeg, reverseCourseDeg, lengthM);
+    lengthM = std::min(lengthM, maxDistanceM);
+
+    for (double along = spacingM; along < lengthM; along += spacingM)
+        track.push_back(SGGeodesy::direct(start, courseDeg, along));
+    track.push_back(SGGeodesy::direct(start, courseDeg, lengthM));
+    return lengthM;
+}
+
+} // of anonymous namespace
+
 class FGTileMgr::TileManagerListener : public SGPropertyChangeListener
 {
 public:
@@ -145,6 +198,24 @@ FGTileMgr::FGTileMgr():
     _disableNasalHooks(fgGetNode("/sim/temp/disable-scenery-nasal", true)),
     _scenery_loaded(fgGetNode("/sim/sceneryloaded", true)),
     _scenery_override(fgGetNode("/sim/sceneryloaded-override", true)),
+    _maxMemoryMB(fgGetNode("/sim/tile-cache/max-memory-mb", true)),
+    _predictEnabled(fgGetNode("/sim/tile-cache/prediction/enabled", true)),
+    _predictLookahead(fgGetNode("/sim/tile-cache/prediction/lookahead-sec", true)),
+    _predictMinSpeed(fgGetNode("/sim/tile-cache/prediction/min-speed-kt", true)),
+    _predictInterval(fgGetNode("/sim/tile-cache/prediction/interval-sec", true)),
+    _northSpeed(fgGetNode("/velocities/speed-north-fps", true)),
+    _eastSpeed(fgGetNode("/velocities/speed-east-fps", true)),
+    _statHits(fgGetNode("/sim/tile-cache/stats/hits", true)),
+    _statMisses(fgGetNode("/sim/tile-cache/stats/misses", true)),
+    _statLateLoads(fgGetNode("/sim/tile-cache/stats/late-loads", true)),
+    _statTiles(fgGetNode("/sim/tile-cache/stats/tiles", true)),
+    _statPending(fgGetNode("/sim/tile-cache/stats/pending", true)),
+    _statMemoryMB(fgGetNode("/sim/tile-cache/stats/memory-mb", true)),
+    _hits(0),
+    _misses(0),
+    _lateLoads(0),
+    _lastPrediction(-DBL_MAX),
+    _prepared_visibility(-1.0),
     _pager(FGScenery::getPagerSingleton()),
     _enableCache(true)
 {
@@ -182,6 +253,7 @@ void FGTileMgr::reinit()
 
     // drops the previous options reference
     _options = new simgear::SGReaderWriterOptions;
+    _options->setReadFileCallback(new TileLoadTimer);
     _listener.reset(new TileManagerListener(this));
 
     materialLibChanged();
@@ -202,6 +274,13 @@ void FGTileMgr::reinit()
     if (!_disableNasalHooks->getBoolValue())
       _options->setModelData(new FGNasalModelDataProxy);
 
+    setDefault(_maxMemoryMB, 2048.0);
+    if (_predictEnabled->getType() == simgear::props::NONE)
+        _predictEnabled->setBoolValue(true);
+    setDefault(_predictLookahead, 60.0);
+    setDefault(_predictMinSpeed, 150.0);
+    setDefault(_predictInterval, 5.0);
+
     double detailed = fgGetDouble("/sim/rendering/static-lod/detailed", SG_OBJECT_RANGE_DETAILED);
     double rough    = fgGetDouble("/sim/rendering/static-lod/rough-delta", SG_OBJECT_RANGE_ROUGH) + detailed;
     double bare     = fgGetDouble("/sim/rendering/static-lod/bare", SG_OBJECT_RANGE_BARE) + rough;
@@ -260,6 +339,8 @@ void FGTileMgr::reinit()
     previous_bucket.make_bad();
     current_bucket.make_bad();
     scheduled_visibility = 100.0;
+    _prepared_visibility = -1.0;
+    _lastPrediction = -DBL_MAX;
 
     // force an update now
     update(0.0);
@@ -344,6 +425,14 @@ void FGTileMgr::schedule_needed(const SGBucket& curr_bucket, double vis)
     // cout << "max cache size = " << tile_cache.get_max_cache_size()
     //      << " current cache size = " << tile_cache.get_size() << endl;
 
+    // remember the previous view set, only tiles entering range count
+    // towards the hit statistics below
+    std::set<long> previousView;
+    for (auto it = tile_cache.begin(); it != tile_cache.end(); ++it) {
+        if (it->second->is_current_view())
+            previousView.insert(it->first);
+    }
+
     // clear flags of all tiles belonging to the previous view set
     tile_cache.clear_current_view();
 
@@ -368,6 +457,19 @@ void FGTileMgr::schedule_needed(const SGBucket& curr_bucket, double vis)
                 continue;
             }
 
+            // count how well caching and prediction kept up with the
+            // tiles newly entering range
+            const long index = b.gen_index();
+            if (previousView.find(index) == previousView.end()) {
+                TileEntry* t = tile_cache.get_tile( index );
+                if (!t)
+                    ++_misses;
+                else if (t->is_loaded())
+                    ++_hits;
+                else
+                    ++_lateLoads;
+            }
+
             float priority = (-1.0) * (x*x+y*y);
             sched_tile( b, priority, true, 0.0 );
 
@@ -387,52 +489,70 @@ void FGTileMgr::update_queues(bool& isDownloadingScenery)
     osg::FrameStamp* framestamp = globals->get_renderer()->getFrameStamp();
     double current_time = framestamp->getReferenceTime();
     double vis = _visibilityMeters->getDoubleValue();
-    TileEntry *e;
     int loading=0;
-    int sz=0;
 
     tile_cache.set_current_time( current_time );
-    tile_cache.reset_traversal();
 
-    while ( ! tile_cache.at_end() )
-    {
-        e = tile_cache.get_current();
-        if ( e )
-        {
-            // Prepare the ssg nodes corresponding to each tile.
-            // Set the ssg transform and update it's range selector
-            // based on current visibilty
-            e->prep_ssg_node(vis);
-
-            if (!e->is_loaded()) {
-                bool nonExpiredOrCurrent = !e->is_expired(current_time) || e->is_current_view();
-                bool downloading = isTileDirSyncing(e->tileFileName);
-                isDownloadingScenery |= downloading;
-                if ( !downloading && nonExpiredOrCurrent) {
-                    // schedule tile for loading with osg pager
-                    _pager->queueRequest(e->tileFileName,
-                                         e->getNode(),
-                                         e->get_priority(),
-                                         framestamp,
-                                         e->getDatabaseRequest(),
-                                         _options.get());
-                    loading++;
-                }
-            } // of tile not loaded case
-        } else {
-            SG_LOG(SG_TERRAIN, SG_ALERT, "Warning: empty tile in cache!");
+    // Prepare the ssg nodes corresponding to each tile. The range
+    // selectors of loaded tiles only change with the visibility.
+    if (vis != _prepared_visibility) {
+        for (auto it = tile_cache.begin(); it != tile_cache.end(); ++it) {
+            it->second->prep_ssg_node(vis);
         }
-        tile_cache.next();
-        sz++;
+        _prepared_visibility = vis;
+    }
+
+    _newlyLoaded.clear();
+    tile_cache.collect_loaded(_newlyLoaded);
+    for (TileEntry* e : _newlyLoaded) {
+        e->prep_ssg_node(vis);
+    }
+
+    for (TileEntry* e : tile_cache.get_pending()) {
+        bool nonExpiredOrCurrent = !e->is_expired(current_time) || e->is_current_view();
+        bool downloading = isTileDirSyncing(e->tileFileName);
+        isDownloadingScenery |= downloading;
+        if ( !downloading && nonExpiredOrCurrent) {
+            // schedule tile for loading with osg pager
+            _pager->queueRequest(e->tileFileName,
+                                 e->getNode(),
+                                 e->get_priority(),
+                                 framestamp,
+                                 e->getDatabaseRequest(),
+                                 _options.get());
+            loading++;
+        }
+    }
+
+    auto dropTile = [this](long drop_index) {
+        // schedule tile for deletion with osg pager
+        TileEntry* old = tile_cache.get_tile(drop_index);
+        SG_LOG(SG_TERRAIN, SG_DEBUG, "Dropping:" << old->get_tile_bucket());
+
+        tile_cache.clear_entry(drop_index);
+
+        osg::ref_ptr<osg::Object> subgraph = old->getNode();
+        old->removeFromSceneGraph();
+        delete old;
+        // zeros out subgraph ref_ptr, so subgraph is owned by
+        // the pager and will be deleted in the pager thread.
+        _pager->queueDeleteRequest(subgraph);
+    };
+
+    // tiles which never loaded and are no longer wanted cost nothing to drop
+    for (long drop_index = tile_cache.get_unused_empty_tile(); drop_index > -1;
+         drop_index = tile_cache.get_unused_empty_tile()) {
+        dropTile(drop_index);
     }
 
-    int drop_count = sz - tile_cache.get_max_cache_size();
     bool dropTiles = false;
     if (_enableCache) {
-      dropTiles = ( drop_count > 0 ) && ((loading==0)||(drop_count > 10));
+      const double maxMemoryMB = std::max(0.0, _maxMemoryMB->getDoubleValue());
+      tile_cache.set_max_memory(static_cast<size_t>(maxMemoryMB * 1024 * 1024));
+      dropTiles = tile_cache.is_over_budget(false) &&
+                  ((loading==0)||tile_cache.is_over_budget(true));
     } else {
-      dropTiles = true;
-      drop_count = sz; // no limit on tiles to drop
+      dropTiles = true; // no limit on tiles to drop
     }
 
     if (dropTiles)
@@ -441,28 +561,24 @@ void FGTileMgr::update_queues(bool& isDownloadingScenery)
                                          tile_cache.get_first_expired_tile();
         while ( drop_index > -1 )
         {
-            // schedule tile for deletion with osg pager
-            TileEntry* old = tile_cache.get_tile(drop_index);
-            SG_LOG(SG_TERRAIN, SG_DEBUG, "Dropping:" << old->get_tile_bucket());
-
-            tile_cache.clear_entry(drop_index);
-
-            osg::ref_ptr<osg::Object> subgraph = old->getNode();
-            old->removeFromSceneGraph();
-            delete old;
-            // zeros out subgraph ref_ptr, so subgraph is owned by
-            // the pager and will be deleted in the pager thread.
-            _pager->queueDeleteRequest(subgraph);
+            dropTile(drop_index);
 
             if (!_enableCache)
                 drop_index = tile_cache.get_first_expired_tile();
-            // limit tiles dropped to drop_count
-            else if (--drop_count > 0)
+            // drop until the cache is within its budget again
+            else if (tile_cache.is_over_budget(false))
                 drop_index = tile_cache.get_drop_tile();
             else
                drop_index = -1;
         }
     } // of dropping tiles loop
+
+    _statHits->setLongValue(_hits);
+    _statMisses->setLongValue(_misses);
+    _statLateLoads->setLongValue(_lateLoads);
+    _statTiles->setIntValue(tile_cache.get_size());
+    _statPending->setIntValue(tile_cache.get_pending().size());
+    _statMemoryMB->setDoubleValue(tile_cache.get_memory_usage() / (1024.0 * 1024.0));
 }
 
 // given the current lon/lat (in degrees), fill in the array of local
@@ -541,6 +657,9 @@ void FGTileMgr::schedule_tiles_at(const SGGeod& location, double range_m)
             schedule_needed(current_bucket, range_m);
         }
 
+        osg::FrameStamp* framestamp = globals->get_renderer()->getFrameStamp();
+        schedule_predicted(range_m, framestamp->getReferenceTime());
+
         // save bucket
         previous_bucket = current_bucket;
     } else if ( state == Start || state == Inited ) {
@@ -552,6 +671,116 @@ void FGTileMgr::schedule_tiles_at(const SGGeod& location, double range_m)
     last_state = state;
 }
 
+void FGTileMgr::schedule_predicted(double range_m, double current_time)
+{
+    if (!_predictEnabled->getBoolValue() ||
+        (current_time - _lastPrediction < _predictInterval->getDoubleValue()))
+        return;
+    _lastPrediction = current_time;
+
+    const double vn = _northSpeed->getDoubleValue();
+    const double ve = _eastSpeed->getDoubleValue();
+    const double speedMS = sqrt(vn*vn + ve*ve) * SG_FEET_TO_METER;
+    if (speedMS * SG_METER_TO_NM * 3600.0 < _predictMinSpeed->getDoubleValue())
+        return;
+
+    const SGGeod aircraftPos = globals->get_aircraft_position();
+    if (!aircraftPos.isValid())
+        return;
+
+    std::vector<SGGeod> track;
+    predict_track(aircraftPos, speedMS * _predictLookahead->getDoubleValue(), track);
+
+    // the same range as schedule_needed() uses around the viewer
+    double maxTileRange = _lodDetailed->getDoubleValue() + _lodRoughDelta->getDoubleValue() + _lodBareDelta->getDoubleValue();
+    double tileRangeM = std::min(range_m, maxTileRange);
+
+    // keep the requests until well after the next prediction replaces them
+    const double duration = 2.0 * std::max(1.0, _predictInterval->getDoubleValue());
+    tile_cache.set_current_time(current_time);
+
+    auto terraSync = globals->get_subsystem<simgear::SGTerraSync>();
+    const SGVec3d aircraftCart = SGVec3d::fromGeod(aircraftPos);
+    std::set<long> scheduled;
+
+    for (const SGGeod& point : track) {
+        SGBucket bucket(point);
+        if (!bucket.isValid())
+            continue;
+
+        double tile_width = bucket.get_width_m();
+        double tile_height = bucket.get_height_m();
+        double tile_r = 0.5*sqrt(tile_width*tile_width + tile_height*tile_height);
+        double max_dist2 = (tileRangeM + tile_r) * (tileRangeM + tile_r);
+        int xrange = (int)(tileRangeM / tile_width) + 1;
+        int yrange = (int)(tileRangeM / tile_height) + 1;
+        SGVec3d pointCart = SGVec3d::fromGeod(point);
+
+        for ( int x = -xrange; x <= xrange; ++x )
+        {
+            for ( int y = -yrange; y <= yrange; ++y )
+            {
+                SGBucket b = bucket.sibling(x, y);
+                if (!b.isValid() || !scheduled.insert(b.gen_index()).second)
+                    continue;
+
+                SGVec3d center = SGVec3d::fromGeod(b.get_center());
+                if (distSqr(pointCart, center) > max_dist2)
+                    continue;
+
+                // same scale as the viewer tiles: squared distance in tiles
+                float priority = (-1.0) * distSqr(aircraftCart, center) / (tile_width*tile_height);
+                sched_tile( b, priority, false, duration );
+
+                if (terraSync) {
+                    terraSync->scheduleTile(b);
+                }
+            }
+        }
+    }
+}
+
+void FGTileMgr::predict_track(const SGGeod& start, double distanceM,
+                              std::vector<SGGeod>& track) const
+{
+    track.clear();
+    track.push_back(start);
+    if (distanceM <= 0.0)
+        return;
+
+    // a point about every tile, so the scheduled areas overlap
+    SGBucket bucket(start);
+    const double spacingM = std::max(1000.0, std::min(bucket.get_width_m(), bucket.get_height_m()));
+
+    // follow the active route while its waypoints have a fixed position
+    auto routeMgr = globals->get_subsystem<FGRouteMgr>();
+    if (routeMgr && routeMgr->isRouteActive()) {
+        flightgear::FlightPlanRef plan = routeMgr->flightPlan();
+        SGGeod from = start;
+        double remaining = distanceM;
+        for (int i = std::max(0, plan->currentIndex());
+             (i < plan->numLegs()) && (remaining > 0.0); ++i) {
+            flightgear::WayptRef wpt = plan->legAtIndex(i)->waypoint();
+            if (wpt->flag(flightgear::WPT_DYNAMIC))
+                break;
+            SGGeod to = wpt->position();
+            if (!to.isValid())
+                break;
+            remaining -= addTrackSegment(from, to, remaining, spacingM, track);
+            from = to;
+        }
+
+        if (track.size() > 1)
+            return;
+    }
+
+    // otherwise straight ahead along the current ground track
+    const double trackDeg = atan2(_eastSpeed->getDoubleValue(),
+                                  _northSpeed->getDoubleValue()) * SG_RADIANS_TO_DEGREES;
+    addTrackSegment(start, SGGeodesy::direct(start, trackDeg, distanceM), distanceM,
+                    spacingM, track);
+}
+
 /** Schedules scenery for given position. Load request remains valid for given duration
  * (duration=0.0 => nothing is loaded).
  * Used for FDM/AI/groundcache/... requests. Viewer uses "schedule_tiles_at" instead.
@@ -83,9 +83,32 @@ private:
     // schedule tiles for the viewer bucket
     void schedule_tiles_at(const SGGeod& location, double rangeM);
 
+    // schedule tiles ahead of the aircraft, along the active route or
+    // its current velocity, so fast aircraft do not outrun the pager
+    void schedule_predicted(double rangeM, double current_time);
+
+    // points along the expected ground track, up to distanceM ahead
+    void predict_track(const SGGeod& start, double distanceM,
+                       std::vector<SGGeod>& track) const;
+
     SGPropertyNode_ptr _visibilityMeters;
     SGPropertyNode_ptr _lodDetailed, _lodRoughDelta, _lodBareDelta, _disableNasalHooks;
     SGPropertyNode_ptr _scenery_loaded, _scenery_override;
+    SGPropertyNode_ptr _maxMemoryMB;
+    SGPropertyNode_ptr _predictEnabled, _predictLookahead, _predictMinSpeed, _predictInterval;
+    SGPropertyNode_ptr _northSpeed, _eastSpeed;
+    SGPropertyNode_ptr _statHits, _statMisses, _statLateLoads, _statTiles,
+        _statPending, _statMemoryMB;
+
+    // tiles entering view range which were loaded, still loading or missing
+    long _hits, _misses, _lateLoads;
+
+    // reference time of the last predictive scheduling
+    double _lastPrediction;
+
+    // visibility the loaded tiles' range selectors were last set up for
+    double _prepared_visibility;
+    std::vector<TileEntry*> _newlyLoaded;
 
     osg::ref_ptr<flightgear::SceneryPager> _pager;
 
@@ -22,6 +22,7 @@
 
 #include "NasalAircraft.hxx"
 #include <Aircraft/FlightHistory.hxx>
+#include <AIModel/AIManager.hxx>
 #include <Main/globals.hxx>
 
 #include <simgear/nasal/cppbind/NasalHash.hxx>
@@ -38,12 +39,76 @@ static naRef f_getHistory(const nasal::CallContext& ctx)
   return ctx.to_nasal(history);
 }
 
+//------------------------------------------------------------------------------
+static naRef f_getTraffic(const nasal::CallContext& ctx)
+{
+  FGAIManager* aiManager = globals->get_subsystem<FGAIManager>();
+  if( !aiManager )
+    ctx.runtimeError("Failed to get 'ai-model' subsystem");
+
+  return ctx.to_nasal(aiManager->trafficSnapshot());
+}
+
+//------------------------------------------------------------------------------
+static naRef trafficEntryToNasal( const FGTrafficEntry& entry,
+                                  const nasal::CallContext& ctx )
+{
+  nasal::Hash h(ctx.c_ctx());
+  h.set("id", entry.id);
+  h.set("type", entry.typeName);
+  h.set("callsign", entry.callsign);
+  h.set("transponder_id", entry.transponderId);
+  h.set("lat", entry.position.getLatitudeDeg());
+  h.set("lon", entry.position.getLongitudeDeg());
+  h.set("alt_ft", entry.position.getElevationFt());
+  h.set("heading", entry.headingDeg);
+  h.set("tas_kt", entry.trueAirspeedKt);
+  h.set("vs_fps", entry.verticalSpeedFps);
+  h.set("squawk", entry.squawk);
+  if( entry.transponderAltitudeFt != FGTrafficEntry::NO_ALTITUDE )
+    h.set("transponder_alt_ft", entry.transponderAltitudeFt);
+  h.set("invisible", entry.invisible);
+  h.set("path", entry.props->getPath());
+  return h.get_naRef();
+}
+
+//------------------------------------------------------------------------------
+static naRef f_trafficGet(FGTrafficSnapshot& traffic, const nasal::CallContext& ctx)
+{
+  int index = ctx.requireArg<int>(0);
+  if( index < 0 || index >= static_cast<int>(traffic.size()) )
+    return naNil();
+
+  return trafficEntryToNasal(traffic.entries()[index], ctx);
+}
+
+//------------------------------------------------------------------------------
+static naRef f_trafficFind(FGTrafficSnapshot& traffic, const nasal::CallContext& ctx)
+{
+  naRef key = ctx.requireArg<naRef>(0);
+  const FGTrafficEntry* entry =
+    naIsNum(key) ? traffic.findById(static_cast<int>(key.num))
+                 : traffic.findByCallsign(ctx.requireArg<std::string>(0));
+  if( !entry )
+    return naNil();
+
+  return trafficEntryToNasal(*entry, ctx);
+}
+
 //------------------------------------------------------------------------------
 void initNasalAircraft(naRef globals, naContext c)
 {
   nasal::Ghost<SGSharedPtr<FGFlightHistory> >::init("FGFlightHistory")
     .method("pathForHistory", &FGFlightHistory::pathForHistory);
 
+  nasal::Ghost<FGTrafficSnapshotRef>::init("TrafficSnapshot")
+    .member("frame", &FGTrafficSnapshot::frame)
+    .member("sim_time", &FGTrafficSnapshot::simTimeSec)
+    .member("size", &FGTrafficSnapshot::size)
+    .method("get", &f_trafficGet)
+    .method("find", &f_trafficFind);
+
   nasal::Hash aircraft_module = nasal::Hash(globals, c).createHash("aircraft");
   aircraft_module.set("history", &f_getHistory);
+  aircraft_module.set("traffic", &f_getTraffic);
 }
@@ -72,6 +72,7 @@
 #include <Main/globals.hxx>
 #include <Main/util.hxx>
 #include <Main/fg_props.hxx>
+#include <Main/FrameProfiler.hxx>
 #include <Main/sentryIntegration.hxx>
 
 using std::map;
@@ -198,6 +199,7 @@ public:
       // event manager).
       _isRunning = false;
 
+    flightgear::FrameProfiler::Zone zone("nasal-timer", _name);
     naRef *args = nullptr;
     _sys->callMethod(_func, _self, 0, args, naNil() /* locals */);
   }
@@ -1685,6 +1687,7 @@ void FGNasalSys::setTimer(naContext c, int argc, naRef* args)
 
     // Generate and register a C++ timer handler
     NasalTimer* t = new NasalTimer(handler, this);
+    t->name = name;
     _nasalTimers.push_back(t);
     globals->get_event_mgr()->addEvent(name,
                                        t, &NasalTimer::timerExpired,
@@ -1693,7 +1696,10 @@ void FGNasalSys::setTimer(naContext c, int argc, naRef* args)
 
 void FGNasalSys::handleTimer(NasalTimer* t)
 {
-    call(t->handler, 0, 0, naNil());
+    {
+        flightgear::FrameProfiler::Zone zone("nasal-timer", t->name);
+        call(t->handler, 0, 0, naNil());
+    }
     auto it =  std::find(_nasalTimers.begin(), _nasalTimers.end(), t);
     assert(it != _nasalTimers.end());
     _nasalTimers.erase(it);
@@ -1890,6 +1896,11 @@ void FGNasalListener::call(SGPropertyNode* which, naRef mode)
     arg[1] = _nas->propNodeGhost(_node);
     arg[2] = mode;                  // value changed, child added/removed
     arg[3] = naNum(_node != which); // child event?
+
+    flightgear::FrameProfiler::Zone zone("nasal-listener",
+        flightgear::FrameProfiler::isActive()
+            ? "listener-" + std::to_string(_id) + ":" + _node->getPath()
+            : std::string());
     _nas->call(_code, 4, arg, naNil());
     _active--;
 }
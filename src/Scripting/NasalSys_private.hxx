@@ -86,6 +86,7 @@ struct NasalTimer
     ~NasalTimer();
     
     naRef handler;
+    std::string name; ///< settimer-<file>:<line>, for profiling
     int gcKey = 0;
     FGNasalSys* nasal = nullptr;
 };
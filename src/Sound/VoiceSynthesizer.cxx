@@ -17,6 +17,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 #include "VoiceSynthesizer.hxx"
+#include "sample_cache.hxx"
 #include <Main/globals.hxx>
 #include <Main/fg_props.hxx>
 #include <simgear/sg_inlines.h>
@@ -26,6 +27,9 @@
 
 #include <flite_hts_engine.h>
 
+#include <iomanip>
+#include <sstream>
+
 using std::string;
 
 static const char * VOICE_FILES[] = {
@@ -47,6 +51,8 @@ private:
 
 void FLITEVoiceSynthesizer::WorkerThread::run()
 {
+  _synthesizer->loadVoice();
+
   for (;;) {
     SynthesizeRequest request = _synthesizer->_requests.pop();
 
@@ -93,24 +99,58 @@ void FLITEVoiceSynthesizer::synthesize( SynthesizeRequest & request)
 
 FLITEVoiceSynthesizer::FLITEVoiceSynthesizer(const std::string & voice)
     // REVIEW: Memory Leak - 1,696 bytes in 4 blocks are definitely lost in loss record 6,145 of 6,440
-    : _engine(new Flite_HTS_Engine), _worker(new FLITEVoiceSynthesizer::WorkerThread(this)), _volume(6.0)
+    : _engine(new Flite_HTS_Engine), _voice(voice), _loaded(false),
+      _worker(new FLITEVoiceSynthesizer::WorkerThread(this)), _volume(6.0)
 {
   _volume = fgGetDouble("/sim/sound/voice-synthesizer/volume", _volume );
-  Flite_HTS_Engine_initialize(_engine);
-  Flite_HTS_Engine_load(_engine, voice.c_str());
   _worker->start();
 }
 
+void FLITEVoiceSynthesizer::loadVoice()
+{
+  std::lock_guard<std::mutex> lock(_engineLock);
+  if (_loaded)
+    return;
+
+  Flite_HTS_Engine_initialize(_engine);
+  Flite_HTS_Engine_load(_engine, _voice.c_str());
+  _loaded = true;
+}
+
+string FLITEVoiceSynthesizer::cacheKey( const std::string & text, double volume, double speed, double pitch ) const
+{
+  SG_CLAMP_RANGE( volume, 0.0, 1.0 );
+  SG_CLAMP_RANGE( speed, 0.0, 10.0 );
+  SG_CLAMP_RANGE( pitch, 0.0, 10.0 );
+
+  // everything that changes the rendered audio, with the voice by file
+  // name so the key survives a move of FG_ROOT
+  std::ostringstream key;
+  key << std::setprecision(6) << "flite:" << SGPath::fromUtf8(_voice).file()
+      << ":" << _volume << ":" << volume << ":" << speed << ":" << pitch
+      << ":" << text;
+  return key.str();
+}
+
 FLITEVoiceSynthesizer::~FLITEVoiceSynthesizer()
 {
   // push the special marker value
   _requests.push(SynthesizeRequest::cancelThreadRequest());
   _worker->join();
-  Flite_HTS_Engine_clear(_engine);
+  if (_loaded)
+    Flite_HTS_Engine_clear(_engine);
 }
 
 SGSoundSample * FLITEVoiceSynthesizer::synthesize(const std::string & text, double volume, double speed, double pitch )
 {
+  const string key = cacheKey(text, volume, speed, pitch);
+  SGSoundSample * cached = FGSampleCache::instance()->find(key);
+  if (cached)
+    return cached;
+
+  loadVoice();
+  std::lock_guard<std::mutex> lock(_engineLock);
+
   SG_CLAMP_RANGE( volume, 0.0, 1.0 );
   SG_CLAMP_RANGE( speed, 0.0, 10.0 );
   SG_CLAMP_RANGE( pitch, 0.0, 10.0 );
@@ -127,6 +167,9 @@ SGSoundSample * FLITEVoiceSynthesizer::synthesize(const std::string & text, doub
     reinterpret_cast<unsigned char*>( data ),
     free
   };
+  // speech is worth keeping between sessions, if the disk cache is enabled
+  FGSampleCache::instance()->insert(key, buf.get(), count * sizeof(short),
+                                    rate, SG_SAMPLE_MONO16, true);
   return new SGSoundSample(buf,
                            count * sizeof(short),
                            rate,
@@ -22,6 +22,7 @@
 #include <simgear/sound/sample.hxx>
 #include <simgear/threads/SGQueue.hxx>
 
+#include <mutex>
 #include <string>
 struct _Flite_HTS_Engine;
 
@@ -91,13 +92,31 @@ public:
   static std::string getVoicePath( voice_t voice );
   static std::string getVoicePath( const std::string & voice );
 
+  /**
+   * The voice is loaded by the synthesis thread, so creating a synthesizer
+   * does not stall the caller.
+   */
   FLITEVoiceSynthesizer( const std::string & voice );
   ~FLITEVoiceSynthesizer();
+
+  /**
+   * Synthesize text, or fetch the audio from FGSampleCache when the same
+   * text was spoken by this voice with the same settings before.
+   */
   virtual SGSoundSample * synthesize( const std::string & text, double volume, double speed, double pitch  );
 
   virtual void synthesize( SynthesizeRequest & request );
+
 private:
+  std::string cacheKey( const std::string & text, double volume, double speed, double pitch ) const;
+  void loadVoice();
+
   struct _Flite_HTS_Engine * _engine;
+  std::string _voice;
+  bool _loaded;
+  // guards _engine and _loaded between the worker thread and direct
+  // synthesize() callers
+  std::mutex _engineLock;
 
   class WorkerThread;
   WorkerThread * _worker;
@@ -23,6 +23,7 @@
 #include <simgear/constants.h>
 
 #include "morse.hxx"
+#include "sample_cache.hxx"
 
 #include <simgear/sound/sample.hxx>
 
@@ -136,9 +137,40 @@ bool FGMorse::cust_init(const int freq ) {
 }
 
 
+std::string FGMorse::cache_key( const std::string& id, const int freq ) {
+    return "morse:" + std::to_string( freq ) + ":" + id;
+}
+
+
 // make a SGSoundSample morse code transmission for the specified string
 SGSoundSample *FGMorse::make_ident( const std::string& id, const int freq ) {
 
+    SGSoundSample *sample = FGSampleCache::instance()->find( cache_key( id, freq ) );
+    if ( !sample ) {
+        sample = render_ident( id, freq );
+    }
+
+    sample->set_reference_dist( 10.0 );
+    sample->set_max_dist( 20.0 );
+
+    return sample;
+}
+
+
+bool FGMorse::prefetch_ident( const std::string& id, const int freq ) {
+    if ( FGSampleCache::instance()->contains( cache_key( id, freq ) ) ) {
+        return false;
+    }
+
+    SGSharedPtr<SGSoundSample> sample = render_ident( id, freq );
+    return true;
+}
+
+
+// render a morse code transmission for the specified string, and keep a
+// copy in the sample cache
+SGSoundSample *FGMorse::render_ident( const std::string& id, const int freq ) {
+
     char *idptr = (char *)id.c_str();
 
     int length = 0;
@@ -234,14 +266,13 @@ SGSoundSample *FGMorse::make_ident( const std::string& id, const int freq ) {
     memcpy( buf_ptr, space, SPACE_SIZE );
     buf_ptr += SPACE_SIZE;
 
-    // 4. create the simple sound and return
-    SGSoundSample *sample = new SGSoundSample( buffer, length,
-                                               BYTES_PER_SECOND );
+    // 4. keep a copy, cheap enough to render that it need not go to disk
+    FGSampleCache::instance()->insert( cache_key( id, freq ), buffer.get(),
+                                       length, BYTES_PER_SECOND,
+                                       SG_SAMPLE_MONO8, false );
 
-    sample->set_reference_dist( 10.0 );
-    sample->set_max_dist( 20.0 );
-
-    return sample;
+    // 5. create the simple sound and return
+    return new SGSoundSample( buffer, length, BYTES_PER_SECOND );
 }
 
 FGMorse * FGMorse::_instance = NULL;
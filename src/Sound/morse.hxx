@@ -113,9 +113,20 @@ public:
 
     static FGMorse * instance();
 
-    // make a SimpleSound morse code transmission for the specified string
+    // make a SimpleSound morse code transmission for the specified string,
+    // rendered once per ident and frequency and then kept in FGSampleCache
     SGSoundSample *make_ident( const std::string& id,
                                const int freq = LO_FREQUENCY );
+
+    // render the ident into the sample cache ahead of its first use;
+    // returns false if it was cached already
+    bool prefetch_ident( const std::string& id,
+                         const int freq = LO_FREQUENCY );
+
+private:
+    static std::string cache_key( const std::string& id, const int freq );
+    // render a new sample, and a copy into the sample cache
+    SGSoundSample *render_ident( const std::string& id, const int freq );
 };
 
 
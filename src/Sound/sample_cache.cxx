@@ -0,0 +1,373 @@
+// sample_cache.cxx -- shared cache of rendered sound samples
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "sample_cache.hxx"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include <simgear/debug/logstream.hxx>
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/misc/sg_dir.hxx>
+#include <simgear/sound/sample.hxx>
+
+namespace {
+
+const char FILE_MAGIC[4] = { 'F', 'G', 'S', 'C' };
+const uint32_t FILE_VERSION = 1;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t keyLength;
+    int32_t frequency;
+    int32_t format;
+    uint64_t dataLength;
+};
+
+// FNV-1a, stable between runs and platforms unlike std::hash
+uint64_t hashKey( const std::string & key )
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+} // of anonymous namespace
+
+FGSampleCache::FGSampleCache() :
+    _max_bytes(32 * 1024 * 1024),
+    _bytes(0),
+    _max_disk_bytes(64 * 1024 * 1024),
+    _disk_bytes(0),
+    _hits(0),
+    _misses(0)
+{
+}
+
+FGSampleCache * FGSampleCache::instance()
+{
+    static FGSampleCache cache;
+    return &cache;
+}
+
+SGSoundSample * FGSampleCache::find( const std::string & key )
+{
+    std::unique_lock<std::mutex> lock(_lock);
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        SGPath path = disk_path(key);
+        lock.unlock();
+
+        Entry entry;
+        if (path.isNull() || !read_from_disk(path, key, entry)) {
+            lock.lock();
+            ++_misses;
+            return NULL;
+        }
+
+        lock.lock();
+        it = _index.find(key);
+        if (it == _index.end()) {
+            add_locked(std::move(entry));
+            it = _index.find(key);
+            if (it == _index.end()) {
+                // too large to keep in memory
+                ++_misses;
+                return NULL;
+            }
+        }
+    }
+
+    ++_hits;
+    _entries.splice(_entries.begin(), _entries, it->second);
+    const Entry & entry = *it->second;
+
+    // the sample takes ownership of a malloc()ed buffer
+    auto buffer = std::unique_ptr<unsigned char, decltype(free)*>{
+        reinterpret_cast<unsigned char*>( malloc( entry.data.size() ) ),
+        free
+    };
+    memcpy( buffer.get(), entry.data.data(), entry.data.size() );
+    return new SGSoundSample( buffer, entry.data.size(), entry.frequency,
+                              entry.format );
+}
+
+bool FGSampleCache::contains( const std::string & key ) const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    return _index.count(key) > 0;
+}
+
+void FGSampleCache::insert( const std::string & key, const unsigned char * data,
+                            size_t size, int frequency, int format, bool persistent )
+{
+    Entry entry;
+    entry.key = key;
+    entry.data.assign( data, data + size );
+    entry.frequency = frequency;
+    entry.format = format;
+
+    SGPath path;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (persistent)
+            path = disk_path(key);
+        if (_index.count(key) == 0) {
+            if (path.isNull()) {
+                add_locked(std::move(entry));
+                return;
+            }
+            add_locked(Entry(entry));
+        }
+    }
+
+    if (path.isNull() || path.exists())
+        return;
+
+    const size_t fileBytes = sizeof(FileHeader) + entry.key.size() + entry.data.size();
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_disk_bytes + fileBytes > _max_disk_bytes)
+            return; // full until pruned in a later session
+        _disk_bytes += fileBytes;
+    }
+    write_to_disk(path, entry);
+}
+
+void FGSampleCache::add_locked( Entry && entry )
+{
+    if (entry.data.size() > _max_bytes)
+        return;
+
+    _bytes += entry.data.size();
+    _entries.push_front(std::move(entry));
+    _index[_entries.front().key] = _entries.begin();
+
+    while (_bytes > _max_bytes) {
+        const Entry & oldest = _entries.back();
+        _bytes -= oldest.data.size();
+        _index.erase(oldest.key);
+        _entries.pop_back();
+    }
+}
+
+void FGSampleCache::set_max_memory( size_t bytes )
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _max_bytes = bytes;
+    while (_bytes > _max_bytes) {
+        const Entry & oldest = _entries.back();
+        _bytes -= oldest.data.size();
+        _index.erase(oldest.key);
+        _entries.pop_back();
+    }
+}
+
+void FGSampleCache::set_max_disk( size_t bytes )
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _max_disk_bytes = bytes;
+}
+
+void FGSampleCache::set_disk_cache_dir( const SGPath & dir )
+{
+    if (!dir.isNull() && !dir.exists()) {
+        SGPath(dir / "dummy").create_dir(0755);
+    }
+
+    size_t maxBytes;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        maxBytes = _max_disk_bytes;
+    }
+    const size_t diskBytes = dir.isNull() ? 0 : prune_disk(dir, maxBytes);
+
+    std::lock_guard<std::mutex> lock(_lock);
+    _disk_dir = dir;
+    _disk_bytes = diskBytes;
+}
+
+// Remove the least recently written files beyond max_bytes, returning the
+// size of the ones kept.
+size_t FGSampleCache::prune_disk( const SGPath & dir, size_t max_bytes )
+{
+    struct CacheFile {
+        SGPath path;
+        time_t modTime;
+        size_t size;
+    };
+
+    std::vector<CacheFile> files;
+    size_t total = 0;
+    const PathList children = simgear::Dir(dir).children(
+        simgear::Dir::TYPE_FILE | simgear::Dir::NO_DOT_OR_DOTDOT);
+    for (const SGPath & child : children) {
+        const std::string ext = child.extension();
+        if (ext == "tmp") {
+            // left behind by a crash while writing
+            SGPath(child).remove();
+        } else if (ext == "pcm") {
+            files.push_back(CacheFile{child, child.modTime(), child.sizeInBytes()});
+            total += files.back().size;
+        }
+    }
+
+    if (total <= max_bytes)
+        return total;
+
+    std::sort(files.begin(), files.end(),
+              [](const CacheFile & a, const CacheFile & b) {
+                  return a.modTime < b.modTime;
+              });
+
+    unsigned int removed = 0;
+    for (CacheFile & file : files) {
+        if (total <= max_bytes)
+            break;
+        if (file.path.remove()) {
+            total -= file.size;
+            ++removed;
+        }
+    }
+
+    SG_LOG(SG_SOUND, SG_INFO, "Removed " << removed << " old files from sample cache "
+           << dir << ", " << (total / 1024) << " KiB left");
+    return total;
+}
+
+void FGSampleCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _entries.clear();
+    _index.clear();
+    _bytes = 0;
+}
+
+size_t FGSampleCache::get_memory_usage() const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    return _bytes;
+}
+
+unsigned long FGSampleCache::get_hits() const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    return _hits;
+}
+
+unsigned long FGSampleCache::get_misses() const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    return _misses;
+}
+
+SGPath FGSampleCache::disk_path( const std::string & key ) const
+{
+    if (_disk_dir.isNull())
+        return SGPath();
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.pcm",
+             static_cast<unsigned long long>(hashKey(key)));
+    return _disk_dir / name;
+}
+
+bool FGSampleCache::read_from_disk( const SGPath & path, const std::string & key,
+                                    Entry & entry ) const
+{
+    if (!path.exists())
+        return false;
+
+    sg_ifstream in(path, std::ios::in | std::ios::binary);
+    FileHeader header;
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in.good() || memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) ||
+        (header.version != FILE_VERSION) || (header.keyLength != key.size()))
+        return false;
+
+    // the file name is only a hash, the key itself decides
+    entry.key.resize(header.keyLength);
+    in.read(&entry.key[0], header.keyLength);
+    if (!in.good() || (entry.key != key))
+        return false;
+
+    // never trust the length enough to allocate more than the file holds
+    const uint64_t fileBytes = path.sizeInBytes();
+    const uint64_t headerBytes = sizeof(header) + header.keyLength;
+    if ((fileBytes < headerBytes) || (header.dataLength > fileBytes - headerBytes) ||
+        (header.dataLength > _max_bytes)) {
+        SG_LOG(SG_SOUND, SG_WARN, "Bad sample length in sample cache file " << path);
+        return false;
+    }
+
+    entry.data.resize(header.dataLength);
+    in.read(reinterpret_cast<char*>(entry.data.data()), header.dataLength);
+    if (!in.good()) {
+        SG_LOG(SG_SOUND, SG_WARN, "Truncated sample cache file " << path);
+        return false;
+    }
+
+    entry.frequency = header.frequency;
+    entry.format = header.format;
+    return true;
+}
+
+void FGSampleCache::write_to_disk( const SGPath & path, const Entry & entry ) const
+{
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+    header.version = FILE_VERSION;
+    header.keyLength = entry.key.size();
+    header.frequency = entry.frequency;
+    header.format = entry.format;
+    header.dataLength = entry.data.size();
+
+    // write to a temporary file, so a crash can't leave a truncated
+    // sample with a valid header behind
+    SGPath tmpPath = SGPath::fromUtf8(path.utf8Str() + ".tmp");
+    {
+        sg_ofstream out(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            SG_LOG(SG_SOUND, SG_WARN, "Unable to write sample cache file " << tmpPath);
+            return;
+        }
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(entry.key.data(), entry.key.size());
+        out.write(reinterpret_cast<const char*>(entry.data.data()), entry.data.size());
+        if (!out.good()) {
+            SG_LOG(SG_SOUND, SG_WARN, "Failed writing sample cache file " << tmpPath);
+            return;
+        }
+    }
+
+    if (!tmpPath.rename(path)) {
+        SG_LOG(SG_SOUND, SG_WARN, "Unable to rename sample cache file to " << path);
+        SGPath(tmpPath).remove();
+    }
+}
@@ -0,0 +1,107 @@
+// sample_cache.hxx -- shared cache of rendered sound samples
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef _FG_SAMPLE_CACHE_HXX
+#define _FG_SAMPLE_CACHE_HXX
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <simgear/misc/sg_path.hxx>
+
+class SGSoundSample;
+
+/**
+ * Keeps the PCM data of generated samples, such as morse idents and
+ * synthesized speech, keyed by everything that went into rendering them,
+ * so the same audio is only rendered once.
+ *
+ * The least recently used samples are dropped beyond the memory limit.
+ * Samples inserted as persistent are also written to the disk cache
+ * directory, when one is set, and read back from there in later sessions.
+ * The disk cache is kept within its own limit: the oldest files beyond it
+ * are removed when the directory is set, and nothing more is written once
+ * it is full.
+ *
+ * All methods may be called from any thread.
+ */
+class FGSampleCache
+{
+public:
+    static FGSampleCache * instance();
+
+    /**
+     * A new sample playing the audio cached for key, or NULL if there is
+     * none. Each caller gets its own sample, with its own volume and
+     * position.
+     */
+    SGSoundSample * find( const std::string & key );
+
+    bool contains( const std::string & key ) const;
+
+    /**
+     * Keep a copy of size bytes of PCM data in the given SGSoundMgr
+     * format for key.
+     */
+    void insert( const std::string & key, const unsigned char * data,
+                 size_t size, int frequency, int format, bool persistent );
+
+    void set_max_memory( size_t bytes );
+    // takes effect on the next set_disk_cache_dir()
+    void set_max_disk( size_t bytes );
+    // an empty path disables the disk cache
+    void set_disk_cache_dir( const SGPath & dir );
+    void clear();
+
+    size_t get_memory_usage() const;
+    unsigned long get_hits() const;
+    unsigned long get_misses() const;
+
+private:
+    FGSampleCache();
+
+    struct Entry {
+        std::string key;
+        std::vector<unsigned char> data;
+        int frequency;
+        int format;
+    };
+    // most recently used first
+    typedef std::list<Entry> EntryList;
+
+    void add_locked( Entry && entry );
+    SGPath disk_path( const std::string & key ) const;
+    static size_t prune_disk( const SGPath & dir, size_t max_bytes );
+    bool read_from_disk( const SGPath & path, const std::string & key, Entry & entry ) const;
+    void write_to_disk( const SGPath & path, const Entry & entry ) const;
+
+    mutable std::mutex _lock;
+    EntryList _entries;
+    std::unordered_map<std::string, EntryList::iterator> _index;
+    size_t _max_bytes;
+    size_t _bytes;
+    SGPath _disk_dir;
+    size_t _max_disk_bytes;
+    size_t _disk_bytes;
+    unsigned long _hits;
+    unsigned long _misses;
+};
+
+#endif // _FG_SAMPLE_CACHE_HXX
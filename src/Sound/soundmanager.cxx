@@ -23,10 +23,14 @@
 #include <simgear/structure/commands.hxx>
 
 #include "VoiceSynthesizer.hxx"
+#include "morse.hxx"
+#include "sample_cache.hxx"
 #include "sample_queue.hxx"
 #include "soundmanager.hxx"
 #include <Main/globals.hxx>
 #include <Main/fg_props.hxx>
+#include <Navaids/positioned.hxx>
+#include <Navaids/PositionedOctree.hxx>
 #include <Viewer/view.hxx>
 
 #include <stdio.h>
@@ -57,6 +61,7 @@ FGSoundManager::FGSoundManager()
   : _active_dt(0.0),
     _is_initialized(false),
     _enabled(false),
+    _prefetchTimer(0.0),
     _listener(new Listener(this))
 {
 }
@@ -78,6 +83,24 @@ void FGSoundManager::init()
 
     _frozen = fgGetNode("sim/freeze/master");
 
+    // rendered morse idents and synthesized speech are shared by all radios
+    SGPropertyNode_ptr cacheNode = fgGetNode("/sim/sound/sample-cache", true);
+    FGSampleCache* cache = FGSampleCache::instance();
+    cache->set_max_memory(static_cast<size_t>(
+        cacheNode->getDoubleValue("max-memory-mb", 32.0) * 1024 * 1024));
+    if (cacheNode->getBoolValue("persistent", false)) {
+        cache->set_max_disk(static_cast<size_t>(
+            cacheNode->getDoubleValue("max-disk-mb", 64.0) * 1024 * 1024));
+        cache->set_disk_cache_dir(globals->get_fg_home() / "SoundCache");
+    }
+    _prefetchRange = cacheNode->getNode("prefetch-range-nm", true);
+    if (_prefetchRange->getType() == simgear::props::NONE) {
+        _prefetchRange->setDoubleValue(50.0);
+    }
+    _cacheHits = cacheNode->getNode("hits", true);
+    _cacheMisses = cacheNode->getNode("misses", true);
+    _cacheMemory = cacheNode->getNode("memory-kb", true);
+
     SGPropertyNode_ptr scenery_loaded = fgGetNode("sim/sceneryloaded", true);
     scenery_loaded->addChangeListener(_listener.get());
 
@@ -195,7 +218,52 @@ void FGSoundManager::update(double dt)
 
             set_volume(vf*_volume->getFloatValue());
             SGSoundMgr::update(dt);
+
+            prefetchIdents(dt);
         }
+
+        FGSampleCache* cache = FGSampleCache::instance();
+        _cacheHits->setLongValue(cache->get_hits());
+        _cacheMisses->setLongValue(cache->get_misses());
+        _cacheMemory->setLongValue(cache->get_memory_usage() / 1024);
+    }
+}
+
+void FGSoundManager::prefetchIdents(double dt)
+{
+    // render at most one ident per frame
+    FGMorse* morse = FGMorse::instance();
+    while (!_prefetchQueue.empty()) {
+        const auto ident = _prefetchQueue.back();
+        _prefetchQueue.pop_back();
+        if (morse->prefetch_ident(ident.first, ident.second))
+            return;
+    }
+
+    _prefetchTimer -= dt;
+    const double rangeNm = _prefetchRange->getDoubleValue();
+    if ((_prefetchTimer > 0.0) || (rangeNm <= 0.0))
+        return;
+
+    // the same tones AudioIdent and the ADF use for these stations
+    FGPositioned::TypeFilter filter({FGPositioned::NDB, FGPositioned::VOR,
+                                     FGPositioned::ILS, FGPositioned::LOC,
+                                     FGPositioned::DME});
+
+    // keep the query to a few milliseconds; if it runs out of time, the
+    // octree nodes it loaded stay loaded and the next frame carries on
+    FGPositionedList navaids;
+    const bool partial = flightgear::Octree::findAllWithinRange(
+        SGVec3d::fromGeod(globals->get_aircraft_position()),
+        rangeNm * SG_NM_TO_METER, &filter, navaids, 4);
+    if (partial)
+        return;
+
+    _prefetchTimer = 30.0;
+    for (const auto& navaid : navaids) {
+        const int freq = (navaid->type() == FGPositioned::DME) ?
+            FGMorse::HI_FREQUENCY : FGMorse::LO_FREQUENCY;
+        _prefetchQueue.emplace_back(navaid->ident(), freq);
     }
 }
 
@@ -22,6 +22,9 @@
 
 #include <memory>
 #include <map>
+#include <string>
+#include <utility>
+#include <vector>
 #include <simgear/props/props.hxx>
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/sound/soundmgr.hxx>
@@ -55,6 +58,10 @@ public:
 private:
     bool stationaryView() const;
 
+    // render the idents of the navaids around the aircraft ahead of
+    // tuning, spread over frames
+    void prefetchIdents(double dt);
+
     bool playAudioSampleCommand(const SGPropertyNode * arg, SGPropertyNode * root);
 
     std::map<std::string,SGSharedPtr<FGSampleQueue>> _queue;
@@ -64,6 +71,10 @@ private:
     SGPropertyNode_ptr _sound_working, _sound_enabled, _volume, _device_name;
     SGPropertyNode_ptr _velocityNorthFPS, _velocityEastFPS, _velocityDownFPS;
     SGPropertyNode_ptr _frozen;
+    SGPropertyNode_ptr _prefetchRange;
+    SGPropertyNode_ptr _cacheHits, _cacheMisses, _cacheMemory;
+    double _prefetchTimer;
+    std::vector<std::pair<std::string, int>> _prefetchQueue; ///< ident, tone
     std::unique_ptr<Listener> _listener;
 
     std::map<std::string,VoiceSynthesizer*> _synthesizers;
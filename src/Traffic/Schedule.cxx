@@ -75,7 +75,8 @@ FGAISchedule::FGAISchedule()
     courseToDest(0),
     initialized(false),
     valid(false),
-    scheduleComplete(false)
+    scheduleComplete(false),
+    nextUpdate(0)
 {
 }
 
@@ -104,7 +105,8 @@ FGAISchedule::FGAISchedule(const string& model,
       courseToDest(0),
       initialized(false),
       valid(true),
-      scheduleComplete(false)
+      scheduleComplete(false),
+      nextUpdate(0)
 {
   modelPath        = model;
   livery           = lvry;
@@ -149,6 +151,7 @@ FGAISchedule::FGAISchedule(const FGAISchedule &other)
   initialized        = other.initialized;
   valid              = other.valid;
   scheduleComplete   = other.scheduleComplete;
+  nextUpdate         = other.nextUpdate;
 }
 
 
@@ -199,7 +202,7 @@ bool FGAISchedule::init()
  *  Returns false when processing was aborted due to timeout, so
  *    more time required - and another call is requested (next sim iteration).
  */
-bool FGAISchedule::update(time_t now, const SGVec3d& userCart)
+bool FGAISchedule::update(time_t now, const SGVec3d& userCart, double maxUserSpeedKt)
 {
 
   time_t totalTimeEnroute,
@@ -216,6 +219,7 @@ bool FGAISchedule::update(time_t now, const SGVec3d& userCart)
   }
 
   if (!scheduleComplete) {
+      nextUpdate = now;
       return false; // not ready yet, continue processing in next iteration
   }
 
@@ -248,6 +252,7 @@ bool FGAISchedule::update(time_t now, const SGVec3d& userCart)
     if (aiAircraft->getDie()) {
       aiAircraft = NULL;
     } else {
+      nextUpdate = now + TRAFFICAIPOLLINTERVAL;
       return true; // in visual range, let the AIManager handle it
     }
   }
@@ -261,9 +266,13 @@ bool FGAISchedule::update(time_t now, const SGVec3d& userCart)
     // and detach it from the current list of aircraft.
     flight->update();
     flights.erase(flights.begin()); // pop_front(), effectively
+    nextUpdate = now; // look at the next leg straight away
     return true; // processing complete
   }
 
+  // nothing changes for this flight until it is in the past
+  nextUpdate = flight->getArrivalTime();
+
   FGAirport* dep = flight->getDepartureAirport();
   FGAirport* arr = flight->getArrivalAirport();
   if (!dep || !arr) {
@@ -271,8 +280,12 @@ bool FGAISchedule::update(time_t now, const SGVec3d& userCart)
   }
 
   double speed = 450.0;
+  double routeSpeedKt = 0.0;
   if (dep != arr) {
     totalTimeEnroute = flight->getArrivalTime() - flight->getDepartureTime();
+    if (totalTimeEnroute > 0) {
+      routeSpeedKt = SGGeodesy::distanceNm(dep->geod(), arr->geod()) * 3600.0 / totalTimeEnroute;
+    }
     if (flight->getDepartureTime() < now) {
       elapsedTimeEnroute   = now - flight->getDepartureTime();
       //remainingTimeEnroute = totalTimeEnroute - elapsedTimeEnroute;
@@ -317,12 +330,22 @@ bool FGAISchedule::update(time_t now, const SGVec3d& userCart)
 	     << dep->getId() << " to " << arr->getId() << ". Current distance to user: "
              << distanceToUser);
   if (distanceToUser >= TRAFFICTOAIDISTTOSTART) {
+    // Neither we nor the user can close the gap faster than this, so
+    // there is no point in looking at this schedule again before then.
+    const double closingKt = routeSpeedKt + maxUserSpeedKt;
+    time_t deferral = TRAFFICMAXDEFERRAL;
+    if (closingKt > 0.0) {
+        const double hours = (distanceToUser - TRAFFICTOAIDISTTOSTART) / closingKt;
+        deferral = std::min<time_t>(deferral, static_cast<time_t>(hours * 3600.0));
+    }
+    nextUpdate = std::min(nextUpdate, now + std::max<time_t>(1, deferral));
     return true; // out of visual range, for the moment.
   }
 
   if (!createAIAircraft(flight, speed, deptime)) {
       valid = false;
   }
+  nextUpdate = now + TRAFFICAIPOLLINTERVAL;
 
 
     return true; // processing complete
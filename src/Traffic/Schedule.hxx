@@ -32,6 +32,11 @@
 #define TRAFFICTOAIDISTTOSTART 150.0
 #define TRAFFICTOAIDISTTODIE   200.0
 
+// seconds between checks of a schedule whose aircraft is handled by the AIManager
+#define TRAFFICAIPOLLINTERVAL  10
+// upper limit for how long a distant schedule is left alone, in seconds
+#define TRAFFICMAXDEFERRAL     900
+
 // forward decls
 class FGAIAircraft;
 class FGScheduledFlight;
@@ -66,6 +71,7 @@ class FGAISchedule
   bool initialized;
   bool valid;
   bool scheduleComplete;
+  time_t nextUpdate;
 
   bool scheduleFlights(time_t now);
   int groundTimeFromRadius();
@@ -101,7 +107,14 @@ class FGAISchedule
     static bool validModelPath(const std::string& model);
     static SGPath resolveModelPath(const std::string& model);
     
-  bool update(time_t now, const SGVec3d& userCart);
+  /**
+   * Advance the schedule. maxUserSpeedKt is the fastest the user is
+   * assumed to travel; it bounds how long a distant aircraft can be left
+   * alone before it might come into range, see getNextUpdateTime().
+   */
+  bool update(time_t now, const SGVec3d& userCart, double maxUserSpeedKt);
+  time_t getNextUpdateTime() const { return nextUpdate; }
+  bool isValid() const { return valid; }
   bool init();
 
   double getSpeed         ();
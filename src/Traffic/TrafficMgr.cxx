@@ -62,6 +62,7 @@
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/threads/SGThread.hxx>
 #include <simgear/timing/sg_time.hxx>
+#include <simgear/timing/timestamp.hxx>
 
 #include <simgear/xml/easyxml.hxx>
 #include <simgear/scene/tsync/terrasync.hxx>
@@ -439,7 +440,9 @@ FGTrafficManager::FGTrafficManager() :
   realWxEnabled("/environment/realwx/enabled"),
   metarValid("/environment/metar/valid"),
   active("/sim/traffic-manager/active"),
-  aiDataUpdateNow("/sim/terrasync/ai-data-update-now")
+  aiDataUpdateNow("/sim/terrasync/ai-data-update-now"),
+  lastUpdateTime(0),
+  userSpeedBound(0.0)
 {
 }
 
@@ -503,6 +506,7 @@ void FGTrafficManager::shutdown()
     if (saveData) {
         cachefile.close();
     }
+    updateQueue = ScheduleQueue();
     scheduledAircraft.clear();
 
     for (auto flight : flights) {
@@ -511,7 +515,6 @@ void FGTrafficManager::shutdown()
     }
     flights.clear();
 
-    currAircraft = scheduledAircraft.begin();
     doingInit = false;
     inited = false;
     trafficSyncRequested = false;
@@ -624,8 +627,24 @@ void FGTrafficManager::finishInit()
 
     sort(scheduledAircraft.begin(), scheduledAircraft.end(),
          compareSchedules);
-    currAircraft = scheduledAircraft.begin();
-    currAircraftClosest = scheduledAircraft.begin();
+
+    SGPropertyNode* tm = fgGetNode("/sim/traffic-manager", true);
+    maxUserSpeedNode = tm->getNode("max-user-speed-kt", true);
+    if (!maxUserSpeedNode->hasValue()) {
+        maxUserSpeedNode->setDoubleValue(600.0);
+    }
+    updateBudgetNode = tm->getNode("update-budget-ms", true);
+    if (!updateBudgetNode->hasValue()) {
+        updateBudgetNode->setDoubleValue(1.0);
+    }
+    queueSizeNode = tm->getNode("queue/size", true);
+    processedNode = tm->getNode("queue/processed", true);
+    lateNode = tm->getNode("queue/late-sec", true);
+
+    userSpeedBound = maxUserSpeedNode->getDoubleValue();
+    lastUserCart = globals->get_aircraft_position_cart();
+    lastUpdateTime = globals->get_time_params()->get_cur_time();
+    resetUpdateQueue(0); // everything is due
 
     doingInit = false;
     inited = true;
@@ -675,15 +694,58 @@ void FGTrafficManager::loadHeuristics()
       }
     }
 
-  for(currAircraft = scheduledAircraft.begin(); currAircraft != scheduledAircraft.end(); ++currAircraft) {
-        const string& registration = (*currAircraft)->getRegistration();
+    for (auto schedule : scheduledAircraft) {
+        const string& registration = schedule->getRegistration();
         HeuristicMapIterator itr = heurMap.find(registration);
         if (itr != heurMap.end()) {
-            (*currAircraft)->setrunCount(itr->second.runCount);
-            (*currAircraft)->setHits(itr->second.hits);
-            (*currAircraft)->setLastUsed(itr->second.lastRun);
+            schedule->setrunCount(itr->second.runCount);
+            schedule->setHits(itr->second.hits);
+            schedule->setLastUsed(itr->second.lastRun);
+        }
+    }
+}
+
+void FGTrafficManager::resetUpdateQueue(time_t due)
+{
+    updateQueue = ScheduleQueue();
+    unsigned int rank = 0;
+    for (auto schedule : scheduledAircraft) {
+        if (schedule->isValid()) {
+            updateQueue.push(QueuedSchedule{due, rank, schedule});
+        }
+        ++rank;
+    }
+}
+
+/**
+ * Distant schedules are deferred on the assumption that the user flies no
+ * faster than userSpeedBound. Returns true when that no longer holds, e.g.
+ * after a relocation, a jump in the time of day, or simply a fast aircraft.
+ */
+bool FGTrafficManager::userMovedTooFast(const SGVec3d& userCart, time_t now, double dt)
+{
+    const double movedNm = dist(userCart, lastUserCart) * SG_METER_TO_NM;
+    const bool timeJumpedBack = now < lastUpdateTime;
+    lastUserCart = userCart;
+    lastUpdateTime = now;
+
+    // allow some slack for the sim time and position not advancing in step
+    const double allowedNm = userSpeedBound * (dt + 1.0) / 3600.0;
+    if (!timeJumpedBack && movedNm <= allowedNm) {
+        return false;
+    }
+
+    // a plausible speed means a fast aircraft: raise the bound, so the
+    // queue is not reset every frame. Anything else is a relocation.
+    if (dt > 0.0) {
+        const double speedKt = movedNm * 3600.0 / dt;
+        if (speedKt < 4000.0) {
+            userSpeedBound = std::max(userSpeedBound, speedKt * 1.25);
         }
     }
+    SG_LOG(SG_AI, SG_DEBUG, "Traffic manager: user moved " << movedNm
+           << "nm, rescheduling all aircraft");
+    return true;
 }
 
 bool FGTrafficManager::metarReady(double dt)
@@ -756,18 +818,46 @@ void FGTrafficManager::update(double dt)
     }
 
     SGVec3d userCart = globals->get_aircraft_position_cart();
+    time_t now = globals->get_time_params()->get_cur_time();
 
-    if (currAircraft == scheduledAircraft.end()) {
-        currAircraft = scheduledAircraft.begin();
+    userSpeedBound = std::max(userSpeedBound, maxUserSpeedNode->getDoubleValue());
+    if (userMovedTooFast(userCart, now, dt)) {
+        resetUpdateQueue(now);
     }
 
-    time_t now = globals->get_time_params()->get_cur_time();
+    // Service the schedules which are due, most urgent first, until the
+    // time budget for this frame is used up. At least one is processed
+    // per frame, as before, so a small budget can't stall the traffic.
+    SGTimeStamp start;
+    start.stamp();
+    const double budgetMSec = updateBudgetNode->getDoubleValue();
+    int processed = 0;
+    while (!updateQueue.empty() && (updateQueue.top().due <= now)) {
+        if (processed > 0 && start.elapsedMSec() >= budgetMSec) {
+            break;
+        }
 
-    //cerr << "Processing << " << (*currAircraft)->getRegistration() << " with score " << (*currAircraft)->getScore() << endl;
-    if ((*currAircraft)->update(now, userCart)) {
-        // schedule is done - process another aircraft in next iteration
-        currAircraft++;
+        QueuedSchedule entry = updateQueue.top();
+        updateQueue.pop();
+        ++processed;
+
+        //cerr << "Processing << " << entry.schedule->getRegistration() << " with score " << entry.schedule->getScore() << endl;
+        if (!entry.schedule->update(now, userCart, userSpeedBound)) {
+            // more time required: keep its place at the front of the queue
+            updateQueue.push(entry);
+            break;
+        }
+
+        if (entry.schedule->isValid()) {
+            entry.due = std::max(entry.schedule->getNextUpdateTime(), now);
+            updateQueue.push(entry);
+        }
     }
+
+    queueSizeNode->setIntValue(static_cast<int>(updateQueue.size()));
+    processedNode->setIntValue(processed);
+    lateNode->setIntValue(updateQueue.empty() ? 0 :
+                          static_cast<int>(std::max<time_t>(0, now - updateQueue.top().due)));
 }
 
 void FGTrafficManager::readTimeTableFromFile(SGPath infileName)
@@ -48,6 +48,7 @@
 
 #include <set>
 #include <memory>
+#include <queue>
 
 #include <simgear/structure/subsystem_mgr.hxx>
 #include <simgear/props/propertyObject.hxx>
@@ -85,7 +86,32 @@ private:
     std::string waitingMetarStation;
 
     ScheduleVector scheduledAircraft;
-    ScheduleVectorIterator currAircraft, currAircraftClosest;
+
+    // Schedules ordered by the time they next need attention. Equal times
+    // are served in order of score, i.e. the order of scheduledAircraft.
+    struct QueuedSchedule
+    {
+        time_t due;
+        unsigned int rank;
+        FGAISchedule* schedule;
+
+        bool operator>(const QueuedSchedule& other) const
+        {
+            return (due != other.due) ? (due > other.due) : (rank > other.rank);
+        }
+    };
+    typedef std::priority_queue<QueuedSchedule, std::vector<QueuedSchedule>,
+                                std::greater<QueuedSchedule> > ScheduleQueue;
+    ScheduleQueue updateQueue;
+
+    // where the user was at the last update, to catch them moving faster
+    // than the schedules were told to expect
+    SGVec3d lastUserCart;
+    time_t lastUpdateTime;
+    double userSpeedBound;
+
+    SGPropertyNode_ptr maxUserSpeedNode, updateBudgetNode;
+    SGPropertyNode_ptr queueSizeNode, processedNode, lateNode;
 
     FGScheduledFlightMap flights;
 
@@ -95,6 +121,8 @@ private:
     simgear::PropertyObject<bool> enabled, aiEnabled, realWxEnabled, metarValid, active, aiDataUpdateNow;
 
     void loadHeuristics();
+    void resetUpdateQueue(time_t due);
+    bool userMovedTooFast(const SGVec3d& userCart, time_t now, double dt);
 
     bool doDataSync();
     void finishInit();
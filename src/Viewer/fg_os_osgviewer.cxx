@@ -44,6 +44,7 @@
 #include <osgViewer/Viewer>
 #include <osgViewer/GraphicsWindow>
 
+#include <FDM/fdm_thread.hxx>
 #include <Scenery/scenery.hxx>
 #include <Main/fg_os.hxx>
 #include <Main/fg_props.hxx>
@@ -363,6 +364,11 @@ int fgOSMainLoop()
     }
 
     while (!viewer_base->done()) {
+        // keeps a threaded FDM from stepping during the frame: the update,
+        // cull and draw traversals all read the property tree and the FDM
+        FDMThread::yieldMainLoop();
+        std::lock_guard<std::timed_mutex> fdmLock(FDMThread::mainLoopMutex());
+
         fgIdleHandler idleFunc = globals->get_renderer()->getEventHandler()->getIdleHandler();
         if (idleFunc)
         {
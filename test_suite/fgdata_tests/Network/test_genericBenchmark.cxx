@@ -0,0 +1,94 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "config.h"
+
+#include "test_genericBenchmark.hxx"
+
+#include <simgear/misc/sg_dir.hxx>
+#include <simgear/props/props_io.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <Main/globals.hxx>
+#include <Network/generic.hxx>
+
+namespace {
+
+const int BENCHMARK_MESSAGES = 10000;
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void GenericProtocolBenchmarks::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("generic-benchmark");
+}
+
+
+// Clean up after each test.
+void GenericProtocolBenchmarks::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+// Generates messages for each of the output protocols shipped in
+// $FG_ROOT/Protocol, and reports the cost per message so that changes to
+// the generic protocol can be tracked.
+void GenericProtocolBenchmarks::testOutputBenchmark()
+{
+    const simgear::PathList files =
+        simgear::Dir(globals->get_fg_root() / "Protocol").children(simgear::Dir::TYPE_FILE, ".xml");
+
+    // only used to configure the channel, messages are generated in memory
+    const SGPath outPath = globals->get_fg_home() / "generic-benchmark.out";
+
+    int protocols = 0;
+    for (const SGPath& file : files) {
+        SGPropertyNode root;
+        try {
+            readProperties(file, &root);
+        } catch (const sg_exception&) {
+            continue;
+        }
+        if (!root.getNode("generic/output"))
+            continue;
+
+        const std::string name = file.file_base();
+        FGGeneric generic({"generic", "file", "out", "60", outPath.utf8Str(), name});
+        if (!generic.getInitOk())
+            continue;
+
+        SGTimeStamp st;
+        st.stamp();
+        for (int i = 0; i < BENCHMARK_MESSAGES; ++i)
+            CPPUNIT_ASSERT(generic.gen_message());
+        const double elapsed = (SGTimeStamp::now() - st).toUSecs();
+
+        SG_LOG(SG_NETWORK, SG_INFO, "Generic protocol benchmark (" << name << "): "
+               << BENCHMARK_MESSAGES << " messages in " << elapsed / 1000.0 << "ms, "
+               << 1000.0 * elapsed / BENCHMARK_MESSAGES << "ns/message");
+        ++protocols;
+    }
+
+    SG_LOG(SG_NETWORK, SG_INFO, "Generic protocol benchmark: " << protocols << " protocols");
+    CPPUNIT_ASSERT(protocols > 0);
+}
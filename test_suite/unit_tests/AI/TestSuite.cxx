@@ -19,6 +19,7 @@
 
 #include "test_AIFlightPlan.hxx"
 #include "test_AIManager.hxx"
+#include "test_AISpatialGrid.hxx"
 #include "test_groundnet.hxx"
 #include "test_traffic.hxx"
 #include "test_TrafficMgr.hxx"
@@ -27,6 +28,7 @@
 
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(AIFlightPlanTests, "Unit tests");
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(AIManagerTests, "Unit tests");
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(AISpatialGridTests, "Unit tests");
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(GroundnetTests, "Unit tests");
 // CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(TrafficTests, "Unit tests");
 // CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(TrafficMgrTests, "Unit tests");
@@ -21,6 +21,9 @@
 
 #include <cstring>
 #include <memory>
+#include <vector>
+
+#include <simgear/timing/timestamp.hxx>
 
 #include "test_suite/FGTestApi/NavDataCache.hxx"
 #include "test_suite/FGTestApi/TestDataLogger.hxx"
@@ -129,3 +132,196 @@ void AIManagerTests::testAircraftWaypoints()
     std::unique_ptr<FGAIFlightPlan> aiFP(new FGAIFlightPlan);
     ai->setFlightPlan(std::move(aiFP));    
 }
+
+// The kinematics of aircraft running on the worker threads must give
+// exactly the same result as the serial update.
+void AIManagerTests::testParallelUpdate()
+{
+    auto aim = globals->get_subsystem<FGAIManager>();
+    auto eggd = FGAirport::findByIdent("EGGD");
+    FGTestApi::setPositionAndStabilise(eggd->geod());
+
+    const int numAircraft = 40;
+
+    auto run = [&](bool parallel) {
+        fgSetBool("/sim/ai/parallel-update/enabled", parallel);
+        fgSetInt("/sim/ai/parallel-update/threads", 3);
+
+        std::vector<FGAIBasePtr> aircraft;
+        for (int i = 0; i < numAircraft; ++i) {
+            SGPropertyNode_ptr def(new SGPropertyNode);
+            def->setStringValue("type", "aircraft");
+            def->setStringValue("callsign", "PAR" + std::to_string(i));
+            def->setDoubleValue("heading", i * 9.0);
+            def->setDoubleValue("latitude", eggd->geod().getLatitudeDeg() + i * 0.01);
+            def->setDoubleValue("longitude", eggd->geod().getLongitudeDeg());
+            def->setDoubleValue("altitude", 6000.0 + i * 100.0);
+            def->setDoubleValue("speed", 200.0 + i);
+
+            auto ai = aim->addObject(def);
+            CPPUNIT_ASSERT(ai);
+            ai->setFlightPlan(std::unique_ptr<FGAIFlightPlan>(new FGAIFlightPlan));
+            aircraft.push_back(ai);
+        }
+
+        for (int i = 0; i < 20; ++i) {
+            aim->update(0.1);
+        }
+
+        std::vector<SGGeod> positions;
+        for (auto ai : aircraft) {
+            CPPUNIT_ASSERT(!ai->getDie());
+            positions.push_back(ai->getGeodPos());
+            ai->setDie(true);
+        }
+        aim->update(0.1); // removes them again
+        return positions;
+    };
+
+    const auto serial = run(false);
+    CPPUNIT_ASSERT_EQUAL(0, fgGetInt("/sim/ai/performance/worker-threads"));
+
+    const auto parallel = run(true);
+    CPPUNIT_ASSERT_EQUAL(3, fgGetInt("/sim/ai/performance/worker-threads"));
+
+    for (int i = 0; i < numAircraft; ++i) {
+        CPPUNIT_ASSERT_EQUAL(serial[i].getLatitudeDeg(), parallel[i].getLatitudeDeg());
+        CPPUNIT_ASSERT_EQUAL(serial[i].getLongitudeDeg(), parallel[i].getLongitudeDeg());
+        CPPUNIT_ASSERT_EQUAL(serial[i].getElevationFt(), parallel[i].getElevationFt());
+    }
+
+    // the aircraft moved, so the comparison above means something
+    CPPUNIT_ASSERT(serial[0].getLatitudeDeg() > eggd->geod().getLatitudeDeg() + 1e-4);
+}
+
+// Thousands of ballistic objects with collision checks, as from a gun or
+// flare dispenser, among a field of targets
+void AIManagerTests::testBallisticCollisions()
+{
+    auto aim = globals->get_subsystem<FGAIManager>();
+    auto eggd = FGAirport::findByIdent("EGGD");
+    FGTestApi::setPositionAndStabilise(eggd->geod());
+
+    const int numTargets = 50;
+    const int numBallistic = 3000;
+    const double targetAltFt = 3000.0;
+
+    std::vector<FGAIBasePtr> targets;
+    for (int i = 0; i < numTargets; ++i) {
+        SGPropertyNode_ptr def(new SGPropertyNode);
+        def->setStringValue("type", "static");
+        def->setStringValue("name", "target" + std::to_string(i));
+        def->setDoubleValue("latitude", eggd->geod().getLatitudeDeg() + i * 0.02);
+        def->setDoubleValue("longitude", eggd->geod().getLongitudeDeg());
+        def->setDoubleValue("altitude", targetAltFt);
+
+        auto ai = aim->addObject(def);
+        CPPUNIT_ASSERT(ai);
+        targets.push_back(ai);
+    }
+
+    // every other one starts just above a target, the rest well clear
+    std::vector<FGAIBasePtr> ballistic;
+    for (int i = 0; i < numBallistic; ++i) {
+        const bool aimed = (i % 2) == 0;
+        const SGGeod target = targets[i % numTargets]->getGeodPos();
+
+        SGPropertyNode_ptr def(new SGPropertyNode);
+        def->setStringValue("type", "ballistic");
+        def->setStringValue("name", "round");
+        def->setDoubleValue("latitude", target.getLatitudeDeg());
+        def->setDoubleValue("longitude", target.getLongitudeDeg() + (aimed ? 0.0 : 0.05));
+        def->setDoubleValue("altitude", targetAltFt + 20.0);
+        def->setDoubleValue("speed", 0.0);
+        def->setDoubleValue("elevation", -90.0);
+        def->setDoubleValue("life", 100.0);
+        def->setBoolValue("collision", true);
+        def->setStringValue("impact-reports", "/ai/models/model-impact");
+
+        auto ai = aim->addObject(def);
+        CPPUNIT_ASSERT(ai);
+        ballistic.push_back(ai);
+    }
+
+    SGTimeStamp st = SGTimeStamp::now();
+    const int frames = 10;
+    for (int i = 0; i < frames; ++i) {
+        aim->update(0.02);
+    }
+    SG_LOG(SG_AI, SG_INFO, numBallistic << " ballistic objects, " << numTargets
+           << " targets: " << (SGTimeStamp::now() - st).toUSecs() / frames << "us per update");
+
+    for (int i = 0; i < numBallistic; ++i) {
+        CPPUNIT_ASSERT_EQUAL((i % 2) == 0, ballistic[i]->_getCollisionData());
+        ballistic[i]->setDie(true);
+    }
+    for (auto ai : targets) {
+        ai->setDie(true);
+    }
+    aim->update(0.02);
+    CPPUNIT_ASSERT(aim->get_ai_list().empty());
+}
+
+void AIManagerTests::testTrafficSnapshot()
+{
+    auto aim = globals->get_subsystem<FGAIManager>();
+    auto eggd = FGAirport::findByIdent("EGGD");
+    FGTestApi::setPositionAndStabilise(eggd->geod());
+
+    std::vector<FGAIBasePtr> aircraft;
+    for (int i = 0; i < 5; ++i) {
+        SGPropertyNode_ptr def(new SGPropertyNode);
+        def->setStringValue("type", "aircraft");
+        def->setStringValue("callsign", "SNP" + std::to_string(i));
+        def->setDoubleValue("heading", i * 30.0);
+        def->setDoubleValue("latitude", eggd->geod().getLatitudeDeg() + i * 0.01);
+        def->setDoubleValue("longitude", eggd->geod().getLongitudeDeg());
+        def->setDoubleValue("altitude", 5000.0 + i * 500.0);
+        def->setDoubleValue("speed", 180.0);
+
+        auto ai = aim->addObject(def);
+        CPPUNIT_ASSERT(ai);
+        ai->setFlightPlan(std::unique_ptr<FGAIFlightPlan>(new FGAIFlightPlan));
+        aircraft.push_back(ai);
+    }
+
+    aim->update(0.1);
+    FGTrafficSnapshotRef first = aim->trafficSnapshot();
+    CPPUNIT_ASSERT(first);
+    CPPUNIT_ASSERT_EQUAL(aircraft.size(), first->size());
+
+    for (auto ai : aircraft) {
+        const FGTrafficEntry* entry = first->findById(ai->getID());
+        CPPUNIT_ASSERT(entry);
+        CPPUNIT_ASSERT_EQUAL(std::string(ai->_getCallsign()), entry->callsign);
+        CPPUNIT_ASSERT_EQUAL(std::string("aircraft"), entry->typeName);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(ai->getGeodPos().getLatitudeDeg(),
+                                     entry->position.getLatitudeDeg(), 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(ai->getGeodPos().getElevationFt(),
+                                     entry->position.getElevationFt(), 1e-6);
+        CPPUNIT_ASSERT(entry->props);
+        CPPUNIT_ASSERT(entry == first->findByCallsign(entry->callsign));
+    }
+
+    // a held snapshot stays as it was while the traffic moves on
+    const double lat0 = first->findById(aircraft[0]->getID())->position.getLatitudeDeg();
+    aircraft[4]->setDie(true);
+    for (int i = 0; i < 10; ++i) {
+        aim->update(0.1);
+    }
+
+    FGTrafficSnapshotRef latest = aim->trafficSnapshot();
+    CPPUNIT_ASSERT(latest != first);
+    CPPUNIT_ASSERT_EQUAL(first->frame() + 10, latest->frame());
+    CPPUNIT_ASSERT_EQUAL(aircraft.size(), first->size());
+    CPPUNIT_ASSERT_EQUAL(aircraft.size() - 1, latest->size());
+    CPPUNIT_ASSERT(!latest->findById(aircraft[4]->getID()));
+    CPPUNIT_ASSERT_EQUAL(lat0, first->findById(aircraft[0]->getID())->position.getLatitudeDeg());
+    CPPUNIT_ASSERT(latest->findById(aircraft[0]->getID())->position.getLatitudeDeg() != lat0);
+
+    for (auto ai : aircraft) {
+        ai->setDie(true);
+    }
+    aim->update(0.1);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), aim->trafficSnapshot()->size());
+}
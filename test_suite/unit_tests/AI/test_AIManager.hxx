@@ -35,6 +35,9 @@ class AIManagerTests : public CppUnit::TestFixture
     CPPUNIT_TEST_SUITE(AIManagerTests);
     CPPUNIT_TEST(testBasic);
     CPPUNIT_TEST(testAircraftWaypoints);
+    CPPUNIT_TEST(testParallelUpdate);
+    CPPUNIT_TEST(testBallisticCollisions);
+    CPPUNIT_TEST(testTrafficSnapshot);
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -49,4 +52,7 @@ public:
     // The tests.
     void testBasic();
     void testAircraftWaypoints();
+    void testParallelUpdate();
+    void testBallisticCollisions();
+    void testTrafficSnapshot();
 };
@@ -0,0 +1,188 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_AISpatialGrid.hxx"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <AIModel/AISpatialGrid.hxx>
+
+namespace {
+
+struct Object
+{
+    FGAIBase* object;
+    SGVec3d cartPos;
+};
+
+// The grid never dereferences the objects, so any distinct pointer will do
+FGAIBase* fakeObject(size_t i)
+{
+    return reinterpret_cast<FGAIBase*>(static_cast<uintptr_t>(i + 1) * 16);
+}
+
+// Objects scattered within 20km of a point near Bristol, some stacked
+std::vector<Object> makeObjects(size_t count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(-20000.0, 20000.0);
+    const SGVec3d center = SGVec3d::fromGeod(SGGeod::fromDegM(-2.7, 51.4, 1000.0));
+
+    std::vector<Object> objects;
+    for (size_t i = 0; i < count; ++i) {
+        SGVec3d pos = center + SGVec3d(u(rng), u(rng), u(rng) * 0.1);
+        if ((i % 10 == 1) && !objects.empty()) {
+            pos = objects.back().cartPos;
+        }
+        objects.push_back({fakeObject(i), pos});
+    }
+    return objects;
+}
+
+void fill(FGAISpatialGrid& grid, const std::vector<Object>& objects)
+{
+    grid.clear();
+    for (const auto& o : objects) {
+        grid.insert(o.object, o.cartPos);
+    }
+    grid.build();
+}
+
+std::set<FGAIBase*> found(const FGAISpatialGrid::ResultList& results)
+{
+    std::set<FGAIBase*> r;
+    for (const auto& result : results) {
+        CPPUNIT_ASSERT(r.insert(result.object).second); // no duplicates
+    }
+    return r;
+}
+
+} // of anonymous namespace
+
+void AISpatialGridTests::testRange()
+{
+    const auto objects = makeObjects(2000, 1);
+    const SGVec3d center = objects[7].cartPos;
+
+    for (double cellSize : {250.0, 1000.0, 5000.0}) {
+        FGAISpatialGrid grid(cellSize);
+        fill(grid, objects);
+        CPPUNIT_ASSERT_EQUAL(objects.size(), grid.size());
+
+        for (double range : {0.0, 300.0, 2500.0, 100000.0}) {
+            std::set<FGAIBase*> expected;
+            for (const auto& o : objects) {
+                if (dist(center, o.cartPos) <= range) {
+                    expected.insert(o.object);
+                }
+            }
+
+            FGAISpatialGrid::ResultList results;
+            grid.findInRange(center, range, results);
+            CPPUNIT_ASSERT(expected == found(results));
+            for (const auto& r : results) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(dist(center, r.cartPos), r.distanceM, 1e-6);
+            }
+        }
+    }
+
+    // empty again
+    FGAISpatialGrid grid;
+    fill(grid, objects);
+    grid.clear();
+    grid.build();
+    FGAISpatialGrid::ResultList results;
+    grid.findInRange(center, 100000.0, results);
+    CPPUNIT_ASSERT(results.empty());
+}
+
+void AISpatialGridTests::testNearest()
+{
+    const auto objects = makeObjects(1000, 2);
+    FGAISpatialGrid grid(500.0);
+    fill(grid, objects);
+
+    const SGVec3d center = objects[0].cartPos + SGVec3d(123.0, -45.0, 6.0);
+    std::vector<double> distances;
+    for (const auto& o : objects) {
+        distances.push_back(dist(center, o.cartPos));
+    }
+    std::sort(distances.begin(), distances.end());
+
+    FGAISpatialGrid::ResultList results;
+    grid.findNearest(center, 25, 1e6, results);
+    CPPUNIT_ASSERT_EQUAL(size_t(25), results.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(distances[i], results[i].distanceM, 1e-6);
+    }
+
+    // limited by range
+    grid.findNearest(center, 25, distances[4] + 1e-3, results);
+    CPPUNIT_ASSERT_EQUAL(size_t(5), results.size());
+
+    // more than there are
+    grid.findNearest(center, 5000, 1e6, results);
+    CPPUNIT_ASSERT_EQUAL(objects.size(), results.size());
+}
+
+void AISpatialGridTests::testSegment()
+{
+    const auto objects = makeObjects(2000, 3);
+    FGAISpatialGrid grid(1000.0);
+    fill(grid, objects);
+
+    auto segmentDist = [](const SGVec3d& a, const SGVec3d& b, const SGVec3d& p) {
+        const SGVec3d d = b - a;
+        const double t = SGMiscd::clip(dot(p - a, d) / dot(d, d), 0.0, 1.0);
+        return dist(a + t * d, p);
+    };
+
+    // a short hop, as a bullet covers in a frame, and a long one
+    const SGVec3d start = objects[3].cartPos + SGVec3d(10.0, 0.0, 0.0);
+    for (const SGVec3d& step : {SGVec3d(15.0, 5.0, -2.0), SGVec3d(20000.0, -15000.0, 500.0)}) {
+        const SGVec3d end = start + step;
+        for (double range : {60.0, 400.0}) {
+            std::set<FGAIBase*> expected;
+            for (const auto& o : objects) {
+                if (segmentDist(start, end, o.cartPos) <= range) {
+                    expected.insert(o.object);
+                }
+            }
+            CPPUNIT_ASSERT(!expected.empty());
+
+            FGAISpatialGrid::ResultList results;
+            grid.findNearSegment(start, end, range, results);
+            CPPUNIT_ASSERT(expected == found(results));
+            for (const auto& r : results) {
+                CPPUNIT_ASSERT(r.along >= 0.0 && r.along <= 1.0);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(dist(start + r.along * step, r.cartPos),
+                                             r.distanceM, 1e-6);
+            }
+        }
+    }
+
+    // a segment of zero length is a point
+    FGAISpatialGrid::ResultList results;
+    grid.findNearSegment(start, start, 100.0, results);
+    FGAISpatialGrid::ResultList pointResults;
+    grid.findInRange(start, 100.0, pointResults);
+    CPPUNIT_ASSERT(found(pointResults) == found(results));
+}
@@ -136,6 +136,10 @@ void TrafficMgrTests::testTrafficManager()
 
     FGTestApi::runForTime(360.0);
 
+    // every valid schedule stays queued, and they are all serviced in time
+    CPPUNIT_ASSERT(fgGetInt("/sim/traffic-manager/queue/size") > 0);
+    CPPUNIT_ASSERT_EQUAL(0, fgGetInt("/sim/traffic-manager/queue/late-sec"));
+
     FGScheduledFlightVecIterator fltBegin, fltEnd;
     fltBegin = tmgr->getFirstFlight("HBR_BN_2");
     fltEnd = tmgr->getLastFlight("HBR_BN_2");
@@ -0,0 +1,490 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "test_replay.hxx"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <Aircraft/replay.hxx>
+#include <Main/globals.hxx>
+#include <Main/fg_props.hxx>
+
+namespace {
+
+// Size of the data of each frame made by makeFrame().
+const size_t FRAME_DATA_SIZE = 16;
+
+// Size of an index footer entry: sim_time, offset and flags.
+const size_t INDEX_ENTRY_SIZE = sizeof(double) + sizeof(uint64_t) + sizeof(uint8_t);
+
+std::unique_ptr<FGReplayContinuousFrame> makeFrame(double sim_time)
+{
+    std::unique_ptr<FGReplayContinuousFrame> frame(new FGReplayContinuousFrame);
+    frame->sim_time = sim_time;
+    frame->flags = 1;
+    frame->data.assign(FRAME_DATA_SIZE, static_cast<char>(static_cast<int>(sim_time)));
+    return frame;
+}
+
+// Returns the times of the uncompressed frames made by makeFrame() in a
+// file written by FGReplayContinuousWriter.
+std::vector<double> readFrameTimes(const SGPath& path)
+{
+    sg_ifstream in(path, std::ios::in | std::ios::binary);
+    std::vector<double> times;
+    for (;;) {
+        double sim_time;
+        char data[FRAME_DATA_SIZE];
+        in.read(reinterpret_cast<char*>(&sim_time), sizeof(sim_time));
+        in.read(data, sizeof(data));
+        if (!in) {
+            break;
+        }
+        CPPUNIT_ASSERT_EQUAL(static_cast<char>(static_cast<int>(sim_time)), data[FRAME_DATA_SIZE - 1]);
+        times.push_back(sim_time);
+    }
+    return times;
+}
+
+// Size of the signal data made by signalsAt().
+const size_t SIGNALS_SIZE = 64;
+
+// Signal data of frame <i>: a fixed pattern with one byte changed, except
+// for frame 7 where everything changes.
+std::vector<char> signalsAt(int i)
+{
+    std::vector<char> signals(SIGNALS_SIZE);
+    for (size_t j = 0; j < SIGNALS_SIZE; ++j) {
+        signals[j] = static_cast<char>(j);
+    }
+    signals[i % SIGNALS_SIZE] = static_cast<char>(100 + i);
+    if (i == 7) {
+        for (char& c : signals) {
+            c = ~c;
+        }
+    }
+    return signals;
+}
+
+FGReplayData* makeData(int i)
+{
+    FGReplayData* r = new FGReplayData;
+    r->sim_time = i;
+    r->raw_data = signalsAt(i);
+    return r;
+}
+
+// Checks that <r> decodes to the signals it was made with.
+void checkSignals(const FGReplayData* r)
+{
+    const std::vector<char> expected = signalsAt(static_cast<int>(r->sim_time));
+    std::vector<char> scratch;
+    const char* signals = r->signals(scratch);
+    CPPUNIT_ASSERT(signals != nullptr);
+    CPPUNIT_ASSERT_EQUAL(expected.size(), r->signalsSize());
+    CPPUNIT_ASSERT(std::equal(expected.begin(), expected.end(), signals));
+}
+
+// Copies the first <size> bytes of <from> to <to>.
+void copyPrefix(const SGPath& from, const SGPath& to, size_t size)
+{
+    sg_ifstream in(from, std::ios::in | std::ios::binary);
+    std::vector<char> data(size);
+    in.read(data.data(), data.size());
+    CPPUNIT_ASSERT(in.good());
+    sg_ofstream out(to, std::ios::out | std::ios::binary);
+    out.write(data.data(), data.size());
+}
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void ReplayTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("replay");
+}
+
+
+// Clean up after each test.
+void ReplayTests::tearDown()
+{
+    FGReplayData::resetStatisticsProperties();
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void ReplayTests::testContinuousWriterQueue()
+{
+    const SGPath path = globals->get_fg_home() / "writer-queue.fgtape";
+    std::ofstream out(path.utf8Str(), std::ios::binary);
+    std::vector<char> index;
+    FGReplayContinuousWriter writer(out, 0 /*compression*/, &index, 4);
+
+    // Nothing is written before the thread starts, so the queue fills up and
+    // further frames are dropped.
+    for (int i = 0; i < 4; ++i) {
+        CPPUNIT_ASSERT(writer.push(makeFrame(i)));
+    }
+    CPPUNIT_ASSERT(!writer.push(makeFrame(4)));
+    CPPUNIT_ASSERT(!writer.push(makeFrame(5)));
+    CPPUNIT_ASSERT_EQUAL(size_t(4), writer.depth());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), writer.dropped());
+
+    writer.start();
+    writer.stop();
+    out.close();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), writer.depth());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), writer.dropped());
+
+    // The queued frames are written in order, each with an index entry
+    // pointing at it.
+    const std::vector<double> expected = {0, 1, 2, 3};
+    CPPUNIT_ASSERT(readFrameTimes(path) == expected);
+    CPPUNIT_ASSERT_EQUAL(expected.size() * INDEX_ENTRY_SIZE, index.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const char* entry = &index[i * INDEX_ENTRY_SIZE];
+        double      sim_time;
+        uint64_t    offset;
+        memcpy(&sim_time, entry, sizeof(sim_time));
+        memcpy(&offset, entry + sizeof(sim_time), sizeof(offset));
+        CPPUNIT_ASSERT_EQUAL(expected[i], sim_time);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(i * (sizeof(double) + FRAME_DATA_SIZE)), offset);
+        CPPUNIT_ASSERT_EQUAL(char(1), entry[INDEX_ENTRY_SIZE - 1]);
+    }
+}
+
+
+void ReplayTests::testContinuousWriterShutdown()
+{
+    const SGPath path = globals->get_fg_home() / "writer-shutdown.fgtape";
+    std::ofstream out(path.utf8Str(), std::ios::binary);
+    FGReplayContinuousWriter writer(out, 0 /*compression*/, nullptr, 8);
+    writer.start();
+
+    // A frame pushed while the writer is idle wakes it up.
+    CPPUNIT_ASSERT(writer.push(makeFrame(0)));
+    SGTimeStamp stamp;
+    stamp.stamp();
+    while (writer.depth() > 0 && stamp.elapsedMSec() < 5000) {
+        SGTimeStamp::sleepForMSec(1);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(0), writer.depth());
+
+    // Push faster than the writer can keep up with, then stop() must still
+    // write every frame that was not dropped.
+    size_t pushed = 1;
+    for (int i = 1; i < 1000; ++i) {
+        if (writer.push(makeFrame(i))) {
+            ++pushed;
+        }
+    }
+    writer.stop();
+    out.close();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), writer.depth());
+    CPPUNIT_ASSERT_EQUAL(size_t(1000), pushed + writer.dropped());
+
+    const std::vector<double> times = readFrameTimes(path);
+    CPPUNIT_ASSERT_EQUAL(pushed, times.size());
+    CPPUNIT_ASSERT(std::is_sorted(times.begin(), times.end()));
+
+    // An idle writer stops too.
+    std::ofstream unused;
+    FGReplayContinuousWriter idle(unused, 0 /*compression*/, nullptr, 8);
+    idle.start();
+    idle.stop();
+}
+
+
+void ReplayTests::testContinuousIndexFooter()
+{
+    FGReplay replay;
+    SGPropertyNode_ptr config = new SGPropertyNode;
+    config->addChild("data")->setStringValue("signals");
+    config->setBoolValue("meta/continuous-index", true);
+
+    // Record a tape with an index footer. The indexing doesn't look at the
+    // header, so a placeholder will do.
+    const SGPath path = globals->get_fg_home() / "footer.fgtape";
+    const std::string header = "continuous recording header";
+    const int num_frames = 20;
+    std::vector<uint64_t> offsets;
+    replay.m_continuous_out.open(path.utf8Str(), std::ios::binary);
+    replay.m_continuous_out << header;
+    replay.m_continuous_out_config = config;
+    replay.m_continuous_out_compression = 0;
+    for (int i = 0; i < num_frames; ++i) {
+        FGReplayData r;
+        r.sim_time = i * 0.5;
+        r.raw_data.assign(32, static_cast<char>(i));
+        offsets.push_back(replay.m_continuous_out.tellp());
+        CPPUNIT_ASSERT(replay.continuousWriteFrame(&r, replay.m_continuous_out, config,
+                                                   &replay.m_continuous_out_index));
+    }
+    const uint64_t footer_offset = replay.m_continuous_out.tellp();
+    replay.continuousStopRecording();
+    CPPUNIT_ASSERT(path.sizeInBytes() > footer_offset);
+
+    auto index = [&](const SGPath& tape) {
+        replay.m_continuous_in_config = config;
+        replay.m_continuous_in_compression = 0;
+        return replay.indexContinuousRecordingFile(tape, header.size(), nullptr);
+    };
+
+    // Whichever way the index was made, seeking by time finds the frame
+    // written at that time.
+    auto checkSeek = [&](const SGPath& tape) {
+        const FGReplayFrameIndex& frames = replay.m_continuous_in_frame_index;
+        CPPUNIT_ASSERT_EQUAL(size_t(num_frames), frames.size());
+        sg_ifstream in(tape, std::ios::in | std::ios::binary);
+        for (int i = 0; i < num_frames; ++i) {
+            const double sim_time = i * 0.5;
+            size_t pos = frames.lowerBound(sim_time - 0.1);
+            CPPUNIT_ASSERT_EQUAL(size_t(i), pos);
+            CPPUNIT_ASSERT_EQUAL(sim_time, frames.time(pos));
+            CPPUNIT_ASSERT_EQUAL(size_t(i + 1), frames.upperBound(sim_time));
+
+            const FGFrameInfo info = frames.frameInfo(pos);
+            CPPUNIT_ASSERT_EQUAL(size_t(offsets[i]), info.offset);
+            CPPUNIT_ASSERT(info.has_signals);
+            CPPUNIT_ASSERT(!info.has_multiplayer);
+            CPPUNIT_ASSERT(!info.has_extra_properties);
+
+            double frame_time;
+            in.seekg(info.offset);
+            in.read(reinterpret_cast<char*>(&frame_time), sizeof(frame_time));
+            CPPUNIT_ASSERT_EQUAL(sim_time, frame_time);
+        }
+        CPPUNIT_ASSERT_EQUAL(size_t(0), frames.lowerBound(-1.0));
+        CPPUNIT_ASSERT_EQUAL(frames.size(), frames.lowerBound(num_frames));
+        CPPUNIT_ASSERT_EQUAL(num_frames * 0.5 - 0.5, fgGetDouble("/sim/replay/end-time"));
+    };
+
+    CPPUNIT_ASSERT(index(path));
+    checkSeek(path);
+
+    // A truncated footer is ignored and the frames are scanned instead,
+    // stopping at the start of the footer.
+    const SGPath truncated = globals->get_fg_home() / "footer-truncated.fgtape";
+    copyPrefix(path, truncated, path.sizeInBytes() - 4);
+    CPPUNIT_ASSERT(!index(truncated));
+    checkSeek(truncated);
+
+    // So is a missing one, e.g. after a crash while recording.
+    const SGPath absent = globals->get_fg_home() / "footer-absent.fgtape";
+    copyPrefix(path, absent, footer_offset);
+    CPPUNIT_ASSERT(!index(absent));
+    checkSeek(absent);
+}
+
+
+void ReplayTests::testFrameIndexAdd()
+{
+    FGReplayFrameIndex frames;
+    FGFrameInfo info;
+    info.has_signals = true;
+
+    for (int i : {0, 1, 3, 2}) {
+        info.offset = 100 * i;
+        info.has_multiplayer = (i == 3);
+        frames.add(i, info);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(4), frames.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        CPPUNIT_ASSERT_EQUAL(double(i), frames.time(i));
+        CPPUNIT_ASSERT_EQUAL(100 * i, frames.frameInfo(i).offset);
+        CPPUNIT_ASSERT(frames.frameInfo(i).has_signals);
+        CPPUNIT_ASSERT_EQUAL(i == 3, frames.frameInfo(i).has_multiplayer);
+    }
+
+    // A repeated time replaces the earlier frame.
+    info.offset = 1000;
+    info.has_extra_properties = true;
+    frames.add(1, info);
+    CPPUNIT_ASSERT_EQUAL(size_t(4), frames.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1000), frames.frameInfo(1).offset);
+    CPPUNIT_ASSERT(frames.frameInfo(1).has_extra_properties);
+    CPPUNIT_ASSERT_EQUAL(size_t(200), frames.frameInfo(2).offset);
+
+    frames.clear();
+    CPPUNIT_ASSERT(frames.empty());
+}
+
+
+void ReplayTests::testDeltaEncoding()
+{
+    FGReplayDeltaEncoder encoder;
+    encoder.setKeyframeInterval(4);
+    std::vector<std::unique_ptr<FGReplayData>> frames;
+    for (int i = 0; i < 12; ++i) {
+        frames.emplace_back(makeData(i));
+        encoder.encode(frames.back().get());
+    }
+
+    // Frame 5 starts a keyframe after four deltas. Frame 7 changes too much
+    // for a delta, and so does frame 8 against it.
+    for (int i = 0; i < 12; ++i) {
+        const FGReplayData* r = frames[i].get();
+        CPPUNIT_ASSERT(r->keyframe);
+        const bool is_keyframe = (i == 0 || i == 5 || i == 7 || i == 8);
+        CPPUNIT_ASSERT_EQUAL(is_keyframe, r->raw_data.empty());
+        if (!is_keyframe) {
+            CPPUNIT_ASSERT(r->raw_data.size() < SIGNALS_SIZE / 2);
+            CPPUNIT_ASSERT(r->keyframe == frames[i - 1]->keyframe);
+        }
+        checkSignals(r);
+    }
+
+    // Re-encoding against another encoder's keyframes, as when frames move
+    // to the next list, keeps the data.
+    FGReplayDeltaEncoder sparse;
+    sparse.setKeyframeInterval(2);
+    for (int i = 0; i < 12; i += 2) {
+        sparse.encode(frames[i].get());
+        checkSignals(frames[i].get());
+    }
+
+    // Decoding makes the frames complete again.
+    for (auto& r : frames) {
+        r->deltaDecode();
+        CPPUNIT_ASSERT(!r->keyframe);
+        CPPUNIT_ASSERT(r->raw_data == signalsAt(static_cast<int>(r->sim_time)));
+    }
+}
+
+
+void ReplayTests::testKeyframeLifetime()
+{
+    const size_t baseline = FGReplayData::s_bytes_keyframes;
+    auto keyframeBytes = [baseline]() {
+        return FGReplayData::s_bytes_keyframes - baseline;
+    };
+
+    FGReplayDeltaEncoder encoder;
+    encoder.setKeyframeInterval(4);
+    std::deque<std::unique_ptr<FGReplayData>> frames;
+    for (int i = 0; i < 10; ++i) {
+        frames.emplace_back(makeData(i));
+        encoder.encode(frames.back().get());
+    }
+
+    // Keyframes at frames 0, 5, 7 and 8 (see testDeltaEncoding()), each
+    // counted once however many frames share it.
+    CPPUNIT_ASSERT_EQUAL(4 * SIGNALS_SIZE, keyframeBytes());
+
+    // A keyframe is released with the last frame using it.
+    auto dropUntil = [&frames](int sim_time) {
+        while (frames.front()->sim_time < sim_time) {
+            frames.pop_front();
+        }
+    };
+    dropUntil(4);
+    CPPUNIT_ASSERT_EQUAL(4 * SIGNALS_SIZE, keyframeBytes());
+    dropUntil(5);
+    CPPUNIT_ASSERT_EQUAL(3 * SIGNALS_SIZE, keyframeBytes());
+    dropUntil(7);
+    CPPUNIT_ASSERT_EQUAL(2 * SIGNALS_SIZE, keyframeBytes());
+    dropUntil(8);
+    CPPUNIT_ASSERT_EQUAL(SIGNALS_SIZE, keyframeBytes());
+
+    // The encoder keeps its current keyframe alive too.
+    frames.clear();
+    CPPUNIT_ASSERT_EQUAL(SIGNALS_SIZE, keyframeBytes());
+    encoder.reset();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), keyframeBytes());
+
+    // Decoding a frame releases its keyframe.
+    frames.emplace_back(makeData(0));
+    encoder.encode(frames.back().get());
+    encoder.reset();
+    CPPUNIT_ASSERT_EQUAL(SIGNALS_SIZE, keyframeBytes());
+    frames.back()->deltaDecode();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), keyframeBytes());
+}
+
+
+void ReplayTests::testMemoryBudget()
+{
+    FGReplay replay;
+    const size_t baseline = FGReplayData::s_bytes_keyframes;
+
+    auto add = [](replay_list_type& list, FGReplayDeltaEncoder& encoder, int i) {
+        FGReplayData* r = makeData(i);
+        encoder.encode(r);
+        r->UpdateStats();
+        list.push_back(r);
+    };
+    for (int i = 0; i < 10; ++i) {
+        add(replay.long_term, replay.m_long_term_encoder, i);
+        add(replay.medium_term, replay.m_medium_term_encoder, 10 + i);
+        add(replay.short_term, replay.m_short_term_encoder, 20 + i);
+    }
+    replay.recountBufferBytes();
+
+    // Tightening the budget one frame at a time recycles the oldest long
+    // term frame, then the oldest medium term frame, then the oldest short
+    // term frame, but always keeps the newest one.
+    std::vector<replay_list_type*> lists = {&replay.long_term, &replay.medium_term, &replay.short_term};
+    for (replay_list_type* list : lists) {
+        const size_t keep = (list == &replay.short_term) ? 1 : 0;
+        while (list->size() > keep) {
+            std::vector<size_t> sizes;
+            for (auto l : lists) {
+                sizes.push_back(l->size());
+            }
+            const double oldest = list->front()->sim_time;
+            const size_t recycled = replay.recycler.size();
+
+            const size_t budget = replay.bufferBytes() - 1;
+            replay.applyMemoryBudget(budget);
+            CPPUNIT_ASSERT(replay.bufferBytes() <= budget);
+            CPPUNIT_ASSERT_EQUAL(recycled + 1, replay.recycler.size());
+            CPPUNIT_ASSERT_EQUAL(oldest, replay.recycler.back()->sim_time);
+            CPPUNIT_ASSERT(!replay.recycler.back()->keyframe);
+            for (size_t l = 0; l < lists.size(); ++l) {
+                CPPUNIT_ASSERT_EQUAL(sizes[l] - (lists[l] == list ? 1 : 0), lists[l]->size());
+            }
+        }
+    }
+
+    replay.applyMemoryBudget(0);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), replay.short_term.size());
+    CPPUNIT_ASSERT_EQUAL(29.0, replay.short_term.front()->sim_time);
+    checkSignals(replay.short_term.front());
+
+    // The running count matches a recount.
+    const size_t tracked = replay.m_buffer_bytes;
+    replay.recountBufferBytes();
+    CPPUNIT_ASSERT_EQUAL(tracked, replay.m_buffer_bytes);
+
+    replay.clear();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), replay.m_buffer_bytes);
+    CPPUNIT_ASSERT_EQUAL(baseline, FGReplayData::s_bytes_keyframes.load());
+}
@@ -0,0 +1,53 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+
+// Tests of the flight recorder's replay buffers and continuous recordings.
+class ReplayTests : public CppUnit::TestFixture
+{
+    // Set up the test suite.
+    CPPUNIT_TEST_SUITE(ReplayTests);
+    CPPUNIT_TEST(testContinuousWriterQueue);
+    CPPUNIT_TEST(testContinuousWriterShutdown);
+    CPPUNIT_TEST(testContinuousIndexFooter);
+    CPPUNIT_TEST(testFrameIndexAdd);
+    CPPUNIT_TEST(testDeltaEncoding);
+    CPPUNIT_TEST(testKeyframeLifetime);
+    CPPUNIT_TEST(testMemoryBudget);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    // Set up function for each test.
+    void setUp();
+
+    // Clean up after each test.
+    void tearDown();
+
+    // The tests.
+    void testContinuousWriterQueue();
+    void testContinuousWriterShutdown();
+    void testContinuousIndexFooter();
+    void testFrameIndexAdd();
+    void testDeltaEncoding();
+    void testKeyframeLifetime();
+    void testMemoryBudget();
+};
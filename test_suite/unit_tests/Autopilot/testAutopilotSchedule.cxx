@@ -0,0 +1,168 @@
+#include "testAutopilotSchedule.hxx"
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+
+#include <Autopilot/autopilot.hxx>
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+
+
+#include <simgear/props/props_io.hxx>
+
+// Set up function for each test.
+void AutopilotScheduleTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("ap-schedule");
+}
+
+
+// Clean up after each test.
+void AutopilotScheduleTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+SGPropertyNode_ptr AutopilotScheduleTests::configFromString(const std::string& s)
+{
+    SGPropertyNode_ptr config = new SGPropertyNode;
+
+    std::istringstream iss(s);
+    readProperties(iss, config);
+    return config;
+}
+
+// Two gain filters, the one reading /test/b listed before the one writing it.
+SGPropertyNode_ptr AutopilotScheduleTests::chainConfig(bool dependencyOrder)
+{
+    auto config = configFromString(R"(<?xml version="1.0" encoding="UTF-8"?>
+                                    <PropertyList>
+                                    <filter>
+                                        <name>consumer</name>
+                                        <type>gain</type>
+                                        <gain>3.0</gain>
+                                        <input>/test/b</input>
+                                        <output>/test/c</output>
+                                    </filter>
+                                    <filter>
+                                        <name>producer</name>
+                                        <type>gain</type>
+                                        <gain>2.0</gain>
+                                        <input>/test/a</input>
+                                        <output>/test/b</output>
+                                    </filter>
+                                    </PropertyList>
+                                    )");
+    // dependency order is the default
+    if (!dependencyOrder)
+        config->setBoolValue("dependency-order", false);
+    return config;
+}
+
+void AutopilotScheduleTests::testConfigurationOrder()
+{
+    auto ap = new FGXMLAutopilot::Autopilot(globals->get_props(), chainConfig(false));
+
+    globals->add_subsystem("ap", ap, SGSubsystemMgr::FDM);
+    ap->bind();
+    ap->init();
+
+    // the consumer still sees the value of the previous frame
+    fgSetDouble("/test/a", 1.0);
+    ap->update(0.1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, fgGetDouble("/test/b"), 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, fgGetDouble("/test/c"), 1e-9);
+
+    ap->update(0.1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0, fgGetDouble("/test/c"), 1e-9);
+}
+
+void AutopilotScheduleTests::testDependencyOrder()
+{
+    auto ap = new FGXMLAutopilot::Autopilot(globals->get_props(), chainConfig(true));
+
+    globals->add_subsystem("ap", ap, SGSubsystemMgr::FDM);
+    ap->bind();
+    ap->init();
+
+    fgSetDouble("/test/a", 1.0);
+    ap->update(0.1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, fgGetDouble("/test/b"), 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0, fgGetDouble("/test/c"), 1e-9);
+
+    fgSetDouble("/test/a", -0.5);
+    ap->update(0.1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(-3.0, fgGetDouble("/test/c"), 1e-9);
+}
+
+void AutopilotScheduleTests::testPropertyGain()
+{
+    // the consumer reads the producer's output through its gain, not its input
+    auto config = configFromString(R"(<?xml version="1.0" encoding="UTF-8"?>
+                                    <PropertyList>
+                                    <filter>
+                                        <name>consumer</name>
+                                        <type>gain</type>
+                                        <gain>
+                                            <property>/test/gain</property>
+                                        </gain>
+                                        <input>/test/x</input>
+                                        <output>/test/y</output>
+                                    </filter>
+                                    <filter>
+                                        <name>producer</name>
+                                        <type>gain</type>
+                                        <gain>2.0</gain>
+                                        <input>/test/a</input>
+                                        <output>/test/gain</output>
+                                    </filter>
+                                    </PropertyList>
+                                    )");
+
+    auto ap = new FGXMLAutopilot::Autopilot(globals->get_props(), config);
+
+    globals->add_subsystem("ap", ap, SGSubsystemMgr::FDM);
+    ap->bind();
+    ap->init();
+
+    fgSetDouble("/test/x", 5.0);
+    fgSetDouble("/test/a", 1.5);
+    ap->update(0.1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, fgGetDouble("/test/gain"), 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(15.0, fgGetDouble("/test/y"), 1e-9);
+}
+
+void AutopilotScheduleTests::testConstantInputs()
+{
+    // constant scale, offset and limits behave as before they were folded
+    auto config = configFromString(R"(<?xml version="1.0" encoding="UTF-8"?>
+                                    <PropertyList>
+                                    <filter>
+                                        <type>gain</type>
+                                        <gain>1.0</gain>
+                                        <input>
+                                            <property>/test/a</property>
+                                            <scale>2.0</scale>
+                                            <offset>1.0</offset>
+                                            <max>8.0</max>
+                                        </input>
+                                        <output>/test/b</output>
+                                    </filter>
+                                    </PropertyList>
+                                    )");
+
+    auto ap = new FGXMLAutopilot::Autopilot(globals->get_props(), config);
+
+    globals->add_subsystem("ap", ap, SGSubsystemMgr::FDM);
+    ap->bind();
+    ap->init();
+
+    fgSetDouble("/test/a", 1.5);
+    ap->update(0.1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, fgGetDouble("/test/b"), 1e-9);
+
+    fgSetDouble("/test/a", 10.0);
+    ap->update(0.1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(8.0, fgGetDouble("/test/b"), 1e-9);
+}
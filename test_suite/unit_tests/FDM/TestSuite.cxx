@@ -19,10 +19,16 @@
 
 #include "test_ls_matrix.hxx"
 #include "testAeroElement.hxx"
+#include "testFDMThread.hxx"
+#include "testGroundCache.hxx"
 #include "testYASimAtmosphere.hxx"
+#include "testYASimSurfaceBatch.hxx"
 
 
 // Set up the unit tests.
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(AeroElementTests, "Unit tests");
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(FDMThreadTests, "Unit tests");
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(GroundCacheTests, "Unit tests");
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(LaRCSimMatrixTests, "Unit tests");
 CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(YASimAtmosphereTests, "Unit tests");
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(YASimSurfaceBatchTests, "Unit tests");
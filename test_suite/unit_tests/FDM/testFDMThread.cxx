@@ -0,0 +1,135 @@
+#include "testFDMThread.hxx"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include <FDM/fdm_thread.hxx>
+
+
+namespace {
+
+void sleepMSec(int msec)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(msec));
+}
+
+} // of anonymous namespace
+
+
+void FDMThreadTests::testSteps()
+{
+    std::atomic<int> steps{0};
+    std::atomic<double> stepDt{0.0};
+    FDMThread* thread = nullptr;
+    FDMThread t(200.0, [&](double dt) {
+        stepDt = dt;
+        FDMSnapshot snapshot;
+        snapshot.vTrueKts = ++steps;
+        thread->publish(snapshot);
+    });
+    thread = &t;
+
+    FDMSnapshot snapshot;
+    CPPUNIT_ASSERT(!t.latest(snapshot));
+
+    t.start();
+    CPPUNIT_ASSERT(FDMThread::isRunning());
+    sleepMSec(200);
+    t.stop();
+    CPPUNIT_ASSERT(!FDMThread::isRunning());
+
+    // loose bounds, the machine running the tests may be busy
+    CPPUNIT_ASSERT(steps >= 10);
+    CPPUNIT_ASSERT(steps <= 60);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.005, stepDt.load(), 1e-12);
+
+    const FDMThread::Statistics stats = t.takeStatistics();
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(steps), stats.steps);
+    CPPUNIT_ASSERT(stats.ticks >= stats.steps);
+    CPPUNIT_ASSERT(stats.stepMaxUSec >= stats.stepMeanUSec);
+    CPPUNIT_ASSERT(stats.jitterMaxUSec >= stats.jitterMeanUSec);
+
+    // the snapshot is the one of the last step
+    CPPUNIT_ASSERT(t.latest(snapshot));
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(steps), snapshot.step);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(steps * 0.005, snapshot.simTimeSec, 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(steps, snapshot.vTrueKts, 1e-9);
+}
+
+
+void FDMThreadTests::testMainLoopLock()
+{
+    std::atomic<int> steps{0};
+    FDMThread t(200.0, [&](double) { ++steps; });
+    t.start(false, 0.0, 1.0);
+    sleepMSec(50);
+
+    int before;
+    {
+        std::unique_lock<std::timed_mutex> lock(FDMThread::mainLoopMutex());
+        before = steps;
+        sleepMSec(100);
+        CPPUNIT_ASSERT_EQUAL(before, steps.load());
+    }
+
+    // the ticks missed while the lock was held are made up for
+    sleepMSec(50);
+    CPPUNIT_ASSERT(steps - before >= 20);
+
+    // stopping must not wait for the lock
+    {
+        std::unique_lock<std::timed_mutex> lock(FDMThread::mainLoopMutex());
+        t.stop();
+    }
+    CPPUNIT_ASSERT(!t.isAlive());
+    CPPUNIT_ASSERT(t.takeStatistics().overruns > 0);
+}
+
+
+void FDMThreadTests::testYieldMainLoop()
+{
+    std::atomic<int> steps{0};
+    FDMThread t(200.0, [&](double) { ++steps; });
+    t.start(false, 0.0, 1.0);
+
+    // a main loop which holds the lock for whole 20 ms frames and takes it
+    // again right away still lets the thread keep up
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < 10; ++frame) {
+        FDMThread::yieldMainLoop();
+        std::lock_guard<std::timed_mutex> lock(FDMThread::mainLoopMutex());
+        sleepMSec(20);
+    }
+    const double elapsedSec = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    t.stop();
+
+    // loose bound, the machine running the tests may be busy
+    CPPUNIT_ASSERT(steps >= elapsedSec * 200 / 2);
+}
+
+
+void FDMThreadTests::testTimeScale()
+{
+    std::atomic<int> steps{0};
+    FDMThread t(200.0, [&](double) { ++steps; });
+    t.setTimeScale(0.0);
+    t.start();
+    sleepMSec(100);
+    CPPUNIT_ASSERT_EQUAL(0, steps.load());
+
+    const FDMThread::Statistics paused = t.takeStatistics();
+    CPPUNIT_ASSERT(paused.ticks > 0);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), paused.steps);
+
+    t.setTimeScale(2.0);
+    sleepMSec(100);
+    t.stop();
+
+    // two steps per tick, but for a tick or two around the changes
+    const FDMThread::Statistics fast = t.takeStatistics();
+    CPPUNIT_ASSERT(fast.steps <= 2 * fast.ticks);
+    CPPUNIT_ASSERT(fast.steps + 4 >= 2 * fast.ticks);
+}
@@ -0,0 +1,45 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _FG_FDM_THREAD_UNIT_TESTS_HXX
+#define _FG_FDM_THREAD_UNIT_TESTS_HXX
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+
+// The unit tests.
+class FDMThreadTests : public CppUnit::TestFixture
+{
+    // Set up the test suite.
+    CPPUNIT_TEST_SUITE(FDMThreadTests);
+    CPPUNIT_TEST(testSteps);
+    CPPUNIT_TEST(testMainLoopLock);
+    CPPUNIT_TEST(testYieldMainLoop);
+    CPPUNIT_TEST(testTimeScale);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    // The tests.
+    void testSteps();
+    void testMainLoopLock();
+    void testYieldMainLoop();
+    void testTimeScale();
+};
+
+#endif  // _FG_FDM_THREAD_UNIT_TESTS_HXX
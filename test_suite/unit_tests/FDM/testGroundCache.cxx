@@ -0,0 +1,175 @@
+#include "testGroundCache.hxx"
+
+#include <vector>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <simgear/bvh/BVHGroup.hxx>
+#include <simgear/bvh/BVHMaterial.hxx>
+#include <simgear/bvh/BVHMotionTransform.hxx>
+#include <simgear/bvh/BVHStaticGeometryBuilder.hxx>
+#include <simgear/bvh/BVHTransform.hxx>
+#include <simgear/constants.h>
+#include <simgear/math/SGMath.hxx>
+
+#include <FDM/flight.hxx>
+
+
+namespace {
+
+const SGSharedPtr<simgear::BVHMaterial> groundMaterial = new simgear::BVHMaterial;
+const SGSharedPtr<simgear::BVHMaterial> rampMaterial = new simgear::BVHMaterial;
+const SGSharedPtr<simgear::BVHMaterial> deckMaterial = new simgear::BVHMaterial;
+
+const simgear::BVHNode::Id deckId = 7;
+
+// Maps a local frame with x east, y north and z up to the earth centered
+// frame at lat = lon = 0.
+SGMatrixd localToWorld()
+{
+    const double r = SGVec3d::fromGeod(SGGeod::fromDegM(0, 0, 0))[0];
+    const double m[16] = { 0, 1, 0, 0,  0, 0, 1, 0,  1, 0, 0, 0,  r, 0, 0, 1 };
+    return SGMatrixd(m);
+}
+
+SGVec3d localPoint(double x, double y, double z)
+{
+    const SGMatrixd m = localToWorld();
+    return SGVec3d(m(0, 3) + z, x, y);
+}
+
+// Adds a quad over [x0, x1] x [y0, y1] rising from z0 at x0 to z1 at x1
+void addQuad(simgear::BVHStaticGeometryBuilder& builder,
+             const simgear::BVHMaterial* material, float x0, float y0,
+             float x1, float y1, float z0, float z1)
+{
+    builder.setCurrentMaterial(material);
+    builder.addTriangle(SGVec3f(x0, y0, z0), SGVec3f(x1, y0, z1),
+                        SGVec3f(x1, y1, z1));
+    builder.addTriangle(SGVec3f(x0, y0, z0), SGVec3f(x1, y1, z1),
+                        SGVec3f(x0, y1, z0));
+}
+
+void checkClose(const SGVec3d& expected, const SGVec3d& actual, double tol)
+{
+    for (int i = 0; i < 3; ++i)
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], actual[i], tol);
+}
+
+} // anonymous namespace
+
+
+// Set up function for each test.
+void GroundCacheTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("ground-cache");
+}
+
+
+// Clean up after each test.
+void GroundCacheTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void GroundCacheTests::installScenery(FGInterface& fdm)
+{
+    // Flat ground with a ramp on it
+    simgear::BVHStaticGeometryBuilder groundBuilder;
+    addQuad(groundBuilder, groundMaterial, -100, -100, 100, 100, 0, 0);
+    addQuad(groundBuilder, rampMaterial, 10, -20, 40, 20, 0, 6);
+    SGSharedPtr<simgear::BVHTransform> ground = new simgear::BVHTransform;
+    ground->setToWorldTransform(localToWorld());
+    ground->addChild(groundBuilder.buildTree());
+
+    // A moving and turning deck above the ground, like a carrier
+    simgear::BVHStaticGeometryBuilder deckBuilder;
+    addQuad(deckBuilder, deckMaterial, -60, -15, -20, 15, 8, 8);
+    SGSharedPtr<simgear::BVHMotionTransform> deck = new simgear::BVHMotionTransform;
+    deck->setToWorldTransform(localToWorld());
+    deck->setLinearVelocity(SGVec3d(0, 5, 1));
+    deck->setAngularVelocity(SGVec3d(0.02, 0, 0));
+    deck->setReferenceTime(0);
+    deck->setStartTime(0);
+    deck->setEndTime(10);
+    deck->setId(deckId);
+
+    SGSharedPtr<simgear::BVHGroup> root = new simgear::BVHGroup;
+    root->addChild(ground);
+    root->addChild(deck);
+
+    FGGroundCache& cache = fdm.ground_cache;
+    cache._localBvhTree = root;
+    cache.reference_wgs84_point = localPoint(0, 0, 0);
+    cache.reference_vehicle_radius = 50;
+    cache.down = -normalize(localPoint(0, 0, 0));
+    cache._altitude = 0;
+    cache._material = groundMaterial;
+    // Report misses, so they can be told apart from hits below
+    cache.found_ground = false;
+}
+
+
+// The batched lookup that JSBSim uses for its gear units must give the same
+// answers as the single point get_agl_ft it replaces.
+void GroundCacheTests::testBatchedAglMatchesSingle()
+{
+    FGInterface fdm;
+    installScenery(fdm);
+
+    // More points than one batch visitor pass takes, over the ground, the
+    // ramp, the deck and beyond the scenery, and both above and below the
+    // deck.
+    std::vector<FGGroundCache::AglQuery> queries;
+    for (int i = 0; i < 40; ++i) {
+        for (int j = 0; j < 5; ++j) {
+            FGGroundCache::AglQuery query;
+            query.pt = localPoint(-130 + 7*i, -36 + 18*j, 1 + 4*((i + j) % 4));
+            queries.push_back(query);
+        }
+    }
+    const std::vector<FGGroundCache::AglQuery> points = queries;
+
+    const double t = 2;
+    const double altOffM = 2;
+    fdm.get_agl_m(t, queries.data(), queries.size(), altOffM);
+
+    unsigned hits = 0, misses = 0, deckHits = 0, rampHits = 0;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const FGGroundCache::AglQuery& query = queries[i];
+        checkClose(points[i].pt, query.pt, 0);
+
+        double pt[3], contact[3], normal[3], vel[3], angularVel[3];
+        for (int k = 0; k < 3; ++k)
+            pt[k] = SG_METER_TO_FEET*query.pt[k];
+        const simgear::BVHMaterial* material = nullptr;
+        simgear::BVHNode::Id id = 0;
+        bool found = fdm.get_agl_ft(t, pt, SG_METER_TO_FEET*altOffM, contact,
+                                    normal, vel, angularVel, material, id);
+
+        CPPUNIT_ASSERT_EQUAL(found, query.found);
+        CPPUNIT_ASSERT(material == query.material);
+        CPPUNIT_ASSERT_EQUAL(id, query.id);
+        checkClose(SG_FEET_TO_METER*SGVec3d(contact), query.contact, 1e-4);
+        checkClose(SGVec3d(normal), query.normal, 1e-6);
+        checkClose(SG_FEET_TO_METER*SGVec3d(vel), query.linearVel, 1e-4);
+        checkClose(SGVec3d(angularVel), query.angularVel, 1e-9);
+
+        if (!query.found) {
+            ++misses;
+            continue;
+        }
+        ++hits;
+        if (query.id == deckId)
+            ++deckHits;
+        else if (query.material == rampMaterial)
+            ++rampHits;
+    }
+
+    // All kinds of answers were compared
+    CPPUNIT_ASSERT(misses > 0);
+    CPPUNIT_ASSERT(deckHits > 0);
+    CPPUNIT_ASSERT(rampHits > 0);
+    CPPUNIT_ASSERT(hits > deckHits + rampHits);
+}
@@ -0,0 +1,51 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _FG_GROUND_CACHE_UNIT_TESTS_HXX
+#define _FG_GROUND_CACHE_UNIT_TESTS_HXX
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+class FGInterface;
+
+
+// The unit tests.
+class GroundCacheTests : public CppUnit::TestFixture
+{
+    // Set up the test suite.
+    CPPUNIT_TEST_SUITE(GroundCacheTests);
+    CPPUNIT_TEST(testBatchedAglMatchesSingle);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    // Set up function for each test.
+    void setUp();
+
+    // Clean up after each test.
+    void tearDown();
+
+    // The tests.
+    void testBatchedAglMatchesSingle();
+
+private:
+    // Fills the ground cache of fdm with a synthetic scenery.
+    void installScenery(FGInterface& fdm);
+};
+
+#endif  // _FG_GROUND_CACHE_UNIT_TESTS_HXX
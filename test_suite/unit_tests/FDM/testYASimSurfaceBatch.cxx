@@ -0,0 +1,196 @@
+#include "testYASimSurfaceBatch.hxx"
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <FDM/YASim/Surface.hpp>
+#include <FDM/YASim/SurfaceBatch.hpp>
+#include <FDM/YASim/Vector.hpp>
+#include <FDM/YASim/Version.hpp>
+
+
+using namespace yasim;
+
+namespace {
+
+typedef std::vector<std::unique_ptr<Surface>> Surfaces;
+
+// Gives a and b the same, randomly chosen configuration
+void configure(std::mt19937& rng, Surface* a, Surface* b, int i)
+{
+    std::uniform_real_distribution<float> u(-1, 1), p(0, 1);
+
+    float orient[9];
+    for (int j = 0; j < 9; j++) orient[j] = u(rng);
+    float pos[3] = { 10*u(rng), 10*u(rng), u(rng) };
+    const float chord = 1 + p(rng);
+    const float c0 = 1 + p(rng), cx = p(rng), cy = p(rng), cz = 2*p(rng);
+    const float cz0 = 0.1f*p(rng), peak0 = 1 + p(rng), peak1 = 1 + p(rng);
+    float stalls[4], widths[4];
+    for (int j = 0; j < 4; j++) {
+        // some surfaces without a stall in one direction
+        stalls[j] = (j == 3 && i % 5 == 0) ? 0 : 0.3f*p(rng);
+        widths[j] = 0.1f*p(rng);
+    }
+    const float flapLift = 1 + p(rng), flapDrag = 1 + p(rng);
+    const float spoilerLift = p(rng), spoilerDrag = 1 + p(rng);
+    const float slatAlpha = 0.1f*p(rng), slatDrag = 1 + p(rng);
+    const float flap = u(rng), spoiler = p(rng), slat = p(rng);
+    const float incidence = 0.1f*u(rng), twist = 0.05f*u(rng);
+    const float induced = p(rng), mcrit = 0.5f + 0.3f*p(rng);
+    const bool zero = (i % 17 == 0);
+
+    for (Surface* s : { a, b }) {
+        s->setPosition(pos);
+        s->setOrientation(orient);
+        s->setChord(chord);
+        s->setTotalForceCoefficient(c0);
+        s->setDragCoefficient(zero ? 0 : cx);
+        s->setYDrag(zero ? 0 : cy);
+        s->setLiftCoefficient(zero ? 0 : cz);
+        s->setZeroAlphaLift(cz0);
+        s->setStallPeak(0, peak0);
+        s->setStallPeak(1, peak1);
+        for (int j = 0; j < 4; j++) {
+            s->setStall(j, stalls[j]);
+            s->setStallWidth(j, widths[j]);
+        }
+        s->setFlapParams(flapLift, flapDrag);
+        s->setSpoilerParams(spoilerLift, spoilerDrag);
+        s->setSlatParams(slatAlpha, slatDrag);
+        s->setFlapPos(flap);
+        s->setSpoilerPos(spoiler);
+        s->setSlatPos(slat);
+        s->setIncidence(incidence);
+        s->setTwist(twist);
+        s->setInducedDrag(induced);
+        s->setCriticalMachNumber(mcrit);
+        if (i % 3 == 0) {
+            s->setFlowRegime(FLOW_TRANSONIC);
+        }
+    }
+}
+
+void checkClose(float expected, float actual)
+{
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, actual, 1e-5 * (1 + std::fabs(expected)));
+}
+
+// Runs the batch and the reference surfaces with the same winds
+void compare(std::mt19937& rng, SurfaceBatch& batch, const Vector& batched,
+             const Surfaces& reference, float mach)
+{
+    std::uniform_real_distribution<float> u(-1, 1);
+    const float rho = 1.2f;
+    const int n = batched.size();
+
+    batch.sync(batched);
+    CPPUNIT_ASSERT_EQUAL(n, batch.size());
+
+    std::vector<float> winds(3*n);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < 3; j++) {
+            winds[3*i+j] = (i % 23 == 0) ? 0 : 100*u(rng);
+        }
+        batch.setWind(i, &winds[3*i]);
+    }
+    batch.calcForces(rho, mach);
+
+    for (int i = 0; i < n; i++) {
+        float force[3], torque[3], batchForce[3], batchTorque[3];
+        reference[i]->calcForce(&winds[3*i], rho, mach, force, torque);
+        batch.getForce(i, batchForce);
+        batch.getTorque(i, batchTorque);
+        for (int j = 0; j < 3; j++) {
+            checkClose(force[j], batchForce[j]);
+            checkClose(torque[j], batchTorque[j]);
+        }
+
+        const Surface* s = (const Surface*)batched.get(i);
+        CPPUNIT_ASSERT_EQUAL(reference[i]->getAlpha(), s->getAlpha());
+        CPPUNIT_ASSERT_EQUAL(reference[i]->getStallAlpha(), s->getStallAlpha());
+    }
+}
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void YASimSurfaceBatchTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("yasim-surface-batch");
+}
+
+
+// Clean up after each test.
+void YASimSurfaceBatchTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void YASimSurfaceBatchTests::testMatchesSurface()
+{
+    std::mt19937 rng(1);
+    Version original, v32;
+    v32.setVersion("YASIM_VERSION_32");
+
+    const float pos[3] = { 0, 0, 0 };
+    Surfaces owned, reference;
+    Vector batched;
+    for (int i = 0; i < 100; i++) {
+        Version* version = (i % 2) ? &v32 : &original;
+        owned.emplace_back(new Surface(version, pos, 1));
+        reference.emplace_back(new Surface(version, pos, 1));
+        configure(rng, owned.back().get(), reference.back().get(), i);
+        batched.add(owned.back().get());
+    }
+
+    SurfaceBatch batch;
+    for (float mach : { 0.3f, 0.85f, 1.3f }) {
+        for (int run = 0; run < 10; run++) {
+            compare(rng, batch, batched, reference, mach);
+        }
+    }
+}
+
+
+void YASimSurfaceBatchTests::testSync()
+{
+    std::mt19937 rng(2);
+    Version version;
+
+    const float pos[3] = { 0, 0, 0 };
+    Surfaces owned, reference;
+    Vector batched;
+    for (int i = 0; i < 10; i++) {
+        owned.emplace_back(new Surface(&version, pos, 1));
+        reference.emplace_back(new Surface(&version, pos, 1));
+        configure(rng, owned.back().get(), reference.back().get(), i);
+        batched.add(owned.back().get());
+    }
+
+    SurfaceBatch batch;
+    compare(rng, batch, batched, reference, 0.5f);
+
+    // control movements and coefficient changes are picked up
+    for (int i = 0; i < 10; i += 3) {
+        for (Surface* s : { owned[i].get(), reference[i].get() }) {
+            s->setFlapPos(0.7f);
+            s->setSpoilerPos(0.2f);
+            s->mulDragCoefficient(1.5f);
+        }
+    }
+    compare(rng, batch, batched, reference, 0.5f);
+
+    // as are new surfaces
+    owned.emplace_back(new Surface(&version, pos, 1));
+    reference.emplace_back(new Surface(&version, pos, 1));
+    configure(rng, owned.back().get(), reference.back().get(), 10);
+    batched.add(owned.back().get());
+    compare(rng, batch, batched, reference, 0.5f);
+}
@@ -0,0 +1,144 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "test_frameProfiler.hxx"
+
+#include <chrono>
+#include <thread>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/misc/sg_path.hxx>
+
+#include "Main/FrameProfiler.hxx"
+#include "Main/fg_props.hxx"
+#include "Main/globals.hxx"
+
+using flightgear::FrameProfiler;
+
+namespace {
+
+// takes a known, if approximate, time to update
+class SlowSubsystem : public SGSubsystem
+{
+public:
+    void update(double) override
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+};
+
+void runFrames(FrameProfiler* profiler, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        profiler->beginFrame();
+        globals->get_subsystem_mgr()->update(0.01);
+        {
+            FrameProfiler::Zone zone("nasal-timer", i == 3 ? "slow-timer" : "timer");
+            std::this_thread::sleep_for(std::chrono::milliseconds(i == 3 ? 5 : 1));
+        }
+        profiler->endFrame();
+    }
+}
+
+} // of anonymous namespace
+
+
+void FrameProfilerTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("frameProfiler");
+    globals->get_subsystem_mgr()->add("slow-subsystem", new SlowSubsystem,
+                                      SGSubsystemMgr::GENERAL);
+    globals->add_new_subsystem<FrameProfiler>(SGSubsystemMgr::INIT);
+    globals->get_subsystem<FrameProfiler>()->init();
+}
+
+
+void FrameProfilerTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void FrameProfilerTests::testStatistics()
+{
+    auto profiler = globals->get_subsystem<FrameProfiler>();
+
+    // nothing is recorded unless enabled
+    runFrames(profiler, 2);
+    CPPUNIT_ASSERT(!FrameProfiler::isActive());
+
+    fgSetBool("/sim/performance/enabled", true);
+    fgSetDouble("/sim/performance/update-interval-sec", 0.0);
+    runFrames(profiler, 10);
+    CPPUNIT_ASSERT(FrameProfiler::isActive());
+    profiler->update(0.0);
+
+    SGPropertyNode* subsystem = fgGetNode("/sim/performance/subsystems/slow-subsystem");
+    CPPUNIT_ASSERT(subsystem);
+    CPPUNIT_ASSERT_EQUAL(10, subsystem->getIntValue("samples"));
+    CPPUNIT_ASSERT(subsystem->getDoubleValue("p50-ms") >= 2.0);
+    CPPUNIT_ASSERT(subsystem->getDoubleValue("p99-ms") >= subsystem->getDoubleValue("p50-ms"));
+    CPPUNIT_ASSERT(subsystem->getDoubleValue("max-ms") >= subsystem->getDoubleValue("p99-ms"));
+
+    SGPropertyNode* timers = fgGetNode("/sim/performance/zones/nasal-timer");
+    CPPUNIT_ASSERT(timers);
+    CPPUNIT_ASSERT_EQUAL(std::string("slow-timer"), std::string(timers->getStringValue("slowest")));
+    CPPUNIT_ASSERT(timers->getDoubleValue("max-ms") >= 5.0);
+
+    // the frame includes both
+    CPPUNIT_ASSERT(fgGetDouble("/sim/performance/frame/p50-ms") >= 3.0);
+
+    fgSetBool("/sim/performance/enabled", false);
+    runFrames(profiler, 1);
+    CPPUNIT_ASSERT(!FrameProfiler::isActive());
+}
+
+
+void FrameProfilerTests::testCapture()
+{
+    auto profiler = globals->get_subsystem<FrameProfiler>();
+    const SGPath path = globals->get_fg_home() / "frame-trace.json";
+
+    CPPUNIT_ASSERT(!profiler->stopCapture());
+    CPPUNIT_ASSERT(profiler->startCapture(path));
+    CPPUNIT_ASSERT(!profiler->startCapture(path));
+    runFrames(profiler, 5);
+
+    // zones on other threads are recorded as well
+    std::thread([] {
+        FrameProfiler::Zone zone("tile-load", "w123n45/3040338.stg");
+    }).join();
+
+    CPPUNIT_ASSERT(profiler->stopCapture());
+    CPPUNIT_ASSERT(!profiler->isCapturing());
+    // at least a frame, group, subsystem and timer per frame, and the tile
+    CPPUNIT_ASSERT(fgGetInt("/sim/performance/capture/events") >= 4 * 5 + 1);
+
+    sg_ifstream in(path);
+    const std::string trace = in.read_all();
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), trace.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    CPPUNIT_ASSERT(trace.find("{\"name\":\"slow-subsystem\",\"cat\":\"subsystem\",\"ph\":\"X\"") != std::string::npos);
+    CPPUNIT_ASSERT(trace.find("{\"name\":\"general\",\"cat\":\"group\"") != std::string::npos);
+    CPPUNIT_ASSERT(trace.find("{\"name\":\"slow-timer\",\"cat\":\"nasal-timer\"") != std::string::npos);
+    CPPUNIT_ASSERT(trace.find("\"cat\":\"tile-load\",\"ph\":\"X\"") != std::string::npos);
+    CPPUNIT_ASSERT(trace.find("\"args\":{\"name\":\"thread-1\"}") != std::string::npos);
+    CPPUNIT_ASSERT_EQUAL(std::string("\n]}\n"), trace.substr(trace.size() - 4));
+}
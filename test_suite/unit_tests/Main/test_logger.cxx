@@ -0,0 +1,171 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "test_logger.hxx"
+
+#include <sstream>
+
+#include "Main/logger_format.hxx"
+
+using namespace flightgear::logformat;
+
+namespace {
+
+std::vector<Column> testColumns()
+{
+    return {{"Time", DOUBLE}, {"gear-down", BOOL}, {"count", INT},
+            {"ticks", LONG}, {"rudder", FLOAT}, {"callsign", STRING}};
+}
+
+std::vector<Row> testRows(size_t count)
+{
+    std::vector<Row> rows(count, Row(testColumns().size()));
+    for (size_t r = 0; r < count; ++r) {
+        rows[r][0].d = r * 0.02;
+        rows[r][1].b = (r % 2) == 1;
+        rows[r][2].i = -static_cast<int>(r);
+        rows[r][3].l = (int64_t(1) << 40) + r;
+        rows[r][4].f = 0.25f * r;
+        rows[r][5].s = "N" + std::to_string(r);
+    }
+    return rows;
+}
+
+// writes the header and one block per group of rows
+std::string writeLog(const std::vector<Row>& rows, size_t rowsPerBlock)
+{
+    std::ostringstream out;
+    writeHeader(out, testColumns());
+    for (size_t begin = 0; begin < rows.size(); begin += rowsPerBlock) {
+        std::vector<const Row*> block;
+        for (size_t r = begin; r < std::min(begin + rowsPerBlock, rows.size()); ++r)
+            block.push_back(&rows[r]);
+        writeBlock(out, testColumns(), block);
+    }
+    return out.str();
+}
+
+} // of anonymous namespace
+
+
+void LoggerTests::testRoundTrip()
+{
+    CPPUNIT_ASSERT_EQUAL(0xcbf43926u, crc32("123456789", 9));
+
+    const std::vector<Row> rows = testRows(10);
+    std::istringstream in(writeLog(rows, 4));
+
+    Reader reader(in);
+    CPPUNIT_ASSERT_EQUAL(Reader::OK, reader.readHeader());
+    CPPUNIT_ASSERT_EQUAL(testColumns().size(), reader.columns().size());
+    CPPUNIT_ASSERT_EQUAL(std::string("callsign"), reader.columns()[5].name);
+    CPPUNIT_ASSERT_EQUAL(STRING, reader.columns()[5].type);
+
+    std::vector<Row> block;
+    size_t r = 0;
+    while (reader.readBlock(block) == Reader::OK) {
+        for (const Row& row : block) {
+            CPPUNIT_ASSERT_EQUAL(rows[r][0].d, row[0].d);
+            CPPUNIT_ASSERT_EQUAL(rows[r][1].b, row[1].b);
+            CPPUNIT_ASSERT_EQUAL(rows[r][2].i, row[2].i);
+            CPPUNIT_ASSERT_EQUAL(rows[r][3].l, row[3].l);
+            CPPUNIT_ASSERT_EQUAL(rows[r][4].f, row[4].f);
+            CPPUNIT_ASSERT_EQUAL(rows[r][5].s, row[5].s);
+            ++r;
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(rows.size(), r);
+    CPPUNIT_ASSERT_EQUAL(Reader::END, reader.readBlock(block));
+}
+
+
+void LoggerTests::testDamagedBlock()
+{
+    const std::vector<Row> rows = testRows(9);
+    const std::string log = writeLog(rows, 3);
+    const size_t first = log.find("FBLK");
+    const size_t second = log.find("FBLK", first + 1);
+    CPPUNIT_ASSERT(second != std::string::npos);
+
+    // a damaged payload only loses its own block
+    std::string damaged = log;
+    damaged[second + 20] ^= 0x55;
+    std::istringstream in(damaged);
+    Reader reader(in);
+    std::vector<Row> block;
+    CPPUNIT_ASSERT_EQUAL(Reader::OK, reader.readHeader());
+    CPPUNIT_ASSERT_EQUAL(Reader::OK, reader.readBlock(block));
+    CPPUNIT_ASSERT_EQUAL(Reader::CORRUPT, reader.readBlock(block));
+    CPPUNIT_ASSERT_EQUAL(Reader::OK, reader.readBlock(block));
+    CPPUNIT_ASSERT_EQUAL(std::string("N6"), block[0][5].s);
+    CPPUNIT_ASSERT_EQUAL(Reader::END, reader.readBlock(block));
+
+    // as does a damaged block marker
+    damaged = log;
+    damaged[second] = 'X';
+    std::istringstream in2(damaged);
+    Reader reader2(in2);
+    CPPUNIT_ASSERT_EQUAL(Reader::OK, reader2.readHeader());
+    CPPUNIT_ASSERT_EQUAL(Reader::OK, reader2.readBlock(block));
+    CPPUNIT_ASSERT_EQUAL(Reader::CORRUPT, reader2.readBlock(block));
+    CPPUNIT_ASSERT_EQUAL(Reader::OK, reader2.readBlock(block));
+    CPPUNIT_ASSERT_EQUAL(std::string("N6"), block[0][5].s);
+
+    // a row count outside the CRC can't claim more rows than the payload holds
+    damaged = log;
+    damaged[second + 7] = '\xff';
+    std::istringstream in5(damaged);
+    Reader reader5(in5);
+    CPPUNIT_ASSERT_EQUAL(Reader::OK, reader5.readHeader());
+    CPPUNIT_ASSERT_EQUAL(Reader::OK, reader5.readBlock(block));
+    CPPUNIT_ASSERT_EQUAL(Reader::CORRUPT, reader5.readBlock(block));
+    CPPUNIT_ASSERT_EQUAL(Reader::OK, reader5.readBlock(block));
+    CPPUNIT_ASSERT_EQUAL(std::string("N6"), block[0][5].s);
+
+    // a truncated log ends with a damaged block
+    std::istringstream in3(log.substr(0, log.size() - 2));
+    Reader reader3(in3);
+    CPPUNIT_ASSERT_EQUAL(Reader::OK, reader3.readHeader());
+    CPPUNIT_ASSERT_EQUAL(Reader::OK, reader3.readBlock(block));
+    CPPUNIT_ASSERT_EQUAL(Reader::OK, reader3.readBlock(block));
+    CPPUNIT_ASSERT_EQUAL(Reader::CORRUPT, reader3.readBlock(block));
+    CPPUNIT_ASSERT_EQUAL(Reader::END, reader3.readBlock(block));
+
+    // and a damaged header is refused
+    damaged = log;
+    damaged[20] ^= 0x01;
+    std::istringstream in4(damaged);
+    Reader reader4(in4);
+    CPPUNIT_ASSERT_EQUAL(Reader::CORRUPT, reader4.readHeader());
+}
+
+
+void LoggerTests::testFormatValue()
+{
+    const std::vector<Row> rows = testRows(3);
+    const std::vector<Column> columns = testColumns();
+
+    std::ostringstream out;
+    for (size_t c = 0; c < columns.size(); ++c) {
+        if (c > 0)
+            out << ',';
+        formatValue(out, columns[c].type, rows[1][c]);
+    }
+    CPPUNIT_ASSERT_EQUAL(std::string("0.02,true,-1,1099511627777,0.25,N1"), out.str());
+}
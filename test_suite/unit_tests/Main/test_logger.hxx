@@ -0,0 +1,39 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+
+// The unit tests of the binary log format.
+class LoggerTests : public CppUnit::TestFixture
+{
+    // Set up the test suite.
+    CPPUNIT_TEST_SUITE(LoggerTests);
+    CPPUNIT_TEST(testRoundTrip);
+    CPPUNIT_TEST(testDamagedBlock);
+    CPPUNIT_TEST(testFormatValue);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    // The tests.
+    void testRoundTrip();
+    void testDamagedBlock();
+    void testFormatValue();
+};
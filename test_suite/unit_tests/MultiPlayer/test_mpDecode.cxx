@@ -0,0 +1,285 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "test_mpDecode.hxx"
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <simgear/math/SGMath.hxx>
+#include <simgear/timing/timestamp.hxx>
+
+#include <AIModel/AIManager.hxx>
+#include <AIModel/AIMultiplayer.hxx>
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+#include <MultiPlayer/MPPeerTable.hxx>
+#include <MultiPlayer/mpmessages.hxx>
+#include <MultiPlayer/multiplaymgr.hxx>
+#include <MultiPlayer/tiny_xdr.hxx>
+
+namespace {
+
+const int NUM_PEERS = 200;
+const int PACKETS_PER_PEER = 25;
+
+/*
+ * Builds a position message the way it is stored in a multiplayer
+ * recording, i.e. with the header already converted to host byte order.
+ * The property list is a typical mix of short int encoded surface
+ * positions, plain floats and ints, a bool array and a chat string.
+ */
+class PositionPacket
+{
+public:
+    PositionPacket(const std::string& callsign, double time, const SGGeod& pos)
+        : _callsign(callsign),
+          _buf(sizeof(T_MsgHdr) + sizeof(T_PositionMsg), 0)
+    {
+        T_PositionMsg* posMsg = reinterpret_cast<T_PositionMsg*>(&_buf[sizeof(T_MsgHdr)]);
+        strncpy(posMsg->Model, "Aircraft/c172p/Models/c172p.xml", MAX_MODEL_NAME_LEN - 1);
+        posMsg->time = XDR_encode_double(time);
+        posMsg->lag = XDR_encode_double(0.1);
+        SGVec3d cart = SGVec3d::fromGeod(pos);
+        for (unsigned i = 0; i < 3; ++i) {
+            posMsg->position[i] = XDR_encode_double(cart[i]);
+            posMsg->orientation[i] = XDR_encode_float(0.0f);
+            posMsg->linearVel[i] = XDR_encode_float(0.0f);
+            posMsg->angularVel[i] = XDR_encode_float(0.0f);
+            posMsg->linearAccel[i] = XDR_encode_float(0.0f);
+            posMsg->angularAccel[i] = XDR_encode_float(0.0f);
+        }
+        posMsg->pad = 0;
+    }
+
+    void add(xdr_data_t word)
+    {
+        const char* p = reinterpret_cast<const char*>(&word);
+        _buf.insert(_buf.end(), p, p + sizeof(word));
+    }
+
+    void addShortInt(unsigned id, int value)
+    {
+        add(XDR_encode_shortints32(id, value));
+    }
+
+    void addFloat(unsigned id, float value)
+    {
+        add(XDR_encode_uint32(id));
+        add(XDR_encode_float(value));
+    }
+
+    void addInt(unsigned id, int value)
+    {
+        add(XDR_encode_uint32(id));
+        add(XDR_encode_int32(value));
+    }
+
+    void addString(unsigned id, const std::string& value)
+    {
+        add(XDR_encode_uint32(id));
+        add(XDR_encode_uint32(value.size()));
+        for (char c : value)
+            add(XDR_encode_int8(c));
+        for (size_t i = value.size(); i % 4; ++i)
+            add(0);
+    }
+
+    std::shared_ptr<std::vector<char>> finish()
+    {
+        T_MsgHdr* hdr = reinterpret_cast<T_MsgHdr*>(&_buf[0]);
+        hdr->Magic = MSG_MAGIC;
+        hdr->Version = PROTO_VER;
+        hdr->MsgId = POS_DATA_ID;
+        hdr->MsgLen = _buf.size();
+        hdr->RequestedRangeNm = 0;
+        hdr->ReplyPort = 0;
+        strncpy(hdr->Callsign, _callsign.c_str(), MAX_CALLSIGN_LEN - 1);
+        hdr->Callsign[MAX_CALLSIGN_LEN - 1] = '\0';
+        return std::make_shared<std::vector<char>>(_buf);
+    }
+
+private:
+    std::string _callsign;
+    std::vector<char> _buf;
+};
+
+std::shared_ptr<std::vector<char>> makePacket(const std::string& callsign,
+                                              double time, const SGGeod& pos)
+{
+    PositionPacket packet(callsign, time, pos);
+    packet.addShortInt(10, 2);
+    for (unsigned id = 100; id <= 107; ++id)
+        packet.addShortInt(id, static_cast<int>(32767 * sin(time + id)));
+    packet.addShortInt(200, 16000);
+    packet.addShortInt(201, 32767);
+    packet.addShortInt(210, 16000);
+    packet.addShortInt(300, 855);
+    packet.addShortInt(301, 970);
+    packet.addShortInt(302, 2400);
+    for (unsigned id = 10200; id < 10210; ++id)
+        packet.addFloat(id, static_cast<float>(time));
+    for (unsigned id = 10300; id < 10305; ++id)
+        packet.addInt(id, static_cast<int>(id));
+    packet.addInt(11000, 0x2aaaaaaa);
+    packet.addString(10002, "Hello from " + callsign);
+    return packet.finish();
+}
+
+std::string peerCallsign(int i)
+{
+    return "MP" + std::to_string(1000 + i);
+}
+
+// Even peers are 5nm from us, odd peers 300nm.
+SGGeod peerPosition(const SGGeod& own, int i)
+{
+    double distanceM = ((i % 2) ? 300 : 5) * SG_NM_TO_METER;
+    return SGGeodesy::direct(own, i * 360.0 / NUM_PEERS, distanceM);
+}
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void MPDecodeTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("MultiPlayer");
+}
+
+
+// Clean up after each test.
+void MPDecodeTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void MPDecodeTests::testPeerTable()
+{
+    typedef MPPeerTable<int> Table;
+    Table table;
+    uint64_t key;
+
+    CPPUNIT_ASSERT(!Table::makeKey(std::string(""), key));
+    CPPUNIT_ASSERT(!Table::makeKey(std::string("TOOLONGCS"), key));
+    CPPUNIT_ASSERT(Table::makeKey(std::string("G-ABCD"), key));
+    CPPUNIT_ASSERT_EQUAL(std::string("G-ABCD"), Table::keyToCallsign(key));
+
+    // A header callsign uses all MAX_CALLSIGN_LEN bytes if it has to.
+    const char header[MAX_CALLSIGN_LEN] = {'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H'};
+    CPPUNIT_ASSERT(Table::makeKey(header, MAX_CALLSIGN_LEN, key));
+    CPPUNIT_ASSERT_EQUAL(std::string("ABCDEFGH"), Table::keyToCallsign(key));
+
+    for (int i = 0; i < 1000; ++i) {
+        CPPUNIT_ASSERT(Table::makeKey(peerCallsign(i), key));
+        table.insert(key) = i;
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(1000), table.size());
+
+    // Erase every third entry; the others must survive the backward shifts.
+    for (int i = 0; i < 1000; i += 3) {
+        Table::makeKey(peerCallsign(i), key);
+        CPPUNIT_ASSERT(table.erase(key));
+        CPPUNIT_ASSERT(!table.erase(key));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        Table::makeKey(peerCallsign(i), key);
+        int* value = table.find(key);
+        if (i % 3 == 0) {
+            CPPUNIT_ASSERT(!value);
+        } else {
+            CPPUNIT_ASSERT(value);
+            CPPUNIT_ASSERT_EQUAL(i, *value);
+        }
+    }
+
+    int count = 0;
+    table.forEach([&count](uint64_t, int&) { ++count; });
+    CPPUNIT_ASSERT_EQUAL(int(table.size()), count);
+}
+
+
+// Decodes a recording of a busy server, once with everything decoded in
+// full and once with interest management. Reports the cost per packet so
+// that changes to the decoder can be tracked.
+void MPDecodeTests::testDecodeBenchmark()
+{
+    globals->add_new_subsystem<FGAIManager>(SGSubsystemMgr::GENERAL);
+    auto mp = globals->add_new_subsystem<FGMultiplayMgr>(SGSubsystemMgr::POST_FDM);
+    fgSetBool("/sim/ai/enabled", true);
+    globals->get_subsystem_mgr()->bind();
+    globals->get_subsystem_mgr()->init();
+    globals->get_subsystem_mgr()->postinit();
+
+    const SGGeod own = SGGeod::fromDegFt(-3.0, 56.0, 5000.0);
+    fgSetDouble("/position/longitude-deg", own.getLongitudeDeg());
+    fgSetDouble("/position/latitude-deg", own.getLatitudeDeg());
+    fgSetDouble("/position/altitude-ft", own.getElevationFt());
+
+    // Recorded messages are only processed while replaying.
+    fgSetInt("/sim/replay/replay-state", 1);
+
+    auto runPass = [&](double startTime, const char* label) {
+        for (int p = 0; p < PACKETS_PER_PEER; ++p) {
+            for (int i = 0; i < NUM_PEERS; ++i) {
+                mp->pushMessageHistory(makePacket(peerCallsign(i),
+                                                  startTime + p * 0.1,
+                                                  peerPosition(own, i)));
+            }
+        }
+        SGTimeStamp st;
+        st.stamp();
+        mp->update(0.0);
+        const double elapsed = (SGTimeStamp::now() - st).toUSecs();
+        const int numPackets = NUM_PEERS * PACKETS_PER_PEER;
+        SG_LOG(SG_NETWORK, SG_MANDATORY_INFO, "MP decode benchmark (" << label << "): "
+               << numPackets << " packets in " << elapsed / 1000.0 << "ms, "
+               << 1000.0 * elapsed / numPackets << "ns/packet");
+    };
+
+    // Full decode of every packet.
+    fgSetBool("/sim/multiplay/interest/enabled", false);
+    runPass(1000.0, "full");
+
+    CPPUNIT_ASSERT_EQUAL(long(NUM_PEERS * PACKETS_PER_PEER),
+                         fgGetLong("/sim/multiplay/interest/near/decoded"));
+    CPPUNIT_ASSERT_EQUAL(0L, fgGetLong("/sim/multiplay/interest/far/decoded"));
+    for (int i = 0; i < NUM_PEERS; ++i)
+        CPPUNIT_ASSERT(mp->getMultiplayer(peerCallsign(i)));
+
+    // With interest management the far half of the peers only get a
+    // rate limited position decode.
+    fgSetBool("/sim/multiplay/interest/enabled", true);
+    fgSetDouble("/sim/multiplay/interest/near-range-nm", 30.0);
+    fgSetDouble("/sim/multiplay/interest/far-interval-sec", 60.0);
+    runPass(2000.0, "interest");
+
+    const long nearDecoded = fgGetLong("/sim/multiplay/interest/near/decoded");
+    const long farDecoded = fgGetLong("/sim/multiplay/interest/far/decoded");
+    const long farSkipped = fgGetLong("/sim/multiplay/interest/far/skipped");
+    CPPUNIT_ASSERT_EQUAL(long(NUM_PEERS * PACKETS_PER_PEER * 3 / 2), nearDecoded);
+    CPPUNIT_ASSERT_EQUAL(long(NUM_PEERS / 2), farDecoded);
+    CPPUNIT_ASSERT_EQUAL(long(NUM_PEERS / 2 * (PACKETS_PER_PEER - 1)), farSkipped);
+}
@@ -4,8 +4,12 @@
 #include "test_suite/FGTestApi/NavDataCache.hxx"
 
 #include <Navaids/NavDataCache.hxx>
+#include <Navaids/PositionedSpatialIndex.hxx>
 #include <Navaids/navrecord.hxx>
 #include <Navaids/navlist.hxx>
+#include <Airports/airport.hxx>
+
+#include <algorithm>
 
 
 // Set up function for each test.
@@ -34,3 +38,62 @@ void NavaidsTests::testBasic()
     CPPUNIT_ASSERT_EQUAL(tla->get_freq(), 11570);
     CPPUNIT_ASSERT_EQUAL(tla->get_range(), 130);
 }
+
+
+static std::vector<PositionedID> sortedIds(const FGPositionedList& items)
+{
+    std::vector<PositionedID> ids;
+    for (const auto& p : items)
+        ids.push_back(p->guid());
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+void NavaidsTests::testSpatialIndex()
+{
+    auto cache = flightgear::NavDataCache::instance();
+    CPPUNIT_ASSERT(cache->spatialIndex() != nullptr);
+
+    const SGGeod positions[] = {
+        SGGeod::fromDeg(-2.27, 53.35),   // EGCC
+        SGGeod::fromDeg(-122.37, 37.62), // KSFO
+        SGGeod::fromDeg(151.18, -33.94), // YSSY
+        SGGeod::fromDeg(-43.0, 30.0)     // mid-Atlantic
+    };
+
+    FGPositioned::TypeFilter navaids({FGPositioned::VOR, FGPositioned::NDB});
+    FGAirport::AirportFilter airports;
+
+    for (const auto& pos : positions) {
+        for (FGPositioned::Filter* filter : {static_cast<FGPositioned::Filter*>(&navaids),
+                                             static_cast<FGPositioned::Filter*>(&airports)}) {
+            cache->setUseSpatialIndex(true);
+            FGPositionedList inRange = FGPositioned::findWithinRange(pos, 80.0, filter);
+            FGPositionedList closest = FGPositioned::findClosestN(pos, 10, 500.0, filter);
+
+            cache->setUseSpatialIndex(false);
+            CPPUNIT_ASSERT(cache->spatialIndex() == nullptr);
+            FGPositionedList octreeInRange = FGPositioned::findWithinRange(pos, 80.0, filter);
+            FGPositionedList octreeClosest = FGPositioned::findClosestN(pos, 10, 500.0, filter);
+
+            // ordering of equidistant items may differ, so compare the
+            // range query results as sets
+            CPPUNIT_ASSERT(sortedIds(inRange) == sortedIds(octreeInRange));
+
+            CPPUNIT_ASSERT_EQUAL(octreeClosest.size(), closest.size());
+            for (size_t i = 0; i < closest.size(); ++i) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(SGGeodesy::distanceM(pos, octreeClosest[i]->geod()),
+                                             SGGeodesy::distanceM(pos, closest[i]->geod()),
+                                             0.01);
+            }
+        }
+    }
+
+    // asking for no results must not look at an empty result list
+    for (bool useIndex : {true, false}) {
+        cache->setUseSpatialIndex(useIndex);
+        CPPUNIT_ASSERT(FGPositioned::findClosestN(positions[0], 0, 500.0, &airports).empty());
+    }
+
+    cache->setUseSpatialIndex(true);
+}
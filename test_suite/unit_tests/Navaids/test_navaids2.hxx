@@ -32,6 +32,7 @@ class NavaidsTests : public CppUnit::TestFixture
     // Set up the test suite.
     CPPUNIT_TEST_SUITE(NavaidsTests);
     CPPUNIT_TEST(testBasic);
+    CPPUNIT_TEST(testSpatialIndex);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -43,6 +44,7 @@ public:
 
     // The tests.
     void testBasic();
+    void testSpatialIndex();
 };
 
 #endif  // _FG_NAVAIDS_UNIT_TESTS_HXX
@@ -0,0 +1,182 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "config.h"
+
+#include "test_generic.hxx"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#include <simgear/io/iostreams/sgstream.hxx>
+#include <simgear/io/sg_file.hxx>
+#include <simgear/misc/sg_dir.hxx>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <Main/fg_props.hxx>
+#include <Main/globals.hxx>
+#include <Network/generic.hxx>
+
+namespace {
+
+void writeProtocol(const SGPath& dir, const std::string& name, const std::string& xml)
+{
+    sg_ofstream out(dir / "Protocol" / (name + ".xml"));
+    out << "<?xml version=\"1.0\"?>\n<PropertyList>\n<generic>\n"
+        << xml << "</generic>\n</PropertyList>\n";
+}
+
+// Runs one output message of the protocol through a file channel, and
+// returns what was written.
+std::string generateOnce(const SGPath& dir, const std::string& name)
+{
+    const SGPath outPath = dir / (name + ".out");
+    std::unique_ptr<FGGeneric> generic(
+        new FGGeneric({"generic", "file", "out", "10", outPath.utf8Str(), name}));
+    CPPUNIT_ASSERT(generic->getInitOk());
+
+    generic->set_io_channel(new SGFile(outPath));
+    CPPUNIT_ASSERT(generic->open());
+    CPPUNIT_ASSERT(generic->process());
+    CPPUNIT_ASSERT(generic->close());
+
+    sg_ifstream in(outPath, std::ios::in | std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void GenericProtocolTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("generic");
+
+    _dataDir = globals->get_fg_home() / "generic-protocol-test";
+    simgear::Dir(_dataDir / "Protocol").create(0755);
+    globals->append_data_path(_dataDir);
+}
+
+
+// Clean up after each test.
+void GenericProtocolTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void GenericProtocolTests::testAsciiOutput()
+{
+    writeProtocol(_dataDir, "test-ascii",
+        "<output>\n"
+        " <line_separator>newline</line_separator>\n"
+        " <var_separator>,</var_separator>\n"
+        " <chunk><node>/test/int</node><type>int</type><factor>2</factor><offset>1</offset></chunk>\n"
+        " <chunk><node>/test/float</node><type>float</type><format>%.2f</format></chunk>\n"
+        " <chunk><node>/test/bool</node><type>bool</type></chunk>\n"
+        " <chunk><node>/test/string</node><type>string</type><format>[%s]</format></chunk>\n"
+        " <chunk><node>/test/double</node><type>double</type><format>%.3f</format></chunk>\n"
+        " <chunk><type>int</type><const>7</const></chunk>\n"
+        "</output>\n");
+
+    fgSetInt("/test/int", 20);
+    fgSetDouble("/test/float", 1.5);
+    fgSetBool("/test/bool", true);
+    fgSetString("/test/string", "hello");
+    fgSetDouble("/test/double", -0.25);
+
+    CPPUNIT_ASSERT_EQUAL(std::string("41,1.50,1,[hello],-0.250,7\n"),
+                         generateOnce(_dataDir, "test-ascii"));
+
+    // formats with more than one conversion are refused, the line is
+    // still written
+    writeProtocol(_dataDir, "test-bad-format",
+        "<output>\n"
+        " <line_separator>newline</line_separator>\n"
+        " <chunk><node>/test/int</node><type>int</type><format>%s%s</format></chunk>\n"
+        "</output>\n");
+    const std::string badFormat = generateOnce(_dataDir, "test-bad-format");
+    CPPUNIT_ASSERT(!badFormat.empty());
+    CPPUNIT_ASSERT_EQUAL('\n', badFormat.back());
+}
+
+
+void GenericProtocolTests::testBinaryOutput()
+{
+    writeProtocol(_dataDir, "test-binary",
+        "<output>\n"
+        " <binary_mode>true</binary_mode>\n"
+        " <binary_footer>length</binary_footer>\n"
+        " <byte_order>network</byte_order>\n"
+        " <chunk><node>/test/int</node><type>int</type></chunk>\n"
+        " <chunk><node>/test/bool</node><type>bool</type></chunk>\n"
+        " <chunk><node>/test/string</node><type>string</type></chunk>\n"
+        " <chunk><node>/test/double</node><type>double</type><factor>2</factor></chunk>\n"
+        "</output>\n");
+
+    fgSetInt("/test/int", 0x010203);
+    fgSetBool("/test/bool", true);
+    fgSetString("/test/string", "abc");
+    fgSetDouble("/test/double", 0.75);
+
+    const std::string msg = generateOnce(_dataDir, "test-binary");
+    const unsigned char expected[] = {
+        0x00, 0x01, 0x02, 0x03,                         // int
+        0x01,                                           // bool
+        0x00, 0x00, 0x00, 0x03, 'a', 'b', 'c',          // string
+        0x3f, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 1.5
+        0x00, 0x00, 0x00, 0x14                          // footer: length 20
+    };
+    CPPUNIT_ASSERT_EQUAL(sizeof(expected), msg.size());
+    CPPUNIT_ASSERT(memcmp(expected, msg.data(), msg.size()) == 0);
+}
+
+
+// The compiled chunks must format values exactly like the snprintf() calls
+// they replace.
+void GenericProtocolTests::testFormatsMatchPrintf()
+{
+    writeProtocol(_dataDir, "test-printf",
+        "<output>\n"
+        " <line_separator>newline</line_separator>\n"
+        " <var_separator>tab</var_separator>\n"
+        " <chunk><node>/test/int</node><type>int</type><format>%05d</format></chunk>\n"
+        " <chunk><node>/test/int</node><type>int</type><format>x=%-4d|</format></chunk>\n"
+        " <chunk><node>/test/float</node><type>float</type><format>%8.3f</format></chunk>\n"
+        " <chunk><node>/test/double</node><type>double</type><format>%e</format></chunk>\n"
+        " <chunk><node>/test/double</node><type>double</type><format>%g</format></chunk>\n"
+        " <chunk><node>/test/string</node><type>string</type><format>%-6s|</format></chunk>\n"
+        " <chunk><node>/test/bool</node><type>bool</type><format>b%d</format></chunk>\n"
+        "</output>\n");
+
+    const int i = -42;
+    const double f = 3.14159;
+    const double d = 12345.678;
+    fgSetInt("/test/int", i);
+    fgSetDouble("/test/float", f);
+    fgSetDouble("/test/double", d);
+    fgSetString("/test/string", "ab");
+    fgSetBool("/test/bool", true);
+
+    char expected[256];
+    snprintf(expected, sizeof(expected), "%05d\tx=%-4d|\t%8.3f\t%e\t%g\t%-6s|\tb%d\n",
+             i, i, static_cast<float>(f), d, d, "ab", 1);
+    CPPUNIT_ASSERT_EQUAL(std::string(expected), generateOnce(_dataDir, "test-printf"));
+}
@@ -0,0 +1,405 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "config.h"
+
+#include "test_property_stream.hxx"
+
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <Main/fg_props.hxx>
+#include <Network/http/PropertyChangeObserver.hxx>
+#include <Network/http/PropertyStreamWriter.hxx>
+
+using flightgear::http::PropertyChangeObserver;
+using flightgear::http::PropertyChangeObserverEntryRef;
+using flightgear::http::PropertyStreamWriter;
+
+namespace {
+
+std::string bytes(std::initializer_list<int> b)
+{
+    std::string s;
+    for (int c : b)
+        s += static_cast<char>(c);
+    return s;
+}
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void PropertyStreamTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("property-stream");
+}
+
+
+// Clean up after each test.
+void PropertyStreamTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void PropertyStreamTests::testJsonSeparators()
+{
+    std::unique_ptr<PropertyStreamWriter> w =
+        PropertyStreamWriter::create(PropertyStreamWriter::FORMAT_JSON);
+    CPPUNIT_ASSERT(!w->isBinary());
+    CPPUNIT_ASSERT(w->empty());
+
+    w->beginObject();
+    w->key("a");
+    w->value(1);
+    w->key("empty-array");
+    w->beginArray();
+    w->endArray();
+    w->key("empty-object");
+    w->beginObject();
+    w->endObject();
+    w->key("nested");
+    w->beginArray();
+    w->value(true);
+    w->nullValue();
+    w->beginObject();
+    w->key("b");
+    w->value("x");
+    w->endObject();
+    w->beginArray();
+    w->endArray();
+    w->beginArray();
+    w->beginArray();
+    w->value(2);
+    w->endArray();
+    w->value(3);
+    w->endArray();
+    w->value("");
+    w->endArray();
+    // strings ending with characters that open containers or follow names
+    w->key("{[:");
+    w->value("[");
+    w->key("c");
+    w->value(":");
+    w->endObject();
+
+    CPPUNIT_ASSERT_EQUAL(std::string(
+        "{\"a\":1,\"empty-array\":[],\"empty-object\":{},"
+        "\"nested\":[true,null,{\"b\":\"x\"},[],[[2],3],\"\"],"
+        "\"{[:\":\"[\",\"c\":\":\"}"), w->data());
+
+    // a cleared writer starts a new document
+    w->clear();
+    CPPUNIT_ASSERT(w->empty());
+    w->beginArray();
+    w->endArray();
+    CPPUNIT_ASSERT_EQUAL(std::string("[]"), w->data());
+
+    w->clear();
+    w->beginObject();
+    w->endObject();
+    CPPUNIT_ASSERT_EQUAL(std::string("{}"), w->data());
+}
+
+
+void PropertyStreamTests::testJsonValues()
+{
+    std::unique_ptr<PropertyStreamWriter> w =
+        PropertyStreamWriter::create(PropertyStreamWriter::FORMAT_JSON);
+
+    w->beginArray();
+    w->value(0);
+    w->value(-3);
+    w->value(7u);
+    w->value(2.5);
+    w->value(0.1);
+    w->value(1e20);
+    w->value(std::numeric_limits<double>::quiet_NaN());
+    w->value(std::numeric_limits<double>::infinity());
+    w->value(false);
+    w->value("q\"\\\n\t\x01/");
+    w->value(std::string("s"));
+    w->endArray();
+
+    CPPUNIT_ASSERT_EQUAL(std::string(
+        "[0,-3,7,2.5,0.1,1e+20,null,null,false,"
+        "\"q\\\"\\\\\\n\\t\\u0001/\",\"s\"]"), w->data());
+
+    // property nodes, with the members of JSON::toJson
+    fgSetInt("/test/stream/int", 5);
+    fgSetString("/test/stream/string", "abc");
+    SGPropertyNode* empty = fgGetNode("/test/stream/empty", true);
+
+    w->clear();
+    w->beginArray();
+    w->propertyObject(fgGetNode("/test/stream/int"));
+    w->propertyObject(fgGetNode("/test/stream/string"), 1.5);
+    w->propertyObject(empty);
+    w->endArray();
+
+    CPPUNIT_ASSERT_EQUAL(std::string(
+        "[{\"path\":\"/test/stream/int\",\"name\":\"int\",\"value\":5,"
+        "\"type\":\"int\",\"index\":0,\"nChildren\":0},"
+        "{\"path\":\"/test/stream/string\",\"name\":\"string\",\"value\":\"abc\","
+        "\"type\":\"string\",\"index\":0,\"ts\":1.5,\"nChildren\":0},"
+        "{\"path\":\"/test/stream/empty\",\"name\":\"empty\","
+        "\"type\":\"-\",\"index\":0,\"nChildren\":0}]"), w->data());
+}
+
+
+void PropertyStreamTests::testCborContainers()
+{
+    std::unique_ptr<PropertyStreamWriter> w =
+        PropertyStreamWriter::create(PropertyStreamWriter::FORMAT_CBOR);
+    CPPUNIT_ASSERT(w->isBinary());
+
+    // containers are always of indefinite length, closed by a break
+    w->beginObject();
+    w->key("a");
+    w->value(1);
+    w->key("b");
+    w->beginArray();
+    w->endArray();
+    w->key("c");
+    w->beginObject();
+    w->endObject();
+    w->key("d");
+    w->beginArray();
+    w->beginArray();
+    w->value(2);
+    w->endArray();
+    w->nullValue();
+    w->endArray();
+    w->endObject();
+
+    CPPUNIT_ASSERT_EQUAL(bytes({
+        0xbf,
+        0x61, 'a', 0x01,
+        0x61, 'b', 0x9f, 0xff,
+        0x61, 'c', 0xbf, 0xff,
+        0x61, 'd', 0x9f, 0x9f, 0x02, 0xff, 0xf6, 0xff,
+        0xff}), w->data());
+
+    w->clear();
+    w->beginArray();
+    w->endArray();
+    CPPUNIT_ASSERT_EQUAL(bytes({0x9f, 0xff}), w->data());
+}
+
+
+void PropertyStreamTests::testCborValues()
+{
+    std::unique_ptr<PropertyStreamWriter> w =
+        PropertyStreamWriter::create(PropertyStreamWriter::FORMAT_CBOR);
+
+    auto encode = [&w](double d) {
+        w->clear();
+        w->value(d);
+        return w->data();
+    };
+
+    // unsigned integers, major type 0, with all argument sizes
+    CPPUNIT_ASSERT_EQUAL(bytes({0x00}), encode(0));
+    CPPUNIT_ASSERT_EQUAL(bytes({0x17}), encode(23));
+    CPPUNIT_ASSERT_EQUAL(bytes({0x18, 0x18}), encode(24));
+    CPPUNIT_ASSERT_EQUAL(bytes({0x18, 0xff}), encode(255));
+    CPPUNIT_ASSERT_EQUAL(bytes({0x19, 0x01, 0x00}), encode(256));
+    CPPUNIT_ASSERT_EQUAL(bytes({0x19, 0xff, 0xff}), encode(65535));
+    CPPUNIT_ASSERT_EQUAL(bytes({0x1a, 0x00, 0x01, 0x00, 0x00}), encode(65536));
+    CPPUNIT_ASSERT_EQUAL(bytes({0x1b, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00}),
+                         encode(4294967296.0));
+
+    // negative integers, major type 1, encode -1 - n
+    CPPUNIT_ASSERT_EQUAL(bytes({0x20}), encode(-1));
+    CPPUNIT_ASSERT_EQUAL(bytes({0x37}), encode(-24));
+    CPPUNIT_ASSERT_EQUAL(bytes({0x38, 0x18}), encode(-25));
+    CPPUNIT_ASSERT_EQUAL(bytes({0x39, 0x01, 0xf3}), encode(-500));
+    CPPUNIT_ASSERT_EQUAL(bytes({0x3b, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00}),
+                         encode(-4294967297.0));
+
+    // floats in single precision when that is exact, else double precision
+    CPPUNIT_ASSERT_EQUAL(bytes({0xfa, 0x3f, 0xc0, 0x00, 0x00}), encode(1.5));
+    CPPUNIT_ASSERT_EQUAL(bytes({0xfa, 0xc0, 0x10, 0x00, 0x00}), encode(-2.25));
+    CPPUNIT_ASSERT_EQUAL(bytes({0xfa, 0x7f, 0x80, 0x00, 0x00}),
+                         encode(std::numeric_limits<double>::infinity()));
+    CPPUNIT_ASSERT_EQUAL(bytes({0xfb, 0x3f, 0xb9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a}),
+                         encode(0.1));
+    CPPUNIT_ASSERT_EQUAL(bytes({0xf6}),
+                         encode(std::numeric_limits<double>::quiet_NaN()));
+
+    // integer overloads go through the same encoding
+    w->clear();
+    w->value(-7);
+    w->value(300u);
+    CPPUNIT_ASSERT_EQUAL(bytes({0x26, 0x19, 0x01, 0x2c}), w->data());
+
+    // simple values
+    w->clear();
+    w->value(false);
+    w->value(true);
+    w->nullValue();
+    CPPUNIT_ASSERT_EQUAL(bytes({0xf4, 0xf5, 0xf6}), w->data());
+
+    // text strings, major type 3, the length is in bytes
+    w->clear();
+    w->value("");
+    w->value("abc");
+    CPPUNIT_ASSERT_EQUAL(bytes({0x60, 0x63, 'a', 'b', 'c'}), w->data());
+
+    const std::string s30(30, 'x');
+    w->clear();
+    w->value(s30);
+    CPPUNIT_ASSERT_EQUAL(bytes({0x78, 0x1e}) + s30, w->data());
+
+    const std::string s300(300, 'y');
+    w->clear();
+    w->value(s300);
+    CPPUNIT_ASSERT_EQUAL(bytes({0x79, 0x01, 0x2c}) + s300, w->data());
+
+    // embedded zero bytes and quotes are written as they are
+    w->clear();
+    w->value("a\0\"", 3);
+    CPPUNIT_ASSERT_EQUAL(bytes({0x63, 'a', 0x00, '"'}), w->data());
+}
+
+
+void PropertyStreamTests::testObserverVersions()
+{
+    PropertyChangeObserver observer;
+
+    {
+        fgSetInt("/test/observe/int", 1);
+        PropertyChangeObserverEntryRef entry = observer.addObservation("/test/observe/int");
+        CPPUNIT_ASSERT(entry.valid());
+        CPPUNIT_ASSERT_EQUAL(1u, entry->version());
+
+        // nothing written
+        observer.check();
+        CPPUNIT_ASSERT_EQUAL(1u, entry->version());
+
+        fgSetInt("/test/observe/int", 2);
+        observer.check();
+        CPPUNIT_ASSERT_EQUAL(2u, entry->version());
+
+        // writes of the same value are no change
+        fgSetInt("/test/observe/int", 2);
+        observer.check();
+        CPPUNIT_ASSERT_EQUAL(2u, entry->version());
+
+        // several changes between two checks are a single one
+        fgSetInt("/test/observe/int", 3);
+        fgSetInt("/test/observe/int", 4);
+        observer.check();
+        CPPUNIT_ASSERT_EQUAL(3u, entry->version());
+
+        // and none at all if the value is back where it was
+        fgSetInt("/test/observe/int", 9);
+        fgSetInt("/test/observe/int", 4);
+        observer.check();
+        CPPUNIT_ASSERT_EQUAL(3u, entry->version());
+
+        // adding the same node again shares the entry and its version
+        PropertyChangeObserverEntryRef again = observer.addObservation("/test/observe/int");
+        CPPUNIT_ASSERT(again == entry);
+        CPPUNIT_ASSERT_EQUAL(3u, again->version());
+
+        fgSetInt("/test/observe/int", 5);
+        observer.check();
+        CPPUNIT_ASSERT_EQUAL(4u, again->version());
+
+        // other nodes are independent
+        fgSetString("/test/observe/string", "a");
+        fgSetDouble("/test/observe/double", std::numeric_limits<double>::quiet_NaN());
+        PropertyChangeObserverEntryRef str = observer.addObservation("/test/observe/string");
+        PropertyChangeObserverEntryRef dbl = observer.addObservation("/test/observe/double");
+        CPPUNIT_ASSERT(str != entry);
+        CPPUNIT_ASSERT_EQUAL(1u, str->version());
+        CPPUNIT_ASSERT_EQUAL(1u, dbl->version());
+
+        // NaN is no change of NaN
+        fgSetString("/test/observe/string", "a");
+        fgSetDouble("/test/observe/double", std::numeric_limits<double>::quiet_NaN());
+        observer.check();
+        CPPUNIT_ASSERT_EQUAL(1u, str->version());
+        CPPUNIT_ASSERT_EQUAL(1u, dbl->version());
+        CPPUNIT_ASSERT_EQUAL(4u, entry->version());
+
+        fgSetString("/test/observe/string", "b");
+        fgSetDouble("/test/observe/double", 0.5);
+        observer.check();
+        CPPUNIT_ASSERT_EQUAL(2u, str->version());
+        CPPUNIT_ASSERT_EQUAL(2u, dbl->version());
+        CPPUNIT_ASSERT_EQUAL(4u, entry->version());
+    }
+
+    // once nobody but the observer holds the entries, they are dropped
+    observer.check();
+    fgSetInt("/test/observe/int", 6);
+    observer.check();
+
+    // adding the node back starts over with a new entry
+    PropertyChangeObserverEntryRef readded = observer.addObservation("/test/observe/int");
+    CPPUNIT_ASSERT(readded.valid());
+    CPPUNIT_ASSERT_EQUAL(1u, readded->version());
+    observer.check();
+    CPPUNIT_ASSERT_EQUAL(1u, readded->version());
+    fgSetInt("/test/observe/int", 7);
+    observer.check();
+    CPPUNIT_ASSERT_EQUAL(2u, readded->version());
+
+    // entries still held by a websocket keep working after a clear
+    observer.clear();
+    fgSetInt("/test/observe/int", 8);
+    CPPUNIT_ASSERT_EQUAL(2u, readded->version());
+    readded->check();
+    CPPUNIT_ASSERT_EQUAL(3u, readded->version());
+}
+
+
+void PropertyStreamTests::testObserverTiedNode()
+{
+    PropertyChangeObserver observer;
+
+    int value = 1;
+    SGPropertyNode* node = fgGetNode("/test/observe/tied", true);
+    node->setIntValue(1);
+    PropertyChangeObserverEntryRef entry = observer.addObservation("/test/observe/tied");
+    CPPUNIT_ASSERT_EQUAL(1u, entry->version());
+
+    // tied nodes do not fire listeners, they are compared on every check
+    CPPUNIT_ASSERT(node->tie(SGRawValuePointer<int>(&value), false));
+    observer.check();
+    CPPUNIT_ASSERT_EQUAL(1u, entry->version());
+
+    value = 2;
+    observer.check();
+    CPPUNIT_ASSERT_EQUAL(2u, entry->version());
+    observer.check();
+    CPPUNIT_ASSERT_EQUAL(2u, entry->version());
+
+    value = 3;
+    observer.check();
+    CPPUNIT_ASSERT_EQUAL(3u, entry->version());
+
+    node->untie();
+}
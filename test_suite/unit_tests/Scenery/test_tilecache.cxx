@@ -0,0 +1,316 @@
+/*
+ * This file is part of the program FlightGear.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "test_tilecache.hxx"
+
+#include <random>
+#include <vector>
+
+#include <osg/Array>
+#include <osg/Geode>
+#include <osg/Geometry>
+
+#include <simgear/bucket/newbucket.hxx>
+
+#include "test_suite/FGTestApi/testGlobals.hxx"
+
+#include <Scenery/tilecache.hxx>
+#include <Scenery/tileentry.hxx>
+
+namespace {
+
+// A tile of its own bucket for each i
+TileEntry* newTile(int i)
+{
+    return new TileEntry(SGBucket(SGGeod::fromDeg(-179.5 + i, 0.5)));
+}
+
+long tileIndex(const TileEntry* e)
+{
+    return e->get_tile_bucket().gen_index();
+}
+
+void removeTile(TileCache& cache, TileEntry* e)
+{
+    cache.clear_entry(tileIndex(e));
+    delete e;
+}
+
+// Makes the tile count as loaded, with the given number of vertices
+void loadTile(TileEntry* e, unsigned vertices)
+{
+    osg::Geometry* geometry = new osg::Geometry;
+    geometry->setVertexArray(new osg::Vec3Array(vertices));
+    osg::Geode* geode = new osg::Geode;
+    geode->addDrawable(geometry);
+    e->getNode()->addChild(geode);
+}
+
+} // of anonymous namespace
+
+
+// Set up function for each test.
+void TileCacheTests::setUp()
+{
+    FGTestApi::setUp::initTestGlobals("tilecache");
+}
+
+
+// Clean up after each test.
+void TileCacheTests::tearDown()
+{
+    FGTestApi::tearDown::shutdownTestGlobals();
+}
+
+
+void TileCacheTests::checkHeap(const TileCache& cache)
+{
+    const std::vector<TileEntry*>& heap = cache.drop_heap;
+    CPPUNIT_ASSERT_EQUAL(cache.get_size(), heap.size());
+    for (size_t i = 0; i < heap.size(); ++i) {
+        CPPUNIT_ASSERT_EQUAL(i, heap[i]->_drop_heap_index);
+        CPPUNIT_ASSERT(cache.get_tile(tileIndex(heap[i])) == heap[i]);
+        if (i > 0)
+            CPPUNIT_ASSERT(!TileCache::drop_before(heap[i], heap[(i - 1) / 2]));
+    }
+}
+
+
+void TileCacheTests::testDropOrder()
+{
+    TileCache cache;
+    auto front = [&cache]() { return cache.drop_heap.front(); };
+
+    TileEntry* a = newTile(0);
+    TileEntry* b = newTile(1);
+    TileEntry* c = newTile(2);
+    TileEntry* d = newTile(3);
+    for (TileEntry* e : {a, b, c, d})
+        cache.insert_tile(e);
+    checkHeap(cache);
+
+    // tiles outside of the view go first, by expiry time and priority
+    cache.request_tile(a, 1.0, false, 30.0);
+    cache.request_tile(b, 2.0, false, 20.0);
+    cache.request_tile(c, 3.0, true, 10.0);
+    cache.request_tile(d, 4.0, false, 20.0);
+    checkHeap(cache);
+    CPPUNIT_ASSERT(front() == b);
+
+    // only expired tiles are offered for dropping
+    CPPUNIT_ASSERT_EQUAL(-1L, cache.get_first_expired_tile());
+    cache.set_current_time(25.0);
+    CPPUNIT_ASSERT_EQUAL(tileIndex(b), cache.get_first_expired_tile());
+    cache.set_current_time(0.0);
+
+    // a higher priority keeps a tile longer
+    cache.request_tile(b, 5.0, false, 1.0);
+    checkHeap(cache);
+    CPPUNIT_ASSERT(front() == d);
+
+    // tiles leaving the view are ordered by their expiry time
+    cache.clear_current_view();
+    checkHeap(cache);
+    CPPUNIT_ASSERT(front() == c);
+
+    // and move to the end when they enter it again
+    cache.request_tile(c, 3.0, true, 0.0);
+    checkHeap(cache);
+    CPPUNIT_ASSERT(front() == d);
+
+    // a later expiry time
+    cache.request_tile(d, 4.0, false, 40.0);
+    checkHeap(cache);
+    CPPUNIT_ASSERT(front() == b);
+
+    removeTile(cache, a);
+    checkHeap(cache);
+
+    const std::vector<TileEntry*> expected = {b, d, c};
+    for (TileEntry* e : expected) {
+        CPPUNIT_ASSERT(front() == e);
+        removeTile(cache, e);
+        checkHeap(cache);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(0), cache.get_size());
+    CPPUNIT_ASSERT_EQUAL(-1L, cache.get_first_expired_tile());
+}
+
+
+void TileCacheTests::testRemoveArbitrary()
+{
+    TileCache cache;
+
+    // distinct expiry times, not in insertion order
+    const int n = 31;
+    std::vector<TileEntry*> tiles;
+    for (int i = 0; i < n; ++i) {
+        TileEntry* e = newTile(i);
+        tiles.push_back(e);
+        cache.insert_tile(e);
+        cache.request_tile(e, static_cast<float>(i % 5), false, 1.0 + (i * 7) % n);
+        checkHeap(cache);
+    }
+
+    // from the top, the bottom and in between
+    int removed = 0;
+    for (int i = 1; i < n; i += 3) {
+        removeTile(cache, tiles[i]);
+        checkHeap(cache);
+        ++removed;
+    }
+    removeTile(cache, cache.drop_heap.front());
+    checkHeap(cache);
+    removeTile(cache, cache.drop_heap.back());
+    checkHeap(cache);
+    removed += 2;
+    CPPUNIT_ASSERT_EQUAL(size_t(n - removed), cache.get_size());
+
+    double prevExpiry = -1.0;
+    while (cache.get_size() > 0) {
+        TileEntry* e = cache.drop_heap.front();
+        CPPUNIT_ASSERT(e->get_time_expired() > prevExpiry);
+        prevExpiry = e->get_time_expired();
+        removeTile(cache, e);
+        checkHeap(cache);
+    }
+}
+
+
+void TileCacheTests::testRandomUpdates()
+{
+    TileCache cache;
+    std::mt19937 rng(42);
+
+    int nextTile = 0;
+    std::vector<TileEntry*> tiles;
+    for (; nextTile < 40; ++nextTile) {
+        tiles.push_back(newTile(nextTile));
+        cache.insert_tile(tiles.back());
+    }
+
+    for (int step = 0; step < 1000; ++step) {
+        const size_t k = rng() % tiles.size();
+        switch (rng() % 8) {
+        case 0:
+            cache.clear_current_view();
+            break;
+        case 1:
+            cache.set_current_time(cache.get_current_time() + 1.0);
+            break;
+        case 2:
+            // replace a tile
+            removeTile(cache, tiles[k]);
+            tiles[k] = newTile(nextTile++);
+            cache.insert_tile(tiles[k]);
+            break;
+        default: {
+            const float priority = static_cast<float>(rng() % 10);
+            const bool currentView = rng() % 4 == 0;
+            const double requestTime = static_cast<double>(rng() % 20);
+            cache.request_tile(tiles[k], priority, currentView, requestTime);
+            break;
+        }
+        }
+
+        checkHeap(cache);
+        const TileEntry* top = cache.drop_heap.front();
+        for (const TileEntry* t : tiles)
+            CPPUNIT_ASSERT(!TileCache::drop_before(t, top));
+    }
+
+    // the tiles come off the heap in drop order, they are deleted at the
+    // end to compare each with the one before
+    std::vector<TileEntry*> drained;
+    while (cache.get_size() > 0) {
+        TileEntry* e = cache.drop_heap.front();
+        if (!drained.empty())
+            CPPUNIT_ASSERT(!TileCache::drop_before(e, drained.back()));
+        drained.push_back(e);
+        cache.clear_entry(tileIndex(e));
+        checkHeap(cache);
+    }
+    for (TileEntry* e : drained)
+        delete e;
+}
+
+
+void TileCacheTests::testBudget()
+{
+    TileCache cache;
+    cache.set_max_cache_size(3);
+
+    // without a memory budget, the tiles are counted
+    std::vector<TileEntry*> tiles;
+    for (int i = 0; i < 3; ++i) {
+        tiles.push_back(newTile(i));
+        cache.insert_tile(tiles.back());
+    }
+    CPPUNIT_ASSERT(!cache.is_over_budget(false));
+
+    tiles.push_back(newTile(3));
+    cache.insert_tile(tiles.back());
+    CPPUNIT_ASSERT(cache.is_over_budget(false));
+    CPPUNIT_ASSERT(!cache.is_over_budget(true));
+
+    for (int i = 4; i < 14; ++i) {
+        tiles.push_back(newTile(i));
+        cache.insert_tile(tiles.back());
+    }
+    CPPUNIT_ASSERT(cache.is_over_budget(true));
+
+    // only tiles which finished loading use memory
+    loadTile(tiles[0], 100);
+    loadTile(tiles[1], 50);
+    std::vector<TileEntry*> loaded;
+    cache.collect_loaded(loaded);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), loaded.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(12), cache.get_pending().size());
+    const size_t bytes = tiles[0]->get_memory_bytes() + tiles[1]->get_memory_bytes();
+    CPPUNIT_ASSERT(tiles[0]->get_memory_bytes() >= 100 * sizeof(osg::Vec3));
+    CPPUNIT_ASSERT(tiles[1]->get_memory_bytes() >= 50 * sizeof(osg::Vec3));
+    CPPUNIT_ASSERT_EQUAL(bytes, cache.get_memory_usage());
+
+    // with a memory budget, the tile count no longer matters
+    cache.set_max_memory(bytes);
+    CPPUNIT_ASSERT(!cache.is_over_budget(false));
+    cache.set_max_memory(bytes - 1);
+    CPPUNIT_ASSERT(cache.is_over_budget(false));
+    CPPUNIT_ASSERT(!cache.is_over_budget(true));
+    cache.set_max_memory(bytes * 10 / 12);
+    CPPUNIT_ASSERT(cache.is_over_budget(true));
+
+    // dropping a loaded tile releases its memory, pending tiles have none
+    const size_t remaining = tiles[1]->get_memory_bytes();
+    removeTile(cache, tiles[0]);
+    CPPUNIT_ASSERT_EQUAL(remaining, cache.get_memory_usage());
+    removeTile(cache, tiles[5]);
+    CPPUNIT_ASSERT_EQUAL(remaining, cache.get_memory_usage());
+    CPPUNIT_ASSERT_EQUAL(size_t(11), cache.get_pending().size());
+    cache.set_max_memory(remaining);
+    CPPUNIT_ASSERT(!cache.is_over_budget(false));
+
+    // and back to counting tiles
+    cache.set_max_memory(0);
+    CPPUNIT_ASSERT_EQUAL(size_t(12), cache.get_size());
+    CPPUNIT_ASSERT(cache.is_over_budget(false));
+    CPPUNIT_ASSERT(!cache.is_over_budget(true));
+    cache.set_max_cache_size(12);
+    CPPUNIT_ASSERT(!cache.is_over_budget(false));
+}
@@ -0,0 +1,143 @@
+// fglogconvert.cxx -- convert a binary FGLogger log to CSV
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <Main/logger_format.hxx>
+
+using std::cerr;
+using std::endl;
+using std::string;
+
+using namespace flightgear;
+
+static void usage(const char* prog)
+{
+    cerr << "Usage: " << prog << " [--delimiter=C] [--schema] <log.fglog> [<output.csv>]" << endl
+         << "  Converts a binary log written by the FlightGear logger to CSV." << endl
+         << "  Without an output file, the CSV is written to standard output." << endl
+         << "  --schema only prints the columns and their types." << endl;
+}
+
+static const char* typeName(logformat::ColumnType type)
+{
+    switch (type) {
+    case logformat::BOOL:   return "bool";
+    case logformat::INT:    return "int";
+    case logformat::LONG:   return "long";
+    case logformat::FLOAT:  return "float";
+    case logformat::DOUBLE: return "double";
+    case logformat::STRING: return "string";
+    }
+    return "unknown";
+}
+
+int main(int argc, char** argv)
+{
+    char delimiter = ',';
+    bool schema = false;
+    std::vector<string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strncmp(argv[i], "--delimiter=", 12) && argv[i][12]) {
+            delimiter = argv[i][12];
+        } else if (!strcmp(argv[i], "--schema")) {
+            schema = true;
+        } else if (argv[i][0] == '-' && argv[i][1]) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    if (files.empty() || files.size() > 2) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream in(files[0], std::ios::in | std::ios::binary);
+    if (!in) {
+        cerr << "Cannot open " << files[0] << endl;
+        return EXIT_FAILURE;
+    }
+
+    logformat::Reader reader(in);
+    if (reader.readHeader() != logformat::Reader::OK) {
+        cerr << files[0] << " is not a binary FlightGear log" << endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<logformat::Column>& columns = reader.columns();
+    if (schema) {
+        for (const auto& c : columns)
+            std::cout << c.name << ": " << typeName(c.type) << endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::ofstream file;
+    if (files.size() == 2) {
+        file.open(files[1]);
+        if (!file) {
+            cerr << "Cannot write " << files[1] << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::ostream& out = (files.size() == 2) ? file : std::cout;
+
+    for (size_t c = 0; c < columns.size(); ++c) {
+        if (c > 0)
+            out << delimiter;
+        out << columns[c].name;
+    }
+    out << '\n';
+
+    std::vector<logformat::Row> rows;
+    unsigned long num_rows = 0, damaged = 0;
+    for (;;) {
+        const logformat::Reader::Status status = reader.readBlock(rows);
+        if (status == logformat::Reader::END)
+            break;
+        if (status == logformat::Reader::CORRUPT) {
+            ++damaged;
+            continue;
+        }
+
+        for (const auto& row : rows) {
+            for (size_t c = 0; c < columns.size(); ++c) {
+                if (c > 0)
+                    out << delimiter;
+                logformat::formatValue(out, columns[c].type, row[c]);
+            }
+            out << '\n';
+        }
+        num_rows += rows.size();
+    }
+
+    out.flush();
+    if (damaged) {
+        cerr << "Skipped " << damaged << " damaged block(s); "
+             << num_rows << " rows converted" << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}